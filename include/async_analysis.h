@@ -0,0 +1,123 @@
+#ifndef LIBYT_PROJECT_INCLUDE_ASYNC_ANALYSIS_H_
+#define LIBYT_PROJECT_INCLUDE_ASYNC_ANALYSIS_H_
+
+#include <Python.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "data_structure_amr.h"
+#include "yt_type.h"
+
+struct AsyncAnalysisJob {
+  std::string function_name;
+  std::string str_function;  // function call with arguments, for logging
+  std::string arguments;     // arguments joined by commas
+  std::shared_ptr<PyObject> py_arguments;  // (args, kwargs) of typed arguments, or null
+  int exec_result = 0;
+  double exec_time = 0.0;
+  double wait_time = 0.0;
+};
+
+/**
+ * \class PythonGilGuard
+ * \brief Hold the GIL in the scope.
+ * \details
+ * 1. The main thread does not hold the GIL in between libyt API calls when inline
+ *    functions are run asynchronously, so every libyt API that touches Python must hold
+ *    this guard. It is a no-op if the thread already holds the GIL.
+ * 2. It is also a no-op if Python is not initialized, e.g. on processes without Python
+ *    in node aggregation.
+ */
+class PythonGilGuard {
+ private:
+  bool is_python_initialized_;
+  PyGILState_STATE gil_state_;
+
+ public:
+  PythonGilGuard()
+      : is_python_initialized_(Py_IsInitialized() != 0), gil_state_(PyGILState_UNLOCKED) {
+    if (is_python_initialized_) {
+      gil_state_ = PyGILState_Ensure();
+    }
+  }
+  ~PythonGilGuard() {
+    if (is_python_initialized_) {
+      PyGILState_Release(gil_state_);
+    }
+  }
+  PythonGilGuard(const PythonGilGuard& other) = delete;
+  PythonGilGuard& operator=(const PythonGilGuard& other) = delete;
+};
+
+/**
+ * \class PythonGilRelease
+ * \brief Release the GIL in the scope.
+ * \details
+ * 1. Collective MPI calls made inside Python must hold this, otherwise a process
+ *    blocked in the collective keeps the GIL from the other thread on it, which may be
+ *    the one the other processes are waiting for.
+ * 2. Must hold the GIL when it is constructed, and must not touch Python in the scope.
+ */
+class PythonGilRelease {
+ private:
+  PyThreadState* thread_state_;
+
+ public:
+  PythonGilRelease() : thread_state_(PyEval_SaveThread()) {}
+  ~PythonGilRelease() { PyEval_RestoreThread(thread_state_); }
+  PythonGilRelease(const PythonGilRelease& other) = delete;
+  PythonGilRelease& operator=(const PythonGilRelease& other) = delete;
+};
+
+template<typename Func>
+auto CallWithoutGil(Func func) -> decltype(func()) {
+  PythonGilRelease gil_release;
+  return func();
+}
+
+/**
+ * \namespace async_analysis
+ * \brief Run inline functions on a dedicated analysis thread, while the simulation
+ *        advances.
+ * \details
+ * 1. Jobs are executed in the order they are submitted. The analysis thread holds the
+ *    GIL while executing a job. Functions that block on the main thread release the GIL
+ *    while they are waiting.
+ * 2. Jobs submitted in a step belong to the live step. RetireStep moves the data
+ *    structure and the libyt Python dictionaries of the live step to a ring of at most
+ *    max_steps retired steps, so that the simulation can free and commit the next step
+ *    while the jobs are still running. Jobs of a retired step see its own copy of
+ *    libyt.param_yt, libyt.param_user, libyt.hierarchy, libyt.grid_data, and
+ *    libyt.particle_data. Jobs that have started on any MPI process finish on the live
+ *    step before it is retired, so that every process runs a job on the same data.
+ * 3. BeginStep reaps retired steps that are done on every MPI process, and applies the
+ *    backpressure policy if the ring is still full.
+ * 4. Wait blocks until every submitted job is done, and returns the finished jobs, so
+ *    that everything that needs MPI communication in libyt is done on the main thread.
+ * 5. FinishJob only records the local result of a job, whether it runs synchronously or
+ *    not. SyncStatus gathers load imbalance and function status of every job finished
+ *    since the last call in a single collective, e.g. once per step in yt_free.
+ */
+namespace async_analysis {
+void Enable(bool enable, int max_steps, yt_async_policy policy);
+bool IsEnabled();
+int GetMaxSteps();
+void ReleaseMainThreadGil();
+int BeginStep(std::vector<AsyncAnalysisJob>& finished_jobs);
+bool IsStepSkipped();
+void Submit(const AsyncAnalysisJob& job);
+void RetireStep(long step, DataStructureAmr& data_structure_amr, PyObject* py_param_yt,
+                PyObject* py_param_user);
+bool IsDone();
+bool HasPendingJobs();
+std::vector<AsyncAnalysisJob> Wait();
+void RunJob(AsyncAnalysisJob& job);
+int FinishJob(const AsyncAnalysisJob& job);
+int SyncStatus();
+DataStructureAmr* GetDataStructureAmrInUse();
+void Finalize();
+}  // namespace async_analysis
+
+#endif  // LIBYT_PROJECT_INCLUDE_ASYNC_ANALYSIS_H_
@@ -6,6 +6,7 @@
 #include <limits.h>
 #include <mpi.h>
 
+#include "comm_mpi.h"
 #include "timer.h"
 #include "yt_macro.h"
 
@@ -31,8 +32,8 @@ BigMpiStatus BigMpiAllgatherv(int* send_counts, const void* send_buffer,
   SET_TIMER(__PRETTY_FUNCTION__);
 
   int mpi_size, mpi_rank;
-  MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-  MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+  MPI_Comm_rank(CommMpi::GetComm(), &mpi_rank);
+  MPI_Comm_size(CommMpi::GetComm(), &mpi_size);
 
   // Count recv_counts, offsets, and split the buffer, if too large.
   int* recv_counts = new int[mpi_size];
@@ -69,7 +70,7 @@ BigMpiStatus BigMpiAllgatherv(int* send_counts, const void* send_buffer,
                        recv_counts,
                        offsets,
                        mpi_datatype,
-                       MPI_COMM_WORLD);
+                       CommMpi::GetComm());
       } else {
         MPI_Allgatherv(send_buffer,
                        0,
@@ -78,7 +79,7 @@ BigMpiStatus BigMpiAllgatherv(int* send_counts, const void* send_buffer,
                        recv_counts,
                        offsets,
                        mpi_datatype,
-                       MPI_COMM_WORLD);
+                       CommMpi::GetComm());
       }
 
       // New start point.
@@ -111,7 +112,7 @@ BigMpiStatus BigMpiAllgatherv(int* send_counts, const void* send_buffer,
                        recv_counts,
                        offsets,
                        mpi_datatype,
-                       MPI_COMM_WORLD);
+                       CommMpi::GetComm());
       } else {
         MPI_Allgatherv(send_buffer,
                        0,
@@ -120,7 +121,7 @@ BigMpiStatus BigMpiAllgatherv(int* send_counts, const void* send_buffer,
                        recv_counts,
                        offsets,
                        mpi_datatype,
-                       MPI_COMM_WORLD);
+                       CommMpi::GetComm());
       }
     }
   }
@@ -148,8 +149,8 @@ BigMpiStatus BigMpiGatherv(int root_rank, int* send_counts, const void* send_buf
   SET_TIMER(__PRETTY_FUNCTION__);
 
   int mpi_size, mpi_rank;
-  MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-  MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+  MPI_Comm_rank(CommMpi::GetComm(), &mpi_rank);
+  MPI_Comm_size(CommMpi::GetComm(), &mpi_size);
 
   // Count recv_counts, offsets, and split the buffer, if too large.
   int* recv_counts = new int[mpi_size];
@@ -187,7 +188,7 @@ BigMpiStatus BigMpiGatherv(int root_rank, int* send_counts, const void* send_buf
                     offsets,
                     *mpi_datatype,
                     root_rank,
-                    MPI_COMM_WORLD);
+                    CommMpi::GetComm());
       } else {
         MPI_Gatherv(send_buffer,
                     0,
@@ -197,7 +198,7 @@ BigMpiStatus BigMpiGatherv(int root_rank, int* send_counts, const void* send_buf
                     offsets,
                     *mpi_datatype,
                     root_rank,
-                    MPI_COMM_WORLD);
+                    CommMpi::GetComm());
       }
 
       // New start point.
@@ -231,7 +232,7 @@ BigMpiStatus BigMpiGatherv(int root_rank, int* send_counts, const void* send_buf
                     offsets,
                     *mpi_datatype,
                     root_rank,
-                    MPI_COMM_WORLD);
+                    CommMpi::GetComm());
       } else {
         MPI_Gatherv(send_buffer,
                     0,
@@ -241,7 +242,7 @@ BigMpiStatus BigMpiGatherv(int root_rank, int* send_counts, const void* send_buf
                     offsets,
                     *mpi_datatype,
                     root_rank,
-                    MPI_COMM_WORLD);
+                    CommMpi::GetComm());
       }
     }
   }
@@ -276,10 +277,17 @@ BigMpiStatus BigMpiBcast(int root_rank, long send_count, void* buffer,
   for (int i = 0; i < part; i++) {
     index = i * stride;
     if (i == part - 1) {
-      MPI_Bcast(&(((T*)buffer)[index]), remain, *mpi_datatype, root_rank, MPI_COMM_WORLD);
+      MPI_Bcast(&(((T*)buffer)[index]),
+                remain,
+                *mpi_datatype,
+                root_rank,
+                CommMpi::GetComm());
     } else {
-      MPI_Bcast(
-          &(((T*)buffer)[index]), (int)stride, *mpi_datatype, root_rank, MPI_COMM_WORLD);
+      MPI_Bcast(&(((T*)buffer)[index]),
+                (int)stride,
+                *mpi_datatype,
+                root_rank,
+                CommMpi::GetComm());
     }
   }
 
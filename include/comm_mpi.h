@@ -10,13 +10,26 @@
 /**
  * \class CommMpi
  * \brief Class to handle MPI communication
+ * \details
+ * 1. Communication is done on comm_, which is the communicator passed to yt_initialize,
+ *    or the group this process belongs to in in-transit mode.
+ * 2. A communicator set for the calling thread has higher priority, so that collectives
+ *    called by the analysis thread do not match those called by the main thread at the
+ *    same time.
  */
 class CommMpi {
  public:
   static int mpi_rank_;
   static int mpi_size_;
   static int mpi_root_;
+  static MPI_Comm comm_;
+  static thread_local MPI_Comm thread_comm_;
   static void InitializeInfo(int mpi_root = 0);
+  static MPI_Comm GetComm() {
+    return (thread_comm_ != MPI_COMM_NULL) ? thread_comm_ : comm_;
+  }
+  static void SetComm(MPI_Comm comm) { comm_ = comm; }
+  static void SetThreadComm(MPI_Comm comm) { thread_comm_ = comm; }
   static void SetAllNumGridsLocal(int* all_num_grids_local, int num_grids_local);
   static int CheckAllStates(int local_state, int desired_state, int success_value,
                             int failure_value);
@@ -25,6 +25,23 @@ struct MpiRmaAddress {
 struct CommMpiRmaQueryInfo {
   int mpi_rank;
   long id;
+  int label = 0;  ///< Only used by data classes that carry a label
+};
+
+/**
+ * \struct AmrDataArrayLabeled
+ * \brief Data array labeled with the field or particle attribute it belongs to.
+ * \details
+ * 1. Used to exchange different fields and particle attributes in a single RMA window.
+ * 2. Unused dimensions are set to 1.
+ */
+struct AmrDataArrayLabeled {
+  long id = -1;
+  int label = -1;
+  yt_dtype data_dtype = YT_DTYPE_UNKNOWN;
+  long data_dim[3]{1, 1, 1};
+  void* data_ptr = nullptr;
+  bool contiguous_in_x = false;
 };
 
 enum class CommMpiRmaStatus : int { kMpiFailed = 0, kMpiSuccess = 1 };
@@ -48,6 +65,18 @@ class CommMpiRma {
   std::vector<long> search_range_;
   std::vector<DataClass> mpi_fetched_data_;
 
+  long memory_budget_;
+  std::string spill_dir_;
+  long resident_size_;
+
+  // Fetch ids split into chunks, each chunk is fetched in its own epoch
+  std::vector<long> fetch_index_list_;
+  std::vector<std::size_t> chunk_end_list_;
+  std::size_t fetch_pos_;
+  int epoch_;
+  int num_epochs_;
+  CommMpiRmaStatus fetch_status_;
+
   std::string data_group_name_;
   std::string data_format_;
   std::string error_str_;
@@ -60,7 +89,10 @@ class CommMpiRma {
   CommMpiRmaStatus PrepareData(const std::vector<DataClass>& prepared_data_list);
   CommMpiRmaStatus GatherAllPreparedData(
       const std::vector<DataClass>& prepared_data_list);
-  CommMpiRmaStatus FetchRemoteData(const std::vector<CommMpiRmaQueryInfo>& fetch_id_list);
+  CommMpiRmaStatus SplitFetchChunks(
+      const std::vector<CommMpiRmaQueryInfo>& fetch_id_list);
+  CommMpiRmaStatus FetchRemoteDataChunk();
+  void* AllocateFetchBuffer(long data_size);
   CommMpiRmaStatus FreeMpiWindow();
   CommMpiRmaStatus DetachBuffer(const std::vector<DataClass>& prepared_data_list);
   CommMpiRmaStatus CleanUp(const std::vector<DataClass>& prepared_data_list);
@@ -68,13 +100,22 @@ class CommMpiRma {
   // Custom implementations for derived classes
   virtual long GetDataSize(const DataClass& data) = 0;
   virtual long GetDataLen(const DataClass& data) = 0;
-  // TODO: create virtual function to select the data (ex: id)
+  virtual bool IsQueriedData(const DataClass& data, const CommMpiRmaQueryInfo& query) {
+    return data.id == query.id;
+  }
 
  public:
   CommMpiRma(const std::string& data_group_name, const std::string& data_format);
   CommMpiRmaReturn<DataClass> GetRemoteData(
       const std::vector<DataClass>& prepared_data_list,
       const std::vector<CommMpiRmaQueryInfo>& fetch_id_list);
+  CommMpiRmaReturn<DataClass> BeginChunkedRemoteData(
+      const std::vector<DataClass>& prepared_data_list,
+      const std::vector<CommMpiRmaQueryInfo>& fetch_id_list);
+  CommMpiRmaReturn<DataClass> GetNextRemoteDataChunk();
+  bool HasNextRemoteDataChunk() const { return epoch_ < num_epochs_; }
+  void EndChunkedRemoteData(const std::vector<DataClass>& prepared_data_list);
+  void SetMemoryBudget(long memory_budget, const std::string& spill_dir);
   const std::vector<DataClass>& GetFetchedData() const { return mpi_fetched_data_; }
   const std::string& GetErrorStr() const { return error_str_; }
   MPI_Datatype& GetMpiAddressDataType() { return mpi_rma_data_type_; }
@@ -128,5 +169,24 @@ class CommMpiRmaAmrDataArray1D : public CommMpiRma<AmrDataArray1D> {
   }
 };
 
+class CommMpiRmaAmrDataArrayLabeled : public CommMpiRma<AmrDataArrayLabeled> {
+ private:
+  static MPI_Datatype mpi_data_type_;
+  long GetDataSize(const AmrDataArrayLabeled& data) override;
+  long GetDataLen(const AmrDataArrayLabeled& data) override;
+  bool IsQueriedData(const AmrDataArrayLabeled& data,
+                     const CommMpiRmaQueryInfo& query) override {
+    return data.id == query.id && data.label == query.label;
+  }
+  static void InitializeMpiDataType();
+
+ public:
+  CommMpiRmaAmrDataArrayLabeled(const std::string& data_group_name,
+                                const std::string& data_format);
+  MPI_Datatype& GetMpiDataType() override {
+    return CommMpiRmaAmrDataArrayLabeled::mpi_data_type_;
+  }
+};
+
 #endif  // #ifndef SERIAL_MODE
 #endif  // LIBYT_PROJECT_INCLUDE_COMM_MPI_RMA_H_
@@ -8,6 +8,7 @@
 #include <Python.h>
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "yt_type.h"
@@ -97,6 +98,15 @@ class DataStructureAmr {
   PyObject* py_grid_data_;
   PyObject* py_particle_data_;
 
+  // Name lookup tables, they are built at BindInfoToPython
+  bool has_name_lookup_tables_;
+  std::unordered_map<std::string, int> field_index_map_;
+  std::unordered_map<std::string, int> particle_index_map_;
+  std::vector<std::unordered_map<std::string, int>> particle_attr_index_map_;
+  std::vector<PyObject*> py_field_name_list_;
+  std::vector<PyObject*> py_particle_type_list_;
+  std::vector<std::vector<PyObject*>> py_particle_attr_name_list_;
+
   // Hierarchy
   long num_grids_;
   int num_fields_;
@@ -136,8 +146,10 @@ class DataStructureAmr {
   void CleanUpParticleList();
   void CleanUpFullHierarchyStorageForPython();
   void CleanUpLocalDataPythonBindings() const;
+  void CleanUpNameLookupTables();
 
   // Sub operations
+  void BuildNameLookupTables();
   DataStructureOutput GatherAllHierarchy(int mpi_root, yt_hierarchy** full_hierarchy_ptr,
                                          long*** full_particle_count_ptr) const;
   DataStructureOutput BindFieldListToPython(PyObject* py_dict,
@@ -146,6 +158,12 @@ class DataStructureAmr {
                                                const std::string& py_dict_name) const;
   DataStructureOutput BindLocalFieldDataToPython(const yt_grid& grid) const;
   DataStructureOutput BindLocalParticleDataToPython(const yt_grid& grid) const;
+  const yt_grid* FindGridLocal(long gid) const;
+  DataStructureOutput GetGridsLocalFieldDataByIndex(long gid, int field_index,
+                                                    yt_data* field_data) const;
+  DataStructureOutput GetGridsLocalParticleDataByIndex(long gid, int ptype_index,
+                                                       int attr_index,
+                                                       yt_data* par_data) const;
 
   // Check data method
 #ifndef SERIAL_MODE
@@ -185,12 +203,18 @@ class DataStructureAmr {
   DataStructureOutput BindInfoToPython(const std::string& py_dict_name,
                                        PyObject* py_dict);
   DataStructureOutput BindAllHierarchyToPython(int mpi_root);
+  DataStructureOutput BindLocalHierarchy();
+  DataStructureOutput CheckLocalData() const;
   DataStructureOutput BindLocalDataToPython() const;
+  DataStructureOutput SnapshotLocalDataInPython(long* num_bytes) const;
   void CleanUpGridsLocal();  // This method is public due to bad API design :(
   void CleanUp();
 
   // Get basic info
   int GetDimensionality() const { return dimensionality_; }
+  PyObject* GetPythonHierarchy() const { return py_hierarchy_; }
+  PyObject* GetPythonGridData() const { return py_grid_data_; }
+  PyObject* GetPythonParticleData() const { return py_particle_data_; }
 
   // Look up field/particle info method.
   yt_grid* GetGridsLocal() const { return grids_local_; }
@@ -224,6 +248,11 @@ class DataStructureAmr {
   DataStructureOutput GetPythonBoundFullHierarchyGridParticleCount(long gid,
                                                                    const char* ptype,
                                                                    long* par_count) const;
+  DataStructureOutput GetPythonBoundFullHierarchyGridParticleCount(
+      const std::vector<long>& gid_list, int ptype_index,
+      std::vector<long>& par_count_list) const;
+  DataStructureOutput GetPythonBoundFullHierarchyGridParticleCountByIndex(
+      long gid, int ptype_index, long* par_count) const;
 
   // Look up data methods
   DataStructureOutput GetPythonBoundLocalFieldData(long gid, const char* field_name,
@@ -231,6 +260,11 @@ class DataStructureAmr {
   DataStructureOutput GetPythonBoundLocalParticleData(long gid, const char* ptype,
                                                       const char* attr,
                                                       yt_data* par_data) const;
+  DataStructureOutput GetPythonBoundLocalFieldDataByIndex(long gid, int field_index,
+                                                          yt_data* field_data) const;
+  DataStructureOutput GetPythonBoundLocalParticleDataByIndex(long gid, int ptype_index,
+                                                             int attr_index,
+                                                             yt_data* par_data) const;
 };
 
 #endif  // LIBYT_PROJECT_INCLUDE_DATA_STRUCTURE_AMR_H_
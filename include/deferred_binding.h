@@ -0,0 +1,31 @@
+#ifndef LIBYT_PROJECT_INCLUDE_DEFERRED_BINDING_H_
+#define LIBYT_PROJECT_INCLUDE_DEFERRED_BINDING_H_
+
+/**
+ * \namespace deferred_binding
+ * \brief Bind the full hierarchy and local data to Python only in steps where an inline
+ *        function runs.
+ * \details
+ * 1. It is only used if yt_param_libyt defer_binding is on, otherwise yt_commit always
+ *    binds right away.
+ * 2. Inline functions called through yt_run_* are recorded in each step. yt_commit
+ *    binds right away if any function called in the previous step will run in this
+ *    step, which is neither set to idle nor holding a trigger that does not fire.
+ *    Otherwise, binding is deferred, and local grids are kept until then.
+ * 3. EnsureBound binds deferred data before Python touches it, e.g. the first inline
+ *    function that actually runs, or entering the interactive prompt. It is collective,
+ *    the same as binding in yt_commit.
+ * 4. The first step always binds in yt_commit, since there is no history yet.
+ */
+namespace deferred_binding {
+void RecordCall(const char* function_name);
+bool WillAnyFunctionRun();
+int Bind();
+void Defer();
+bool IsDeferred();
+int EnsureBound();
+void EndStep();
+void Finalize();
+}  // namespace deferred_binding
+
+#endif  // LIBYT_PROJECT_INCLUDE_DEFERRED_BINDING_H_
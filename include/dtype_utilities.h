@@ -5,6 +5,7 @@
 #include <mpi.h>
 #endif
 
+#include "memory_tracker.h"
 #include "yt_type.h"
 
 namespace dtype_utilities {
@@ -15,7 +16,7 @@ MPI_Datatype YtDtype2MpiDtype(yt_dtype data_type);
 yt_dtype NumPyDtype2YtDtype(int npy_dtype);
 int YtDtype2NumPyDtype(yt_dtype data_type);
 int GetYtDtypeSize(yt_dtype data_type);
-void* AllocateMemory(yt_dtype data_type, unsigned long length);
+void* AllocateMemory(yt_dtype data_type, unsigned long length, MemoryCategory category);
 }  // namespace dtype_utilities
 
 #endif  // LIBYT_PROJECT_INCLUDE_DTYPE_UTILITIES_H_
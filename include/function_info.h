@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "perf_counter.h"
+
 class FunctionInfo {
  public:
   enum RunStatus : int { kNotSetYet = -1, kWillIdle = 0, kWillRun = 1 };
@@ -22,6 +24,8 @@ class FunctionInfo {
   ExecuteStatus status_;
   ExecuteStatus all_status_;
   std::vector<std::string> all_error_msg_;
+  bool has_load_imbalance_;
+  PerfLoadImbalance load_imbalance_;
   static int mpi_size_;
   static int mpi_root_;
   static int mpi_rank_;
@@ -39,6 +43,13 @@ class FunctionInfo {
   void SetRun(RunStatus run) { run_ = run; }
   ExecuteStatus GetStatus() { return status_; }
   void SetAllStatus(ExecuteStatus status) { all_status_ = status; }
+  void SetLoadImbalance(const PerfLoadImbalance& load_imbalance) {
+    load_imbalance_ = load_imbalance;
+    has_load_imbalance_ = true;
+  }
+  void ClearLoadImbalance() { has_load_imbalance_ = false; }
+  bool HasLoadImbalance() { return has_load_imbalance_; }
+  const PerfLoadImbalance& GetLoadImbalance() { return load_imbalance_; }
 
   void SetStatus(ExecuteStatus status);
   void SetStatusUsingPythonResult();
@@ -62,6 +73,7 @@ class FunctionInfoList {
 
   void ResetEveryFunctionStatus();
   int GetFunctionIndex(const std::string& function_name);
+  bool IsSetToIdle(const std::string& function_name);
   int AddNewFunction(const std::string& function_name, FunctionInfo::RunStatus run);
   void RunEveryFunction();
 };
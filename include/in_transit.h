@@ -0,0 +1,44 @@
+#ifndef LIBYT_PROJECT_INCLUDE_IN_TRANSIT_H_
+#define LIBYT_PROJECT_INCLUDE_IN_TRANSIT_H_
+
+#include <string>
+
+#include "yt_type.h"
+
+/**
+ * \namespace in_transit
+ * \brief Ship committed data from simulation processes to processes dedicated to inline
+ *        analysis.
+ * \details
+ * 1. Split divides the libyt communicator into a simulation group and an analysis group
+ *    made of the last num_analysis_ranks processes, and libyt communicates within the
+ *    group this process belongs to afterward.
+ * 2. Each analysis process aggregates the local grids of a contiguous block of
+ *    simulation processes. Derived fields and particle attributes are materialized on
+ *    the simulation processes before they are sent.
+ * 3. The root simulation process forwards yt_commit, yt_run_FunctionArguments,
+ *    yt_run_FunctionWithArgs, yt_free, and yt_finalize as commands to every analysis
+ *    process, and Serve replays them there with the same libyt API.
+ * 4. Sends are non-blocking and the data is staged, so the simulation only waits for
+ *    the analysis processes when the previous step has not been received yet.
+ * 5. Simulation processes do not initialize Python. fig_basename and user parameters
+ *    are recorded as plain values, and analysis processes set them in libyt.param_yt
+ *    and libyt.param_user.
+ */
+namespace in_transit {
+int Split(int num_analysis_ranks);
+bool IsEnabled();
+bool IsAnalysisRank();
+bool IsSimulationRank();
+int GetNumAnalysisRanks();
+void RecordFigBasename(const char* fig_basename);
+int RecordUserParameter(const char* key, yt_dtype data_dtype, int n, const void* input);
+int SendCommit();
+int SendRun(const std::string& function_name, const std::string& arguments);
+int SendRunWithArgs(const char* function_name, const yt_arg* args, int num_args);
+int SendFree();
+int Serve();
+void Finalize();
+}  // namespace in_transit
+
+#endif  // LIBYT_PROJECT_INCLUDE_IN_TRANSIT_H_
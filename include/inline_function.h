@@ -0,0 +1,33 @@
+#ifndef LIBYT_PROJECT_INCLUDE_INLINE_FUNCTION_H_
+#define LIBYT_PROJECT_INCLUDE_INLINE_FUNCTION_H_
+
+#include <Python.h>
+
+#include <string>
+
+/**
+ * \namespace inline_function
+ * \brief Call inline functions in the inline script namespace through the Python C API.
+ * \details
+ * 1. The function object is looked up in the namespace once and cached per function
+ *    name, together with the arguments compiled to a code object. A call only evaluates
+ *    the arguments and calls the function, nothing is parsed again as long as the
+ *    arguments stay the same.
+ * 2. The cached function is dropped once the name is bound to another object in the
+ *    namespace, and InvalidateCache drops every cached function, e.g. after reloading
+ *    the script.
+ * 3. Under INTERACTIVE_MODE and JUPYTER_KERNEL, the traceback of an exception raised by
+ *    the function is stored under libyt.interactive_mode["func_err_msg"], and the call
+ *    succeeds. Otherwise, it is printed and the call fails.
+ * 4. CallWithObjects passes args and kwargs that are already Python objects, e.g.
+ *    typed arguments of yt_run_FunctionWithArgs, and skips evaluating arguments.
+ * 5. Must hold the GIL.
+ */
+namespace inline_function {
+int Call(const std::string& function_name, const std::string& arguments);
+int CallWithObjects(const std::string& function_name, PyObject* py_args,
+                    PyObject* py_kwargs);
+void InvalidateCache();
+}  // namespace inline_function
+
+#endif  // LIBYT_PROJECT_INCLUDE_INLINE_FUNCTION_H_
@@ -38,14 +38,20 @@ int yt_set_UserParameterUlong(const char* key, const int n, const unsigned long*
 int yt_set_UserParameterFloat(const char* key, const int n, const float* input);          /*!< \ingroup api_yt_set_UserParameter */
 int yt_set_UserParameterDouble(const char* key, const int n, const double* input);        /*!< \ingroup api_yt_set_UserParameter */
 int yt_set_UserParameterString(const char* key, const char* input);                       /*!< \ingroup api_yt_set_UserParameter */
+int yt_set_FunctionTrigger(const char* function_name, const yt_trigger* trigger);         /*!< \ingroup api_yt_set_FunctionTrigger */
 int yt_commit();                                                                          /*!< \ingroup api_yt_commit */
 int yt_free();                                                                            /*!< \ingroup api_yt_free */
 int yt_run_FunctionArguments(const char* function_name, int argc, ...);                   /*!< \ingroup api_yt_run_Function */
 int yt_run_Function(const char* function_name);                                           /*!< \ingroup api_yt_run_Function */
+int yt_run_FunctionWithArgs(const char* function_name, const yt_arg* args, int num_args); /*!< \ingroup api_yt_run_Function */
+int yt_wait();                                                                            /*!< \ingroup api_yt_wait */
+int yt_test(bool* is_done);                                                               /*!< \ingroup api_yt_wait */
 int yt_run_InteractiveMode(const char* flag_file_name);                                   /*!< \ingroup api_yt_run_InteractiveMode */
 int yt_run_ReloadScript(const char* flag_file_name, const char* reload_file_name,
                         const char* script_name);                                         /*!< \ingroup api_yt_run_ReloadScript */
 int yt_run_JupyterKernel(const char* flag_file_name, bool use_connection_file);           /*!< \ingroup api_yt_run_JupyterKernel */
+int yt_get_InTransitRole(bool* is_analysis_rank);                                         /*!< \ingroup api_yt_run_InTransit */
+int yt_run_InTransit();                                                                   /*!< \ingroup api_yt_run_InTransit */
 
 // For derived field function to get grid information by GID and by field_name.
 int yt_getGridInfo_Dimensions(const long gid, int (*dimensions)[3]);                        /*!< \ingroup api_yt_getGridInfo */
@@ -58,6 +64,12 @@ int yt_getGridInfo_ParticleCount(const long gid, const char* ptype, long* par_co
 int yt_getGridInfo_FieldData(const long gid, const char* field_name, yt_data* field_data);  /*!< \ingroup api_yt_getGridInfo */
 int yt_getGridInfo_ParticleData(const long gid, const char* ptype, const char* attr,
                                 yt_data* par_data);                                         /*!< \ingroup api_yt_getGridInfo */
+int yt_getGridInfo_ParticleCountByIndex(const long gid, const int ptype_index,
+                                        long* par_count);                                   /*!< \ingroup api_yt_getGridInfo */
+int yt_getGridInfo_FieldDataByIndex(const long gid, const int field_index,
+                                    yt_data* field_data);                                   /*!< \ingroup api_yt_getGridInfo */
+int yt_getGridInfo_ParticleDataByIndex(const long gid, const int ptype_index,
+                                       const int attr_index, yt_data* par_data);            /*!< \ingroup api_yt_getGridInfo */
 // clang-format on
 #ifdef __cplusplus
 }
@@ -13,9 +13,7 @@
 #include "function_info.h"
 #include "libyt_python_shell.h"
 #endif
-#ifdef SUPPORT_TIMER
 #include "timer_control.h"
-#endif
 
 //-------------------------------------------------------------------------------------------------------
 // Class       :  LibytProcessControl
@@ -36,10 +34,8 @@ class LibytProcessControl {
   CommMpi comm_mpi_;
 #endif
 
-#ifdef SUPPORT_TIMER
   // Timer Control
   TimerControl timer_control;
-#endif
 
 #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
   // Python shell
@@ -60,6 +56,7 @@ class LibytProcessControl {
   // libyt parameters
   yt_param_libyt param_libyt_;
   PyObject* py_libyt_info_;
+  PyObject* py_perf_;
 
   // yt and user parameters
   yt_param_yt param_yt_;
@@ -68,6 +65,8 @@ class LibytProcessControl {
 
   // Amr data structure
   DataStructureAmr data_structure_amr_;
+  DataStructureAmr& GetDataStructureAmr();
+  bool IsGridsCommitted();
 
   // Singleton methods
   LibytProcessControl(const LibytProcessControl& other) = delete;
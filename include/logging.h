@@ -1,22 +1,36 @@
 #ifndef LIBYT_PROJECT_INCLUDE_LOGGING_H_
 #define LIBYT_PROJECT_INCLUDE_LOGGING_H_
 
+#include <string>
+
+/**
+ * \namespace logging
+ * \brief Log messages of libyt.
+ * \details
+ * 1. By default, messages are written to stdout/stderr right away, info only on root.
+ * 2. If aggregation is on, warning and debug messages are buffered on each MPI process,
+ *    and Flush gathers them to root, which writes each distinct message once as
+ *    "N ranks: message". Flush is a collective operation. Error messages are still
+ *    written right away, since the simulation may abort before Flush, and they are
+ *    also buffered, so that they show up in the summary and the log file.
+ * 3. If a log file is set, root also appends every flushed message to it as a JSON line,
+ *    info messages included.
+ */
 namespace logging {
 void LogInfo(const char* format, ...);
 void LogWarning(const char* format, ...);
 void LogDebug(const char* format, ...);
 void LogError(const char* format, ...);
+void LogErrorAt(const char* file, int line, const char* function, const char* format,
+                ...);
+void SetAggregation(bool aggregate, const std::string& log_file);
+bool IsAggregated();
+void Flush();
 }  // namespace logging
 
 #define YT_ABORT(...)                                                                    \
   {                                                                                      \
-    logging::LogError(__VA_ARGS__);                                                      \
-    fprintf(stderr,                                                                      \
-            "%13s==> file <%s>, line <%d>, function <%s>\n",                             \
-            "",                                                                          \
-            __FILE__,                                                                    \
-            __LINE__,                                                                    \
-            __FUNCTION__);                                                               \
+    logging::LogErrorAt(__FILE__, __LINE__, __FUNCTION__, __VA_ARGS__);                  \
     return YT_FAIL;                                                                      \
   }
 
@@ -43,6 +43,7 @@ class MagicCommand {
   int SetFunctionIdle(const std::vector<std::string>& args);
   int GetFunctionStatusMarkdown(const std::vector<std::string>& args);
   int GetFunctionStatusText(const std::vector<std::string>& args);
+  int SetProfile(const std::vector<std::string>& args);
 
  public:
   explicit MagicCommand(EntryPoint entry_point);
@@ -0,0 +1,24 @@
+#ifndef LIBYT_PROJECT_INCLUDE_MEMORY_SPILL_H_
+#define LIBYT_PROJECT_INCLUDE_MEMORY_SPILL_H_
+
+#include <string>
+
+/**
+ * \namespace memory_spill
+ * \brief Buffers backed by memory-mapped files in node-local storage.
+ * \details
+ * 1. Used when libyt-owned buffers would exceed the memory budget set in
+ *    yt_param_libyt, so that the pages can be written back to disk instead of staying
+ *    resident in memory alongside the simulation.
+ * 2. The backing file is unlinked right after it is mapped, so it is removed by the
+ *    operating system once the buffer is unmapped or the process exits.
+ * 3. Buffers allocated here must be freed by FreeSpillBuffer, not by free().
+ */
+namespace memory_spill {
+void* AllocateSpillBuffer(const std::string& spill_dir, long size);
+bool IsSpillBuffer(void* ptr);
+void ReleaseResidentPages(void* ptr);
+void FreeSpillBuffer(void* ptr);
+}  // namespace memory_spill
+
+#endif  // LIBYT_PROJECT_INCLUDE_MEMORY_SPILL_H_
@@ -0,0 +1,53 @@
+#ifndef LIBYT_PROJECT_INCLUDE_MEMORY_TRACKER_H_
+#define LIBYT_PROJECT_INCLUDE_MEMORY_TRACKER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "perf_counter.h"
+
+enum class MemoryCategory : int {
+  kMemoryHierarchy = 0,
+  kMemoryDataHub = 1,
+  kMemoryRma = 2,
+};
+
+/**
+ * \namespace memory_tracker
+ * \brief Current and peak bytes of libyt-owned allocations on each MPI process, by
+ *        category.
+ * \details
+ * 1. Allocations are tracked by address from Allocate/NewArray (or Track) until they are
+ *    freed by Free/DeleteArray (or Untrack).
+ * 2. Once the ownership of a buffer is passed to Python, e.g. a NumPy array owns the
+ *    data, the buffer is untracked, since it is no longer owned by libyt.
+ * 3. Peak bytes are the high-water mark since the last ResetPeak, which is called at the
+ *    end of each step in yt_free.
+ */
+namespace memory_tracker {
+void* Allocate(MemoryCategory category, std::size_t size);
+void Free(void* ptr);
+void Track(MemoryCategory category, const void* ptr, std::size_t size);
+void Untrack(const void* ptr);
+std::size_t GetCurrentBytes(MemoryCategory category);
+std::size_t GetPeakBytes(MemoryCategory category);
+std::size_t GetTotalPeakBytes();
+void ResetPeak();
+void AddToPerfCounters();
+void LogPeak(const std::vector<PerfCounterSummary>& summary_list);
+
+template<typename T>
+T* NewArray(MemoryCategory category, std::size_t length) {
+  T* ptr = new T[length];
+  Track(category, ptr, length * sizeof(T));
+  return ptr;
+}
+
+template<typename T>
+void DeleteArray(T* ptr) {
+  Untrack(ptr);
+  delete[] ptr;
+}
+}  // namespace memory_tracker
+
+#endif  // LIBYT_PROJECT_INCLUDE_MEMORY_TRACKER_H_
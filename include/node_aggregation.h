@@ -0,0 +1,32 @@
+#ifndef LIBYT_PROJECT_INCLUDE_NODE_AGGREGATION_H_
+#define LIBYT_PROJECT_INCLUDE_NODE_AGGREGATION_H_
+
+/**
+ * \namespace node_aggregation
+ * \brief Run Python only on one process per node, and let the other processes on the
+ *        node share committed data with it through shared memory.
+ * \details
+ * 1. Split divides the libyt communicator into node leaders, which are the first
+ *    process on each node, and node members, which never initialize Python. libyt
+ *    communicates within the group this process belongs to afterward.
+ * 2. A node leader holds the local grids of every process on its node, so
+ *    num_grids_local of a node leader is the sum of them.
+ * 3. Node members copy their local grids and data to a shared memory window in
+ *    yt_commit. Derived fields and particle attributes are materialized there, since
+ *    node leaders cannot call functions of other processes.
+ * 4. The window is freed in yt_free, which is collective on the node, so node members
+ *    wait there until their node leader is done with the data.
+ */
+namespace node_aggregation {
+int Split();
+bool IsEnabled();
+bool IsLeader();
+bool IsMember();
+int AggregateNumGridsLocal(int num_grids_local);
+int ShareGrids();
+int GatherGrids();
+void FreeSharedGrids();
+void Finalize();
+}  // namespace node_aggregation
+
+#endif  // LIBYT_PROJECT_INCLUDE_NODE_AGGREGATION_H_
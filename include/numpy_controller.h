@@ -27,6 +27,8 @@ PyObject* ArrayToNumPyArray(int dim, npy_intp* npy_dim, yt_dtype data_dtype,
                             void* data_ptr, bool readonly = false,
                             bool owned_by_python = false);
 NumPyArray GetNumPyArrayInfo(PyObject* py_array);
+PyObject* CopyNumPyArray(PyObject* py_array, bool readonly = false);
+long GetNumPyArrayNumBytes(PyObject* py_array);
 }  // namespace numpy_controller
 
 #endif  // LIBYT_PROJECT_INCLUDE_NUMPY_CONTROLLER_H_
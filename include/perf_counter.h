@@ -0,0 +1,70 @@
+#ifndef LIBYT_PROJECT_INCLUDE_PERF_COUNTER_H_
+#define LIBYT_PROJECT_INCLUDE_PERF_COUNTER_H_
+
+#include <Python.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct PerfCounterSummary {
+  std::string name;
+  double min;
+  double max;
+  double mean;
+  int max_rank;
+};
+
+struct PerfLoadImbalance {
+  double max;
+  double mean;
+  int max_rank;
+  double wait_max;
+};
+
+/**
+ * \namespace perf_counter
+ * \brief Named counters accumulated on each MPI process during one in situ step.
+ * \details
+ * 1. Counters are keyed by name, e.g. "commit.gather_time" or "rma.bytes", and are
+ *    added to by the module that owns the work. Time is in seconds.
+ * 2. Summarize reduces every counter to min/max/mean over all MPI processes. It is a
+ *    collective operation, counters missing on a process count as 0 there.
+ * 3. Counters are cleared by Reset at the end of each step in yt_free.
+ * 4. GetLoadImbalance finds the slowest MPI process from the time spent by each of
+ *    them, which is already gathered and indexed by rank.
+ */
+namespace perf_counter {
+void Add(const std::string& name, double value);
+double Get(const std::string& name);
+void Reset();
+std::vector<PerfCounterSummary> Summarize();
+PerfLoadImbalance GetLoadImbalance(const std::vector<double>& times,
+                                   const std::vector<double>& wait_times);
+int BindToPython(PyObject* py_perf, long step,
+                 const std::vector<PerfCounterSummary>& summary_list);
+int AppendToFile(const std::string& filename, long step,
+                 const std::vector<PerfCounterSummary>& summary_list);
+
+/**
+ * \class ScopedTimer
+ * \brief Add wall time elapsed between construction and destruction to a counter.
+ */
+class ScopedTimer {
+ private:
+  const char* name_;
+  std::chrono::steady_clock::time_point start_;
+
+ public:
+  explicit ScopedTimer(const char* name)
+      : name_(name), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedTimer() {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+    Add(name_, elapsed.count());
+  }
+  ScopedTimer(const ScopedTimer& other) = delete;
+  ScopedTimer& operator=(const ScopedTimer& other) = delete;
+};
+}  // namespace perf_counter
+
+#endif  // LIBYT_PROJECT_INCLUDE_PERF_COUNTER_H_
@@ -0,0 +1,27 @@
+#ifndef LIBYT_PROJECT_INCLUDE_PYTHON_PROFILER_H_
+#define LIBYT_PROJECT_INCLUDE_PYTHON_PROFILER_H_
+
+#include <string>
+
+/**
+ * \namespace python_profiler
+ * \brief Opt-in sampling profiler of Python code run by libyt.
+ * \details
+ * 1. A Python thread samples the stack of the thread running the inline function or the
+ *    code cell every few milliseconds, and counts each stack in collapsed format
+ *    "root;caller;callee count", which can be read by flamegraph tools.
+ * 2. The root frame of each stack is the label passed to Start, which is the inline
+ *    function name or the cell name, so that it matches the python-exec events in the
+ *    time profile.
+ * 3. Flush is a collective operation. It sums up the samples of every MPI process on
+ *    root, which rewrites the file with the samples of all the steps so far.
+ */
+namespace python_profiler {
+bool Enable(const std::string& filename);
+bool IsEnabled();
+void Start(const std::string& label);
+void Stop();
+int Flush();
+}  // namespace python_profiler
+
+#endif  // LIBYT_PROJECT_INCLUDE_PYTHON_PROFILER_H_
@@ -0,0 +1,68 @@
+#ifndef LIBYT_PROJECT_INCLUDE_REMOTE_DATA_ITERATOR_H_
+#define LIBYT_PROJECT_INCLUDE_REMOTE_DATA_ITERATOR_H_
+#ifndef SERIAL_MODE
+
+#include <Python.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "comm_mpi_rma.h"
+#include "data_hub_amr.h"
+
+enum class RemoteDataIteratorStatus : int {
+  kIteratorFailed = 0,
+  kIteratorSuccess = 1,
+  kIteratorEnd = 2
+};
+
+/**
+ * \class RemoteDataIterator
+ * \brief Fetch remote data chunk by chunk, and wrap each chunk to a Python dictionary.
+ * \details
+ * 1. Each call to Next is a collective operation, every MPI process must iterate
+ *    through it the same number of times until it reaches the end.
+ * 2. Chunks are bounded by the memory budget set in yt_param_libyt.
+ */
+class RemoteDataIterator {
+ protected:
+  std::string error_str_;
+
+ public:
+  virtual ~RemoteDataIterator() = default;
+  virtual RemoteDataIteratorStatus Next(PyObject** py_chunk) = 0;
+  const std::string& GetErrorStr() const { return error_str_; }
+};
+
+template<typename DataClass, typename RmaDataClass>
+class RemoteFieldIterator : public RemoteDataIterator {
+ private:
+  std::vector<std::string> fname_list_;
+  std::vector<long> prepare_id_list_;
+  std::vector<CommMpiRmaQueryInfo> fetch_data_list_;
+
+  std::size_t field_index_;
+  bool is_fetching_;
+  const std::vector<DataClass>* prepared_data_list_;
+  DataHubAmrField<DataClass> local_amr_data_;
+  std::unique_ptr<RmaDataClass> rma_;
+
+  RemoteDataIteratorStatus BeginField();
+  void EndField();
+
+ public:
+  RemoteFieldIterator(const std::vector<std::string>& fname_list,
+                      const std::vector<long>& prepare_id_list,
+                      const std::vector<CommMpiRmaQueryInfo>& fetch_data_list);
+  ~RemoteFieldIterator() override;
+  RemoteDataIteratorStatus Next(PyObject** py_chunk) override;
+};
+
+RemoteDataIterator* CreateRemoteFieldIterator(
+    int dimensionality, const std::vector<std::string>& fname_list,
+    const std::vector<long>& prepare_id_list,
+    const std::vector<CommMpiRmaQueryInfo>& fetch_data_list);
+
+#endif  // #ifndef SERIAL_MODE
+#endif  // LIBYT_PROJECT_INCLUDE_REMOTE_DATA_ITERATOR_H_
@@ -0,0 +1,51 @@
+#ifndef LIBYT_PROJECT_INCLUDE_REMOTE_DATA_REQUEST_H_
+#define LIBYT_PROJECT_INCLUDE_REMOTE_DATA_REQUEST_H_
+#ifndef SERIAL_MODE
+
+#include <Python.h>
+
+#include <string>
+#include <vector>
+
+#include "comm_mpi_rma.h"
+
+enum class RemoteDataRequestStatus : int { kRequestFailed = 0, kRequestSuccess = 1 };
+
+struct RemoteParticleRequest {
+  std::string ptype;
+  std::vector<std::string> attr_list;
+};
+
+/**
+ * \class RemoteDataRequest
+ * \brief Fetch remote field and particle data in one collective round.
+ * \details
+ * 1. Every field and particle attribute is labeled and exposed in a single RMA window,
+ *    so that metadata is gathered once and all the data is fetched in the same epochs.
+ * 2. Fetch is a collective operation. Every MPI process must request the same fields
+ *    and particle attributes in the same order.
+ */
+class RemoteDataRequest {
+ private:
+  std::vector<std::string> fname_list_;
+  std::vector<RemoteParticleRequest> particle_list_;
+  std::vector<long> prepare_id_list_;
+  std::vector<CommMpiRmaQueryInfo> fetch_data_list_;
+  std::string error_str_;
+
+  template<typename DataClass>
+  RemoteDataRequestStatus FetchWithFieldType(PyObject* py_field_output,
+                                             PyObject* py_particle_output);
+
+ public:
+  RemoteDataRequest(const std::vector<std::string>& fname_list,
+                    const std::vector<RemoteParticleRequest>& particle_list,
+                    const std::vector<long>& prepare_id_list,
+                    const std::vector<CommMpiRmaQueryInfo>& fetch_data_list);
+  RemoteDataRequestStatus Fetch(PyObject** py_field_output,
+                                PyObject** py_particle_output);
+  const std::string& GetErrorStr() const { return error_str_; }
+};
+
+#endif  // #ifndef SERIAL_MODE
+#endif  // LIBYT_PROJECT_INCLUDE_REMOTE_DATA_REQUEST_H_
@@ -1,26 +1,37 @@
 #ifndef LIBYT_PROJECT_INCLUDE_TIMER_H_
 #define LIBYT_PROJECT_INCLUDE_TIMER_H_
 
-#ifdef SUPPORT_TIMER
 #include <chrono>
 
+//-------------------------------------------------------------------------------------------------------
+// Enumerate   :  TimerCategory
+// Description :  Categories of time profile, each can be turned on/off at runtime.
+//-------------------------------------------------------------------------------------------------------
+enum TimerCategory : unsigned int {
+  kTimerGeneral = 1u << 0,
+  kTimerCommit = 1u << 1,
+  kTimerHierarchy = 1u << 2,
+  kTimerRma = 1u << 3,
+  kTimerPythonExec = 1u << 4,
+  kTimerDerivedFunc = 1u << 5,
+  kTimerNone = 0u,
+  kTimerAll = (1u << 6) - 1
+};
+
 class Timer {
  public:
-  Timer(const char* func_name);
+  explicit Timer(const char* func_name, TimerCategory category = kTimerGeneral);
   ~Timer();
   void Stop();
 
  private:
   const char* m_FuncName;
+  TimerCategory m_Category;
   std::chrono::time_point<std::chrono::high_resolution_clock> m_StartTime;
   bool m_Stopped;
 };
-#endif  // #ifdef SUPPORT_TIMER
 
-#ifdef SUPPORT_TIMER
 #define SET_TIMER(x) Timer Timer(x)
-#else
-#define SET_TIMER(x)
-#endif  // #ifdef SUPPORT_TIMER
+#define SET_TIMER_CATEGORY(x, category) Timer Timer(x, category)
 
 #endif  // LIBYT_PROJECT_INCLUDE_TIMER_H_
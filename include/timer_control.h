@@ -1,23 +1,113 @@
 #ifndef LIBYT_PROJECT_INCLUDE_TIMER_CONTROL_H_
 #define LIBYT_PROJECT_INCLUDE_TIMER_CONTROL_H_
 
-#ifdef SUPPORT_TIMER
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
+#include "timer.h"
+
+//-------------------------------------------------------------------------------------------------------
+// Structure   :  TimerEvent
+// Description :  A complete event in chrome tracing format, time is in microseconds.
+//
+// Notes       :  1. func_name must outlive the event, since only the pointer is stored.
+//                   It is always a string literal like __PRETTY_FUNCTION__.
+//-------------------------------------------------------------------------------------------------------
+struct TimerEvent {
+  const char* func_name;
+  TimerCategory category;
+  long long start;
+  long long end;
+};
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerBuffer
+// Description :  Fixed-size ring buffer of timer events owned by a thread.
+//
+// Notes       :  1. Only the owner thread pushes events, and it never takes a lock.
+//                2. Events are drained by TimerControl with its lock held, so that there
+//                   is at most one consumer at a time.
+//-------------------------------------------------------------------------------------------------------
+class TimerBuffer {
+ public:
+  TimerBuffer(std::size_t capacity, uint32_t thread_id);
+  bool Push(const TimerEvent& event);
+  void Drain(std::vector<TimerEvent>& events);
+  uint32_t GetThreadId() const { return m_ThreadId; }
+
+ private:
+  std::vector<TimerEvent> m_Events;
+  std::size_t m_Mask;
+  uint32_t m_ThreadId;
+  std::atomic<std::size_t> m_Head;
+  std::atomic<std::size_t> m_Tail;
+};
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Description :  Control which categories are profiled, and write profile to file.
+//
+// Notes       :  1. Enabled categories can be changed at runtime. If SUPPORT_TIMER is
+//                   set, every category is enabled by default, otherwise none.
+//                2. The profile file is created when the first event is written to it.
+//                3. If ranks are merged, every MPI process sends its events to root at
+//                   each flush, and root writes them to a single file. Flush is then a
+//                   collective operation.
+//-------------------------------------------------------------------------------------------------------
 class TimerControl {
  public:
-  TimerControl() {};
+  TimerControl()
+      : m_MPIRank(0),
+        m_MPIRoot(0),
+        m_MPISize(1),
+        m_FirstLine(true),
+        m_FileCreated(false),
+        m_MergeRanks(false),
+        m_ClockOffset(0) {};
+  ~TimerControl();
   void CreateFile(const char* filename, int rank);
-  void WriteProfile(const char* func_name, long long start, long long end,
-                    uint32_t thread_id);
+  void CreateMergedFile(const char* filename, int rank, int root);
+  void WriteProfile(const char* func_name, TimerCategory category, long long start,
+                    long long end);
+  void Flush();
+
+  static bool IsEnabled(TimerCategory category) {
+    return (m_EnabledCategories.load(std::memory_order_relaxed) & category) != 0u;
+  }
+  static unsigned int GetEnabledCategories() {
+    return m_EnabledCategories.load(std::memory_order_relaxed);
+  }
+  static void SetEnabledCategories(unsigned int categories) {
+    m_EnabledCategories.store(categories & kTimerAll, std::memory_order_relaxed);
+  }
+  static bool ParseCategories(const std::string& categories_str,
+                              unsigned int* categories);
+  static std::string GetCategoriesStr(unsigned int categories);
 
  private:
+  static std::atomic<unsigned int> m_EnabledCategories;
+
+  TimerBuffer& GetThreadBuffer();
+  void WriteBuffer(TimerBuffer& buffer, std::string& profile);
+  void AppendToFile(const std::string& profile);
+  void AppendToMergedFile(const std::vector<std::string>& all_profiles);
+
   std::string m_FileName;
   int m_MPIRank;
+  int m_MPIRoot;
+  int m_MPISize;
   bool m_FirstLine;
+  bool m_FileCreated;
+  bool m_MergeRanks;
+  long long m_ClockOffset;
+  std::string m_PendingProfile;
   std::mutex m_Lock;
+  std::vector<std::shared_ptr<TimerBuffer>> m_Buffers;
+  std::vector<TimerEvent> m_DrainedEvents;
 };
-#endif  // #ifdef SUPPORT_TIMER
 
 #endif  // LIBYT_PROJECT_INCLUDE_TIMER_CONTROL_H_
@@ -0,0 +1,26 @@
+#ifndef LIBYT_PROJECT_INCLUDE_TRIGGER_H_
+#define LIBYT_PROJECT_INCLUDE_TRIGGER_H_
+
+#include "yt_type.h"
+
+/**
+ * \namespace trigger
+ * \brief Decide whether an inline function runs in a step by a predicate evaluated on
+ *        committed data, before paying for running it.
+ * \details
+ * 1. A trigger is set per inline function name. Functions without a trigger always run.
+ * 2. Evaluate is called in yt_commit after the local grids are set. Step and simulation
+ *    time triggers are decided locally, since they are the same on every process. Field
+ *    triggers reduce local grids first, and then every field trigger is reduced in a
+ *    single MPI_Allreduce.
+ * 3. Triggers are kept in name order, so every process must set the same triggers.
+ * 4. A trigger only fires in the step it is evaluated in.
+ */
+namespace trigger {
+int Set(const char* function_name, const yt_trigger* trigger);
+int Evaluate();
+bool IsFired(const char* function_name);
+void Finalize();
+}  // namespace trigger
+
+#endif  // LIBYT_PROJECT_INCLUDE_TRIGGER_H_
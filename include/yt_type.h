@@ -13,6 +13,12 @@ typedef enum yt_verbose {
   YT_VERBOSE_DEBUG    /*!< Log level debug */
 } yt_verbose;
 
+typedef enum yt_async_policy {
+  YT_ASYNC_BLOCK = 0,   /*!< Wait for the oldest step to finish */
+  YT_ASYNC_SKIP_STEP,   /*!< Skip analysis of the new step */
+  YT_ASYNC_DROP_OLDEST  /*!< Drop functions of the oldest step not started yet */
+} yt_async_policy;
+
 typedef enum yt_dtype {
   YT_FLOAT = 0,    /*!< float */
   YT_DOUBLE,       /*!< double */
@@ -30,12 +36,27 @@ typedef enum yt_dtype {
   YT_DTYPE_UNKNOWN /*!< unknown data type */
 } yt_dtype;
 
+typedef enum yt_arg_type {
+  YT_ARG_SCALAR = 0, /*!< Scalar of data_dtype */
+  YT_ARG_STRING,     /*!< Null-terminated string */
+  YT_ARG_ARRAY       /*!< C-contiguous array of data_dtype */
+} yt_arg_type;
+
+typedef enum yt_trigger_type {
+  YT_TRIGGER_EVERY_STEPS = 0, /*!< Every every_steps steps */
+  YT_TRIGGER_EVERY_TIME,      /*!< Every every_time of simulation time */
+  YT_TRIGGER_FIELD_MAX_ABOVE, /*!< Maximum of a field is above threshold */
+  YT_TRIGGER_FIELD_MIN_BELOW  /*!< Minimum of a field is below threshold */
+} yt_trigger_type;
+
 // structures
+#include "yt_type_arg.h"
 #include "yt_type_array.h"
 #include "yt_type_field.h"
 #include "yt_type_grid.h"
 #include "yt_type_param_libyt.h"
 #include "yt_type_param_yt.h"
 #include "yt_type_particle.h"
+#include "yt_type_trigger.h"
 
 #endif  // LIBYT_PROJECT_INCLUDE_YT_TYPE_H_
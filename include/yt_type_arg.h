@@ -0,0 +1,41 @@
+#ifndef LIBYT_PROJECT_INCLUDE_YT_TYPE_ARG_H_
+#define LIBYT_PROJECT_INCLUDE_YT_TYPE_ARG_H_
+
+#include "yt_macro.h"
+
+/**
+ * \struct yt_arg
+ * \brief Data structure to pass an argument to an inline function by value, used in
+ * \ref yt_run_FunctionWithArgs.
+ * \details
+ * 1. `YT_ARG_SCALAR`: `data_ptr` points to a single value of `data_dtype`, which is
+ *    passed as a Python int or float.
+ * 2. `YT_ARG_STRING`: `data_ptr` points to a null-terminated string, which is passed as a
+ *    Python str.
+ * 3. `YT_ARG_ARRAY`: `data_ptr` points to a C-contiguous array of `data_dtype` with
+ *    `num_dims` dimensions, which is wrapped by a read-only NumPy array without copying.
+ * 4. If `keyword` is set, the argument is passed as a keyword argument.
+ */
+typedef struct yt_arg {
+  yt_arg_type arg_type;     /*!< Argument type */
+  const char* keyword;      /*!< Keyword of the argument, or NULL if it is positional */
+  const void* data_ptr;     /*!< Data pointer */
+  yt_dtype data_dtype;      /*!< Data type of scalar and array */
+  int num_dims;             /*!< Number of dimensions of array, 1 to 3 */
+  long data_dimensions[3];  /*!< Dimensions of array */
+
+#ifdef __cplusplus
+  yt_arg() {
+    arg_type = YT_ARG_SCALAR;
+    keyword = nullptr;
+    data_ptr = nullptr;
+    data_dtype = YT_DTYPE_UNKNOWN;
+    num_dims = 1;
+    for (int d = 0; d < 3; d++) {
+      data_dimensions[d] = 0;
+    }
+  }
+#endif  // #ifdef __cplusplus
+} yt_arg;
+
+#endif  // LIBYT_PROJECT_INCLUDE_YT_TYPE_ARG_H_
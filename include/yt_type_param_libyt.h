@@ -11,7 +11,8 @@
  *
  * \rst
  * .. caution::
- *    The lifetime of ``script`` should cover the whole in situ process in libyt.
+ *    The lifetime of ``script``, ``spill_dir``, ``perf_file``, ``python_profile``, and
+ *    ``log_file`` should cover the whole in situ process in libyt.
  * \endrst
  */
 typedef struct yt_param_libyt {
@@ -19,6 +20,45 @@ typedef struct yt_param_libyt {
   const char* script; /*!< Script name _without_ the file extension `.py` */
   long counter;       /*!< Number of iteration doing in situ analysis */
   bool check_data;    /*!< Check the input data (e.g., hierarchy, grid information...) */
+  long memory_budget; /*!< Memory ceiling in bytes of fetched data (0 for no limit) */
+  /** Node-local directory to spill fetched data over memory_budget (NULL to disable) */
+  const char* spill_dir;
+  /** Comma-separated time profiling categories to turn on, or "all" (NULL for default) */
+  const char* trace;
+  /** Merge time profile of every MPI process into a single file on root */
+  bool trace_merge;
+  /** File to append per-step performance counters to, ".csv" or JSON lines (NULL to
+   *  disable) */
+  const char* perf_file;
+  /** File to write sampled Python stacks to in collapsed format (NULL to disable) */
+  const char* python_profile;
+  /** Buffer log messages on each MPI process, and write distinct ones once from root */
+  bool log_aggregate;
+  /** File to append aggregated log messages to as JSON lines (NULL to disable) */
+  const char* log_file;
+  /** Snapshot local data in yt_commit, and run inline functions on an analysis thread
+   *  while the simulation advances */
+  bool async_analysis;
+  /** Max number of steps whose inline functions are still running after yt_free (0 for
+   *  waiting in yt_free) */
+  int async_max_steps;
+  /** What to do in yt_commit if async_max_steps steps are still running */
+  yt_async_policy async_policy;
+  /** Synchronize every MPI process before calling an inline function synchronously, so
+   *  that time waiting for other processes is measured */
+  bool call_barrier;
+  /** Defer binding data to Python in yt_commit until an inline function runs, if none of
+   *  the functions called in the previous step will run in this step */
+  bool defer_binding;
+  /** Number of MPI processes at the end of comm dedicated to inline analysis, the rest
+   *  of them ship committed data to them (0 to disable) */
+  int in_transit_ranks;
+  /** Run Python only on one process per node, the other processes on the node share
+   *  committed data with it through shared memory */
+  bool node_aggregate;
+  /** Fortran handle (MPI_Comm_c2f) of the communicator of processes running libyt,
+   *  other processes never call libyt API (-1 for MPI_COMM_WORLD) */
+  int comm_f;
 
 #ifdef __cplusplus
   yt_param_libyt() {
@@ -26,6 +66,22 @@ typedef struct yt_param_libyt {
     script = "yt_inline_script";
     counter = 0;
     check_data = true;
+    memory_budget = 0;
+    spill_dir = nullptr;
+    trace = nullptr;
+    trace_merge = false;
+    perf_file = nullptr;
+    python_profile = nullptr;
+    log_aggregate = false;
+    log_file = nullptr;
+    async_analysis = false;
+    async_max_steps = 1;
+    async_policy = YT_ASYNC_BLOCK;
+    call_barrier = true;
+    defer_binding = false;
+    in_transit_ranks = 0;
+    node_aggregate = false;
+    comm_f = -1;
   }
 #endif  // #ifdef __cplusplus
 
@@ -0,0 +1,37 @@
+#ifndef LIBYT_PROJECT_INCLUDE_YT_TYPE_TRIGGER_H_
+#define LIBYT_PROJECT_INCLUDE_YT_TYPE_TRIGGER_H_
+
+#include "yt_macro.h"
+
+/**
+ * \struct yt_trigger
+ * \brief Data structure to decide whether an inline function runs in a step, used in
+ * \ref yt_set_FunctionTrigger.
+ * \details
+ * 1. `YT_TRIGGER_EVERY_STEPS`: run if \ref yt_param_libyt counter is a multiple of
+ *    `every_steps`.
+ * 2. `YT_TRIGGER_EVERY_TIME`: run if `every_time` of simulation time has passed since the
+ *    last time it runs, it always runs the first time.
+ * 3. `YT_TRIGGER_FIELD_MAX_ABOVE` / `YT_TRIGGER_FIELD_MIN_BELOW`: run if the maximum /
+ *    minimum of field `field_name` over every grid, excluding ghost cells, is above /
+ *    below `threshold`.
+ */
+typedef struct yt_trigger {
+  yt_trigger_type trigger_type; /*!< Trigger type */
+  long every_steps;             /*!< Number of steps in between */
+  double every_time;            /*!< Simulation time in between, in code units */
+  const char* field_name;       /*!< Field name to reduce */
+  double threshold;             /*!< Threshold of the field */
+
+#ifdef __cplusplus
+  yt_trigger() {
+    trigger_type = YT_TRIGGER_EVERY_STEPS;
+    every_steps = 1;
+    every_time = 0.0;
+    field_name = nullptr;
+    threshold = 0.0;
+  }
+#endif  // #ifdef __cplusplus
+} yt_trigger;
+
+#endif  // LIBYT_PROJECT_INCLUDE_YT_TYPE_TRIGGER_H_
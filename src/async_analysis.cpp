@@ -0,0 +1,759 @@
+#include "async_analysis.h"
+
+#ifndef SERIAL_MODE
+#include <mpi.h>
+
+#include "comm_mpi.h"
+#endif
+
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "inline_function.h"
+#include "libyt.h"
+#include "libyt_process_control.h"
+#include "logging.h"
+#include "perf_counter.h"
+#include "python_profiler.h"
+#include "timer.h"
+
+// Attributes of libyt Python module which every retired step has its own copy.
+static const int kNumStepAttrs = 5;
+static const char* kStepAttrNames[kNumStepAttrs] = {
+    "param_yt", "param_user", "hierarchy", "grid_data", "particle_data"};
+
+// Jobs submitted in one step, and the data they run on after the step is retired.
+class AnalysisStep {
+ public:
+  long step_ = -1;
+  DataStructureAmr data_structure_amr_;
+  PyObject* py_attrs_[kNumStepAttrs] = {nullptr};
+  bool is_retired_ = false;
+  long num_submitted_ = 0;
+  long num_started_ = 0;
+  long num_finished_ = 0;
+  long num_allowed_ = LONG_MAX;
+  std::vector<AsyncAnalysisJob> finished_jobs_;
+
+  bool IsDone() const { return num_finished_ == num_submitted_; }
+};
+
+struct QueuedJob {
+  AnalysisStep* step;
+  long index;
+  AsyncAnalysisJob job;
+};
+
+// Analysis thread, its job queue, and the ring of retired steps. The thread is stopped
+// at exit if it is running. The mutex must not be held while acquiring the GIL.
+class AnalysisThread {
+ public:
+  std::mutex mutex_;
+  std::condition_variable job_cv_;
+  std::condition_variable done_cv_;
+  std::deque<QueuedJob> job_queue_;
+  std::deque<AnalysisStep*> retired_steps_;
+  AnalysisStep* live_step_ = nullptr;
+  AnalysisStep* running_step_ = nullptr;
+  bool stop_ = false;
+  std::thread worker_;
+
+  ~AnalysisThread() { Stop(); }
+  void Stop() {
+    if (!worker_.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    job_cv_.notify_all();
+    worker_.join();
+    stop_ = false;
+  }
+  bool CanRunFrontJob() const {
+    if (job_queue_.empty()) {
+      return false;
+    }
+    const QueuedJob& front = job_queue_.front();
+    return front.index < front.step->num_allowed_;
+  }
+};
+
+static bool enabled = false;
+static int max_retired_steps = 0;
+static yt_async_policy backpressure_policy = YT_ASYNC_BLOCK;
+static bool is_step_skipped = false;
+static AnalysisThread analysis_thread;
+// Thread state of the main thread, which is saved when it releases the GIL.
+static PyThreadState* main_thread_state = nullptr;
+// Retired step whose job is running on this thread.
+static thread_local AnalysisStep* step_in_use = nullptr;
+#ifndef SERIAL_MODE
+// Duplicate of the libyt communicator used by libyt inside jobs on the analysis thread.
+static MPI_Comm analysis_comm = MPI_COMM_NULL;
+#endif
+
+// Local result of a job finished on the main thread, which is not synchronized with
+// other MPI processes yet.
+struct UnsyncedJob {
+  std::string function_name;
+  bool is_success;
+  double exec_time;
+  double wait_time;
+};
+static std::vector<UnsyncedJob> unsynced_jobs;
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  WaitWithoutGil
+// Description :  Block on done_cv_ until pred is true, while releasing the GIL.
+//
+// Notes       :  1. Must hold the GIL. The mutex is released before the GIL is acquired
+//                   back.
+//-------------------------------------------------------------------------------------------------------
+template<typename Predicate>
+static void WaitWithoutGil(Predicate pred) {
+  PyThreadState* thread_state = PyEval_SaveThread();
+  {
+    std::unique_lock<std::mutex> lock(analysis_thread.mutex_);
+    analysis_thread.done_cv_.wait(lock, pred);
+  }
+  PyEval_RestoreThread(thread_state);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  AllReduceLong
+// Description :  Reduce a long across MPI processes, while releasing the GIL.
+//-------------------------------------------------------------------------------------------------------
+static long AllReduceLong(long value, bool find_max) {
+#ifndef SERIAL_MODE
+  long result = value;
+  PyThreadState* thread_state = PyEval_SaveThread();
+  MPI_Allreduce(
+      &value, &result, 1, MPI_LONG, (find_max ? MPI_MAX : MPI_MIN), CommMpi::GetComm());
+  PyEval_RestoreThread(thread_state);
+  return result;
+#else
+  return value;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SwapStepAttrs
+// Description :  Swap attributes of libyt Python module with py_attrs.
+//
+// Notes       :  1. Must hold the GIL.
+//                2. It is a no-op if libyt is not imported.
+//-------------------------------------------------------------------------------------------------------
+static void SwapStepAttrs(PyObject** py_attrs) {
+  PyObject* py_libyt = PyDict_GetItemString(PyImport_GetModuleDict(), "libyt");
+  if (py_libyt == nullptr) {
+    return;
+  }
+  for (int i = 0; i < kNumStepAttrs; i++) {
+    PyObject* py_current = PyObject_GetAttrString(py_libyt, kStepAttrNames[i]);
+    if (py_current == nullptr) {
+      PyErr_Clear();
+    }
+    if (py_attrs[i] != nullptr) {
+      PyObject_SetAttrString(py_libyt, kStepAttrNames[i], py_attrs[i]);
+      Py_DECREF(py_attrs[i]);
+    }
+    py_attrs[i] = py_current;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ReapOldestStep
+// Description :  Remove the oldest retired step, append its finished jobs to
+//                finished_jobs, and free its data.
+//
+// Notes       :  1. Must hold the GIL, and every job of the step must be done.
+//-------------------------------------------------------------------------------------------------------
+static void ReapOldestStep(std::vector<AsyncAnalysisJob>& finished_jobs) {
+  AnalysisStep* step;
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    step = analysis_thread.retired_steps_.front();
+    analysis_thread.retired_steps_.pop_front();
+  }
+  finished_jobs.insert(
+      finished_jobs.end(), step->finished_jobs_.begin(), step->finished_jobs_.end());
+  step->data_structure_amr_.CleanUp();
+  for (int i = 0; i < kNumStepAttrs; i++) {
+    Py_XDECREF(step->py_attrs_[i]);
+  }
+  delete step;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  FreezeStartedJobs
+// Description :  Stop starting new jobs of step, and return the max number of jobs of
+//                step that have started on any MPI process.
+//
+// Notes       :  1. Collective operation. Jobs started on any MPI process are still
+//                   allowed to run on every MPI process, so that communication inside
+//                   them matches, and waiting for them does not depend on the timing of
+//                   the analysis thread on each MPI process.
+//-------------------------------------------------------------------------------------------------------
+static long FreezeStartedJobs(AnalysisStep* step) {
+  long num_started;
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    step->num_allowed_ = step->num_started_;
+    num_started = step->num_started_;
+  }
+  num_started = AllReduceLong(num_started, true);
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    step->num_allowed_ = num_started;
+  }
+  analysis_thread.job_cv_.notify_all();
+
+  return num_started;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  DropJobsOfOldestStep
+// Description :  Drop jobs of the oldest retired step that have not started on any MPI
+//                process, and return the number of jobs dropped.
+//
+// Notes       :  1. Collective operation.
+//-------------------------------------------------------------------------------------------------------
+static long DropJobsOfOldestStep() {
+  AnalysisStep* step;
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    step = analysis_thread.retired_steps_.front();
+  }
+  long num_started = FreezeStartedJobs(step);
+
+  long num_dropped;
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    std::deque<QueuedJob>& job_queue = analysis_thread.job_queue_;
+    for (auto it = job_queue.begin(); it != job_queue.end();) {
+      if (it->step == step && it->index >= num_started) {
+        it = job_queue.erase(it);
+      } else {
+        it++;
+      }
+    }
+    num_dropped = step->num_submitted_ - num_started;
+    step->num_submitted_ = num_started;
+  }
+  analysis_thread.done_cv_.notify_all();
+
+  return num_dropped;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  AnalysisThreadLoop
+// Description :  Pop jobs in order and run them while holding the GIL, until it is asked
+//                to stop and there is no job left.
+//
+// Notes       :  1. Jobs of a retired step run on its own data, which is swapped into
+//                   libyt Python module and step_in_use for the job.
+//-------------------------------------------------------------------------------------------------------
+static void AnalysisThreadLoop() {
+#ifndef SERIAL_MODE
+  CommMpi::SetThreadComm(analysis_comm);
+#endif
+  while (true) {
+    QueuedJob queued_job;
+    {
+      std::unique_lock<std::mutex> lock(analysis_thread.mutex_);
+      analysis_thread.job_cv_.wait(lock, [] {
+        return (analysis_thread.stop_ && analysis_thread.job_queue_.empty()) ||
+               analysis_thread.CanRunFrontJob();
+      });
+      if (analysis_thread.job_queue_.empty()) {
+        return;
+      }
+      queued_job = analysis_thread.job_queue_.front();
+      analysis_thread.job_queue_.pop_front();
+      queued_job.step->num_started_++;
+      analysis_thread.running_step_ = queued_job.step;
+    }
+
+    AnalysisStep* step = queued_job.step;
+    PyGILState_STATE gil_state = PyGILState_Ensure();
+    if (step->is_retired_) {
+      step_in_use = step;
+      SwapStepAttrs(step->py_attrs_);
+    }
+    async_analysis::RunJob(queued_job.job);
+    if (step->is_retired_) {
+      SwapStepAttrs(step->py_attrs_);
+      step_in_use = nullptr;
+    }
+    PyGILState_Release(gil_state);
+
+    {
+      std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+      step->finished_jobs_.push_back(queued_job.job);
+      step->num_finished_++;
+      analysis_thread.running_step_ = nullptr;
+    }
+    analysis_thread.done_cv_.notify_all();
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : Enable
+//
+// Notes         :  1. Must be the same on every MPI process.
+//                  2. max_steps is the max number of retired steps whose jobs are still
+//                     running, and policy is applied in BeginStep if it is reached.
+//                  3. Collective operation if it is enabled for the first time, which
+//                     duplicates the communicator for the analysis thread.
+//-------------------------------------------------------------------------------------------------------
+void async_analysis::Enable(bool enable, int max_steps, yt_async_policy policy) {
+#ifndef SERIAL_MODE
+  if (enable && analysis_comm == MPI_COMM_NULL) {
+    MPI_Comm_dup(CommMpi::GetComm(), &analysis_comm);
+  }
+#endif
+  enabled = enable;
+  max_retired_steps = max_steps;
+  backpressure_policy = policy;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : IsEnabled
+//-------------------------------------------------------------------------------------------------------
+bool async_analysis::IsEnabled() { return enabled; }
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : GetMaxSteps
+//-------------------------------------------------------------------------------------------------------
+int async_analysis::GetMaxSteps() { return max_retired_steps; }
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : ReleaseMainThreadGil
+//
+// Notes         :  1. Called on the main thread at the end of yt_initialize, so that the
+//                     analysis thread can run while the simulation advances. libyt API
+//                     holds PythonGilGuard afterward. Finalize acquires it back.
+//-------------------------------------------------------------------------------------------------------
+void async_analysis::ReleaseMainThreadGil() {
+  if (main_thread_state == nullptr) {
+    main_thread_state = PyEval_SaveThread();
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : BeginStep
+//
+// Notes         :  1. Collective operation, called in yt_commit with the GIL held.
+//                  2. Reap the oldest retired steps that are done on every MPI process,
+//                     and append their finished jobs to finished_jobs.
+//                  3. If the ring is still full, apply the policy:
+//                     (1) YT_ASYNC_BLOCK: wait for the oldest step.
+//                     (2) YT_ASYNC_DROP_OLDEST: drop jobs of the oldest step that have
+//                         not started, and wait for the rest of them.
+//                     (3) YT_ASYNC_SKIP_STEP: jobs submitted in this step are not run.
+//                  4. Return the number of jobs dropped.
+//-------------------------------------------------------------------------------------------------------
+int async_analysis::BeginStep(std::vector<AsyncAnalysisJob>& finished_jobs) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  is_step_skipped = false;
+
+  long num_done = 0;
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    for (AnalysisStep* step : analysis_thread.retired_steps_) {
+      if (!step->IsDone()) {
+        break;
+      }
+      num_done++;
+    }
+  }
+  num_done = AllReduceLong(num_done, false);
+  for (long i = 0; i < num_done; i++) {
+    ReapOldestStep(finished_jobs);
+  }
+
+  if (max_retired_steps <= 0 ||
+      static_cast<int>(analysis_thread.retired_steps_.size()) < max_retired_steps) {
+    return 0;
+  }
+
+  long num_dropped = 0;
+  switch (backpressure_policy) {
+    case YT_ASYNC_SKIP_STEP:
+      is_step_skipped = true;
+      return 0;
+    case YT_ASYNC_DROP_OLDEST:
+      num_dropped = DropJobsOfOldestStep();
+      break;
+    case YT_ASYNC_BLOCK:
+    default:
+      break;
+  }
+
+  AnalysisStep* oldest_step = analysis_thread.retired_steps_.front();
+  if (num_dropped > 0) {
+    logging::LogWarning("Drop %ld inline functions of step %ld, since %d steps are "
+                        "still running.\n",
+                        num_dropped,
+                        oldest_step->step_,
+                        max_retired_steps);
+  }
+  WaitWithoutGil([oldest_step] { return oldest_step->IsDone(); });
+  ReapOldestStep(finished_jobs);
+
+  return static_cast<int>(num_dropped);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : IsStepSkipped
+//
+// Notes         :  1. Return true if jobs submitted in this step should not run, which is
+//                     decided in BeginStep.
+//-------------------------------------------------------------------------------------------------------
+bool async_analysis::IsStepSkipped() { return is_step_skipped; }
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : Submit
+//
+// Notes         :  1. The job belongs to the live step. The analysis thread is started at
+//                     the first call.
+//-------------------------------------------------------------------------------------------------------
+void async_analysis::Submit(const AsyncAnalysisJob& job) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    if (analysis_thread.live_step_ == nullptr) {
+      analysis_thread.live_step_ = new AnalysisStep();
+    }
+    AnalysisStep* step = analysis_thread.live_step_;
+    analysis_thread.job_queue_.push_back(QueuedJob{step, step->num_submitted_, job});
+    step->num_submitted_++;
+  }
+  analysis_thread.job_cv_.notify_all();
+
+  if (!analysis_thread.worker_.joinable()) {
+    analysis_thread.worker_ = std::thread(AnalysisThreadLoop);
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : RetireStep
+//
+// Notes         :  1. Called in yt_free with the GIL held, before the data structure and
+//                     the libyt Python dictionaries are cleaned up.
+//                  2. Wait for the jobs of the live step that have started on any MPI
+//                     process, then move data_structure_amr to the step, and keep a
+//                     shallow copy of the dictionaries for it. data_structure_amr is left
+//                     empty and bound to the same dictionaries as before.
+//                  3. It is a no-op if no job is submitted in this step, otherwise it is
+//                     a collective call.
+//-------------------------------------------------------------------------------------------------------
+void async_analysis::RetireStep(long step, DataStructureAmr& data_structure_amr,
+                                PyObject* py_param_yt, PyObject* py_param_user) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  AnalysisStep* live_step;
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    live_step = analysis_thread.live_step_;
+    if (live_step == nullptr) {
+      return;
+    }
+  }
+  FreezeStartedJobs(live_step);
+  WaitWithoutGil(
+      [live_step] { return live_step->num_finished_ >= live_step->num_allowed_; });
+
+  PyObject* py_hierarchy = data_structure_amr.GetPythonHierarchy();
+  PyObject* py_grid_data = data_structure_amr.GetPythonGridData();
+  PyObject* py_particle_data = data_structure_amr.GetPythonParticleData();
+  PyObject* py_live_dicts[kNumStepAttrs] = {
+      py_param_yt, py_param_user, py_hierarchy, py_grid_data, py_particle_data};
+  for (int i = 0; i < kNumStepAttrs; i++) {
+    live_step->py_attrs_[i] = PyDict_Copy(py_live_dicts[i]);
+  }
+
+  live_step->step_ = step;
+  std::swap(live_step->data_structure_amr_, data_structure_amr);
+  live_step->data_structure_amr_.SetPythonBindings(
+      live_step->py_attrs_[2], live_step->py_attrs_[3], live_step->py_attrs_[4]);
+  data_structure_amr.SetPythonBindings(py_hierarchy, py_grid_data, py_particle_data);
+
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    live_step->is_retired_ = true;
+    live_step->num_allowed_ = LONG_MAX;
+    analysis_thread.retired_steps_.push_back(live_step);
+    analysis_thread.live_step_ = nullptr;
+  }
+  analysis_thread.job_cv_.notify_all();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : IsDone
+//
+// Notes         :  1. Return true if every submitted job is done. It does not touch
+//                     Python, so it can be called any time.
+//-------------------------------------------------------------------------------------------------------
+bool async_analysis::IsDone() {
+  std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+  return analysis_thread.job_queue_.empty() && analysis_thread.running_step_ == nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : HasPendingJobs
+//
+// Notes         :  1. Return true if jobs are submitted since the last Wait, and they are
+//                     not reaped yet.
+//-------------------------------------------------------------------------------------------------------
+bool async_analysis::HasPendingJobs() {
+  std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+  return analysis_thread.live_step_ != nullptr ||
+         !analysis_thread.retired_steps_.empty();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : Wait
+//
+// Notes         :  1. Must hold the GIL. Block until every submitted job is done, then
+//                     reap every retired step and the live step.
+//                  2. Return the jobs finished since the last call, in submitted order.
+//-------------------------------------------------------------------------------------------------------
+std::vector<AsyncAnalysisJob> async_analysis::Wait() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  std::vector<AsyncAnalysisJob> finished_jobs;
+  WaitWithoutGil([] {
+    return analysis_thread.job_queue_.empty() && analysis_thread.running_step_ == nullptr;
+  });
+
+  while (!analysis_thread.retired_steps_.empty()) {
+    ReapOldestStep(finished_jobs);
+  }
+
+  AnalysisStep* live_step;
+  {
+    std::lock_guard<std::mutex> lock(analysis_thread.mutex_);
+    live_step = analysis_thread.live_step_;
+    analysis_thread.live_step_ = nullptr;
+  }
+  if (live_step != nullptr) {
+    finished_jobs.insert(finished_jobs.end(),
+                         live_step->finished_jobs_.begin(),
+                         live_step->finished_jobs_.end());
+    delete live_step;
+  }
+
+  return finished_jobs;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : RunJob
+//
+// Notes         :  1. Must hold the GIL. Execute the job and record the result and the
+//                     time spent.
+//                  2. Typed arguments are passed as they are, otherwise arguments are
+//                     evaluated in the inline script namespace. Typed arguments are
+//                     released here while holding the GIL, so that finished jobs do not
+//                     hold Python objects.
+//-------------------------------------------------------------------------------------------------------
+void async_analysis::RunJob(AsyncAnalysisJob& job) {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerPythonExec);
+
+  std::chrono::steady_clock::time_point exec_start = std::chrono::steady_clock::now();
+  python_profiler::Start(job.function_name);
+  if (job.py_arguments != nullptr) {
+    PyObject* py_kwargs = PyTuple_GET_ITEM(job.py_arguments.get(), 1);
+    job.exec_result = inline_function::CallWithObjects(
+        job.function_name,
+        PyTuple_GET_ITEM(job.py_arguments.get(), 0),
+        (py_kwargs != Py_None) ? py_kwargs : nullptr);
+  } else {
+    job.exec_result = inline_function::Call(job.function_name, job.arguments);
+  }
+  job.py_arguments.reset();
+  python_profiler::Stop();
+  std::chrono::duration<double> exec_time = std::chrono::steady_clock::now() - exec_start;
+  job.exec_time = exec_time.count();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : FinishJob
+//
+// Notes         :  1. Must hold the GIL. No communication is done here.
+//                  2. Record the time spent and update the local status of an inline
+//                     function after it is executed. Load imbalance and the status on
+//                     every MPI process are synchronized later in SyncStatus.
+//-------------------------------------------------------------------------------------------------------
+int async_analysis::FinishJob(const AsyncAnalysisJob& job) {
+  const char* function_name = job.function_name.c_str();
+  perf_counter::Add(std::string("python.exec_time.") + function_name, job.exec_time);
+
+  // Record it even if it failed, so that every rank synchronizes the same jobs
+  unsynced_jobs.push_back({job.function_name, true, job.exec_time, job.wait_time});
+#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
+  int func_index =
+      LibytProcessControl::Get().function_info_list_.GetFunctionIndex(function_name);
+#endif
+
+  if (job.exec_result != 0) {
+    unsynced_jobs.back().is_success = false;
+#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
+    LibytProcessControl::Get().function_info_list_[func_index].SetStatus(
+        FunctionInfo::ExecuteStatus::kFailed);
+#endif
+    YT_ABORT("Unexpected error occurred while executing %s in script's namespace.\n",
+             job.str_function.c_str());
+  }
+
+#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
+  // update status in LibytProcessControl::Get().function_info_list_
+  FunctionInfo& function_info =
+      LibytProcessControl::Get().function_info_list_[func_index];
+  function_info.SetStatusUsingPythonResult();
+  unsynced_jobs.back().is_success =
+      (function_info.GetStatus() == FunctionInfo::ExecuteStatus::kSuccess);
+#endif
+  logging::LogInfo("Performing YT inline analysis %s ... %s.\n",
+                   job.str_function.c_str(),
+                   unsynced_jobs.back().is_success ? "done" : "failed");
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : SyncStatus
+//
+// Notes         :  1. Collective operation if any job is finished since the last call,
+//                     must hold the GIL. Every process finishes the same jobs, so they
+//                     all skip it otherwise.
+//                  2. Gather the status and the time spent of every finished job in a
+//                     single MPI_Allgather, then log load imbalance and update the
+//                     status of every inline function on every MPI process.
+//                  3. Return YT_FAIL if any job failed on any MPI process.
+//-------------------------------------------------------------------------------------------------------
+int async_analysis::SyncStatus() {
+  if (unsynced_jobs.empty()) {
+    return YT_SUCCESS;
+  }
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  const int kNumValues = 3;
+  const int num_jobs = static_cast<int>(unsynced_jobs.size());
+  std::vector<double> local_values(kNumValues * num_jobs);
+  for (int j = 0; j < num_jobs; j++) {
+    local_values[kNumValues * j] = unsynced_jobs[j].is_success ? 1.0 : 0.0;
+    local_values[kNumValues * j + 1] = unsynced_jobs[j].exec_time;
+    local_values[kNumValues * j + 2] = unsynced_jobs[j].wait_time;
+  }
+#ifndef SERIAL_MODE
+  const int mpi_size = CommMpi::mpi_size_;
+  std::vector<double> all_values(kNumValues * num_jobs * mpi_size);
+  CallWithoutGil([&] {
+    return MPI_Allgather(local_values.data(),
+                         kNumValues * num_jobs,
+                         MPI_DOUBLE,
+                         all_values.data(),
+                         kNumValues * num_jobs,
+                         MPI_DOUBLE,
+                         CommMpi::GetComm());
+  });
+#else
+  const int mpi_size = 1;
+  std::vector<double>& all_values = local_values;
+#endif
+
+  int result = YT_SUCCESS;
+  std::vector<double> times(mpi_size), wait_times(mpi_size);
+  for (int j = 0; j < num_jobs; j++) {
+    int num_failed = 0;
+    for (int r = 0; r < mpi_size; r++) {
+      const double* values = &all_values[kNumValues * (num_jobs * r + j)];
+      num_failed += (values[0] == 0.0) ? 1 : 0;
+      times[r] = values[1];
+      wait_times[r] = values[2];
+    }
+    PerfLoadImbalance load_imbalance = perf_counter::GetLoadImbalance(times, wait_times);
+
+    const char* function_name = unsynced_jobs[j].function_name.c_str();
+#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
+    int func_index =
+        LibytProcessControl::Get().function_info_list_.GetFunctionIndex(function_name);
+    FunctionInfo& function_info =
+        LibytProcessControl::Get().function_info_list_[func_index];
+    function_info.SetLoadImbalance(load_imbalance);
+    function_info.SetAllStatus((num_failed == 0) ? FunctionInfo::ExecuteStatus::kSuccess
+                                                 : FunctionInfo::ExecuteStatus::kFailed);
+#endif
+    logging::LogInfo("Time of %s max/mean = %.3f/%.3f sec on MPI rank %d, max wait = "
+                     "%.3f sec\n",
+                     function_name,
+                     load_imbalance.max,
+                     load_imbalance.mean,
+                     load_imbalance.max_rank,
+                     load_imbalance.wait_max);
+    if (num_failed > 0) {
+      logging::LogInfo("YT inline function \"%s\" failed on %d MPI processes.\n",
+                       function_name,
+                       num_failed);
+      result = YT_FAIL;
+    }
+  }
+  unsynced_jobs.clear();
+
+  return result;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : GetDataStructureAmrInUse
+//
+// Notes         :  1. Return the data structure of the retired step whose job is running
+//                     on this thread, or nullptr if there is none.
+//-------------------------------------------------------------------------------------------------------
+DataStructureAmr* async_analysis::GetDataStructureAmrInUse() {
+  return (step_in_use != nullptr) ? &step_in_use->data_structure_amr_ : nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : async_analysis
+// Function name : Finalize
+//
+// Notes         :  1. Stop the analysis thread, free its communicator, and acquire the
+//                     GIL back on the main thread. Must be called after Wait and before
+//                     Python is finalized.
+//-------------------------------------------------------------------------------------------------------
+void async_analysis::Finalize() {
+  analysis_thread.Stop();
+#ifndef SERIAL_MODE
+  if (analysis_comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&analysis_comm);
+  }
+#endif
+  if (main_thread_state != nullptr) {
+    PyEval_RestoreThread(main_thread_state);
+    main_thread_state = nullptr;
+  }
+}
@@ -6,12 +6,14 @@
 int CommMpi::mpi_rank_ = 0;
 int CommMpi::mpi_size_ = 1;
 int CommMpi::mpi_root_ = 0;
+MPI_Comm CommMpi::comm_ = MPI_COMM_WORLD;
+thread_local MPI_Comm CommMpi::thread_comm_ = MPI_COMM_NULL;
 
 void CommMpi::InitializeInfo(int mpi_root) {
   SET_TIMER(__PRETTY_FUNCTION__);
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank_);
-  MPI_Comm_size(MPI_COMM_WORLD, &mpi_size_);
+  MPI_Comm_rank(comm_, &mpi_rank_);
+  MPI_Comm_size(comm_, &mpi_size_);
   mpi_root_ = mpi_root;
 }
 
@@ -19,7 +21,7 @@ void CommMpi::SetAllNumGridsLocal(int* all_num_grids_local, int num_grids_local)
   SET_TIMER(__PRETTY_FUNCTION__);
 
   MPI_Allgather(
-      &num_grids_local, 1, MPI_INT, all_num_grids_local, 1, MPI_INT, MPI_COMM_WORLD);
+      &num_grids_local, 1, MPI_INT, all_num_grids_local, 1, MPI_INT, GetComm());
 }
 
 /**
@@ -43,7 +45,7 @@ int CommMpi::CheckAllStates(int local_state, int desired_state, int success_valu
   SET_TIMER(__PRETTY_FUNCTION__);
 
   int* all_results = new int[mpi_size_];
-  MPI_Allgather(&local_state, 1, MPI_INT, all_results, 1, MPI_INT, MPI_COMM_WORLD);
+  MPI_Allgather(&local_state, 1, MPI_INT, all_results, 1, MPI_INT, GetComm());
 
   bool match_desired_state = true;
   for (int r = 0; r < mpi_size_; r++) {
@@ -78,7 +80,7 @@ void CommMpi::SetStringUsingValueOnRank(std::string& sync_string, int src_mpi_ra
   if (mpi_rank_ == src_mpi_rank) {
     sync_string_len = sync_string.length();
   }
-  MPI_Bcast(&sync_string_len, 1, MPI_UNSIGNED_LONG, src_mpi_rank, MPI_COMM_WORLD);
+  MPI_Bcast(&sync_string_len, 1, MPI_UNSIGNED_LONG, src_mpi_rank, GetComm());
 
   // Allocate the memory only on other ranks, and broadcast the string
   // Create new string on other ranks
@@ -87,12 +89,12 @@ void CommMpi::SetStringUsingValueOnRank(std::string& sync_string, int src_mpi_ra
               (int)sync_string_len,
               MPI_CHAR,
               src_mpi_rank,
-              MPI_COMM_WORLD);
+              GetComm());
   } else {
     char* dest_string = nullptr;
     dest_string = new char[sync_string_len + 1];
     MPI_Bcast(
-        (void*)dest_string, (int)sync_string_len, MPI_CHAR, src_mpi_rank, MPI_COMM_WORLD);
+        (void*)dest_string, (int)sync_string_len, MPI_CHAR, src_mpi_rank, GetComm());
     dest_string[sync_string_len] = '\0';
     sync_string = std::string(dest_string);
     delete[] dest_string;
@@ -123,7 +125,7 @@ void CommMpi::GatherAllStringsToRank(std::vector<std::string>& all_strings,
                1,
                MPI_INT,
                dest_mpi_rank,
-               MPI_COMM_WORLD);
+               GetComm());
 
     // Allocate buffer, and gather all the strings to the destination rank
     unsigned long sum_all_string_len = 0;
@@ -144,7 +146,7 @@ void CommMpi::GatherAllStringsToRank(std::vector<std::string>& all_strings,
                 displacements,
                 MPI_CHAR,
                 dest_mpi_rank,
-                MPI_COMM_WORLD);
+                GetComm());
 
     // Copies the char* to std::string
     all_strings.clear();
@@ -158,7 +160,7 @@ void CommMpi::GatherAllStringsToRank(std::vector<std::string>& all_strings,
     delete[] buffer;
   } else {
     MPI_Gather(
-        &src_string_len, 1, MPI_INT, nullptr, 0, MPI_INT, dest_mpi_rank, MPI_COMM_WORLD);
+        &src_string_len, 1, MPI_INT, nullptr, 0, MPI_INT, dest_mpi_rank, GetComm());
     MPI_Gatherv(src_string.c_str(),
                 src_string_len,
                 MPI_CHAR,
@@ -167,7 +169,7 @@ void CommMpi::GatherAllStringsToRank(std::vector<std::string>& all_strings,
                 nullptr,
                 MPI_CHAR,
                 dest_mpi_rank,
-                MPI_COMM_WORLD);
+                GetComm());
   }
 }
 
@@ -190,7 +192,7 @@ void CommMpi::GatherAllIntsToRank(std::vector<int>& all_ints, const int src_int,
     all_ints.assign(mpi_size_, 0);
   }
   MPI_Gather(
-      &src_int, 1, MPI_INT, all_ints.data(), 1, MPI_INT, dest_mpi_rank, MPI_COMM_WORLD);
+      &src_int, 1, MPI_INT, all_ints.data(), 1, MPI_INT, dest_mpi_rank, GetComm());
 }
 
 #endif
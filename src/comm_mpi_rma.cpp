@@ -6,6 +6,9 @@
 #include "big_mpi.h"
 #include "comm_mpi.h"
 #include "dtype_utilities.h"
+#include "memory_spill.h"
+#include "memory_tracker.h"
+#include "perf_counter.h"
 #include "timer.h"
 
 template<typename DataClass>
@@ -82,11 +85,35 @@ static BigMpiStatus CallBigMpiGetBasedOnYtDtype(void* recv_buff, long data_len,
 template<typename DataClass>
 CommMpiRma<DataClass>::CommMpiRma(const std::string& data_group_name,
                                   const std::string& data_format)
-    : data_group_name_(data_group_name), data_format_(data_format) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+    : memory_budget_(0),
+      resident_size_(0),
+      fetch_pos_(0),
+      epoch_(0),
+      num_epochs_(0),
+      fetch_status_(CommMpiRmaStatus::kMpiSuccess),
+      data_group_name_(data_group_name),
+      data_format_(data_format) {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
   InitializeMpiAddressDataType();
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Class         :  CommMpiRma<DataClass>
+// Public Method :  SetMemoryBudget
+//
+// Notes       :  1. Set the memory ceiling (in bytes) for the fetched buffers in a
+//                   single GetRemoteData call. If memory_budget <= 0, there is no limit.
+//                2. If spill_dir is not empty, fetched data exceeding the memory budget
+//                   are spilled to memory-mapped files under spill_dir. Otherwise,
+//                   GetRemoteData fails when it exceeds the memory budget.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass>
+void CommMpiRma<DataClass>::SetMemoryBudget(long memory_budget,
+                                            const std::string& spill_dir) {
+  memory_budget_ = memory_budget;
+  spill_dir_ = spill_dir;
+}
+
 template<typename DataClass>
 void CommMpiRma<DataClass>::InitializeMpiAddressDataType() {
   if (mpi_rma_data_type_ != 0) {
@@ -122,19 +149,70 @@ void CommMpiRma<DataClass>::InitializeMpiAddressDataType() {
 //                implement the
 //                   GetDataLen/GetDataSize function for some specific data struct to pass
 //                   around. It is agnostic to what the data is.
-//                7. TODO: chunking data?
+//                7. Fetched data are chunked and spilled based on the memory budget set
+//                   by SetMemoryBudget. All the chunks are fetched before it returns.
 //-------------------------------------------------------------------------------------------------------
 template<typename DataClass>
 CommMpiRmaReturn<DataClass> CommMpiRma<DataClass>::GetRemoteData(
     const std::vector<DataClass>& prepared_data_list,
     const std::vector<CommMpiRmaQueryInfo>& fetch_id_list) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
+
+  CommMpiRmaReturn<DataClass> begin_return =
+      BeginChunkedRemoteData(prepared_data_list, fetch_id_list);
+  if (begin_return.all_status != CommMpiRmaStatus::kMpiSuccess) {
+    return begin_return;
+  }
+
+  // Fetch every chunk, and keep all the fetched data
+  CommMpiRmaStatus status = CommMpiRmaStatus::kMpiSuccess;
+  while (HasNextRemoteDataChunk()) {
+    if (FetchRemoteDataChunk() != CommMpiRmaStatus::kMpiSuccess) {
+      status = CommMpiRmaStatus::kMpiFailed;
+    }
+  }
+  CommMpiRmaStatus all_status = static_cast<CommMpiRmaStatus>(
+      CommMpi::CheckAllStates(static_cast<int>(status),
+                              static_cast<int>(CommMpiRmaStatus::kMpiSuccess),
+                              static_cast<int>(CommMpiRmaStatus::kMpiSuccess),
+                              static_cast<int>(CommMpiRmaStatus::kMpiFailed)));
+
+  EndChunkedRemoteData(prepared_data_list);
+
+  return {.status = status, .all_status = all_status, .data_list = mpi_fetched_data_};
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class         :  CommMpiRma<DataClass>
+// Public Method :  BeginChunkedRemoteData
+//
+// Notes       :  1. Set up the RMA window, prepare and gather the data, and split the
+//                   fetch ids into chunks. Every process fails fast like GetRemoteData.
+//                2. If it fails, the RMA window is freed before it returns. Otherwise,
+//                   call GetNextRemoteDataChunk until HasNextRemoteDataChunk is false,
+//                   then call EndChunkedRemoteData with the same prepared_data_list.
+//                3. prepared_data_list should be alive until EndChunkedRemoteData.
+//                4. Every process gets the same number of chunks, some chunks may be
+//                empty.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass>
+CommMpiRmaReturn<DataClass> CommMpiRma<DataClass>::BeginChunkedRemoteData(
+    const std::vector<DataClass>& prepared_data_list,
+    const std::vector<CommMpiRmaQueryInfo>& fetch_id_list) {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
 
-  // Reset states to be able to reuse, or even do data chunking in the future
+  // Reset states to be able to reuse
   error_str_ = std::string();
   mpi_fetched_data_.clear();
   all_prepared_data_list_ = nullptr;
   all_prepared_data_address_list_ = nullptr;
+  fetch_index_list_.clear();
+  chunk_end_list_.clear();
+  fetch_pos_ = 0;
+  epoch_ = 0;
+  num_epochs_ = 0;
+  resident_size_ = 0;
+  fetch_status_ = CommMpiRmaStatus::kMpiSuccess;
 
   // One-sided MPI
   // Make sure every process can go through each step correctly, otherwise fail fast.
@@ -174,7 +252,7 @@ CommMpiRmaReturn<DataClass> CommMpiRma<DataClass>::GetRemoteData(
     }
     step = 3;
 
-    status = FetchRemoteData(fetch_id_list);
+    status = SplitFetchChunks(fetch_id_list);
     all_status = static_cast<CommMpiRmaStatus>(
         CommMpi::CheckAllStates(static_cast<int>(status),
                                 static_cast<int>(CommMpiRmaStatus::kMpiSuccess),
@@ -185,15 +263,62 @@ CommMpiRmaReturn<DataClass> CommMpiRma<DataClass>::GetRemoteData(
     break;
   }
 
-  if (step >= 1) {
-    DetachBuffer(prepared_data_list);
-    FreeMpiWindow();
+  if (all_status != CommMpiRmaStatus::kMpiSuccess) {
+    if (step >= 1) {
+      DetachBuffer(prepared_data_list);
+      FreeMpiWindow();
+    }
+    CleanUp(prepared_data_list);
+    num_epochs_ = 0;
   }
-  CleanUp(prepared_data_list);
 
-  return {.status = status,
-          .all_status = static_cast<CommMpiRmaStatus>(all_status),
-          .data_list = mpi_fetched_data_};
+  return {.status = status, .all_status = all_status, .data_list = mpi_fetched_data_};
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class         :  CommMpiRma<DataClass>
+// Public Method :  GetNextRemoteDataChunk
+//
+// Notes       :  1. Fetch the next chunk in its own epoch. It is a collective operation.
+//                2. The returned data list only contains data fetched in this chunk, and
+//                   the caller takes the ownership of the buffers before the next call.
+//                3. Memory budget applies to each chunk.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass>
+CommMpiRmaReturn<DataClass> CommMpiRma<DataClass>::GetNextRemoteDataChunk() {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
+
+  mpi_fetched_data_.clear();
+  resident_size_ = 0;
+
+  CommMpiRmaStatus status = FetchRemoteDataChunk();
+  CommMpiRmaStatus all_status = static_cast<CommMpiRmaStatus>(
+      CommMpi::CheckAllStates(static_cast<int>(status),
+                              static_cast<int>(CommMpiRmaStatus::kMpiSuccess),
+                              static_cast<int>(CommMpiRmaStatus::kMpiSuccess),
+                              static_cast<int>(CommMpiRmaStatus::kMpiFailed)));
+
+  return {.status = status, .all_status = all_status, .data_list = mpi_fetched_data_};
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class         :  CommMpiRma<DataClass>
+// Public Method :  EndChunkedRemoteData
+//
+// Notes       :  1. Detach buffers and free the RMA window created by
+//                BeginChunkedRemoteData.
+//                2. It is a collective operation, and should only be called if
+//                   BeginChunkedRemoteData succeeded in all processes.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass>
+void CommMpiRma<DataClass>::EndChunkedRemoteData(
+    const std::vector<DataClass>& prepared_data_list) {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
+
+  DetachBuffer(prepared_data_list);
+  FreeMpiWindow();
+  CleanUp(prepared_data_list);
+  num_epochs_ = 0;
 }
 
 //-------------------------------------------------------------------------------------------------------
@@ -208,13 +333,13 @@ CommMpiRmaReturn<DataClass> CommMpiRma<DataClass>::GetRemoteData(
 //-------------------------------------------------------------------------------------------------------
 template<typename DataClass>
 CommMpiRmaStatus CommMpiRma<DataClass>::InitializeMpiWindow() {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
 
   MPI_Info mpi_window_info;
   MPI_Info_create(&mpi_window_info);
   MPI_Info_set(mpi_window_info, "no_locks", "true");
   int mpi_return_code =
-      MPI_Win_create_dynamic(mpi_window_info, MPI_COMM_WORLD, &mpi_window_);
+      MPI_Win_create_dynamic(mpi_window_info, CommMpi::GetComm(), &mpi_window_);
   MPI_Info_free(&mpi_window_info);
 
   if (mpi_return_code != MPI_SUCCESS) {
@@ -244,7 +369,7 @@ CommMpiRmaStatus CommMpiRma<DataClass>::InitializeMpiWindow() {
 template<typename DataClass>
 CommMpiRmaStatus CommMpiRma<DataClass>::PrepareData(
     const std::vector<DataClass>& prepared_data_list) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
 
   mpi_prepared_data_address_list_.clear();
   mpi_prepared_data_address_list_.reserve(prepared_data_list.size());
@@ -313,12 +438,12 @@ CommMpiRmaStatus CommMpiRma<DataClass>::PrepareData(
 template<typename DataClass>
 CommMpiRmaStatus CommMpiRma<DataClass>::GatherAllPreparedData(
     const std::vector<DataClass>& prepared_data_list) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
 
   // Get send count in each rank
   int send_count = prepared_data_list.size();
   int* all_send_counts = new int[CommMpi::mpi_size_];
-  MPI_Allgather(&send_count, 1, MPI_INT, all_send_counts, 1, MPI_INT, MPI_COMM_WORLD);
+  MPI_Allgather(&send_count, 1, MPI_INT, all_send_counts, 1, MPI_INT, CommMpi::GetComm());
 
   // Calculate total send count and search range
   long total_send_counts = 0;
@@ -332,8 +457,10 @@ CommMpiRmaStatus CommMpiRma<DataClass>::GatherAllPreparedData(
   total_send_counts = search_range_[CommMpi::mpi_size_];
 
   // Get all prepared data
-  all_prepared_data_list_ = new DataClass[total_send_counts];
-  all_prepared_data_address_list_ = new MpiRmaAddress[total_send_counts];
+  all_prepared_data_list_ =
+      memory_tracker::NewArray<DataClass>(MemoryCategory::kMemoryRma, total_send_counts);
+  all_prepared_data_address_list_ = memory_tracker::NewArray<MpiRmaAddress>(
+      MemoryCategory::kMemoryRma, total_send_counts);
   BigMpiAllgatherv<DataClass>(all_send_counts,
                               prepared_data_list.data(),
                               GetMpiDataType(),
@@ -352,119 +479,101 @@ CommMpiRmaStatus CommMpiRma<DataClass>::GatherAllPreparedData(
 
 //-------------------------------------------------------------------------------------------------------
 // Class          :  CommMpiRma<DataClass>
-// Private Method :  FetchRemoteData
+// Private Method :  SplitFetchChunks
 //
-// Notes       :  1. MPI_Win_fence is a collective operation, which requires all processes
-// to participate.
-//                2. Close the window epoch even if the fetch failed, since it is a
-//                collective operation.
-//                3. Allocate new buffer and fetch/copy data from remote buffer to local
-//                buffer.
-//                4. If fetch id contains nullptr, we don't need to fetch it; just get the
-//                data info and
-//                   set the pointer to nullptr.
-//                5. If unable to fetch data, or the data size/length is invalid, return
-//                error.
-//                   If there is error, it would ignore the rest of the fetch ids.
-//                6. Call GetDataLen/GetDataSize to get the length and size of the data.
+// Notes       :  1. Look up the fetch ids in all prepared data, and split them into
+//                chunks
+//                   that each has total size <= memory budget. If memory budget is not
+//                   set, there is only one chunk.
+//                2. If unable to find the data, or the data size/length is invalid,
+//                return
+//                   error.
+//                3. Call GetDataLen/GetDataSize to get the length and size of the data.
 //                The method is
 //                   implemented by the derived class.
+//                4. Every process goes through the same number of epochs, which is the
+//                   maximum number of chunks among all processes. There is at least one
+//                   epoch. MPI_Allreduce is called even if it failed.
 //-------------------------------------------------------------------------------------------------------
 template<typename DataClass>
-CommMpiRmaStatus CommMpiRma<DataClass>::FetchRemoteData(
+CommMpiRmaStatus CommMpiRma<DataClass>::SplitFetchChunks(
     const std::vector<CommMpiRmaQueryInfo>& fetch_id_list) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
 
-  // Open the window epoch
-  MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOPUT | MPI_MODE_NOPRECEDE, mpi_window_);
-
-  // Fetch data
-  mpi_fetched_data_.reserve(fetch_id_list.size());
+  fetch_index_list_.reserve(fetch_id_list.size());
+  long chunk_size = 0;
   bool data_found = true;
   for (const CommMpiRmaQueryInfo& fid : fetch_id_list) {
     data_found = false;
 
     for (long s = search_range_[fid.mpi_rank]; s < search_range_[fid.mpi_rank + 1]; s++) {
-      if (all_prepared_data_list_[s].id == fid.id) {
-        DataClass fetched_data = all_prepared_data_list_[s];
-
+      if (IsQueriedData(all_prepared_data_list_[s], fid)) {
         // If data pointer to fetch is nullptr, we don't need to fetch it.
-        if (reinterpret_cast<void*>(all_prepared_data_address_list_[s].mpi_address) ==
+        long data_size = 0;
+        if (reinterpret_cast<void*>(all_prepared_data_address_list_[s].mpi_address) !=
             nullptr) {
-          fetched_data.data_ptr = nullptr;
-          mpi_fetched_data_.emplace_back(fetched_data);
-          data_found = true;
-          break;
+          // Check the size and length
+          data_size = GetDataSize(all_prepared_data_list_[s]);
+          if (data_size < 0) {
+            error_str_ = std::string("Fetch remote data size is invalid in (data_group, "
+                                     "id, mpi_rank) = (") +
+                         data_group_name_ + std::string(", ") + std::to_string(fid.id) +
+                         std::string(", ") +
+                         std::to_string(all_prepared_data_address_list_[s].mpi_rank) +
+                         std::string(") on MPI rank ") +
+                         std::to_string(CommMpi::mpi_rank_) + std::string("!");
+            break;
+          }
+          if (GetDataLen(all_prepared_data_list_[s]) < 0) {
+            error_str_ = std::string("Fetch remote data length is invalid in "
+                                     "(data_group, id, mpi_rank) = (") +
+                         data_group_name_ + std::string(", ") + std::to_string(fid.id) +
+                         std::string(", ") +
+                         std::to_string(all_prepared_data_address_list_[s].mpi_rank) +
+                         std::string(") on MPI rank ") +
+                         std::to_string(CommMpi::mpi_rank_) + std::string("!");
+            break;
+          }
         }
 
-        // Check the size, length, and data pointer
-        MPI_Datatype mpi_dtype =
-            dtype_utilities::YtDtype2MpiDtype(fetched_data.data_dtype);
-        long data_size = GetDataSize(fetched_data);
-        long data_len = GetDataLen(fetched_data);
-        if (data_size < 0) {
-          error_str_ =
-              std::string(
-                  "Fetch remote data size is invalid in (data_group, id, mpi_rank) = (") +
-              data_group_name_ + std::string(", ") + std::to_string(fetched_data.id) +
-              std::string(", ") +
-              std::to_string(all_prepared_data_address_list_[s].mpi_rank) +
-              std::string(") on MPI rank ") + std::to_string(CommMpi::mpi_rank_) +
-              std::string("!");
-          break;
+        // Start a new chunk if adding this data exceeds the memory budget
+        if (memory_budget_ > 0 && chunk_size > 0 &&
+            chunk_size + data_size > memory_budget_) {
+          chunk_end_list_.emplace_back(fetch_index_list_.size());
+          chunk_size = 0;
         }
-        if (data_len < 0) {
-          error_str_ = std::string("Fetch remote data length is invalid in (data_group, "
-                                   "id, mpi_rank) = (") +
-                       data_group_name_ + std::string(", ") +
-                       std::to_string(fetched_data.id) + std::string(", ") +
-                       std::to_string(all_prepared_data_address_list_[s].mpi_rank) +
-                       std::string(") on MPI rank ") +
-                       std::to_string(CommMpi::mpi_rank_) + std::string("!");
-          break;
-        }
-
-        // Copy data from remote buffer to local, and set the pointer in fetched_data
-        void* fetched_data_buffer = malloc(data_size);
-        fetched_data.data_ptr = fetched_data_buffer;
-        if (CallBigMpiGetBasedOnYtDtype(fetched_data_buffer,
-                                        data_len,
-                                        &fetched_data.data_dtype,
-                                        &mpi_dtype,
-                                        all_prepared_data_address_list_[s].mpi_rank,
-                                        all_prepared_data_address_list_[s].mpi_address,
-                                        &mpi_window_) != BigMpiStatus::kBigMpiSuccess) {
-          error_str_ =
-              std::string("Fetch remote data buffer (data_group, id, mpi_rank) = (") +
-              data_group_name_ + std::string(", ") + std::to_string(fid.id) +
-              std::string(", ") +
-              std::to_string(all_prepared_data_address_list_[s].mpi_rank) +
-              std::string(") failed on MPI rank ") + std::to_string(CommMpi::mpi_rank_) +
-              std::string("!");
-          free(fetched_data_buffer);
-          break;
-        }
-
-        // Push to fetched data list
-        mpi_fetched_data_.emplace_back(fetched_data);
+        chunk_size += data_size;
+        fetch_index_list_.emplace_back(s);
         data_found = true;
         break;
       }
     }
 
     if (!data_found) {
-      error_str_ =
-          std::string("Cannot find remote data buffer (data_group, id, mpi_rank) = (") +
-          data_group_name_ + std::string(", ") + std::to_string(fid.id) +
-          std::string(", ") + std::to_string(fid.mpi_rank) +
-          std::string(") on MPI rank ") + std::to_string(CommMpi::mpi_rank_) +
-          std::string("!");
+      if (error_str_.empty()) {
+        error_str_ =
+            std::string("Cannot find remote data buffer (data_group, id, mpi_rank) = (") +
+            data_group_name_ + std::string(", ") + std::to_string(fid.id) +
+            std::string(", ") + std::to_string(fid.mpi_rank) +
+            std::string(") on MPI rank ") + std::to_string(CommMpi::mpi_rank_) +
+            std::string("!");
+      }
       break;
     }
   }
+  if (data_found && !fetch_index_list_.empty()) {
+    chunk_end_list_.emplace_back(fetch_index_list_.size());
+  } else {
+    fetch_index_list_.clear();
+    chunk_end_list_.clear();
+  }
 
-  // Close the window epoch, even if the fetch failed
-  MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOPUT | MPI_MODE_NOSUCCEED, mpi_window_);
+  // Every process must go through the same number of epochs
+  int num_chunks = static_cast<int>(chunk_end_list_.size());
+  MPI_Allreduce(&num_chunks, &num_epochs_, 1, MPI_INT, MPI_MAX, CommMpi::GetComm());
+  if (num_epochs_ < 1) {
+    num_epochs_ = 1;
+  }
 
   if (data_found) {
     return CommMpiRmaStatus::kMpiSuccess;
@@ -473,9 +582,148 @@ CommMpiRmaStatus CommMpiRma<DataClass>::FetchRemoteData(
   }
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Class          :  CommMpiRma<DataClass>
+// Private Method :  FetchRemoteDataChunk
+//
+// Notes       :  1. MPI_Win_fence is a collective operation, which requires all processes
+// to participate.
+//                2. Close the window epoch even if the fetch failed, since it is a
+//                collective operation.
+//                3. Allocate new buffer and fetch/copy data from remote buffer to local
+//                buffer,
+//                   and append it to mpi_fetched_data_.
+//                4. If fetch id contains nullptr, we don't need to fetch it; just get the
+//                data info and
+//                   set the pointer to nullptr.
+//                5. If unable to allocate or fetch data, return error. If there is error,
+//                it
+//                   would ignore the rest of the fetch ids, but still goes through the
+//                   rest of the epochs.
+//                6. Spilled buffers are written back to disk after the epoch is closed,
+//                so
+//                   that at most one chunk of spilled data stays resident.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass>
+CommMpiRmaStatus CommMpiRma<DataClass>::FetchRemoteDataChunk() {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
+  perf_counter::ScopedTimer perf_timer("rma.fetch_time");
+
+  // Open the window epoch
+  MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOPUT | MPI_MODE_NOPRECEDE, mpi_window_);
+
+  // Fetch data in this chunk
+  long fetched_bytes = 0;
+  std::size_t chunk_begin = mpi_fetched_data_.size();
+  std::size_t chunk_end =
+      (epoch_ < static_cast<int>(chunk_end_list_.size())) ? chunk_end_list_[epoch_]
+                                                          : fetch_pos_;
+  for (; fetch_status_ == CommMpiRmaStatus::kMpiSuccess && fetch_pos_ < chunk_end;
+       fetch_pos_++) {
+    long s = fetch_index_list_[fetch_pos_];
+    DataClass fetched_data = all_prepared_data_list_[s];
+
+    // If data pointer to fetch is nullptr, we don't need to fetch it.
+    if (reinterpret_cast<void*>(all_prepared_data_address_list_[s].mpi_address) ==
+        nullptr) {
+      fetched_data.data_ptr = nullptr;
+      mpi_fetched_data_.emplace_back(fetched_data);
+      continue;
+    }
+
+    // Allocate local buffer within memory budget, or spill it
+    MPI_Datatype mpi_dtype = dtype_utilities::YtDtype2MpiDtype(fetched_data.data_dtype);
+    long data_size = GetDataSize(fetched_data);
+    long data_len = GetDataLen(fetched_data);
+    void* fetched_data_buffer = AllocateFetchBuffer(data_size);
+    if (fetched_data_buffer == nullptr) {
+      error_str_ =
+          std::string("Unable to allocate buffer for remote data (data_group, id, "
+                      "mpi_rank) = (") +
+          data_group_name_ + std::string(", ") + std::to_string(fetched_data.id) +
+          std::string(", ") +
+          std::to_string(all_prepared_data_address_list_[s].mpi_rank) +
+          std::string(") within memory budget ") + std::to_string(memory_budget_) +
+          std::string(" bytes on MPI rank ") + std::to_string(CommMpi::mpi_rank_) +
+          (spill_dir_.empty() ? std::string("!\nSet spill_dir in yt_param_libyt to spill "
+                                            "fetched data to node-local storage.")
+                              : std::string(", and unable to spill it to ") + spill_dir_ +
+                                    std::string("!"));
+      fetch_status_ = CommMpiRmaStatus::kMpiFailed;
+      break;
+    }
+
+    // Copy data from remote buffer to local, and set the pointer in fetched_data
+    fetched_data.data_ptr = fetched_data_buffer;
+    if (CallBigMpiGetBasedOnYtDtype(fetched_data_buffer,
+                                    data_len,
+                                    &fetched_data.data_dtype,
+                                    &mpi_dtype,
+                                    all_prepared_data_address_list_[s].mpi_rank,
+                                    all_prepared_data_address_list_[s].mpi_address,
+                                    &mpi_window_) != BigMpiStatus::kBigMpiSuccess) {
+      error_str_ =
+          std::string("Fetch remote data buffer (data_group, id, mpi_rank) = (") +
+          data_group_name_ + std::string(", ") + std::to_string(fetched_data.id) +
+          std::string(", ") +
+          std::to_string(all_prepared_data_address_list_[s].mpi_rank) +
+          std::string(") failed on MPI rank ") + std::to_string(CommMpi::mpi_rank_) +
+          std::string("!");
+      if (memory_spill::IsSpillBuffer(fetched_data_buffer)) {
+        memory_spill::FreeSpillBuffer(fetched_data_buffer);
+      } else {
+        memory_tracker::Free(fetched_data_buffer);
+      }
+      fetch_status_ = CommMpiRmaStatus::kMpiFailed;
+      break;
+    }
+
+    // Push to fetched data list
+    mpi_fetched_data_.emplace_back(fetched_data);
+    fetched_bytes += data_size;
+  }
+
+  // Close the window epoch, even if the fetch failed
+  MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOPUT | MPI_MODE_NOSUCCEED, mpi_window_);
+  epoch_++;
+  perf_counter::Add("rma.bytes", static_cast<double>(fetched_bytes));
+  perf_counter::Add("rma.epochs", 1.0);
+
+  // Write spilled data in this chunk back to disk
+  for (std::size_t i = chunk_begin; i < mpi_fetched_data_.size(); i++) {
+    memory_spill::ReleaseResidentPages(mpi_fetched_data_[i].data_ptr);
+  }
+
+  return fetch_status_;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  CommMpiRma<DataClass>
+// Private Method :  AllocateFetchBuffer
+//
+// Notes       :  1. Allocate buffer by memory_tracker if it is within memory budget, and
+//                   add the size to resident_size_. If memory budget is <= 0, there is no
+//                   limit.
+//                2. If it exceeds the memory budget, allocate a spill buffer under
+//                spill_dir_.
+//                3. Return nullptr if it is unable to allocate the buffer.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass>
+void* CommMpiRma<DataClass>::AllocateFetchBuffer(long data_size) {
+  if (memory_budget_ <= 0 || resident_size_ + data_size <= memory_budget_) {
+    void* buffer = memory_tracker::Allocate(MemoryCategory::kMemoryRma, data_size);
+    if (buffer != nullptr) {
+      resident_size_ += data_size;
+    }
+    return buffer;
+  }
+
+  return memory_spill::AllocateSpillBuffer(spill_dir_, data_size);
+}
+
 template<typename DataClass>
 CommMpiRmaStatus CommMpiRma<DataClass>::FreeMpiWindow() {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
 
   MPI_Win_free(&mpi_window_);
 
@@ -485,7 +733,7 @@ CommMpiRmaStatus CommMpiRma<DataClass>::FreeMpiWindow() {
 template<typename DataClass>
 CommMpiRmaStatus CommMpiRma<DataClass>::DetachBuffer(
     const std::vector<DataClass>& prepared_data_list) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
 
   // Detach what is attached in PrepareData
   for (std::size_t i = 0; i < mpi_prepared_data_address_list_.size(); i++) {
@@ -498,11 +746,15 @@ CommMpiRmaStatus CommMpiRma<DataClass>::DetachBuffer(
 template<typename DataClass>
 CommMpiRmaStatus CommMpiRma<DataClass>::CleanUp(
     const std::vector<DataClass>& prepared_data_list) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
 
   search_range_.clear();
-  delete[] all_prepared_data_list_;
-  delete[] all_prepared_data_address_list_;
+  fetch_index_list_.clear();
+  chunk_end_list_.clear();
+  memory_tracker::DeleteArray(all_prepared_data_list_);
+  memory_tracker::DeleteArray(all_prepared_data_address_list_);
+  all_prepared_data_list_ = nullptr;
+  all_prepared_data_address_list_ = nullptr;
 
   return CommMpiRmaStatus::kMpiSuccess;
 }
@@ -510,9 +762,11 @@ CommMpiRmaStatus CommMpiRma<DataClass>::CleanUp(
 template class CommMpiRma<AmrDataArray3D>;
 template class CommMpiRma<AmrDataArray2D>;
 template class CommMpiRma<AmrDataArray1D>;
+template class CommMpiRma<AmrDataArrayLabeled>;
 MPI_Datatype CommMpiRmaAmrDataArray3D::mpi_data_type_ = 0;
 MPI_Datatype CommMpiRmaAmrDataArray2D::mpi_data_type_ = 0;
 MPI_Datatype CommMpiRmaAmrDataArray1D::mpi_data_type_ = 0;
+MPI_Datatype CommMpiRmaAmrDataArrayLabeled::mpi_data_type_ = 0;
 
 //-------------------------------------------------------------------------------------------------------
 // Class          :  CommMpiRmaAmrDataArray3D
@@ -701,4 +955,75 @@ void CommMpiRmaAmrDataArray1D::InitializeMpiDataType() {
   MPI_Type_commit(&mpi_data_type_);
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Class          :  CommMpiRmaAmrDataArrayLabeled
+// Private Method :  GetDataSize
+//
+// Notes          :  1. The method is used in PrepareData and FetchRemoteData to get the
+//                      size of the data.
+//                   2. For invalid data, return value < 0.
+//-------------------------------------------------------------------------------------------------------
+long CommMpiRmaAmrDataArrayLabeled::GetDataSize(const AmrDataArrayLabeled& data) {
+  long data_len = GetDataLen(data);
+  if (data_len < 0 || data.data_dtype == YT_DTYPE_UNKNOWN) {
+    return -1;
+  }
+
+  int dtype_size = dtype_utilities::GetYtDtypeSize(data.data_dtype);
+  return data_len * dtype_size;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  CommMpiRmaAmrDataArrayLabeled
+// Private Method :  GetDataLen
+//
+// Notes          :  1. The method is used in FetchRemoteData to get the length of the
+//                      data.
+//                   2. For invalid data, return value < 0.
+//-------------------------------------------------------------------------------------------------------
+long CommMpiRmaAmrDataArrayLabeled::GetDataLen(const AmrDataArrayLabeled& data) {
+  for (int i = 0; i < 3; i++) {
+    if (data.data_dim[i] < 0) {
+      return -1;
+    }
+  }
+  return data.data_dim[0] * data.data_dim[1] * data.data_dim[2];
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  CommMpiRmaAmrDataArrayLabeled
+// Public Method  :  Constructor
+//
+// Notes          :  1. Also initialize custom mpi data type.
+//-------------------------------------------------------------------------------------------------------
+CommMpiRmaAmrDataArrayLabeled::CommMpiRmaAmrDataArrayLabeled(
+    const std::string& data_group_name, const std::string& data_format)
+    : CommMpiRma<AmrDataArrayLabeled>(data_group_name, data_format) {
+  InitializeMpiDataType();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class                 :  CommMpiRmaAmrDataArrayLabeled
+// Private Static Method :  InitializeMpiDataType
+//
+// Notes          :  1. Initialize custom mpi data type for AmrDataArrayLabeled.
+//-------------------------------------------------------------------------------------------------------
+void CommMpiRmaAmrDataArrayLabeled::InitializeMpiDataType() {
+  if (mpi_data_type_ != 0) {
+    return;
+  }
+
+  int lengths[6] = {1, 1, 1, 3, 1, 1};
+  MPI_Aint displacements[6];
+  displacements[0] = offsetof(AmrDataArrayLabeled, id);
+  displacements[1] = offsetof(AmrDataArrayLabeled, label);
+  displacements[2] = offsetof(AmrDataArrayLabeled, data_dtype);
+  displacements[3] = offsetof(AmrDataArrayLabeled, data_dim);
+  displacements[4] = offsetof(AmrDataArrayLabeled, data_ptr);
+  displacements[5] = offsetof(AmrDataArrayLabeled, contiguous_in_x);
+  MPI_Datatype types[6] = {MPI_LONG, MPI_INT, MPI_INT, MPI_LONG, MPI_AINT, MPI_CXX_BOOL};
+  MPI_Type_create_struct(6, lengths, displacements, types, &mpi_data_type_);
+  MPI_Type_commit(&mpi_data_type_);
+}
+
 #endif
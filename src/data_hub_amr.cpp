@@ -1,6 +1,7 @@
 #include "data_hub_amr.h"
 
 #include "dtype_utilities.h"
+#include "memory_tracker.h"
 
 //----------------------------------------------------------------------------------------
 // Class         :  DataHub
@@ -14,7 +15,7 @@ void DataHub<DataClass>::ClearCache() {
   if (!take_ownership_) {
     for (size_t i = 0; i < data_array_list_.size(); i++) {
       if (is_new_allocation_list_[i]) {
-        free(data_array_list_[i].data_ptr);
+        memory_tracker::Free(data_array_list_[i].data_ptr);
       }
     }
   }
@@ -42,7 +43,8 @@ template class DataHubAmrField<AmrDataArray1D>;
 //                fast.
 //                   Every time it is called, it will clear the cache.
 //                4. Can retrieve data type derived_func/cell-centered/face-centered.
-//                   And assume that the data type is the same.
+//                   And assume that the data type is the same. Derived field data in
+//                   libyt.grid_data is read first, and the rest is generated.
 //                5. If the data retrival requires new allocation of data buffer (ex:
 //                derived function),
 //                   then it will be marked in is_new_allocation_list_. It will later be
@@ -65,41 +67,9 @@ DataHubReturn<DataClass> DataHubAmrField<DataClass>::GetLocalFieldData(
     return {DataHubStatus::kDataHubFailed, this->data_array_list_};
   }
 
-  if (strcmp(field_list[field_id].field_type, "derived_func") == 0) {
-    DataStructureOutput status = ds_amr.GenerateLocalFieldData<DataClass>(
-        grid_id_list, field_name.c_str(), this->data_array_list_);
-    this->is_new_allocation_list_.assign(this->data_array_list_.size(), true);
-    if (status.status != DataStructureStatus::kDataStructureSuccess) {
-      this->error_str_ = std::move(status.error);
-      return {DataHubStatus::kDataHubFailed, this->data_array_list_};
-    }
-  } else if (strcmp(field_list[field_id].field_type, "cell-centered") == 0 ||
-             strcmp(field_list[field_id].field_type, "face-centered") == 0) {
-    for (const long& gid : grid_id_list) {
-      yt_data field_data;
-      DataStructureOutput status =
-          ds_amr.GetPythonBoundLocalFieldData(gid, field_name.c_str(), &field_data);
-      if (status.status != DataStructureStatus::kDataStructureSuccess) {
-        this->error_str_ = status.error;
-        this->error_str_ +=
-            std::string("Failed to get data (field_name, gid) = (") + field_name +
-            std::string(", ") + std::to_string(gid) + std::string(") on MPI rank ") +
-            std::to_string(DataStructureAmr::mpi_rank_) + std::string(".\n");
-        return {DataHubStatus::kDataHubFailed, this->data_array_list_};
-      }
-      DataClass amr_data{};
-      amr_data.id = gid;
-      amr_data.contiguous_in_x = field_list[field_id].contiguous_in_x;
-      amr_data.data_dtype = field_data.data_dtype;
-      for (int d = 0; d < ds_amr.GetDimensionality(); d++) {
-        amr_data.data_dim[d] = field_data.data_dimensions[d];
-      }
-      amr_data.data_ptr = field_data.data_ptr;
-
-      this->is_new_allocation_list_.emplace_back(false);
-      this->data_array_list_.emplace_back(amr_data);
-    }
-  } else {
+  const bool is_derived = (strcmp(field_list[field_id].field_type, "derived_func") == 0);
+  if (!is_derived && strcmp(field_list[field_id].field_type, "cell-centered") != 0 &&
+      strcmp(field_list[field_id].field_type, "face-centered") != 0) {
     this->error_str_ = std::string("Unknown field type [ ") +
                        std::string(field_list[field_id].field_type) +
                        std::string(" ] in field [ ") + field_name +
@@ -108,6 +78,51 @@ DataHubReturn<DataClass> DataHubAmrField<DataClass>::GetLocalFieldData(
     return {DataHubStatus::kDataHubFailed, this->data_array_list_};
   }
 
+  // Derived field data already in libyt.grid_data, e.g. generated by node members in
+  // node aggregation, is read as it is, and the rest is generated by derived_func.
+  std::vector<long> generate_gid_list;
+  for (const long& gid : grid_id_list) {
+    yt_data field_data;
+    DataStructureOutput status =
+        ds_amr.GetPythonBoundLocalFieldDataByIndex(gid, field_id, &field_data);
+    if (status.status != DataStructureStatus::kDataStructureSuccess) {
+      if (is_derived) {
+        generate_gid_list.push_back(gid);
+        continue;
+      }
+      this->error_str_ = status.error;
+      this->error_str_ +=
+          std::string("Failed to get data (field_name, gid) = (") + field_name +
+          std::string(", ") + std::to_string(gid) + std::string(") on MPI rank ") +
+          std::to_string(DataStructureAmr::mpi_rank_) + std::string(".\n");
+      return {DataHubStatus::kDataHubFailed, this->data_array_list_};
+    }
+    DataClass amr_data{};
+    amr_data.id = gid;
+    amr_data.contiguous_in_x = field_list[field_id].contiguous_in_x;
+    amr_data.data_dtype = field_data.data_dtype;
+    for (int d = 0; d < ds_amr.GetDimensionality(); d++) {
+      amr_data.data_dim[d] = field_data.data_dimensions[d];
+    }
+    amr_data.data_ptr = field_data.data_ptr;
+
+    this->is_new_allocation_list_.emplace_back(false);
+    this->data_array_list_.emplace_back(amr_data);
+  }
+
+  if (!generate_gid_list.empty()) {
+    size_t num_read = this->data_array_list_.size();
+    DataStructureOutput status = ds_amr.GenerateLocalFieldData<DataClass>(
+        generate_gid_list, field_name.c_str(), this->data_array_list_);
+    this->is_new_allocation_list_.insert(this->is_new_allocation_list_.end(),
+                                         this->data_array_list_.size() - num_read,
+                                         true);
+    if (status.status != DataStructureStatus::kDataStructureSuccess) {
+      this->error_str_ = std::move(status.error);
+      return {DataHubStatus::kDataHubFailed, this->data_array_list_};
+    }
+  }
+
   return {DataHubStatus::kDataHubSuccess, this->data_array_list_};
 }
 
@@ -154,8 +169,8 @@ DataHubReturn<AmrDataArray1D> DataHubAmrParticle::GetLocalParticleData(
   for (const long& kGid : grid_id_list) {
     // Try to retrieve the particle data in libyt.particle_data
     yt_data par_array;
-    DataStructureOutput status = ds_amr.GetPythonBoundLocalParticleData(
-        kGid, ptype.c_str(), pattr.c_str(), &par_array);
+    DataStructureOutput status = ds_amr.GetPythonBoundLocalParticleDataByIndex(
+        kGid, ptype_index, pattr_index, &par_array);
     if (status.status == DataStructureStatus::kDataStructureSuccess) {
       // Read from libyt.particle_data
       AmrDataArray1D amr_1d_data{};
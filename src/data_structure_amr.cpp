@@ -7,7 +7,10 @@
 #include <cstddef>
 
 #include "dtype_utilities.h"
+#include "memory_tracker.h"
 #include "numpy_controller.h"
+#include "perf_counter.h"
+#include "timer.h"
 #ifdef USE_PYBIND11
 #include "pybind11/embed.h"
 #endif
@@ -19,6 +22,9 @@ int DataStructureAmr::mpi_rank_;
 MPI_Datatype DataStructureAmr::mpi_hierarchy_data_type_ = 0;
 #endif
 
+// Hierarchy storage is tracked under this memory category.
+static const MemoryCategory kHierarchy = MemoryCategory::kMemoryHierarchy;
+
 //----------------------------------------------------------------------------------------
 // Class         :  DataStructureAmr
 // Public Method :  Constructor
@@ -34,6 +40,7 @@ DataStructureAmr::DataStructureAmr()
       py_hierarchy_(nullptr),
       py_grid_data_(nullptr),
       py_particle_data_(nullptr),
+      has_name_lookup_tables_(false),
       num_grids_(0),
       num_fields_(0),
       num_par_types_(0),
@@ -113,6 +120,8 @@ DataStructureOutput DataStructureAmr::AllocateStorage(
   // Initialize the data structure
   DataStructureOutput status;
 
+  CleanUpNameLookupTables();
+
   status = AllocateFieldList(num_fields);
   if (status.status != DataStructureStatus::kDataStructureSuccess) {
     return {DataStructureStatus::kDataStructureFailed, status.error};
@@ -304,6 +313,8 @@ DataStructureOutput DataStructureAmr::AllocateGridsLocal(int num_grids_local,
 //                   has_particle_ is set through num_par_types.
 //                   Make sure hierarchy is properly freed before new allocation.
 //                4. I'm not sure if data structure contains python code is a good idea.
+//                5. Only C storage is allocated if Python bindings are not set, e.g. on
+//                   processes without Python in node aggregation.
 //----------------------------------------------------------------------------------------
 DataStructureOutput DataStructureAmr::AllocateFullHierarchyStorageForPython(
     long num_grids, int num_par_types) {
@@ -321,17 +332,25 @@ DataStructureOutput DataStructureAmr::AllocateFullHierarchyStorageForPython(
   }
 
   // Allocate storage
-  grid_left_edge_ = new double[num_grids * 3];
-  grid_right_edge_ = new double[num_grids * 3];
-  grid_dimensions_ = new int[num_grids * 3];
-  grid_parent_id_ = new long[num_grids];
-  grid_levels_ = new int[num_grids];
-  proc_num_ = new int[num_grids];
+  grid_left_edge_ = memory_tracker::NewArray<double>(kHierarchy, num_grids * 3);
+  grid_right_edge_ = memory_tracker::NewArray<double>(kHierarchy, num_grids * 3);
+  grid_dimensions_ = memory_tracker::NewArray<int>(kHierarchy, num_grids * 3);
+  grid_parent_id_ = memory_tracker::NewArray<long>(kHierarchy, num_grids);
+  grid_levels_ = memory_tracker::NewArray<int>(kHierarchy, num_grids);
+  proc_num_ = memory_tracker::NewArray<int>(kHierarchy, num_grids);
   if (num_par_types > 0) {
-    par_count_list_ = new long[num_grids * num_par_types];
+    par_count_list_ =
+        memory_tracker::NewArray<long>(kHierarchy, num_grids * num_par_types);
   } else {
     par_count_list_ = nullptr;
   }
+  num_grids_ = num_grids;
+  has_particle_ = (num_par_types > 0);
+
+  // Processes without Python only keep C storage
+  if (py_hierarchy_ == nullptr) {
+    return {DataStructureStatus::kDataStructureSuccess, ""};
+  }
 
   // Bind to Python
   npy_intp np_dim[2];
@@ -373,8 +392,8 @@ DataStructureOutput DataStructureAmr::AllocateFullHierarchyStorageForPython(
     PyDict_SetItemString(py_hierarchy_, "par_count_list", py_par_count_list);
   }
 #else   // #ifndef USE_PYBIND11
-  pybind11::module_ libyt = pybind11::module_::import("libyt");
-  pybind11::dict py_hierarchy = libyt.attr("hierarchy");
+  pybind11::dict py_hierarchy =
+      pybind11::reinterpret_borrow<pybind11::dict>(py_hierarchy_);
 
   py_hierarchy["grid_left_edge"] = py_grid_left_edge;
   py_hierarchy["grid_right_edge"] = py_grid_right_edge;
@@ -398,9 +417,6 @@ DataStructureOutput DataStructureAmr::AllocateFullHierarchyStorageForPython(
     Py_DECREF(py_par_count_list);
   }
 
-  num_grids_ = num_grids;
-  has_particle_ = (num_par_types > 0);
-
   return {DataStructureStatus::kDataStructureSuccess, ""};
 }
 
@@ -416,6 +432,8 @@ DataStructureOutput DataStructureAmr::AllocateFullHierarchyStorageForPython(
 DataStructureOutput DataStructureAmr::GatherAllHierarchy(
     int mpi_root, yt_hierarchy** full_hierarchy_ptr,
     long*** full_particle_count_ptr) const {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerHierarchy);
+
 #ifndef SERIAL_MODE
   // Get num_grids_local in different ranks
   int* all_num_grids_local = new int[mpi_size_];
@@ -432,13 +450,16 @@ DataStructureOutput DataStructureAmr::GatherAllHierarchy(
   }
 
   // Prepare storage for Mpi
-  yt_hierarchy* hierarchy_full = new yt_hierarchy[num_grids_];
-  yt_hierarchy* hierarchy_local = new yt_hierarchy[num_grids_local_];
+  yt_hierarchy* hierarchy_full =
+      memory_tracker::NewArray<yt_hierarchy>(kHierarchy, num_grids_);
+  yt_hierarchy* hierarchy_local =
+      memory_tracker::NewArray<yt_hierarchy>(kHierarchy, num_grids_local_);
   long** particle_count_list_full = new long*[num_par_types_];
   long** particle_count_list_local = new long*[num_par_types_];
   for (int s = 0; s < num_par_types_; s++) {
-    particle_count_list_full[s] = new long[num_grids_];
-    particle_count_list_local[s] = new long[num_grids_local_];
+    particle_count_list_full[s] = memory_tracker::NewArray<long>(kHierarchy, num_grids_);
+    particle_count_list_local[s] =
+        memory_tracker::NewArray<long>(kHierarchy, num_grids_local_);
   }
 
   // Copy and prepare data for Mpi (TODO: Can I not use hierarchy_local/particle_local?
@@ -475,9 +496,9 @@ DataStructureOutput DataStructureAmr::GatherAllHierarchy(
 
   // Clean up
   delete[] all_num_grids_local;
-  delete[] hierarchy_local;
+  memory_tracker::DeleteArray(hierarchy_local);
   for (int s = 0; s < num_par_types_; s++) {
-    delete[] particle_count_list_local[s];
+    memory_tracker::DeleteArray(particle_count_list_local[s]);
   }
   delete[] particle_count_list_local;
 #endif
@@ -1077,9 +1098,55 @@ DataStructureOutput DataStructureAmr::BindInfoToPython(const std::string& py_dic
       return {DataStructureStatus::kDataStructureFailed, status.error};
     }
   }
+  BuildNameLookupTables();
   return {DataStructureStatus::kDataStructureSuccess, ""};
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Private Method :  BuildNameLookupTables
+//
+// Notes       :  1. Map field names, particle types, and particle attribute names to
+//                   their index in field_list_ and particle_list_, and create interned
+//                   Python strings of them, which are the keys of libyt.grid_data and
+//                   libyt.particle_data.
+//                2. Names are fixed after they are bound to Python, so the tables stay
+//                   valid until CleanUp. If the same name appears twice, the first one
+//                   is used, which is the same as a linear search.
+//-------------------------------------------------------------------------------------------------------
+void DataStructureAmr::BuildNameLookupTables() {
+  CleanUpNameLookupTables();
+
+  field_index_map_.reserve(num_fields_);
+  py_field_name_list_.reserve(num_fields_);
+  for (int v = 0; v < num_fields_; v++) {
+    const char* field_name =
+        field_list_[v].field_name != nullptr ? field_list_[v].field_name : "";
+    field_index_map_.emplace(field_name, v);
+    py_field_name_list_.push_back(PyUnicode_InternFromString(field_name));
+  }
+
+  particle_index_map_.reserve(num_par_types_);
+  particle_attr_index_map_.resize(num_par_types_);
+  py_particle_type_list_.reserve(num_par_types_);
+  py_particle_attr_name_list_.resize(num_par_types_);
+  for (int p = 0; p < num_par_types_; p++) {
+    const char* ptype =
+        particle_list_[p].par_type != nullptr ? particle_list_[p].par_type : "";
+    particle_index_map_.emplace(ptype, p);
+    py_particle_type_list_.push_back(PyUnicode_InternFromString(ptype));
+    for (int a = 0; a < particle_list_[p].num_attr; a++) {
+      const char* attr_name = particle_list_[p].attr_list[a].attr_name != nullptr
+                                  ? particle_list_[p].attr_list[a].attr_name
+                                  : "";
+      particle_attr_index_map_[p].emplace(attr_name, a);
+      py_particle_attr_name_list_[p].push_back(PyUnicode_InternFromString(attr_name));
+    }
+  }
+
+  has_name_lookup_tables_ = true;
+}
+
 //-------------------------------------------------------------------------------------------------------
 // Class          :  DataStructureAmr
 // Public Method  :  BindAllHierarchyToPython
@@ -1094,7 +1161,10 @@ DataStructureOutput DataStructureAmr::BindInfoToPython(const std::string& py_dic
 //                         storage?
 //-------------------------------------------------------------------------------------------------------
 DataStructureOutput DataStructureAmr::BindAllHierarchyToPython(int mpi_root) {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerHierarchy);
+
   if (check_data_) {
+    perf_counter::ScopedTimer perf_timer("commit.check_time");
     DataStructureOutput status = CheckGridsLocal();
     if (status.status != DataStructureStatus::kDataStructureSuccess) {
       return status;
@@ -1109,13 +1179,17 @@ DataStructureOutput DataStructureAmr::BindAllHierarchyToPython(int mpi_root) {
 
   while (true) {
     // Gather hierarchy
-    status = GatherAllHierarchy(mpi_root, &hierarchy_full, &particle_count_list_full);
+    {
+      perf_counter::ScopedTimer perf_timer("commit.gather_time");
+      status = GatherAllHierarchy(mpi_root, &hierarchy_full, &particle_count_list_full);
+    }
     if (status.status != DataStructureStatus::kDataStructureSuccess) {
       break;
     }
 
     // Check data
     if (check_data_) {
+      perf_counter::ScopedTimer perf_timer("commit.check_time");
       status = CheckHierarchyIsValid(hierarchy_full);
       if (status.status != DataStructureStatus::kDataStructureSuccess) {
         break;
@@ -1123,6 +1197,7 @@ DataStructureOutput DataStructureAmr::BindAllHierarchyToPython(int mpi_root) {
     }
 
     // Bind hierarchy to Python
+    perf_counter::ScopedTimer perf_timer("commit.bind_time");
     for (long i = 0; i < num_grids_; i++) {
       long index = hierarchy_full[i].id - index_offset_;
       for (int d = 0; d < 3; d++) {
@@ -1144,34 +1219,20 @@ DataStructureOutput DataStructureAmr::BindAllHierarchyToPython(int mpi_root) {
 #else
   DataStructureOutput status = {DataStructureStatus::kDataStructureSuccess, ""};
   if (check_data_) {
+    perf_counter::ScopedTimer perf_timer("commit.check_time");
     status = CheckHierarchyIsValid(grids_local_);
   }
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
-    for (long i = 0; i < num_grids_local_; i++) {
-      long index = grids_local_[i].id - index_offset_;
-      for (int d = 0; d < 3; d++) {
-        grid_left_edge_[index * 3 + d] = grids_local_[i].left_edge[d];
-        grid_right_edge_[index * 3 + d] = grids_local_[i].right_edge[d];
-        grid_dimensions_[index * 3 + d] = grids_local_[i].grid_dimensions[d];
-      }
-      grid_parent_id_[index] = grids_local_[i].parent_id;
-      grid_levels_[index] = grids_local_[i].level;
-      proc_num_[index] = grids_local_[i].proc_num;
-      if (num_par_types_ > 0) {
-        for (int p = 0; p < num_par_types_; p++) {
-          par_count_list_[index * num_par_types_ + p] = grids_local_[i].par_count_list[p];
-        }
-      }
-    }
+    status = BindLocalHierarchy();
   }
 #endif
 
   // Clean up
 #ifndef SERIAL_MODE
-  delete[] hierarchy_full;
+  memory_tracker::DeleteArray(hierarchy_full);
   for (int s = 0; s < num_par_types_; s++) {
-    delete[] particle_count_list_full[s];
+    memory_tracker::DeleteArray(particle_count_list_full[s]);
   }
   delete[] particle_count_list_full;
 #endif
@@ -1179,6 +1240,73 @@ DataStructureOutput DataStructureAmr::BindAllHierarchyToPython(int mpi_root) {
   return status;
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Public Method  :  BindLocalHierarchy
+//
+// Notes       :  1. Fill the full hierarchy storage with local grids only, without
+//                   gathering hierarchy from other ranks.
+//                2. It is the full hierarchy in SERIAL_MODE. Processes without Python in
+//                   node aggregation and in-transit mode use it, so that yt_getGridInfo_*
+//                   works on their own grids.
+//-------------------------------------------------------------------------------------------------------
+DataStructureOutput DataStructureAmr::BindLocalHierarchy() {
+  for (long i = 0; i < num_grids_local_; i++) {
+    long index = grids_local_[i].id - index_offset_;
+    if (index < 0 || index >= num_grids_) {
+      std::string error =
+          "(grid id) = " + std::to_string(grids_local_[i].id) + " is out of range.\n";
+      return {DataStructureStatus::kDataStructureFailed, error};
+    }
+    for (int d = 0; d < 3; d++) {
+      grid_left_edge_[index * 3 + d] = grids_local_[i].left_edge[d];
+      grid_right_edge_[index * 3 + d] = grids_local_[i].right_edge[d];
+      grid_dimensions_[index * 3 + d] = grids_local_[i].grid_dimensions[d];
+    }
+    grid_parent_id_[index] = grids_local_[i].parent_id;
+    grid_levels_[index] = grids_local_[i].level;
+    proc_num_[index] = grids_local_[i].proc_num;
+    if (num_par_types_ > 0) {
+      for (int p = 0; p < num_par_types_; p++) {
+        par_count_list_[index * num_par_types_ + p] = grids_local_[i].par_count_list[p];
+      }
+    }
+  }
+
+  return {DataStructureStatus::kDataStructureSuccess, ""};
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Public Method  :  CheckLocalData
+//
+// Notes       :  1. Check field list, particle list, and local grids if check_data is
+//                   true, without gathering the full hierarchy.
+//                2. Simulation processes in in-transit mode use it, since they do not
+//                   bind anything to Python, and analysis processes do not receive
+//                   derived_func and get_par_attr to check.
+//-------------------------------------------------------------------------------------------------------
+DataStructureOutput DataStructureAmr::CheckLocalData() const {
+  if (!check_data_) {
+    return {DataStructureStatus::kDataStructureSuccess, ""};
+  }
+  perf_counter::ScopedTimer perf_timer("commit.check_time");
+
+  if (num_fields_ > 0) {
+    DataStructureOutput status = CheckFieldList();
+    if (status.status != DataStructureStatus::kDataStructureSuccess) {
+      return status;
+    }
+  }
+  if (num_par_types_ > 0) {
+    DataStructureOutput status = CheckParticleList();
+    if (status.status != DataStructureStatus::kDataStructureSuccess) {
+      return status;
+    }
+  }
+  return CheckGridsLocal();
+}
+
 //-------------------------------------------------------------------------------------------------------
 // Class          :  DataStructureAmr
 // Private Method :  BindLocalFieldDataToPython
@@ -1410,6 +1538,8 @@ DataStructureOutput DataStructureAmr::BindLocalParticleDataToPython(
 //                         future libyt v1.0.
 //-------------------------------------------------------------------------------------------------------
 DataStructureOutput DataStructureAmr::BindLocalDataToPython() const {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerHierarchy);
+
   for (int i = 0; i < num_grids_local_; i++) {
     if (num_fields_ > 0) {
       DataStructureOutput status = BindLocalFieldDataToPython(grids_local_[i]);
@@ -1427,6 +1557,62 @@ DataStructureOutput DataStructureAmr::BindLocalDataToPython() const {
   return {DataStructureStatus::kDataStructureSuccess, ""};
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SnapshotArraysInDict
+// Description :  Replace every NumPy array in the nested dictionary with its read-only
+//                deep copy, and add up the bytes copied to num_bytes.
+//
+// Notes       :  1. Only values are replaced, keys of the dictionary stay the same, so it
+//                   is safe to iterate through it with PyDict_Next.
+//-------------------------------------------------------------------------------------------------------
+static bool SnapshotArraysInDict(PyObject* py_dict, long* num_bytes) {
+  PyObject *py_key, *py_value;
+  Py_ssize_t pos = 0;
+  while (PyDict_Next(py_dict, &pos, &py_key, &py_value)) {
+    if (PyDict_Check(py_value)) {
+      if (!SnapshotArraysInDict(py_value, num_bytes)) {
+        return false;
+      }
+      continue;
+    }
+    PyObject* py_copy = numpy_controller::CopyNumPyArray(py_value, true);
+    if (py_copy == nullptr) {
+      PyErr_Clear();
+      return false;
+    }
+    *num_bytes += numpy_controller::GetNumPyArrayNumBytes(py_copy);
+    PyDict_SetItem(py_dict, py_key, py_copy);
+    Py_DECREF(py_copy);
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Public Method  :  SnapshotLocalDataInPython
+//
+// Notes       :  1. Deep copy local field and particle data bound to Python, so that
+//                   Python no longer refers to the simulation buffers, and the
+//                   simulation can advance while inline functions are still running.
+//                2. Must be called after BindLocalDataToPython. The copies are owned by
+//                   Python, and they are freed when the bindings are cleaned up.
+//                3. num_bytes is the total bytes copied.
+//-------------------------------------------------------------------------------------------------------
+DataStructureOutput DataStructureAmr::SnapshotLocalDataInPython(long* num_bytes) const {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerHierarchy);
+
+  *num_bytes = 0;
+  if (!SnapshotArraysInDict(py_grid_data_, num_bytes)) {
+    return {DataStructureStatus::kDataStructureFailed,
+            "Unable to snapshot local field data."};
+  }
+  if (!SnapshotArraysInDict(py_particle_data_, num_bytes)) {
+    return {DataStructureStatus::kDataStructureFailed,
+            "Unable to snapshot local particle data."};
+  }
+  return {DataStructureStatus::kDataStructureSuccess, ""};
+}
+
 //-------------------------------------------------------------------------------------------------------
 // Class          :  DataStructureAmr
 // Private Method :  CleanUpFieldList
@@ -1514,14 +1700,14 @@ void DataStructureAmr::CleanUpGridsLocal() {
 //-------------------------------------------------------------------------------------------------------
 void DataStructureAmr::CleanUpFullHierarchyStorageForPython() {
   // C storage
-  delete[] grid_left_edge_;
-  delete[] grid_right_edge_;
-  delete[] grid_dimensions_;
-  delete[] grid_parent_id_;
-  delete[] grid_levels_;
-  delete[] proc_num_;
+  memory_tracker::DeleteArray(grid_left_edge_);
+  memory_tracker::DeleteArray(grid_right_edge_);
+  memory_tracker::DeleteArray(grid_dimensions_);
+  memory_tracker::DeleteArray(grid_parent_id_);
+  memory_tracker::DeleteArray(grid_levels_);
+  memory_tracker::DeleteArray(proc_num_);
   if (has_particle_) {
-    delete[] par_count_list_;
+    memory_tracker::DeleteArray(par_count_list_);
   }
   grid_left_edge_ = nullptr;
   grid_right_edge_ = nullptr;
@@ -1535,12 +1721,14 @@ void DataStructureAmr::CleanUpFullHierarchyStorageForPython() {
   has_particle_ = false;
 
   // Python bindings
+  if (py_hierarchy_ == nullptr) {
+    return;
+  }
 #ifndef USE_PYBIND11
   // Reset data in libyt module
   PyDict_Clear(py_hierarchy_);
 #else
-  pybind11::module_ libyt = pybind11::module_::import("libyt");
-  pybind11::dict py_dict = libyt.attr("hierarchy");
+  pybind11::dict py_dict = pybind11::reinterpret_borrow<pybind11::dict>(py_hierarchy_);
   py_dict.clear();
 #endif
 }
@@ -1553,22 +1741,52 @@ void DataStructureAmr::CleanUpFullHierarchyStorageForPython() {
 //                2. Counterpart for BindLocalDataToPython().
 //-------------------------------------------------------------------------------------------------------
 void DataStructureAmr::CleanUpLocalDataPythonBindings() const {
+  if (py_grid_data_ == nullptr) {
+    return;
+  }
 #ifndef USE_PYBIND11
   // Reset data in libyt module
   PyDict_Clear(py_grid_data_);
   PyDict_Clear(py_particle_data_);
 #else
-  pybind11::module_ libyt = pybind11::module_::import("libyt");
-
-  const char* keys_to_clear[] = {"grid_data", "particle_data"};
-  const int keys_len = 2;
-  for (int i = 0; i < keys_len; i++) {
-    pybind11::dict py_dict = libyt.attr(keys_to_clear[i]);
+  PyObject* dicts_to_clear[] = {py_grid_data_, py_particle_data_};
+  const int dicts_len = 2;
+  for (int i = 0; i < dicts_len; i++) {
+    pybind11::dict py_dict =
+        pybind11::reinterpret_borrow<pybind11::dict>(dicts_to_clear[i]);
     py_dict.clear();
   }
 #endif
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Private Method :  CleanUpNameLookupTables
+//
+// Notes       :  1. Clear name lookup tables and release the Python strings they hold.
+//-------------------------------------------------------------------------------------------------------
+void DataStructureAmr::CleanUpNameLookupTables() {
+  for (PyObject* py_name : py_field_name_list_) {
+    Py_XDECREF(py_name);
+  }
+  for (PyObject* py_name : py_particle_type_list_) {
+    Py_XDECREF(py_name);
+  }
+  for (const std::vector<PyObject*>& py_attr_name_list : py_particle_attr_name_list_) {
+    for (PyObject* py_name : py_attr_name_list) {
+      Py_XDECREF(py_name);
+    }
+  }
+
+  field_index_map_.clear();
+  particle_index_map_.clear();
+  particle_attr_index_map_.clear();
+  py_field_name_list_.clear();
+  py_particle_type_list_.clear();
+  py_particle_attr_name_list_.clear();
+  has_name_lookup_tables_ = false;
+}
+
 //-------------------------------------------------------------------------------------------------------
 // Class          :  DataStructureAmr
 // Public Method  :  CleanUp
@@ -1577,6 +1795,7 @@ void DataStructureAmr::CleanUpLocalDataPythonBindings() const {
 //                2. TODO: should I separate Python bindings into a new class?
 //-------------------------------------------------------------------------------------------------------
 void DataStructureAmr::CleanUp() {
+  CleanUpNameLookupTables();
   CleanUpFieldList();
   CleanUpParticleList();
   CleanUpGridsLocal();
@@ -1592,8 +1811,15 @@ void DataStructureAmr::CleanUp() {
 //
 // Notes       :  1. Get the field index in the field_list_ based on field_name.
 //                2. Return -1 if the field_name is not found.
+//                3. Use the lookup table if it is built at BindInfoToPython, otherwise
+//                   search through the list.
 //-------------------------------------------------------------------------------------------------------
 int DataStructureAmr::GetFieldIndex(const char* field_name) const {
+  if (has_name_lookup_tables_) {
+    auto it = field_index_map_.find(field_name);
+    return it != field_index_map_.end() ? it->second : -1;
+  }
+
   int field_id = -1;
   for (int v = 0; v < num_fields_; v++) {
     if (strcmp(field_name, field_list_[v].field_name) == 0) {
@@ -1610,8 +1836,15 @@ int DataStructureAmr::GetFieldIndex(const char* field_name) const {
 //
 // Notes       :  1. Get the particle index in the particle_list_ based on particle_type.
 //                2. Return -1 if the particle_type is not found.
+//                3. Use the lookup table if it is built at BindInfoToPython, otherwise
+//                   search through the list.
 //-------------------------------------------------------------------------------------------------------
 int DataStructureAmr::GetParticleIndex(const char* particle_type) const {
+  if (has_name_lookup_tables_) {
+    auto it = particle_index_map_.find(particle_type);
+    return it != particle_index_map_.end() ? it->second : -1;
+  }
+
   int ptype_index = -1;
   for (int v = 0; v < num_par_types_; v++) {
     if (strcmp(particle_type, particle_list_[v].par_type) == 0) {
@@ -1630,6 +1863,8 @@ int DataStructureAmr::GetParticleIndex(const char* particle_type) const {
 // particle index and
 //                   attribute name.
 //                2. Return -1 if the particle_type or attribute name is not found.
+//                3. Use the lookup table if it is built at BindInfoToPython, otherwise
+//                   search through the list.
 //-------------------------------------------------------------------------------------------------------
 int DataStructureAmr::GetParticleAttributeIndex(int particle_type_index,
                                                 const char* attr_name) const {
@@ -1638,6 +1873,13 @@ int DataStructureAmr::GetParticleAttributeIndex(int particle_type_index,
     return pattr_index;
   }
 
+  if (has_name_lookup_tables_) {
+    const std::unordered_map<std::string, int>& attr_index_map =
+        particle_attr_index_map_[particle_type_index];
+    auto it = attr_index_map.find(attr_name);
+    return it != attr_index_map.end() ? it->second : -1;
+  }
+
   for (int a = 0; a < particle_list_[particle_type_index].num_attr; a++) {
     if (strcmp(attr_name, particle_list_[particle_type_index].attr_list[a].attr_name) ==
         0) {
@@ -1667,6 +1909,9 @@ template<typename DataClass>
 DataStructureOutput DataStructureAmr::GenerateLocalFieldData(
     const std::vector<long>& gid_list, const char* field_name,
     std::vector<DataClass>& storage) const {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerDerivedFunc);
+  perf_counter::ScopedTimer perf_timer("derived_func.time");
+
   // Get field id and derived function
   int field_id = GetFieldIndex(field_name);
   if (field_id < 0) {
@@ -1683,6 +1928,7 @@ DataStructureOutput DataStructureAmr::GenerateLocalFieldData(
     return {DataStructureStatus::kDataStructureNotImplemented, error};
   }
 
+  long num_calls = 0, num_cells = 0;
   for (const long& kGid : gid_list) {
     DataClass amr_data{};
 
@@ -1734,7 +1980,8 @@ DataStructureOutput DataStructureAmr::GenerateLocalFieldData(
     for (int d = 0; d < dimensionality_; d++) {
       data_len *= amr_data.data_dim[d];
     }
-    amr_data.data_ptr = dtype_utilities::AllocateMemory(amr_data.data_dtype, data_len);
+    amr_data.data_ptr = dtype_utilities::AllocateMemory(
+        amr_data.data_dtype, data_len, MemoryCategory::kMemoryDataHub);
     if (amr_data.data_ptr == nullptr) {
       std::string error =
           std::string("Failed to allocate memory for (field_name, gid) = (") +
@@ -1752,11 +1999,16 @@ DataStructureOutput DataStructureAmr::GenerateLocalFieldData(
     int list_len = 1;
     long list_gid[1] = {amr_data.id};
     (*derived_func)(list_len, list_gid, field_name, data_array);
+    num_calls++;
+    num_cells += data_len;
 
     // Put in storage
     storage.emplace_back(amr_data);
   }
 
+  perf_counter::Add("derived_func.calls", static_cast<double>(num_calls));
+  perf_counter::Add("derived_func.cells", static_cast<double>(num_cells));
+
   return {DataStructureStatus::kDataStructureSuccess, ""};
 }
 
@@ -1783,6 +2035,9 @@ template DataStructureOutput DataStructureAmr::GenerateLocalFieldData<AmrDataArr
 DataStructureOutput DataStructureAmr::GenerateLocalParticleData(
     const std::vector<long>& gid_list, const char* ptype, const char* attr,
     std::vector<AmrDataArray1D>& storage) const {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerDerivedFunc);
+  perf_counter::ScopedTimer perf_timer("par_attr_func.time");
+
   // Get particle id
   int ptype_index = GetParticleIndex(ptype);
   int pattr_index = GetParticleAttributeIndex(ptype_index, attr);
@@ -1792,6 +2047,7 @@ DataStructureOutput DataStructureAmr::GenerateLocalParticleData(
     return {DataStructureStatus::kDataStructureFailed, error};
   }
 
+  long num_calls = 0, num_particles = 0;
   for (const long& kGid : gid_list) {
     AmrDataArray1D amr_1d_data{};
 
@@ -1844,7 +2100,9 @@ DataStructureOutput DataStructureAmr::GenerateLocalParticleData(
 
     // Generate buffer
     amr_1d_data.data_ptr =
-        dtype_utilities::AllocateMemory(amr_1d_data.data_dtype, amr_1d_data.data_dim[0]);
+        dtype_utilities::AllocateMemory(amr_1d_data.data_dtype,
+                                        amr_1d_data.data_dim[0],
+                                        MemoryCategory::kMemoryDataHub);
     if (amr_1d_data.data_ptr == nullptr) {
       std::string error =
           std::string("Failed to allocate memory for (particle type, attribute, gid, "
@@ -1862,11 +2120,16 @@ DataStructureOutput DataStructureAmr::GenerateLocalParticleData(
     data_array[0].data_length = amr_1d_data.data_dim[0];
     data_array[0].data_ptr = amr_1d_data.data_ptr;
     (*get_par_attr)(list_len, list_gid, ptype, attr, data_array);
+    num_calls++;
+    num_particles += amr_1d_data.data_dim[0];
 
     // Put in storage
     storage.emplace_back(amr_1d_data);
   }
 
+  perf_counter::Add("par_attr_func.calls", static_cast<double>(num_calls));
+  perf_counter::Add("par_attr_func.particles", static_cast<double>(num_particles));
+
   return {DataStructureStatus::kDataStructureSuccess, ""};
 }
 
@@ -2056,13 +2319,7 @@ DataStructureOutput DataStructureAmr::GetPythonBoundFullHierarchyGridParticleCou
     return {DataStructureStatus::kDataStructureFailed, error};
   }
 
-  int label = -1;
-  for (int s = 0; s < num_par_types_; s++) {
-    if (strcmp(particle_list_[s].par_type, ptype) == 0) {
-      label = s;
-      break;
-    }
-  }
+  int label = GetParticleIndex(ptype);
   if (label == -1) {
     std::string error =
         "Cannot find (particle type) = " + std::string(ptype) + " in particle_list.\n";
@@ -2074,36 +2331,149 @@ DataStructureOutput DataStructureAmr::GetPythonBoundFullHierarchyGridParticleCou
   return {DataStructureStatus::kDataStructureSuccess, std::string()};
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Public Method  :  GetPythonBoundFullHierarchyGridParticleCount
+//
+// Notes       :  1. Read the full hierarchy grid particle count of a list of grids for a
+//                   ptype index loaded in Python, so that the ptype is only looked up
+//                   once by the caller (ex: GetParticleIndex).
+//                2. par_count_list has the same length as gid_list. If it fails, the
+//                   count of grids that are not read yet is 0.
+//                3. Each grid is read through
+//                   GetPythonBoundFullHierarchyGridParticleCountByIndex(), which does
+//                   the range checks.
+//                4. Counterpart of BindAllHierarchyToPython().
+//-------------------------------------------------------------------------------------------------------
+DataStructureOutput DataStructureAmr::GetPythonBoundFullHierarchyGridParticleCount(
+    const std::vector<long>& gid_list, int ptype_index,
+    std::vector<long>& par_count_list) const {
+  par_count_list.assign(gid_list.size(), 0);
+
+  for (std::size_t i = 0; i < gid_list.size(); i++) {
+    DataStructureOutput status = GetPythonBoundFullHierarchyGridParticleCountByIndex(
+        gid_list[i], ptype_index, &par_count_list[i]);
+    if (status.status != DataStructureStatus::kDataStructureSuccess) {
+      return status;
+    }
+  }
+
+  return {DataStructureStatus::kDataStructureSuccess, std::string()};
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Public Method  :  GetPythonBoundFullHierarchyGridParticleCountByIndex
+//
+// Notes       :  1. Read the full hierarchy grid particle count of ptype index in
+//                   particle_list_ loaded in Python.
+//                2. Counterpart of BindAllHierarchyToPython().
+//-------------------------------------------------------------------------------------------------------
+DataStructureOutput DataStructureAmr::GetPythonBoundFullHierarchyGridParticleCountByIndex(
+    long gid, int ptype_index, long* par_count) const {
+  if (!has_particle_) {
+    std::string error = "Doesn't contain particle data.\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
+  if (par_count_list_ == nullptr) {
+    std::string error = "Full hierarchy is not initialized yet.\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
+  if ((gid - index_offset_) < 0 || (gid - index_offset_) >= num_grids_) {
+    std::string error = "(grid id) = " + std::to_string(gid) + " is out of range.\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
+  if (ptype_index < 0 || ptype_index >= num_par_types_) {
+    std::string error =
+        "(particle type index) = " + std::to_string(ptype_index) + " is out of range.\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
+  *par_count = par_count_list_[(gid - index_offset_) * num_par_types_ + ptype_index];
+
+  return {DataStructureStatus::kDataStructureSuccess, std::string()};
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Helper Function :  NewNameReference
+//
+// Notes       :  1. Return a new reference of the Python string of a name. Use the cached
+//                   interned string if the lookup table is built, otherwise create one.
+//-------------------------------------------------------------------------------------------------------
+static PyObject* NewNameReference(const std::vector<PyObject*>& py_name_list, int index,
+                                  const char* name) {
+  if (index >= 0 && index < static_cast<int>(py_name_list.size())) {
+    Py_INCREF(py_name_list[index]);
+    return py_name_list[index];
+  }
+  return PyUnicode_FromString(name);
+}
+
 //-------------------------------------------------------------------------------------------------------
 // Class          :  DataStructureAmr
 // Public Method  :  GetPythonBoundLocalFieldData
 //
 // Notes       :  1. Read the local field data bind to Python libyt.grid_data[gid][fname].
-//                2. Counterpart of BindLocalFieldDataToPython().
-//                3. If the data is 2D/1D, the extra dimensions will be filled with 1s.
+//                2. Look up field index and call GetPythonBoundLocalFieldDataByIndex.
 //-------------------------------------------------------------------------------------------------------
 DataStructureOutput DataStructureAmr::GetPythonBoundLocalFieldData(
     long gid, const char* field_name, yt_data* field_data) const {
-  // Get dictionary libyt.grid_data[gid][fname]
-  PyObject* py_grid_id = PyLong_FromLong(gid);
-  PyObject* py_field = PyUnicode_FromString(field_name);
-
-  if (PyDict_Contains(py_grid_data_, py_grid_id) != 1 ||
-      PyDict_Contains(PyDict_GetItem(py_grid_data_, py_grid_id), py_field) != 1) {
+  int field_index = GetFieldIndex(field_name);
+  if (field_index < 0) {
     std::string error =
         "Cannot find field data (grid id, field) = " + std::to_string(gid) + ", " +
         field_name + " on MPI rank " + std::to_string(mpi_rank_) + ".\n";
-    Py_DECREF(py_grid_id);
-    Py_DECREF(py_field);
     return {DataStructureStatus::kDataStructureFailed, error};
   }
 
+  return GetPythonBoundLocalFieldDataByIndex(gid, field_index, field_data);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Public Method  :  GetPythonBoundLocalFieldDataByIndex
+//
+// Notes       :  1. Read the local field data bind to Python libyt.grid_data[gid][fname],
+//                   where fname is the field_index-th field in field_list_.
+//                2. Counterpart of BindLocalFieldDataToPython().
+//                3. If the data is 2D/1D, the extra dimensions will be filled with 1s.
+//-------------------------------------------------------------------------------------------------------
+DataStructureOutput DataStructureAmr::GetPythonBoundLocalFieldDataByIndex(
+    long gid, int field_index, yt_data* field_data) const {
+  if (field_index < 0 || field_index >= num_fields_) {
+    std::string error =
+        "(field index) = " + std::to_string(field_index) + " is out of range.\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
+  // Processes without Python read local grids directly
+  if (py_grid_data_ == nullptr) {
+    return GetGridsLocalFieldDataByIndex(gid, field_index, field_data);
+  }
+
+  // Get dictionary libyt.grid_data[gid][fname]
+  PyObject* py_grid_id = PyLong_FromLong(gid);
+  PyObject* py_field = NewNameReference(
+      py_field_name_list_, field_index, field_list_[field_index].field_name);
+  PyObject* py_field_labels = PyDict_GetItem(py_grid_data_, py_grid_id);
+  PyObject* py_data =
+      py_field_labels != nullptr ? PyDict_GetItem(py_field_labels, py_field) : nullptr;
   Py_DECREF(py_grid_id);
   Py_DECREF(py_field);
 
+  if (py_data == nullptr) {
+    std::string error = "Cannot find field data (grid id, field) = " +
+                        std::to_string(gid) + ", " +
+                        field_list_[field_index].field_name + " on MPI rank " +
+                        std::to_string(mpi_rank_) + ".\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
   // Get NumPy array dimensions/data pointer/dtype
-  NumPyArray py_data_info = numpy_controller::GetNumPyArrayInfo(
-      PyDict_GetItem(PyDict_GetItem(py_grid_data_, py_grid_id), py_field));
+  NumPyArray py_data_info = numpy_controller::GetNumPyArrayInfo(py_data);
   for (int d = 0; d < dimensionality_; d++) {
     (*field_data).data_dimensions[d] = (int)py_data_info.data_dims[d];
   }
@@ -2122,24 +2492,14 @@ DataStructureOutput DataStructureAmr::GetPythonBoundLocalFieldData(
 //
 // Notes       :  1. Read the local field data bind to Python
 // libyt.particle_data[gid][ptype][attr].
-//                2. Counterpart of BindLocalParticleDataToPython().
+//                2. Look up particle type and attribute index and call
+//                   GetPythonBoundLocalParticleDataByIndex.
 //-------------------------------------------------------------------------------------------------------
 DataStructureOutput DataStructureAmr::GetPythonBoundLocalParticleData(
     long gid, const char* ptype, const char* attr, yt_data* par_data) const {
-  // Get dictionary libyt.particle_data[gid][ptype]
-  PyObject* py_grid_id = PyLong_FromLong(gid);
-  PyObject* py_ptype = PyUnicode_FromString(ptype);
-  PyObject* py_attr = PyUnicode_FromString(attr);
-
-  if (PyDict_Contains(py_particle_data_, py_grid_id) != 1 ||
-      PyDict_Contains(PyDict_GetItem(py_particle_data_, py_grid_id), py_ptype) != 1 ||
-      PyDict_Contains(
-          PyDict_GetItem(PyDict_GetItem(py_particle_data_, py_grid_id), py_ptype),
-          py_attr) != 1) {
-    Py_DECREF(py_grid_id);
-    Py_DECREF(py_ptype);
-    Py_DECREF(py_attr);
-
+  int ptype_index = GetParticleIndex(ptype);
+  int attr_index = GetParticleAttributeIndex(ptype_index, attr);
+  if (ptype_index < 0 || attr_index < 0) {
     std::string error =
         "Cannot find particle data (grid id, particle type, attribute) = " +
         std::to_string(gid) + ", " + ptype + ", " + attr + " on MPI rank " +
@@ -2147,13 +2507,63 @@ DataStructureOutput DataStructureAmr::GetPythonBoundLocalParticleData(
     return {DataStructureStatus::kDataStructureFailed, error};
   }
 
+  return GetPythonBoundLocalParticleDataByIndex(gid, ptype_index, attr_index, par_data);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Public Method  :  GetPythonBoundLocalParticleDataByIndex
+//
+// Notes       :  1. Read the local particle data bind to Python
+//                   libyt.particle_data[gid][ptype][attr], where ptype and attr are the
+//                   ptype_index-th particle type and its attr_index-th attribute in
+//                   particle_list_.
+//                2. Counterpart of BindLocalParticleDataToPython().
+//-------------------------------------------------------------------------------------------------------
+DataStructureOutput DataStructureAmr::GetPythonBoundLocalParticleDataByIndex(
+    long gid, int ptype_index, int attr_index, yt_data* par_data) const {
+  if (ptype_index < 0 || ptype_index >= num_par_types_ || attr_index < 0 ||
+      attr_index >= particle_list_[ptype_index].num_attr) {
+    std::string error = "(particle type index, attribute index) = " +
+                        std::to_string(ptype_index) + ", " + std::to_string(attr_index) +
+                        " is out of range.\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
+  // Processes without Python read local grids directly
+  if (py_particle_data_ == nullptr) {
+    return GetGridsLocalParticleDataByIndex(gid, ptype_index, attr_index, par_data);
+  }
+
+  const char* ptype = particle_list_[ptype_index].par_type;
+  const char* attr = particle_list_[ptype_index].attr_list[attr_index].attr_name;
+
+  // Get dictionary libyt.particle_data[gid][ptype][attr]
+  PyObject* py_grid_id = PyLong_FromLong(gid);
+  PyObject* py_ptype = NewNameReference(py_particle_type_list_, ptype_index, ptype);
+  PyObject* py_attr = has_name_lookup_tables_
+                          ? NewNameReference(py_particle_attr_name_list_[ptype_index],
+                                             attr_index, attr)
+                          : PyUnicode_FromString(attr);
+  PyObject* py_ptype_labels = PyDict_GetItem(py_particle_data_, py_grid_id);
+  PyObject* py_attributes =
+      py_ptype_labels != nullptr ? PyDict_GetItem(py_ptype_labels, py_ptype) : nullptr;
+  PyObject* py_data =
+      py_attributes != nullptr ? PyDict_GetItem(py_attributes, py_attr) : nullptr;
   Py_DECREF(py_grid_id);
   Py_DECREF(py_ptype);
   Py_DECREF(py_attr);
 
+  if (py_data == nullptr) {
+    std::string error =
+        "Cannot find particle data (grid id, particle type, attribute) = " +
+        std::to_string(gid) + ", " + ptype + ", " + attr + " on MPI rank " +
+        std::to_string(mpi_rank_) + ".\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
   // Get NumPy array dimensions/data pointer/dtype
-  NumPyArray py_data_info = numpy_controller::GetNumPyArrayInfo(PyDict_GetItem(
-      PyDict_GetItem(PyDict_GetItem(py_particle_data_, py_grid_id), py_ptype), py_attr));
+  NumPyArray py_data_info = numpy_controller::GetNumPyArrayInfo(py_data);
   (*par_data).data_dimensions[0] = (int)py_data_info.data_dims[0];
   (*par_data).data_dimensions[1] = 0;
   (*par_data).data_dimensions[2] = 0;
@@ -2163,6 +2573,93 @@ DataStructureOutput DataStructureAmr::GetPythonBoundLocalParticleData(
   return {DataStructureStatus::kDataStructureSuccess, std::string()};
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Private Method :  FindGridLocal
+//
+// Notes       :  1. Find the local grid with grid id gid in grids_local_, return nullptr
+//                   if it is not found.
+//-------------------------------------------------------------------------------------------------------
+const yt_grid* DataStructureAmr::FindGridLocal(long gid) const {
+  for (int i = 0; i < num_grids_local_; i++) {
+    if (grids_local_[i].id == gid) {
+      return &grids_local_[i];
+    }
+  }
+  return nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Private Method :  GetGridsLocalFieldDataByIndex
+//
+// Notes       :  1. Read the local field data in grids_local_, for processes that do not
+//                   bind data to Python.
+//                2. Data type and dimensions are resolved the same way as
+//                   BindLocalFieldDataToPython().
+//-------------------------------------------------------------------------------------------------------
+DataStructureOutput DataStructureAmr::GetGridsLocalFieldDataByIndex(
+    long gid, int field_index, yt_data* field_data) const {
+  const yt_grid* grid = FindGridLocal(gid);
+  if (grid == nullptr || grid->field_data[field_index].data_ptr == nullptr) {
+    std::string error = "Cannot find field data (grid id, field) = " +
+                        std::to_string(gid) + ", " +
+                        field_list_[field_index].field_name + " on MPI rank " +
+                        std::to_string(mpi_rank_) + ".\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
+  const yt_field& field = field_list_[field_index];
+  *field_data = grid->field_data[field_index];
+  if (dtype_utilities::YtDtype2NumPyDtype(field_data->data_dtype) < 0) {
+    field_data->data_dtype = field.field_dtype;
+  }
+  if (strcmp(field.field_type, "cell-centered") == 0) {
+    for (int d = 0; d < dimensionality_; d++) {
+      field_data->data_dimensions[d] =
+          field.contiguous_in_x ? grid->grid_dimensions[(dimensionality_ - 1) - d]
+                                : grid->grid_dimensions[d];
+    }
+    for (int d = 0; d < 2 * dimensionality_; d++) {
+      field_data->data_dimensions[d / 2] += field.field_ghost_cell[d];
+    }
+  }
+  for (int d = dimensionality_; d < 3; d++) {
+    field_data->data_dimensions[d] = 1;
+  }
+
+  return {DataStructureStatus::kDataStructureSuccess, std::string()};
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  DataStructureAmr
+// Private Method :  GetGridsLocalParticleDataByIndex
+//
+// Notes       :  1. Read the local particle data in grids_local_, for processes that do
+//                   not bind data to Python.
+//-------------------------------------------------------------------------------------------------------
+DataStructureOutput DataStructureAmr::GetGridsLocalParticleDataByIndex(
+    long gid, int ptype_index, int attr_index, yt_data* par_data) const {
+  const yt_grid* grid = FindGridLocal(gid);
+  if (grid == nullptr || grid->par_count_list[ptype_index] <= 0 ||
+      grid->particle_data[ptype_index][attr_index].data_ptr == nullptr) {
+    std::string error =
+        "Cannot find particle data (grid id, particle type, attribute) = " +
+        std::to_string(gid) + ", " + particle_list_[ptype_index].par_type + ", " +
+        particle_list_[ptype_index].attr_list[attr_index].attr_name + " on MPI rank " +
+        std::to_string(mpi_rank_) + ".\n";
+    return {DataStructureStatus::kDataStructureFailed, error};
+  }
+
+  (*par_data).data_dimensions[0] = (int)grid->par_count_list[ptype_index];
+  (*par_data).data_dimensions[1] = 0;
+  (*par_data).data_dimensions[2] = 0;
+  (*par_data).data_ptr = grid->particle_data[ptype_index][attr_index].data_ptr;
+  (*par_data).data_dtype = particle_list_[ptype_index].attr_list[attr_index].attr_dtype;
+
+  return {DataStructureStatus::kDataStructureSuccess, std::string()};
+}
+
 //-------------------------------------------------------------------------------------------------------
 // Class          :  DataStructureAmr
 // Private Method :  CheckHierarchyIsValid
@@ -0,0 +1,179 @@
+#include "deferred_binding.h"
+
+#include <set>
+#include <string>
+
+#include "async_analysis.h"
+#include "libyt.h"
+#include "libyt_process_control.h"
+#include "logging.h"
+#include "perf_counter.h"
+#include "timer.h"
+#include "trigger.h"
+
+static std::set<std::string> current_calls;
+static std::set<std::string> previous_calls;
+static bool has_previous_step = false;
+static bool is_deferred = false;
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : deferred_binding
+// Function name : RecordCall
+//
+// Notes         :  1. Called by yt_run_* with every function, including the ones that
+//                     end up skipped, so that they are checked again in the next step.
+//-------------------------------------------------------------------------------------------------------
+void deferred_binding::RecordCall(const char* function_name) {
+  current_calls.insert(function_name);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : deferred_binding
+// Function name : WillAnyFunctionRun
+//
+// Notes         :  1. Must be called after trigger::Evaluate.
+//                  2. Return true if there is no previous step to predict from.
+//                  3. Every process gets the same result, since functions are called,
+//                     set to idle, and triggered the same way on every process.
+//-------------------------------------------------------------------------------------------------------
+bool deferred_binding::WillAnyFunctionRun() {
+  if (async_analysis::IsEnabled() && async_analysis::IsStepSkipped()) {
+    return false;
+  }
+  if (!has_previous_step) {
+    return true;
+  }
+  for (const std::string& function_name : previous_calls) {
+#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
+    if (LibytProcessControl::Get().function_info_list_.IsSetToIdle(function_name)) {
+      continue;
+    }
+#endif
+    if (trigger::IsFired(function_name.c_str())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : deferred_binding
+// Function name : Bind
+//
+// Notes         :  1. Collective operation. Bind the full hierarchy and local data to
+//                     Python, and snapshot local data if inline functions run
+//                     asynchronously in this step.
+//                  2. Local grids are not cleaned up here, callers free them after
+//                     binding.
+//-------------------------------------------------------------------------------------------------------
+int deferred_binding::Bind() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  int root_rank = 0;
+  DataStructureOutput status =
+      LibytProcessControl::Get().data_structure_amr_.BindAllHierarchyToPython(root_rank);
+  if (status.status == DataStructureStatus::kDataStructureSuccess) {
+    logging::LogDebug("Loading full hierarchy to libyt ... done!\n");
+  } else {
+    logging::LogError(status.error.c_str());
+    YT_ABORT("Loading full hierarchy to libyt ... failed!\n");
+  }
+
+  {
+    perf_counter::ScopedTimer perf_bind_timer("commit.bind_time");
+    status = LibytProcessControl::Get().data_structure_amr_.BindLocalDataToPython();
+  }
+  if (status.status == DataStructureStatus::kDataStructureSuccess) {
+    logging::LogDebug("Loading local data to libyt ... done!\n");
+  } else {
+    logging::LogError(status.error.c_str());
+    YT_ABORT("Loading local data to libyt ... failed!\n");
+  }
+
+  // Snapshot local data, so that inline functions run asynchronously do not see the
+  // simulation advancing
+  if (async_analysis::IsEnabled() && !async_analysis::IsStepSkipped()) {
+    perf_counter::ScopedTimer perf_snapshot_timer("commit.snapshot_time");
+    long snapshot_bytes = 0;
+    status = LibytProcessControl::Get().data_structure_amr_.SnapshotLocalDataInPython(
+        &snapshot_bytes);
+    if (status.status != DataStructureStatus::kDataStructureSuccess) {
+      logging::LogError(status.error.c_str());
+      YT_ABORT("Snapshot local data ... failed!\n");
+    }
+    perf_counter::Add("commit.snapshot_bytes", static_cast<double>(snapshot_bytes));
+    logging::LogDebug("Snapshot local data (%ld bytes) ... done!\n", snapshot_bytes);
+  }
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : deferred_binding
+// Function name : Defer
+//
+// Notes         :  1. Called in yt_commit instead of Bind, local grids are kept until
+//                     EnsureBound or yt_free.
+//-------------------------------------------------------------------------------------------------------
+void deferred_binding::Defer() { is_deferred = true; }
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : deferred_binding
+// Function name : IsDeferred
+//-------------------------------------------------------------------------------------------------------
+bool deferred_binding::IsDeferred() { return is_deferred; }
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : deferred_binding
+// Function name : EnsureBound
+//
+// Notes         :  1. Collective operation if binding is deferred, otherwise it does
+//                     nothing.
+//                  2. Local grids are cleaned up after binding, the same as yt_commit.
+//-------------------------------------------------------------------------------------------------------
+int deferred_binding::EnsureBound() {
+  if (!is_deferred) {
+    return YT_SUCCESS;
+  }
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  logging::LogInfo("Loading deferred full hierarchy and local data to libyt ...\n");
+  is_deferred = false;
+  if (Bind() != YT_SUCCESS) {
+    YT_ABORT("Loading deferred full hierarchy and local data ... failed!\n");
+  }
+  LibytProcessControl::Get().data_structure_amr_.CleanUpGridsLocal();
+  logging::LogInfo("Loading deferred full hierarchy and local data ... done.\n");
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : deferred_binding
+// Function name : EndStep
+//
+// Notes         :  1. Called in yt_free. Functions called in this step predict the next
+//                     step, and local grids are freed there anyway if binding is still
+//                     deferred.
+//-------------------------------------------------------------------------------------------------------
+void deferred_binding::EndStep() {
+  if (is_deferred) {
+    logging::LogDebug("No inline function runs in step %ld, binding is skipped.\n",
+                      LibytProcessControl::Get().param_libyt_.counter);
+  }
+  previous_calls.swap(current_calls);
+  current_calls.clear();
+  has_previous_step = true;
+  is_deferred = false;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : deferred_binding
+// Function name : Finalize
+//-------------------------------------------------------------------------------------------------------
+void deferred_binding::Finalize() {
+  current_calls.clear();
+  previous_calls.clear();
+  has_previous_step = false;
+  is_deferred = false;
+}
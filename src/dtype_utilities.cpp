@@ -190,75 +190,79 @@ int GetYtDtypeSize(yt_dtype data_type) {
  * \details
  * 1. The memory is allocated based on yt_dtype and length and initialized to zero.
  * 2. If the data type is unknown, it will return nullptr.
+ * 3. The memory is tracked under category, and should be freed by memory_tracker::Free.
  *
  * @param data_type[in] yt data type
  * @param length[in] length of the array
+ * @param category[in] memory category to track the allocation under
  * @return The pointer to the allocated memory, or nullptr if failed.
  ****************************************************************************************/
-void* AllocateMemory(yt_dtype data_type, unsigned long length) {
+void* AllocateMemory(yt_dtype data_type, unsigned long length, MemoryCategory category) {
   switch (data_type) {
     case YT_FLOAT: {
-      void* data_ptr = malloc(length * sizeof(float));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(float));
       memset(data_ptr, 0, length * sizeof(float));
       return data_ptr;
     }
     case YT_DOUBLE: {
-      void* data_ptr = malloc(length * sizeof(double));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(double));
       memset(data_ptr, 0, length * sizeof(double));
       return data_ptr;
     }
     case YT_LONGDOUBLE: {
-      void* data_ptr = malloc(length * sizeof(long double));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(long double));
       memset(data_ptr, 0, length * sizeof(long double));
       return data_ptr;
     }
     case YT_CHAR: {
-      void* data_ptr = malloc(length * sizeof(char));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(char));
       memset(data_ptr, 0, length * sizeof(char));
       return data_ptr;
     }
     case YT_UCHAR: {
-      void* data_ptr = malloc(length * sizeof(unsigned char));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(unsigned char));
       memset(data_ptr, 0, length * sizeof(unsigned char));
       return data_ptr;
     }
     case YT_SHORT: {
-      void* data_ptr = malloc(length * sizeof(short));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(short));
       memset(data_ptr, 0, length * sizeof(short));
       return data_ptr;
     }
     case YT_USHORT: {
-      void* data_ptr = malloc(length * sizeof(unsigned short));
+      void* data_ptr =
+          memory_tracker::Allocate(category, length * sizeof(unsigned short));
       memset(data_ptr, 0, length * sizeof(unsigned short));
       return data_ptr;
     }
     case YT_INT: {
-      void* data_ptr = malloc(length * sizeof(int));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(int));
       memset(data_ptr, 0, length * sizeof(int));
       return data_ptr;
     }
     case YT_UINT: {
-      void* data_ptr = malloc(length * sizeof(unsigned int));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(unsigned int));
       memset(data_ptr, 0, length * sizeof(unsigned int));
       return data_ptr;
     }
     case YT_LONG: {
-      void* data_ptr = malloc(length * sizeof(long));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(long));
       memset(data_ptr, 0, length * sizeof(long));
       return data_ptr;
     }
     case YT_ULONG: {
-      void* data_ptr = malloc(length * sizeof(unsigned long));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(unsigned long));
       memset(data_ptr, 0, length * sizeof(unsigned long));
       return data_ptr;
     }
     case YT_LONGLONG: {
-      void* data_ptr = malloc(length * sizeof(long long));
+      void* data_ptr = memory_tracker::Allocate(category, length * sizeof(long long));
       memset(data_ptr, 0, length * sizeof(long long));
       return data_ptr;
     }
     case YT_ULONGLONG: {
-      void* data_ptr = malloc(length * sizeof(unsigned long long));
+      void* data_ptr =
+          memory_tracker::Allocate(category, length * sizeof(unsigned long long));
       memset(data_ptr, 0, length * sizeof(unsigned long long));
       return data_ptr;
     }
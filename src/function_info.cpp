@@ -6,6 +6,8 @@
 #include <Python.h>
 #endif
 
+#include "async_analysis.h"
+#include "deferred_binding.h"
 #include "function_info.h"
 #include "libyt_process_control.h"
 #include "logging.h"
@@ -38,7 +40,9 @@ FunctionInfo::FunctionInfo(const char* function_name, RunStatus run)
       run_(run),
       status_(kNotExecuteYet),
       all_status_(kNotExecuteYet),
-      all_error_msg_() {
+      all_error_msg_(),
+      has_load_imbalance_(false),
+      load_imbalance_() {
   SET_TIMER(__PRETTY_FUNCTION__);
   mpi_rank_ = LibytProcessControl::Get().mpi_rank_;
   mpi_root_ = LibytProcessControl::Get().mpi_root_;
@@ -64,7 +68,9 @@ FunctionInfo::FunctionInfo(const FunctionInfo& other)
       run_(other.run_),
       status_(other.status_),
       all_status_(other.all_status_),
-      all_error_msg_(other.all_error_msg_) {
+      all_error_msg_(other.all_error_msg_),
+      has_load_imbalance_(other.has_load_imbalance_),
+      load_imbalance_(other.load_imbalance_) {
   SET_TIMER(__PRETTY_FUNCTION__);
 }
 
@@ -171,7 +177,7 @@ FunctionInfo::ExecuteStatus FunctionInfo::GetAllStatus() {
   // Sync status_ to other ranks
   int total_status = 0;
   int my_status = (status_ == kSuccess) ? 1 : 0;
-  MPI_Allreduce(&my_status, &total_status, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Allreduce(&my_status, &total_status, 1, MPI_INT, MPI_SUM, CommMpi::GetComm());
   all_status_ = (total_status == mpi_size_) ? kSuccess : kFailed;
 #else
   all_status_ = status_;
@@ -231,7 +237,7 @@ std::vector<std::string>& FunctionInfo::GetAllErrorMsg() {
   // Gather all error messages from all ranks
   int error_len = (int)strlen(err_msg);
   int* all_error_len = new int[mpi_size_];
-  MPI_Allgather(&error_len, 1, MPI_INT, all_error_len, 1, MPI_INT, MPI_COMM_WORLD);
+  MPI_Allgather(&error_len, 1, MPI_INT, all_error_len, 1, MPI_INT, CommMpi::GetComm());
 
   long sum_output_len = 0;
   int* displace = new int[mpi_size_];
@@ -250,7 +256,7 @@ std::vector<std::string>& FunctionInfo::GetAllErrorMsg() {
                  all_error_len,
                  displace,
                  MPI_CHAR,
-                 MPI_COMM_WORLD);
+                 CommMpi::GetComm());
 
   for (int r = 0; r < mpi_size_; r++) {
     all_error_msg_.emplace_back(
@@ -331,6 +337,7 @@ void FunctionInfo::ClearAllErrorMsg() {
 //                3. SetAllStatus() should come after SetStatus(), because SetStatus()
 //                will set all_status_,
 //                   which is bad.
+//                4. Clear load imbalance recorded in the previous call.
 //
 // Arguments   :  None
 //-------------------------------------------------------------------------------------------------------
@@ -341,6 +348,7 @@ void FunctionInfoList::ResetEveryFunctionStatus() {
     func.SetStatus(FunctionInfo::kNotExecuteYet);
     func.SetAllStatus(FunctionInfo::kNotExecuteYet);
     func.ClearAllErrorMsg();
+    func.ClearLoadImbalance();
   }
 }
 
@@ -369,6 +377,25 @@ int FunctionInfoList::GetFunctionIndex(const std::string& function_name) {
   return index;
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Class       :  FunctionInfoList
+// Method      :  IsSetToIdle
+//
+// Notes       :  1. Check if the function is set to idle. Unknown functions are not.
+//                2. Only a query, it does not add the function or change its status.
+//
+// Arguments   :  std::string *function_name: inline function name
+//
+// Return      :  true if the function is set to idle, otherwise false.
+//-------------------------------------------------------------------------------------------------------
+bool FunctionInfoList::IsSetToIdle(const std::string& function_name) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  int index = GetFunctionIndex(function_name);
+  return index != -1 &&
+         function_list_[index].GetRun() == FunctionInfo::RunStatus::kWillIdle;
+}
+
 //-------------------------------------------------------------------------------------------------------
 // Class       :  FunctionInfoList
 // Method      :  AddNewFunction
@@ -403,16 +430,12 @@ int FunctionInfoList::AddNewFunction(const std::string& function_name,
 // haven't run by
 //                   yt_run_Function/yt_run_FunctionArguments yet.
 //                2. How this method runs python function is identical to
-//                yt_run_Function*. It uses
-//                   PyRun_SimpleString.
-//                3. libyt uses either """ or ''' to wrap the code to execute in exec().
-//                4. function_name_(input_args_) is how Python calls the function:
-//                   try:
-//                       exec(<wrapper><function_name_with_args><wrapper>,
-//                       sys.modules["<script_name>"].__dict__)
-//                   except Exception as e:
-//                       libyt.interactive_mode["func_err_msg"]["<function_name>"] =
-//                       traceback.format_exc()
+//                   yt_run_Function*. It runs and finishes a job through
+//                   async_analysis, which stores the traceback under
+//                   libyt.interactive_mode["func_err_msg"] if the function raises an
+//                   exception.
+//                3. Status and load imbalance of every function executed here are
+//                   synchronized together at the end.
 //
 // Arguments   :  (None)
 //-------------------------------------------------------------------------------------------------------
@@ -423,34 +446,23 @@ void FunctionInfoList::RunEveryFunction() {
     FunctionInfo::RunStatus run = function.GetRun();
     FunctionInfo::ExecuteStatus status = function.GetStatus();
     if (run == FunctionInfo::kWillRun && status == FunctionInfo::kNotExecuteYet) {
-      std::string command =
-          std::string("try:\n"
-                      "    exec(") +
-          function.GetWrapper() + function.GetFunctionNameWithInputArgs() +
-          function.GetWrapper() + std::string(", sys.modules[\"") +
-          LibytProcessControl::Get().param_libyt_.script +
-          std::string("\"].__dict__)\n"
-                      "except Exception as e:\n"
-                      "    libyt.interactive_mode[\"func_err_msg\"][\"") +
-          function.GetFunctionName() + std::string("\"] = traceback.format_exc()\n");
-
+      if (deferred_binding::EnsureBound() != YT_SUCCESS) {
+        logging::LogError("Unable to bind data, skip running new added functions.\n");
+        break;
+      }
+      AsyncAnalysisJob job;
+      job.function_name = function.GetFunctionName();
+      job.str_function = function.GetFunctionNameWithInputArgs();
+      job.arguments = function.GetInputArgs();
       logging::LogInfo("Performing YT inline analysis %s ...\n",
-                       function.GetFunctionNameWithInputArgs().c_str());
+                       job.str_function.c_str());
       function.SetStatus(FunctionInfo::kNeedUpdate);
-      if (PyRun_SimpleString(command.c_str()) != 0) {
-        // We set the status to failed even though this should never happen,
-        // because the status is set based on if an error msg is set or not.
-        function.SetStatus(FunctionInfo::kFailed);
-        logging::LogError("Unexpected error occurred when running PyRun_SimpleString\n");
-      } else {
-        function.SetStatusUsingPythonResult();
-      }
-      FunctionInfo::ExecuteStatus all_status = function.GetAllStatus();
-      logging::LogInfo("Performing YT inline analysis %s ... %s\n",
-                       function.GetFunctionNameWithInputArgs().c_str(),
-                       (all_status == FunctionInfo::kSuccess) ? "done" : "failed");
+      async_analysis::RunJob(job);
+      async_analysis::FinishJob(job);
     }
   }
+
+  async_analysis::SyncStatus();
 }
 
 #endif  // #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
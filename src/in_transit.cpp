@@ -0,0 +1,1061 @@
+#include "in_transit.h"
+
+#ifndef SERIAL_MODE
+#include <mpi.h>
+
+#include "comm_mpi.h"
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <vector>
+
+#include "dtype_utilities.h"
+#include "libyt.h"
+#include "libyt_process_control.h"
+#include "logging.h"
+#include "perf_counter.h"
+#include "timer.h"
+
+#ifndef SERIAL_MODE
+enum InTransitCommand : int {
+  kCommit = 0,
+  kRun = 1,
+  kFree = 2,
+  kFinalize = 3,
+  kRunWithArgs = 4
+};
+enum InTransitTag : int { kTagCommand = 1, kTagGrids = 2, kTagData = 3 };
+
+// Strings and data received by an analysis process, they are freed after yt_free.
+struct ReceivedStep {
+  std::deque<std::string> strings;
+  std::deque<std::vector<const char*>> string_lists;
+  std::vector<yt_par_type> par_type_list;
+  std::vector<std::vector<char>> data;
+};
+
+// Local grid received by an analysis process, offsets are in bytes in the data received
+// from the same simulation process, or -1 if there is no data.
+struct ReceivedGrid {
+  yt_grid grid;
+  std::vector<long> par_count_list;
+  std::vector<yt_data> field_data;
+  std::vector<long> field_offset;
+  std::vector<long> particle_offset;
+};
+
+static bool enabled = false;
+static bool is_analysis_rank = false;
+static int num_analysis_ranks = 0;
+static int num_simulation_ranks = 0;
+static int channel_rank = 0;
+static MPI_Comm group_comm = MPI_COMM_NULL;
+// Duplicate of the libyt communicator between simulation and analysis processes.
+static MPI_Comm channel_comm = MPI_COMM_NULL;
+// Staged buffers of non-blocking sends, they are freed once the sends complete.
+static std::list<std::vector<char>> send_buffers;
+static std::vector<MPI_Request> send_requests;
+static ReceivedStep received_step;
+// fig_basename and user parameters set on simulation processes in this step, without
+// the counter appended to fig_basename.
+static bool has_fig_basename = false;
+static std::string fig_basename;
+static int num_user_parameters = 0;
+static std::vector<char> user_parameters;
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  MessageBuffer
+// Description :  Pack and unpack plain values and strings to a byte buffer.
+//
+// Notes       :  1. Strings unpacked are kept in received_step, since they are pointed to
+//                   by the libyt data structure until yt_free.
+//                2. Simulation and analysis processes must have the same architecture,
+//                   since structs are packed as they are.
+//-------------------------------------------------------------------------------------------------------
+class MessageBuffer {
+ private:
+  std::vector<char> buffer_;
+  size_t offset_;
+
+ public:
+  MessageBuffer() : offset_(0) {}
+  explicit MessageBuffer(std::vector<char>&& buffer)
+      : buffer_(std::move(buffer)), offset_(0) {}
+  std::vector<char>& GetBuffer() { return buffer_; }
+
+  void PackBytes(const void* src, size_t size) {
+    const char* src_bytes = static_cast<const char*>(src);
+    buffer_.insert(buffer_.end(), src_bytes, src_bytes + size);
+  }
+  template<typename T>
+  void Pack(const T& value) {
+    PackBytes(&value, sizeof(T));
+  }
+  void PackString(const char* str) {
+    Pack<bool>(str != nullptr);
+    if (str != nullptr) {
+      size_t len = strlen(str);
+      Pack<size_t>(len);
+      PackBytes(str, len);
+    }
+  }
+
+  void UnpackBytes(void* dest, size_t size) {
+    memcpy(dest, buffer_.data() + offset_, size);
+    offset_ += size;
+  }
+  template<typename T>
+  T Unpack() {
+    T value;
+    UnpackBytes(&value, sizeof(T));
+    return value;
+  }
+  const char* UnpackString() {
+    if (!Unpack<bool>()) {
+      return nullptr;
+    }
+    size_t len = Unpack<size_t>();
+    received_step.strings.emplace_back(buffer_.data() + offset_, len);
+    offset_ += len;
+    return received_step.strings.back().c_str();
+  }
+};
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetAggregator
+// Description :  Get the rank in channel_comm of the analysis process that aggregates
+//                the local grids of a simulation process.
+//-------------------------------------------------------------------------------------------------------
+static int GetAggregator(int simulation_rank) {
+  long offset = static_cast<long>(simulation_rank) * num_analysis_ranks;
+  return num_simulation_ranks + static_cast<int>(offset / num_simulation_ranks);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  AppendData
+// Description :  Append num_bytes to data, and return the offset of it.
+//
+// Notes       :  1. Keep every array aligned to 8 bytes.
+//-------------------------------------------------------------------------------------------------------
+static long AppendData(std::vector<char>& data, long num_bytes) {
+  long offset = static_cast<long>(data.size());
+  data.resize(offset + (num_bytes + 7) / 8 * 8);
+  return offset;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  PostSend
+// Description :  Stage buffer and send it to dest without blocking.
+//
+// Notes       :  1. Buffer larger than INT_MAX bytes is sent in chunks.
+//                2. Sends are completed in CompleteSends.
+//-------------------------------------------------------------------------------------------------------
+static void PostSend(int dest, int tag, std::vector<char>&& buffer) {
+  send_buffers.emplace_back(std::move(buffer));
+  const std::vector<char>& staged = send_buffers.back();
+  size_t offset = 0;
+  do {
+    int count = static_cast<int>(std::min<size_t>(staged.size() - offset, INT_MAX));
+    MPI_Request request;
+    MPI_Isend(staged.data() + offset, count, MPI_BYTE, dest, tag, channel_comm, &request);
+    send_requests.push_back(request);
+    offset += count;
+  } while (offset < staged.size());
+}
+
+static void CompleteSends() {
+  MPI_Waitall(
+      static_cast<int>(send_requests.size()), send_requests.data(), MPI_STATUSES_IGNORE);
+  send_requests.clear();
+  send_buffers.clear();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ReceiveMessage
+// Description :  Receive a message whose size is unknown.
+//-------------------------------------------------------------------------------------------------------
+static std::vector<char> ReceiveMessage(int source, int tag) {
+  MPI_Status status;
+  MPI_Probe(source, tag, channel_comm, &status);
+  int count = 0;
+  MPI_Get_count(&status, MPI_BYTE, &count);
+  std::vector<char> buffer(count);
+  MPI_Recv(buffer.data(), count, MPI_BYTE, source, tag, channel_comm, MPI_STATUS_IGNORE);
+  return buffer;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ReceiveData
+// Description :  Receive buffer.size() bytes sent by PostSend.
+//-------------------------------------------------------------------------------------------------------
+static void ReceiveData(int source, int tag, std::vector<char>& buffer) {
+  size_t offset = 0;
+  do {
+    int count = static_cast<int>(std::min<size_t>(buffer.size() - offset, INT_MAX));
+    MPI_Recv(buffer.data() + offset,
+             count,
+             MPI_BYTE,
+             source,
+             tag,
+             channel_comm,
+             MPI_STATUS_IGNORE);
+    offset += count;
+  } while (offset < buffer.size());
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  PackHeader
+// Description :  Pack parameters, field list, particle list, and user parameters of this
+//                step.
+//-------------------------------------------------------------------------------------------------------
+static int PackHeader(MessageBuffer& header) {
+  LibytProcessControl& control = LibytProcessControl::Get();
+  const yt_param_yt& param_yt = control.param_yt_;
+
+  header.Pack<long>(control.param_libyt_.counter);
+  header.Pack<yt_param_yt>(param_yt);
+  header.PackString(param_yt.frontend);
+  header.PackString(has_fig_basename ? fig_basename.c_str() : nullptr);
+  for (int p = 0; p < param_yt.num_par_types; p++) {
+    header.PackString(param_yt.par_type_list[p].par_type);
+    header.Pack<int>(param_yt.par_type_list[p].num_attr);
+  }
+
+  const yt_field* field_list = control.data_structure_amr_.GetFieldList();
+  for (int v = 0; v < param_yt.num_fields; v++) {
+    const yt_field& field = field_list[v];
+    header.Pack<yt_field>(field);
+    header.PackString(field.field_name);
+    header.PackString(field.field_type);
+    header.PackString(field.field_unit);
+    header.PackString(field.field_display_name);
+    for (int i = 0; i < field.num_field_name_alias; i++) {
+      header.PackString(field.field_name_alias[i]);
+    }
+  }
+
+  const yt_particle* particle_list = control.data_structure_amr_.GetParticleList();
+  for (int p = 0; p < param_yt.num_par_types; p++) {
+    const yt_particle& particle = particle_list[p];
+    header.PackString(particle.coor_x);
+    header.PackString(particle.coor_y);
+    header.PackString(particle.coor_z);
+    for (int a = 0; a < particle.num_attr; a++) {
+      const yt_attribute& attr = particle.attr_list[a];
+      header.Pack<yt_attribute>(attr);
+      header.PackString(attr.attr_name);
+      header.PackString(attr.attr_unit);
+      header.PackString(attr.attr_display_name);
+      for (int i = 0; i < attr.num_attr_name_alias; i++) {
+        header.PackString(attr.attr_name_alias[i]);
+      }
+    }
+  }
+
+  header.Pack<int>(num_user_parameters);
+  header.Pack<size_t>(user_parameters.size());
+  header.PackBytes(user_parameters.data(), user_parameters.size());
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  PackFieldData
+// Description :  Pack the data info of field v in a local grid, and append the data.
+//
+// Notes       :  1. Derived fields are generated here, and sent as cell-centered fields
+//                   without ghost cells.
+//                2. Data dimensions are resolved the same way as binding local data to
+//                   Python.
+//-------------------------------------------------------------------------------------------------------
+static int PackFieldData(const yt_grid& grid, int v, MessageBuffer& grids,
+                         std::vector<char>& data) {
+  LibytProcessControl& control = LibytProcessControl::Get();
+  const yt_field& field = control.data_structure_amr_.GetFieldList()[v];
+  const int dimensionality = control.param_yt_.dimensionality;
+  const bool is_derived = (strcmp(field.field_type, "derived_func") == 0);
+
+  yt_data field_data = grid.field_data[v];
+  if (!is_derived && field_data.data_ptr == nullptr) {
+    grids.Pack<bool>(false);
+    return YT_SUCCESS;
+  }
+
+  if (is_derived || dtype_utilities::GetYtDtypeSize(field_data.data_dtype) <= 0) {
+    field_data.data_dtype = field.field_dtype;
+  }
+  if (is_derived || strcmp(field.field_type, "cell-centered") == 0) {
+    for (int d = 0; d < dimensionality; d++) {
+      field_data.data_dimensions[d] =
+          field.contiguous_in_x ? grid.grid_dimensions[(dimensionality - 1) - d]
+                                : grid.grid_dimensions[d];
+    }
+    for (int d = 0; d < 2 * dimensionality && !is_derived; d++) {
+      field_data.data_dimensions[d / 2] += field.field_ghost_cell[d];
+    }
+  }
+  long data_len = 1;
+  for (int d = 0; d < dimensionality; d++) {
+    data_len *= field_data.data_dimensions[d];
+  }
+  int dtype_size = dtype_utilities::GetYtDtypeSize(field_data.data_dtype);
+  if (data_len <= 0 || dtype_size <= 0) {
+    YT_ABORT("(grid id, field) = (%ld, %s) has unknown data type or size.\n",
+             grid.id,
+             field.field_name);
+  }
+
+  long num_bytes = data_len * dtype_size;
+  grids.Pack<bool>(true);
+  grids.Pack<yt_data>(field_data);
+  grids.Pack<long>(num_bytes);
+  long offset = AppendData(data, num_bytes);
+  if (is_derived) {
+    yt_array data_array[1];
+    data_array[0].gid = grid.id;
+    data_array[0].data_length = data_len;
+    data_array[0].data_ptr = data.data() + offset;
+    long list_gid[1] = {grid.id};
+    (*field.derived_func)(1, list_gid, field.field_name, data_array);
+  } else {
+    memcpy(data.data() + offset, field_data.data_ptr, num_bytes);
+  }
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  PackParticleData
+// Description :  Pack the data info of attribute a of particle type p in a local grid,
+//                and append the data.
+//
+// Notes       :  1. Attributes not set in particle_data are generated by get_par_attr.
+//-------------------------------------------------------------------------------------------------------
+static int PackParticleData(const yt_grid& grid, int p, int a, MessageBuffer& grids,
+                            std::vector<char>& data) {
+  const yt_particle& particle =
+      LibytProcessControl::Get().data_structure_amr_.GetParticleList()[p];
+  const yt_attribute& attr = particle.attr_list[a];
+  const long par_count = grid.par_count_list[p];
+  const void* data_ptr = grid.particle_data[p][a].data_ptr;
+  if (par_count <= 0 || (data_ptr == nullptr && particle.get_par_attr == nullptr)) {
+    grids.Pack<bool>(false);
+    return YT_SUCCESS;
+  }
+
+  int dtype_size = dtype_utilities::GetYtDtypeSize(attr.attr_dtype);
+  if (dtype_size <= 0) {
+    YT_ABORT("(particle type, attribute) = (%s, %s) has unknown data type.\n",
+             particle.par_type,
+             attr.attr_name);
+  }
+
+  long num_bytes = par_count * dtype_size;
+  grids.Pack<bool>(true);
+  grids.Pack<long>(num_bytes);
+  long offset = AppendData(data, num_bytes);
+  if (data_ptr == nullptr) {
+    yt_array data_array[1];
+    data_array[0].gid = grid.id;
+    data_array[0].data_length = par_count;
+    data_array[0].data_ptr = data.data() + offset;
+    long list_gid[1] = {grid.id};
+    (*particle.get_par_attr)(1, list_gid, particle.par_type, attr.attr_name, data_array);
+  } else {
+    memcpy(data.data() + offset, data_ptr, num_bytes);
+  }
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  UnpackHeader
+// Description :  Unpack what is packed in PackHeader to the arguments.
+//-------------------------------------------------------------------------------------------------------
+static void UnpackHeader(MessageBuffer& header, long* counter, yt_param_yt* param_yt,
+                         std::vector<yt_field>& field_list,
+                         std::vector<yt_particle>& particle_list,
+                         std::deque<std::vector<yt_attribute>>& attr_lists,
+                         int* num_user_parameters_received,
+                         std::vector<char>& user_parameters_received) {
+  *counter = header.Unpack<long>();
+  *param_yt = header.Unpack<yt_param_yt>();
+  param_yt->frontend = header.UnpackString();
+  param_yt->fig_basename = header.UnpackString();
+  received_step.par_type_list.resize(param_yt->num_par_types);
+  for (int p = 0; p < param_yt->num_par_types; p++) {
+    received_step.par_type_list[p].par_type = header.UnpackString();
+    received_step.par_type_list[p].num_attr = header.Unpack<int>();
+  }
+  param_yt->par_type_list = received_step.par_type_list.data();
+
+  // derived fields are generated on simulation processes
+  field_list.resize(param_yt->num_fields);
+  for (int v = 0; v < param_yt->num_fields; v++) {
+    yt_field& field = field_list[v];
+    field = header.Unpack<yt_field>();
+    field.field_name = header.UnpackString();
+    field.field_type = header.UnpackString();
+    field.field_unit = header.UnpackString();
+    field.field_display_name = header.UnpackString();
+    received_step.string_lists.emplace_back(field.num_field_name_alias);
+    for (int i = 0; i < field.num_field_name_alias; i++) {
+      received_step.string_lists.back()[i] = header.UnpackString();
+    }
+    field.field_name_alias = received_step.string_lists.back().data();
+    field.derived_func = nullptr;
+    if (strcmp(field.field_type, "derived_func") == 0) {
+      field.field_type = "cell-centered";
+      for (int d = 0; d < 6; d++) {
+        field.field_ghost_cell[d] = 0;
+      }
+    }
+  }
+
+  // particle attributes are all sent, so there is no need to get them
+  particle_list.resize(param_yt->num_par_types);
+  for (int p = 0; p < param_yt->num_par_types; p++) {
+    yt_particle& particle = particle_list[p];
+    particle.coor_x = header.UnpackString();
+    particle.coor_y = header.UnpackString();
+    particle.coor_z = header.UnpackString();
+    attr_lists.emplace_back(received_step.par_type_list[p].num_attr);
+    for (yt_attribute& attr : attr_lists.back()) {
+      attr = header.Unpack<yt_attribute>();
+      attr.attr_name = header.UnpackString();
+      attr.attr_unit = header.UnpackString();
+      attr.attr_display_name = header.UnpackString();
+      received_step.string_lists.emplace_back(attr.num_attr_name_alias);
+      for (int i = 0; i < attr.num_attr_name_alias; i++) {
+        received_step.string_lists.back()[i] = header.UnpackString();
+      }
+      attr.attr_name_alias = received_step.string_lists.back().data();
+    }
+  }
+
+  *num_user_parameters_received = header.Unpack<int>();
+  user_parameters_received.resize(header.Unpack<size_t>());
+  header.UnpackBytes(user_parameters_received.data(), user_parameters_received.size());
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SetUserParameters
+// Description :  Set user parameters recorded by RecordUserParameter with the same libyt
+//                API on analysis processes.
+//
+// Notes       :  1. Values are copied to received_step.data first, so that they are
+//                   aligned.
+//-------------------------------------------------------------------------------------------------------
+static int SetUserParameters(int num_user_parameters_received,
+                             std::vector<char>&& user_parameters_received) {
+  MessageBuffer buffer(std::move(user_parameters_received));
+  for (int i = 0; i < num_user_parameters_received; i++) {
+    const char* key = buffer.UnpackString();
+    yt_dtype data_dtype = buffer.Unpack<yt_dtype>();
+    int n = buffer.Unpack<int>();
+    received_step.data.emplace_back(buffer.Unpack<size_t>());
+    std::vector<char>& values = received_step.data.back();
+    buffer.UnpackBytes(values.data(), values.size());
+
+    int result = YT_FAIL;
+    switch (data_dtype) {
+      case YT_INT: {
+        result = yt_set_UserParameterInt(key, n, reinterpret_cast<int*>(values.data()));
+        break;
+      }
+      case YT_LONG: {
+        result = yt_set_UserParameterLong(key, n, reinterpret_cast<long*>(values.data()));
+        break;
+      }
+      case YT_LONGLONG: {
+        result = yt_set_UserParameterLongLong(
+            key, n, reinterpret_cast<long long*>(values.data()));
+        break;
+      }
+      case YT_UINT: {
+        result = yt_set_UserParameterUint(
+            key, n, reinterpret_cast<unsigned int*>(values.data()));
+        break;
+      }
+      case YT_ULONG: {
+        result = yt_set_UserParameterUlong(
+            key, n, reinterpret_cast<unsigned long*>(values.data()));
+        break;
+      }
+      case YT_FLOAT: {
+        result =
+            yt_set_UserParameterFloat(key, n, reinterpret_cast<float*>(values.data()));
+        break;
+      }
+      case YT_DOUBLE: {
+        result =
+            yt_set_UserParameterDouble(key, n, reinterpret_cast<double*>(values.data()));
+        break;
+      }
+      case YT_CHAR: {
+        result = yt_set_UserParameterString(key, values.data());
+        break;
+      }
+      default: {
+        YT_ABORT("Unknown data type of user parameter \"%s\".\n", key);
+      }
+    }
+    if (result != YT_SUCCESS) {
+      return YT_FAIL;
+    }
+  }
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ReceiveGrids
+// Description :  Receive local grids and their data from a simulation process.
+//-------------------------------------------------------------------------------------------------------
+static void ReceiveGrids(int source, const yt_param_yt& param_yt,
+                         std::vector<ReceivedGrid>& grids) {
+  MessageBuffer grids_buffer(ReceiveMessage(source, kTagGrids));
+  int num_grids = grids_buffer.Unpack<int>();
+  const size_t first_grid = grids.size();
+  long data_size = 0;
+  for (int g = 0; g < num_grids; g++) {
+    grids.emplace_back();
+    ReceivedGrid& received_grid = grids.back();
+    received_grid.grid = grids_buffer.Unpack<yt_grid>();
+    received_grid.par_count_list.resize(param_yt.num_par_types);
+    for (int p = 0; p < param_yt.num_par_types; p++) {
+      received_grid.par_count_list[p] = grids_buffer.Unpack<long>();
+    }
+    received_grid.field_data.resize(param_yt.num_fields);
+    received_grid.field_offset.assign(param_yt.num_fields, -1);
+    for (int v = 0; v < param_yt.num_fields; v++) {
+      if (grids_buffer.Unpack<bool>()) {
+        received_grid.field_data[v] = grids_buffer.Unpack<yt_data>();
+        received_grid.field_offset[v] = data_size;
+        data_size += (grids_buffer.Unpack<long>() + 7) / 8 * 8;
+      }
+    }
+    for (int p = 0; p < param_yt.num_par_types; p++) {
+      for (int a = 0; a < param_yt.par_type_list[p].num_attr; a++) {
+        received_grid.particle_offset.push_back(-1);
+        if (grids_buffer.Unpack<bool>()) {
+          received_grid.particle_offset.back() = data_size;
+          data_size += (grids_buffer.Unpack<long>() + 7) / 8 * 8;
+        }
+      }
+    }
+  }
+
+  received_step.data.emplace_back(data_size);
+  std::vector<char>& data = received_step.data.back();
+  ReceiveData(source, kTagData, data);
+  perf_counter::Add("in_transit.recv_bytes", static_cast<double>(data_size));
+
+  for (size_t g = first_grid; g < grids.size(); g++) {
+    ReceivedGrid& received_grid = grids[g];
+    for (int v = 0; v < param_yt.num_fields; v++) {
+      received_grid.field_data[v].data_ptr =
+          (received_grid.field_offset[v] >= 0)
+              ? data.data() + received_grid.field_offset[v]
+              : nullptr;
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ReceiveCommit
+// Description :  Receive the step committed on simulation processes, and commit it on
+//                analysis processes.
+//
+// Notes       :  1. Collective operation among analysis processes.
+//                2. Local grids belong to this analysis process afterward, so proc_num is
+//                   its rank in the analysis group.
+//-------------------------------------------------------------------------------------------------------
+static int ReceiveCommit(MessageBuffer& header) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+  LibytProcessControl& control = LibytProcessControl::Get();
+
+  long counter = 0;
+  yt_param_yt param_yt;
+  std::vector<yt_field> field_list;
+  std::vector<yt_particle> particle_list;
+  std::deque<std::vector<yt_attribute>> attr_lists;
+  int num_user_parameters_received = 0;
+  std::vector<char> user_parameters_received;
+  UnpackHeader(header,
+               &counter,
+               &param_yt,
+               field_list,
+               particle_list,
+               attr_lists,
+               &num_user_parameters_received,
+               user_parameters_received);
+
+  std::vector<ReceivedGrid> grids;
+  std::vector<size_t> data_index;
+  {
+    perf_counter::ScopedTimer perf_timer("in_transit.recv_time");
+    for (int s = 0; s < num_simulation_ranks; s++) {
+      if (GetAggregator(s) == channel_rank) {
+        ReceiveGrids(s, param_yt, grids);
+        data_index.resize(grids.size(), received_step.data.size() - 1);
+      }
+    }
+  }
+
+  // set parameters
+  control.param_libyt_.counter = counter;
+  param_yt.num_grids_local = static_cast<int>(grids.size());
+  if (yt_set_Parameters(&param_yt) != YT_SUCCESS) {
+    return YT_FAIL;
+  }
+  if (SetUserParameters(num_user_parameters_received,
+                        std::move(user_parameters_received)) != YT_SUCCESS) {
+    return YT_FAIL;
+  }
+
+  // set field list, particle list, and local grids
+  if (param_yt.num_fields > 0) {
+    yt_field* fields = nullptr;
+    if (yt_get_FieldsPtr(&fields) != YT_SUCCESS) {
+      return YT_FAIL;
+    }
+    std::copy(field_list.begin(), field_list.end(), fields);
+  }
+  if (param_yt.num_par_types > 0) {
+    yt_particle* particles = nullptr;
+    if (yt_get_ParticlesPtr(&particles) != YT_SUCCESS) {
+      return YT_FAIL;
+    }
+    for (int p = 0; p < param_yt.num_par_types; p++) {
+      particles[p].coor_x = particle_list[p].coor_x;
+      particles[p].coor_y = particle_list[p].coor_y;
+      particles[p].coor_z = particle_list[p].coor_z;
+      std::copy(attr_lists[p].begin(), attr_lists[p].end(), particles[p].attr_list);
+    }
+  }
+  if (param_yt.num_grids_local > 0) {
+    yt_grid* grids_local = nullptr;
+    if (yt_get_GridsPtr(&grids_local) != YT_SUCCESS) {
+      return YT_FAIL;
+    }
+    for (int g = 0; g < param_yt.num_grids_local; g++) {
+      const ReceivedGrid& received_grid = grids[g];
+      yt_grid& grid = grids_local[g];
+      for (int d = 0; d < 3; d++) {
+        grid.left_edge[d] = received_grid.grid.left_edge[d];
+        grid.right_edge[d] = received_grid.grid.right_edge[d];
+        grid.grid_dimensions[d] = received_grid.grid.grid_dimensions[d];
+      }
+      grid.id = received_grid.grid.id;
+      grid.parent_id = received_grid.grid.parent_id;
+      grid.level = received_grid.grid.level;
+      grid.proc_num = CommMpi::mpi_rank_;
+      for (int v = 0; v < param_yt.num_fields; v++) {
+        grid.field_data[v] = received_grid.field_data[v];
+      }
+      char* data = received_step.data[data_index[g]].data();
+      int attr_index = 0;
+      for (int p = 0; p < param_yt.num_par_types; p++) {
+        grid.par_count_list[p] = received_grid.par_count_list[p];
+        for (int a = 0; a < param_yt.par_type_list[p].num_attr; a++, attr_index++) {
+          long offset = received_grid.particle_offset[attr_index];
+          grid.particle_data[p][a].data_ptr = (offset >= 0) ? data + offset : nullptr;
+        }
+      }
+    }
+  }
+
+  return yt_commit();
+}
+#endif  // #ifndef SERIAL_MODE
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : in_transit
+// Function name : Split
+//
+// Notes         :  1. Collective operation on the libyt communicator set in yt_initialize,
+//                     it must be called before anything else in libyt communicates.
+//                  2. The last num_analysis_ranks processes are analysis processes. It is
+//                     off if num_analysis_ranks is 0.
+//                  3. Return YT_FAIL if num_analysis_ranks leaves no simulation process,
+//                     or in SERIAL_MODE, and it stays off.
+//-------------------------------------------------------------------------------------------------------
+int in_transit::Split(int num_analysis_ranks_in) {
+  if (num_analysis_ranks_in <= 0) {
+    return YT_SUCCESS;
+  }
+#ifndef SERIAL_MODE
+  int channel_size = 1;
+  MPI_Comm_dup(CommMpi::GetComm(), &channel_comm);
+  MPI_Comm_rank(channel_comm, &channel_rank);
+  MPI_Comm_size(channel_comm, &channel_size);
+  if (num_analysis_ranks_in >= channel_size) {
+    MPI_Comm_free(&channel_comm);
+    return YT_FAIL;
+  }
+
+  num_analysis_ranks = num_analysis_ranks_in;
+  num_simulation_ranks = channel_size - num_analysis_ranks;
+  is_analysis_rank = (channel_rank >= num_simulation_ranks);
+  MPI_Comm_split(channel_comm, is_analysis_rank ? 1 : 0, channel_rank, &group_comm);
+  CommMpi::SetComm(group_comm);
+  enabled = true;
+
+  return YT_SUCCESS;
+#else
+  return YT_FAIL;
+#endif
+}
+
+bool in_transit::IsEnabled() {
+#ifndef SERIAL_MODE
+  return enabled;
+#else
+  return false;
+#endif
+}
+
+bool in_transit::IsAnalysisRank() {
+#ifndef SERIAL_MODE
+  return enabled && is_analysis_rank;
+#else
+  return false;
+#endif
+}
+
+bool in_transit::IsSimulationRank() {
+#ifndef SERIAL_MODE
+  return enabled && !is_analysis_rank;
+#else
+  return false;
+#endif
+}
+
+int in_transit::GetNumAnalysisRanks() {
+#ifndef SERIAL_MODE
+  return num_analysis_ranks;
+#else
+  return 0;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : in_transit
+// Function name : RecordFigBasename
+//
+// Notes         :  1. Called in yt_set_Parameters on simulation processes, since they do
+//                     not keep it in libyt.param_yt.
+//                  2. fig_basename is the one passed in by the user, analysis processes
+//                     append the counter the same way in yt_set_Parameters.
+//-------------------------------------------------------------------------------------------------------
+void in_transit::RecordFigBasename(const char* fig_basename_in) {
+#ifndef SERIAL_MODE
+  has_fig_basename = (fig_basename_in != nullptr);
+  fig_basename = has_fig_basename ? fig_basename_in : "";
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : in_transit
+// Function name : RecordUserParameter
+//
+// Notes         :  1. Called in yt_set_UserParameter* on simulation processes, since they
+//                     do not have libyt.param_user. Values are copied, and sent with the
+//                     next commit.
+//                  2. A string is recorded as YT_CHAR, including the null terminator.
+//                  3. Records are cleared in SendFree.
+//-------------------------------------------------------------------------------------------------------
+int in_transit::RecordUserParameter(const char* key, yt_dtype data_dtype, int n,
+                                    const void* input) {
+#ifndef SERIAL_MODE
+  int dtype_size = dtype_utilities::GetYtDtypeSize(data_dtype);
+  if (key == nullptr || input == nullptr || n <= 0 || dtype_size <= 0) {
+    YT_ABORT("Unable to record user parameter \"%s\".\n", key != nullptr ? key : "");
+  }
+  size_t num_bytes = static_cast<size_t>(n) * dtype_size;
+  MessageBuffer record;
+  record.PackString(key);
+  record.Pack<yt_dtype>(data_dtype);
+  record.Pack<int>(n);
+  record.Pack<size_t>(num_bytes);
+  record.PackBytes(input, num_bytes);
+  user_parameters.insert(
+      user_parameters.end(), record.GetBuffer().begin(), record.GetBuffer().end());
+  num_user_parameters++;
+  logging::LogDebug("Recording code-specific parameter \"%s\" ... done\n", key);
+#endif
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : in_transit
+// Function name : SendCommit
+//
+// Notes         :  1. Called in yt_commit on simulation processes.
+//                  2. Wait for sends of the previous step to complete, then the root
+//                     simulation process sends the commit command with the header to
+//                     every analysis process, and each simulation process sends its local
+//                     grids and data to its aggregator.
+//                  3. Data is staged, so that the simulation can advance once it returns.
+//-------------------------------------------------------------------------------------------------------
+int in_transit::SendCommit() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+#ifndef SERIAL_MODE
+  perf_counter::ScopedTimer perf_timer("in_transit.send_time");
+  {
+    perf_counter::ScopedTimer perf_wait_timer("in_transit.wait_time");
+    CompleteSends();
+  }
+
+  LibytProcessControl& control = LibytProcessControl::Get();
+  const yt_param_yt& param_yt = control.param_yt_;
+
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_root_) {
+    MessageBuffer header;
+    header.Pack<int>(kCommit);
+    if (PackHeader(header) != YT_SUCCESS) {
+      return YT_FAIL;
+    }
+    for (int a = num_simulation_ranks; a < num_simulation_ranks + num_analysis_ranks;
+         a++) {
+      std::vector<char> buffer(header.GetBuffer());
+      PostSend(a, kTagCommand, std::move(buffer));
+    }
+  }
+
+  MessageBuffer grids;
+  std::vector<char> data;
+  const yt_grid* grids_local = control.data_structure_amr_.GetGridsLocal();
+  grids.Pack<int>(param_yt.num_grids_local);
+  for (int g = 0; g < param_yt.num_grids_local; g++) {
+    const yt_grid& grid = grids_local[g];
+    grids.Pack<yt_grid>(grid);
+    for (int p = 0; p < param_yt.num_par_types; p++) {
+      grids.Pack<long>(grid.par_count_list[p]);
+    }
+    for (int v = 0; v < param_yt.num_fields; v++) {
+      if (PackFieldData(grid, v, grids, data) != YT_SUCCESS) {
+        return YT_FAIL;
+      }
+    }
+    for (int p = 0; p < param_yt.num_par_types; p++) {
+      for (int a = 0; a < param_yt.par_type_list[p].num_attr; a++) {
+        if (PackParticleData(grid, p, a, grids, data) != YT_SUCCESS) {
+          return YT_FAIL;
+        }
+      }
+    }
+  }
+  perf_counter::Add("in_transit.send_bytes", static_cast<double>(data.size()));
+
+  int aggregator = GetAggregator(CommMpi::mpi_rank_);
+  PostSend(aggregator, kTagGrids, std::move(grids.GetBuffer()));
+  PostSend(aggregator, kTagData, std::move(data));
+#endif
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : in_transit
+// Function name : SendRun
+//
+// Notes         :  1. Called in yt_run_FunctionArguments on simulation processes, only
+//                     the root simulation process sends the command.
+//                  2. arguments are joined by comma, since they are joined the same way
+//                     to call the function.
+//-------------------------------------------------------------------------------------------------------
+int in_transit::SendRun(const std::string& function_name, const std::string& arguments) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+#ifndef SERIAL_MODE
+  if (CommMpi::mpi_rank_ != CommMpi::mpi_root_) {
+    return YT_SUCCESS;
+  }
+  MessageBuffer command;
+  command.Pack<int>(kRun);
+  command.PackString(function_name.c_str());
+  command.PackString(arguments.c_str());
+  for (int a = num_simulation_ranks; a < num_simulation_ranks + num_analysis_ranks; a++) {
+    std::vector<char> buffer(command.GetBuffer());
+    PostSend(a, kTagCommand, std::move(buffer));
+  }
+#endif
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : in_transit
+// Function name : SendRunWithArgs
+//
+// Notes         :  1. Called in yt_run_FunctionWithArgs on simulation processes, only the
+//                     root simulation process sends the command.
+//                  2. Values that typed arguments point to are packed, so they can be
+//                     reused by the simulation right after it returns.
+//-------------------------------------------------------------------------------------------------------
+int in_transit::SendRunWithArgs(const char* function_name, const yt_arg* args,
+                                int num_args) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+#ifndef SERIAL_MODE
+  if (CommMpi::mpi_rank_ != CommMpi::mpi_root_) {
+    return YT_SUCCESS;
+  }
+  MessageBuffer command;
+  command.Pack<int>(kRunWithArgs);
+  command.PackString(function_name);
+  command.Pack<int>(num_args);
+  for (int i = 0; i < num_args; i++) {
+    const yt_arg& arg = args[i];
+    command.Pack<yt_arg>(arg);
+    command.PackString(arg.keyword);
+    if (arg.arg_type == YT_ARG_STRING) {
+      command.PackString(static_cast<const char*>(arg.data_ptr));
+      continue;
+    }
+    size_t num_bytes = dtype_utilities::GetYtDtypeSize(arg.data_dtype);
+    if (arg.arg_type == YT_ARG_ARRAY) {
+      for (int d = 0; d < arg.num_dims; d++) {
+        num_bytes *= arg.data_dimensions[d];
+      }
+    }
+    command.Pack<size_t>(num_bytes);
+    command.PackBytes(arg.data_ptr, num_bytes);
+  }
+  for (int a = num_simulation_ranks; a < num_simulation_ranks + num_analysis_ranks; a++) {
+    std::vector<char> buffer(command.GetBuffer());
+    PostSend(a, kTagCommand, std::move(buffer));
+  }
+#endif
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : in_transit
+// Function name : SendFree
+//
+// Notes         :  1. Called in yt_free on simulation processes, only the root simulation
+//                     process sends the command.
+//                  2. fig_basename and user parameters recorded in this step are cleared.
+//-------------------------------------------------------------------------------------------------------
+int in_transit::SendFree() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+#ifndef SERIAL_MODE
+  has_fig_basename = false;
+  fig_basename.clear();
+  num_user_parameters = 0;
+  user_parameters.clear();
+  if (CommMpi::mpi_rank_ != CommMpi::mpi_root_) {
+    return YT_SUCCESS;
+  }
+  for (int a = num_simulation_ranks; a < num_simulation_ranks + num_analysis_ranks; a++) {
+    MessageBuffer command;
+    command.Pack<int>(kFree);
+    PostSend(a, kTagCommand, std::move(command.GetBuffer()));
+  }
+#endif
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : in_transit
+// Function name : Serve
+//
+// Notes         :  1. Called in yt_run_InTransit on analysis processes.
+//                  2. Replay commands sent by the root simulation process with libyt API,
+//                     until the simulation finalizes libyt.
+//                  3. Return YT_FAIL if it fails to commit a step, since analysis
+//                     processes are out of sync afterward.
+//-------------------------------------------------------------------------------------------------------
+int in_transit::Serve() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+#ifndef SERIAL_MODE
+  while (true) {
+    MessageBuffer command(ReceiveMessage(0, kTagCommand));
+    switch (command.Unpack<int>()) {
+      case kCommit: {
+        if (ReceiveCommit(command) != YT_SUCCESS) {
+          YT_ABORT("Receiving step %ld from simulation processes ... failed!\n",
+                   LibytProcessControl::Get().param_libyt_.counter);
+        }
+        break;
+      }
+      case kRun: {
+        const char* function_name = command.UnpackString();
+        const char* arguments = command.UnpackString();
+        yt_run_FunctionArguments(
+            function_name, (arguments[0] != '\0') ? 1 : 0, arguments);
+        break;
+      }
+      case kRunWithArgs: {
+        const char* function_name = command.UnpackString();
+        std::vector<yt_arg> args(command.Unpack<int>());
+        for (yt_arg& arg : args) {
+          arg = command.Unpack<yt_arg>();
+          arg.keyword = command.UnpackString();
+          if (arg.arg_type == YT_ARG_STRING) {
+            arg.data_ptr = command.UnpackString();
+            continue;
+          }
+          received_step.data.emplace_back(command.Unpack<size_t>());
+          command.UnpackBytes(received_step.data.back().data(),
+                              received_step.data.back().size());
+          arg.data_ptr = received_step.data.back().data();
+        }
+        yt_run_FunctionWithArgs(
+            function_name, args.data(), static_cast<int>(args.size()));
+        break;
+      }
+      case kFree: {
+        yt_free();
+        received_step = ReceivedStep();
+        break;
+      }
+      case kFinalize: {
+        return YT_SUCCESS;
+      }
+      default: {
+        YT_ABORT("Unknown in-transit command.\n");
+      }
+    }
+  }
+#else
+  return YT_FAIL;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : in_transit
+// Function name : Finalize
+//
+// Notes         :  1. Called at the end of yt_finalize. The root simulation process tells
+//                     analysis processes to return from yt_run_InTransit.
+//                  2. Free the channel and group communicators. yt_finalize resets the
+//                     libyt communicator afterward.
+//-------------------------------------------------------------------------------------------------------
+void in_transit::Finalize() {
+#ifndef SERIAL_MODE
+  if (!enabled) {
+    return;
+  }
+  if (!is_analysis_rank && CommMpi::mpi_rank_ == CommMpi::mpi_root_) {
+    for (int a = num_simulation_ranks; a < num_simulation_ranks + num_analysis_ranks;
+         a++) {
+      MessageBuffer command;
+      command.Pack<int>(kFinalize);
+      PostSend(a, kTagCommand, std::move(command.GetBuffer()));
+    }
+  }
+  CompleteSends();
+  MPI_Comm_free(&channel_comm);
+  MPI_Comm_free(&group_comm);
+  enabled = false;
+#endif
+}
@@ -50,6 +50,7 @@ int python_controller::PreparePythonEnvForLibyt() {
   LibytProcessControl::Get().py_param_yt_ = libyt.attr("param_yt").ptr();
   LibytProcessControl::Get().py_param_user_ = libyt.attr("param_user").ptr();
   LibytProcessControl::Get().py_libyt_info_ = libyt.attr("libyt_info").ptr();
+  LibytProcessControl::Get().py_perf_ = libyt.attr("perf").ptr();
 #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
   LibytProcessControl::Get().py_interactive_mode_ = libyt.attr("interactive_mode").ptr();
 #endif
@@ -72,7 +73,7 @@ int python_controller::PreparePythonEnvForLibyt() {
   }
 
 #ifndef SERIAL_MODE
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Barrier(CommMpi::GetComm());
 #endif
 
   // import YT inline analysis script
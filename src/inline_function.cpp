@@ -0,0 +1,321 @@
+#include "inline_function.h"
+
+#include <Python.h>
+
+#include <unordered_map>
+
+#include "libyt_process_control.h"
+#include "timer.h"
+
+struct CachedFunction {
+  PyObject* py_root = nullptr;      // object bound to the first name in function_name
+  PyObject* py_function = nullptr;  // object function_name refers to
+  std::string arguments;
+  PyObject* py_arguments_code = nullptr;  // evaluates to (args, kwargs)
+};
+
+// Wrap arguments in a call, so that keyword arguments are parsed as well.
+static const char* kPackArgumentsHead = "(lambda *args, **kwargs: (args, kwargs))(";
+
+static PyObject* py_script_globals = nullptr;
+static std::unordered_map<std::string, CachedFunction> function_cache;
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetScriptGlobals
+// Description :  Get the inline script namespace sys.modules["<script>"].__dict__.
+//
+// Notes       :  1. Return a borrowed reference, or nullptr with Python error set.
+//-------------------------------------------------------------------------------------------------------
+static PyObject* GetScriptGlobals() {
+  if (py_script_globals != nullptr) {
+    return py_script_globals;
+  }
+
+  const char* script = LibytProcessControl::Get().param_libyt_.script;
+  PyObject* py_module = PyDict_GetItemString(PyImport_GetModuleDict(), script);
+  if (py_module == nullptr) {
+    PyErr_Format(PyExc_ModuleNotFoundError, "No module named '%s'", script);
+    return nullptr;
+  }
+  py_script_globals = PyModule_GetDict(py_module);
+  Py_INCREF(py_script_globals);
+
+  return py_script_globals;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  LookUpName
+// Description :  Look up a name in the inline script namespace, then in builtins.
+//
+// Notes       :  1. Return a borrowed reference, or nullptr with NameError set.
+//-------------------------------------------------------------------------------------------------------
+static PyObject* LookUpName(PyObject* py_globals, const std::string& name) {
+  PyObject* py_object = PyDict_GetItemString(py_globals, name.c_str());
+  if (py_object == nullptr) {
+    py_object = PyDict_GetItemString(PyEval_GetBuiltins(), name.c_str());
+  }
+  if (py_object == nullptr) {
+    PyErr_Format(PyExc_NameError, "name '%s' is not defined", name.c_str());
+  }
+
+  return py_object;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ResolveFunction
+// Description :  Resolve function_name in the inline script namespace and cache it.
+//
+// Notes       :  1. function_name can be a dotted name, e.g. "module.function".
+//                2. It is resolved again only if the first name is bound to another
+//                   object, which holds for redefining the function in the namespace.
+//                3. Return 0 on success, -1 with Python error set otherwise.
+//-------------------------------------------------------------------------------------------------------
+static int ResolveFunction(PyObject* py_globals, const std::string& function_name,
+                           CachedFunction& cached) {
+  std::size_t end = function_name.find('.');
+  PyObject* py_root = LookUpName(py_globals, function_name.substr(0, end));
+  if (py_root == nullptr) {
+    return -1;
+  }
+  if (py_root == cached.py_root && cached.py_function != nullptr) {
+    return 0;
+  }
+
+  Py_INCREF(py_root);
+  PyObject* py_function = py_root;
+  Py_INCREF(py_function);
+  while (end != std::string::npos) {
+    std::size_t start = end + 1;
+    end = function_name.find('.', start);
+    std::string attr_name = function_name.substr(start, end - start);
+    PyObject* py_attr = PyObject_GetAttrString(py_function, attr_name.c_str());
+    Py_DECREF(py_function);
+    if (py_attr == nullptr) {
+      Py_DECREF(py_root);
+      return -1;
+    }
+    py_function = py_attr;
+  }
+
+  Py_XDECREF(cached.py_root);
+  Py_XDECREF(cached.py_function);
+  cached.py_root = py_root;
+  cached.py_function = py_function;
+
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  PackArguments
+// Description :  Evaluate arguments in the inline script namespace to args and kwargs.
+//
+// Notes       :  1. arguments are compiled only if they are different from the cached
+//                   ones.
+//                2. Return 0 on success, -1 with Python error set otherwise. py_kwargs is
+//                   nullptr if there is no keyword argument.
+//-------------------------------------------------------------------------------------------------------
+static int PackArguments(PyObject* py_globals, const std::string& arguments,
+                         CachedFunction& cached, PyObject** py_args,
+                         PyObject** py_kwargs) {
+  *py_args = nullptr;
+  *py_kwargs = nullptr;
+  if (arguments.empty()) {
+    *py_args = PyTuple_New(0);
+    return (*py_args != nullptr) ? 0 : -1;
+  }
+
+  if (cached.py_arguments_code == nullptr || cached.arguments != arguments) {
+    Py_CLEAR(cached.py_arguments_code);
+    std::string source = kPackArgumentsHead + arguments + ")";
+    cached.py_arguments_code =
+        Py_CompileString(source.c_str(), "<string>", Py_eval_input);
+    if (cached.py_arguments_code == nullptr) {
+      return -1;
+    }
+    cached.arguments = arguments;
+  }
+
+  PyObject* py_packed = PyEval_EvalCode(cached.py_arguments_code, py_globals, py_globals);
+  if (py_packed == nullptr) {
+    return -1;
+  }
+  *py_args = PyTuple_GetItem(py_packed, 0);
+  Py_INCREF(*py_args);
+  PyObject* py_packed_kwargs = PyTuple_GetItem(py_packed, 1);
+  if (PyDict_Size(py_packed_kwargs) > 0) {
+    *py_kwargs = py_packed_kwargs;
+    Py_INCREF(*py_kwargs);
+  }
+  Py_DECREF(py_packed);
+
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  HandleError
+// Description :  Handle the Python error raised while calling an inline function.
+//
+// Notes       :  1. Under INTERACTIVE_MODE and JUPYTER_KERNEL, an Exception is formatted
+//                   by traceback.format_exception and stored under
+//                   libyt.interactive_mode["func_err_msg"]["<function_name>"], which is
+//                   what the function status is based on.
+//                2. Other errors are printed.
+//                3. Return the result of the call, 0 if the error is stored, -1
+//                   otherwise.
+//-------------------------------------------------------------------------------------------------------
+#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
+static int HandleError(const std::string& function_name) {
+  PyObject* py_interactive_mode = LibytProcessControl::Get().py_interactive_mode_;
+  if (py_interactive_mode != nullptr && PyErr_ExceptionMatches(PyExc_Exception)) {
+    PyObject *py_type, *py_value, *py_traceback;
+    PyErr_Fetch(&py_type, &py_value, &py_traceback);
+    PyErr_NormalizeException(&py_type, &py_value, &py_traceback);
+    if (py_traceback != nullptr) {
+      PyException_SetTraceback(py_value, py_traceback);
+    }
+
+    PyObject* py_err_msg = nullptr;
+    PyObject* py_module_traceback = PyImport_ImportModule("traceback");
+    if (py_module_traceback != nullptr) {
+      PyObject* py_lines =
+          PyObject_CallMethod(py_module_traceback,
+                              "format_exception",
+                              "OOO",
+                              py_type,
+                              py_value,
+                              (py_traceback != nullptr) ? py_traceback : Py_None);
+      if (py_lines != nullptr) {
+        PyObject* py_separator = PyUnicode_FromString("");
+        py_err_msg = PyUnicode_Join(py_separator, py_lines);
+        Py_DECREF(py_separator);
+        Py_DECREF(py_lines);
+      }
+      Py_DECREF(py_module_traceback);
+    }
+    Py_XDECREF(py_type);
+    Py_XDECREF(py_value);
+    Py_XDECREF(py_traceback);
+
+    if (py_err_msg != nullptr) {
+      PyObject* py_func_err_msg =
+          PyDict_GetItemString(py_interactive_mode, "func_err_msg");
+      int result =
+          PyDict_SetItemString(py_func_err_msg, function_name.c_str(), py_err_msg);
+      Py_DECREF(py_err_msg);
+      if (result == 0) {
+        return 0;
+      }
+    }
+  }
+
+  PyErr_Print();
+  return -1;
+}
+#else
+static int HandleError(const std::string&) {
+  PyErr_Print();
+  return -1;
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  CallCachedFunction
+// Description :  Call the cached function with args and kwargs.
+//
+// Notes       :  1. py_kwargs can be nullptr. References are not stolen.
+//                2. Return 0 on success, -1 otherwise.
+//-------------------------------------------------------------------------------------------------------
+static int CallCachedFunction(const std::string& function_name, CachedFunction& cached,
+                              PyObject* py_args, PyObject* py_kwargs) {
+  // the function may redefine itself, so hold it during the call
+  PyObject* py_function = cached.py_function;
+  Py_INCREF(py_function);
+  PyObject* py_result = PyObject_Call(py_function, py_args, py_kwargs);
+  Py_DECREF(py_function);
+  if (py_result == nullptr) {
+    return HandleError(function_name);
+  }
+  Py_DECREF(py_result);
+
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : inline_function
+// Function name : Call
+//
+// Notes         :  1. Must hold the GIL. It is equivalent to executing
+//                     "function_name(arguments)" in the inline script namespace.
+//                  2. arguments are joined by commas and may contain keyword arguments,
+//                     they are evaluated in the inline script namespace on every call.
+//                  3. Return 0 on success, -1 otherwise, the same as PyRun_SimpleString.
+//-------------------------------------------------------------------------------------------------------
+int inline_function::Call(const std::string& function_name,
+                          const std::string& arguments) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  PyObject* py_globals = GetScriptGlobals();
+  if (py_globals == nullptr) {
+    return HandleError(function_name);
+  }
+
+  CachedFunction& cached = function_cache[function_name];
+  if (ResolveFunction(py_globals, function_name, cached) != 0) {
+    return HandleError(function_name);
+  }
+
+  PyObject *py_args, *py_kwargs;
+  if (PackArguments(py_globals, arguments, cached, &py_args, &py_kwargs) != 0) {
+    return HandleError(function_name);
+  }
+
+  int result = CallCachedFunction(function_name, cached, py_args, py_kwargs);
+  Py_DECREF(py_args);
+  Py_XDECREF(py_kwargs);
+
+  return result;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : inline_function
+// Function name : CallWithObjects
+//
+// Notes         :  1. Must hold the GIL. Call the function with args and kwargs that are
+//                     already Python objects, nothing is evaluated.
+//                  2. py_args must be a tuple, py_kwargs must be a dict or nullptr.
+//                  3. Return 0 on success, -1 otherwise.
+//-------------------------------------------------------------------------------------------------------
+int inline_function::CallWithObjects(const std::string& function_name, PyObject* py_args,
+                                     PyObject* py_kwargs) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  PyObject* py_globals = GetScriptGlobals();
+  if (py_globals == nullptr) {
+    return HandleError(function_name);
+  }
+
+  CachedFunction& cached = function_cache[function_name];
+  if (ResolveFunction(py_globals, function_name, cached) != 0) {
+    return HandleError(function_name);
+  }
+
+  return CallCachedFunction(function_name, cached, py_args, py_kwargs);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : inline_function
+// Function name : InvalidateCache
+//
+// Notes         :  1. Must hold the GIL. Drop every cached function and the namespace,
+//                     so that they are resolved again on the next call.
+//                  2. Called after reloading the script, and before finalizing Python.
+//-------------------------------------------------------------------------------------------------------
+void inline_function::InvalidateCache() {
+  for (auto& item : function_cache) {
+    Py_XDECREF(item.second.py_root);
+    Py_XDECREF(item.second.py_function);
+    Py_XDECREF(item.second.py_arguments_code);
+  }
+  function_cache.clear();
+  Py_CLEAR(py_script_globals);
+}
@@ -83,7 +83,7 @@ nl::json LibytKernel::execute_request_impl(int execution_counter, const std::str
 #ifndef SERIAL_MODE
     int indicator = 2;
     MPI_Bcast(
-        &indicator, 1, MPI_INT, LibytProcessControl::Get().mpi_root_, MPI_COMM_WORLD);
+        &indicator, 1, MPI_INT, LibytProcessControl::Get().mpi_root_, CommMpi::GetComm());
 #endif
     MagicCommand command(MagicCommand::EntryPoint::kLibytJupyterKernel);
     MagicCommandOutput command_output =
@@ -117,7 +117,8 @@ nl::json LibytKernel::execute_request_impl(int execution_counter, const std::str
   // should wrap in function.
 #ifndef SERIAL_MODE
   int indicator = 1;
-  MPI_Bcast(&indicator, 1, MPI_INT, LibytProcessControl::Get().mpi_root_, MPI_COMM_WORLD);
+  MPI_Bcast(
+      &indicator, 1, MPI_INT, LibytProcessControl::Get().mpi_root_, CommMpi::GetComm());
 #endif
   std::vector<PythonOutput> output;
   PythonStatus all_execute_status =
@@ -379,7 +380,8 @@ void LibytKernel::shutdown_request_impl() {
 
 #ifndef SERIAL_MODE
   int indicator = -1;
-  MPI_Bcast(&indicator, 1, MPI_INT, LibytProcessControl::Get().mpi_rank_, MPI_COMM_WORLD);
+  MPI_Bcast(
+      &indicator, 1, MPI_INT, LibytProcessControl::Get().mpi_rank_, CommMpi::GetComm());
 #endif
 
   if (m_py_jedi_interpreter != NULL) {
@@ -4,6 +4,10 @@
 
 #include "libyt_process_control.h"
 
+#include "async_analysis.h"
+#include "in_transit.h"
+#include "node_aggregation.h"
+
 //-------------------------------------------------------------------------------------------------------
 // Class       :  LibytProcessControl
 // Data member :  Static private LibytProcessControl instance.
@@ -49,6 +53,7 @@ LibytProcessControl::LibytProcessControl() {
   py_param_yt_ = nullptr;
   py_param_user_ = nullptr;
   py_libyt_info_ = nullptr;
+  py_perf_ = nullptr;
 #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
   py_interactive_mode_ = nullptr;
 #endif
@@ -63,13 +68,15 @@ LibytProcessControl::LibytProcessControl() {
 // Notes       :  1. It is called in yt_initialize().
 //                2. Initialize MPI rank, MPI size for all other classes. (if not in
 //                SERIAL_MODE)
-//                3. Initialize and create libyt profile file. (if SUPPORT_TIMER is set)
+//                3. Set libyt profile file name, it is created when profile is written.
+//                   Analysis processes in in-transit mode and node members in node
+//                   aggregation have their own file names.
 //                4. TODO: should I make the initialization of other stuff here?
 //-------------------------------------------------------------------------------------------------------
 void LibytProcessControl::Initialize() {
 #ifndef SERIAL_MODE
-  MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank_);
-  MPI_Comm_size(MPI_COMM_WORLD, &mpi_size_);
+  MPI_Comm_rank(CommMpi::GetComm(), &mpi_rank_);
+  MPI_Comm_size(CommMpi::GetComm(), &mpi_size_);
 
   CommMpi::InitializeInfo(0);
 #endif
@@ -79,13 +86,16 @@ void LibytProcessControl::Initialize() {
 #endif
   DataStructureAmr::SetMpiInfo(mpi_size_, mpi_root_, mpi_rank_);
 
-#ifdef SUPPORT_TIMER
   // Set time profile controller
   std::string filename = "libytTimeProfile_MPI";
+  if (in_transit::IsAnalysisRank()) {
+    filename = "libytTimeProfile_Analysis_MPI";
+  } else if (node_aggregation::IsMember()) {
+    filename = "libytTimeProfile_NodeMember_MPI";
+  }
   filename += std::to_string(mpi_rank_);
   filename += ".json";
   timer_control.CreateFile(filename.c_str(), mpi_rank_);
-#endif
 }
 
 //-------------------------------------------------------------------------------------------------------
@@ -96,3 +106,27 @@ void LibytProcessControl::Initialize() {
 // Notes       :  1. Return the reference of LibytProcessControl instance.
 //-------------------------------------------------------------------------------------------------------
 LibytProcessControl& LibytProcessControl::Get() { return instance_; }
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  LibytProcessControl
+// Method      :  Public method
+// Description :  Get the AMR data structure inline functions on this thread run on.
+//
+// Notes       :  1. It is the data structure of the retired step if the analysis thread
+//                   is running its job, otherwise it is data_structure_amr_.
+//                2. Use this in everything that can be called inside inline functions.
+//-------------------------------------------------------------------------------------------------------
+DataStructureAmr& LibytProcessControl::GetDataStructureAmr() {
+  DataStructureAmr* data_structure_amr = async_analysis::GetDataStructureAmrInUse();
+  return (data_structure_amr != nullptr) ? *data_structure_amr : data_structure_amr_;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  LibytProcessControl
+// Method      :  Public method
+// Description :  Check if grids are committed for the data structure returned by
+//                GetDataStructureAmr.
+//-------------------------------------------------------------------------------------------------------
+bool LibytProcessControl::IsGridsCommitted() {
+  return commit_grids_ || async_analysis::GetDataStructureAmrInUse() != nullptr;
+}
@@ -1,12 +1,16 @@
 #include <iostream>
 
+#include "async_analysis.h"
 #include "comm_mpi_rma.h"
 #include "dtype_utilities.h"
 #include "libyt.h"
 #include "libyt_process_control.h"
 #include "logging.h"
+#include "memory_tracker.h"
 #include "numpy_controller.h"
 #include "python_controller.h"
+#include "remote_data_iterator.h"
+#include "remote_data_request.h"
 #include "timer.h"
 
 #ifdef USE_PYBIND11
@@ -20,6 +24,20 @@
 #endif
 
 #ifndef SERIAL_MODE
+//-------------------------------------------------------------------------------------------------------
+// Helper function : SetRmaMemoryBudget
+// Description     : Set memory budget and spill directory in yt_param_libyt to rma.
+//-------------------------------------------------------------------------------------------------------
+template<typename RmaDataClass>
+static void SetRmaMemoryBudget(RmaDataClass& rma) {
+  const yt_param_libyt& param_libyt = LibytProcessControl::Get().param_libyt_;
+  std::string spill_dir;
+  if (param_libyt.spill_dir != nullptr) {
+    spill_dir = param_libyt.spill_dir;
+  }
+  rma.SetMemoryBudget(param_libyt.memory_budget, spill_dir);
+}
+
 template<typename DataClass, typename RmaDataClass>
 static std::string CallFieldRma(const std::string& fname,
                                 const std::vector<long>& prepare_id_list,
@@ -28,13 +46,14 @@ static std::string CallFieldRma(const std::string& fname,
   // Prepare data for each field on each MPI rank, fail fast if any process fails.
   DataHubAmrField<DataClass> local_amr_data(false);
   DataHubReturn<DataClass> prepared_data = local_amr_data.GetLocalFieldData(
-      LibytProcessControl::Get().data_structure_amr_, fname, prepare_id_list);
-
-  DataHubStatus all_status = static_cast<DataHubStatus>(
-      CommMpi::CheckAllStates(static_cast<int>(prepared_data.status),
-                              static_cast<int>(DataHubStatus::kDataHubSuccess),
-                              static_cast<int>(DataHubStatus::kDataHubSuccess),
-                              static_cast<int>(DataHubStatus::kDataHubFailed)));
+      LibytProcessControl::Get().GetDataStructureAmr(), fname, prepare_id_list);
+
+  DataHubStatus all_status = static_cast<DataHubStatus>(CallWithoutGil([&] {
+    return CommMpi::CheckAllStates(static_cast<int>(prepared_data.status),
+                                   static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                   static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                   static_cast<int>(DataHubStatus::kDataHubFailed));
+  }));
   if (all_status != DataHubStatus::kDataHubSuccess) {
     if (prepared_data.status == DataHubStatus::kDataHubFailed) {
       return local_amr_data.GetErrorStr();
@@ -44,8 +63,10 @@ static std::string CallFieldRma(const std::string& fname,
   }
 
   // Call MPI RMA operation
-  CommMpiRmaReturn<DataClass> rma_return =
-      rma.GetRemoteData(prepared_data.data_list, fetch_data_list);
+  SetRmaMemoryBudget(rma);
+  CommMpiRmaReturn<DataClass> rma_return = CallWithoutGil([&] {
+    return rma.GetRemoteData(prepared_data.data_list, fetch_data_list);
+  });
   if (rma_return.all_status != CommMpiRmaStatus::kMpiSuccess) {
     if (rma_return.status != CommMpiRmaStatus::kMpiSuccess) {
       return rma.GetErrorStr();
@@ -72,6 +93,8 @@ static std::string CallFieldRma(const std::string& fname,
 //                     get_particle            libyt_particle_get_particle
 //                     get_field_remote        libyt_field_get_field_remote
 //                     get_particle_remote     libyt_particle_get_particle_remote
+//                     get_field_remote_iter   libyt_field_get_field_remote_iter
+//                     get_remote              libyt_get_remote
 //-------------------------------------------------------------------------------------------------------
 
 #ifdef USE_PYBIND11
@@ -153,18 +176,19 @@ pybind11::array DerivedFunc(long gid, const char* field_name) {
 
   // Basic info
   std::vector<long> gid_list = {gid};
-  int dimensionality = LibytProcessControl::Get().data_structure_amr_.GetDimensionality();
+  int dimensionality =
+      LibytProcessControl::Get().GetDataStructureAmr().GetDimensionality();
 
   // Generated data and wrap it based on the dimensionality
   if (dimensionality == 3) {
     std::vector<AmrDataArray3D> storage;
     DataStructureOutput status =
         LibytProcessControl::Get()
-            .data_structure_amr_.GenerateLocalFieldData<AmrDataArray3D>(
+            .GetDataStructureAmr().GenerateLocalFieldData<AmrDataArray3D>(
                 gid_list, field_name, storage);
     if (status.status != DataStructureStatus::kDataStructureSuccess) {
       for (const AmrDataArray3D& kData : storage) {
-        free(kData.data_ptr);
+        memory_tracker::Free(kData.data_ptr);
       }
       if (status.status == DataStructureStatus::kDataStructureNotImplemented) {
         PyErr_SetString(PyExc_NotImplementedError, status.error.c_str());
@@ -188,18 +212,18 @@ pybind11::array DerivedFunc(long gid, const char* field_name) {
            storage[0].data_ptr,
            dtype_size * shape[0] * shape[1] * shape[2]);
     for (const AmrDataArray3D& kData : storage) {
-      free(kData.data_ptr);
+      memory_tracker::Free(kData.data_ptr);
     }
     return static_cast<pybind11::array>(output);
   } else if (dimensionality == 2) {
     std::vector<AmrDataArray2D> storage;
     DataStructureOutput status =
         LibytProcessControl::Get()
-            .data_structure_amr_.GenerateLocalFieldData<AmrDataArray2D>(
+            .GetDataStructureAmr().GenerateLocalFieldData<AmrDataArray2D>(
                 gid_list, field_name, storage);
     if (status.status != DataStructureStatus::kDataStructureSuccess) {
       for (const AmrDataArray2D& kData : storage) {
-        free(kData.data_ptr);
+        memory_tracker::Free(kData.data_ptr);
       }
       if (status.status == DataStructureStatus::kDataStructureNotImplemented) {
         PyErr_SetString(PyExc_NotImplementedError, status.error.c_str());
@@ -219,18 +243,18 @@ pybind11::array DerivedFunc(long gid, const char* field_name) {
     // Copy data from storage to output and then free storage
     memcpy(output.mutable_data(), storage[0].data_ptr, dtype_size * shape[0] * shape[1]);
     for (const AmrDataArray2D& kData : storage) {
-      free(kData.data_ptr);
+      memory_tracker::Free(kData.data_ptr);
     }
     return static_cast<pybind11::array>(output);
   } else {
     std::vector<AmrDataArray1D> storage;
     DataStructureOutput status =
         LibytProcessControl::Get()
-            .data_structure_amr_.GenerateLocalFieldData<AmrDataArray1D>(
+            .GetDataStructureAmr().GenerateLocalFieldData<AmrDataArray1D>(
                 gid_list, field_name, storage);
     if (status.status != DataStructureStatus::kDataStructureSuccess) {
       for (const AmrDataArray1D& kData : storage) {
-        free(kData.data_ptr);
+        memory_tracker::Free(kData.data_ptr);
       }
       if (status.status == DataStructureStatus::kDataStructureNotImplemented) {
         PyErr_SetString(PyExc_NotImplementedError, status.error.c_str());
@@ -250,7 +274,7 @@ pybind11::array DerivedFunc(long gid, const char* field_name) {
     // Copy data from storage to output and then free storage
     memcpy(output.mutable_data(), storage[0].data_ptr, dtype_size * shape[0]);
     for (const AmrDataArray1D& kData : storage) {
-      free(kData.data_ptr);
+      memory_tracker::Free(kData.data_ptr);
     }
     return static_cast<pybind11::array>(output);
   }
@@ -292,11 +316,11 @@ pybind11::array GetParticle(long gid, const char* ptype, const char* attr_name)
   std::vector<long> gid_list = {gid};
   std::vector<AmrDataArray1D> storage;
   DataStructureOutput status =
-      LibytProcessControl::Get().data_structure_amr_.GenerateLocalParticleData(
+      LibytProcessControl::Get().GetDataStructureAmr().GenerateLocalParticleData(
           gid_list, ptype, attr_name, storage);
   if (status.status != DataStructureStatus::kDataStructureSuccess) {
     for (const AmrDataArray1D& kData : storage) {
-      free(kData.data_ptr);
+      memory_tracker::Free(kData.data_ptr);
     }
     if (status.status == DataStructureStatus::kDataStructureNotImplemented) {
       PyErr_SetString(PyExc_NotImplementedError, status.error.c_str());
@@ -323,7 +347,7 @@ pybind11::array GetParticle(long gid, const char* ptype, const char* attr_name)
     // Copy data from storage to output and then free storage
     memcpy(output.mutable_data(), storage[0].data_ptr, dtype_size * shape[0]);
     for (const AmrDataArray1D& kData : storage) {
-      free(kData.data_ptr);
+      memory_tracker::Free(kData.data_ptr);
     }
 
     return static_cast<pybind11::array>(output);
@@ -387,7 +411,8 @@ pybind11::object GetFieldRemote(const pybind11::list& py_fname_list, int len_fna
     prepare_id_list.emplace_back(py_gid.cast<long>());
   }
 
-  int dimensionality = LibytProcessControl::Get().data_structure_amr_.GetDimensionality();
+  int dimensionality =
+      LibytProcessControl::Get().GetDataStructureAmr().GetDimensionality();
 
   // Initialize one CommMpiRma at a time for a field.
   // TODO: Will support distributing multiple types of field after dealing with labeling
@@ -530,35 +555,57 @@ pybind11::object GetParticleRemote(const pybind11::dict& py_ptf,
   // labeling for each of them
   //       And also, get_field_remote/get_particle_remote can be merged once the API to
   //       yt_libyt has changed.
+  const DataStructureAmr& ds_amr = LibytProcessControl::Get().GetDataStructureAmr();
+  std::vector<long> to_prepare_id_list;
+  for (auto& py_gid : py_to_prepare) {
+    to_prepare_id_list.emplace_back(py_gid.cast<long>());
+  }
+  std::vector<long> nonlocal_id_list;
+  for (int i = 0; i < len_nonlocal; i++) {
+    nonlocal_id_list.emplace_back(py_nonlocal_id[i].cast<long>());
+  }
+
   for (auto& py_ptype : py_ptf_keys) {
+    std::string ptype = py_ptype.cast<std::string>();
+
+    // Look up particle count once per ptype, and separate particle count > 0
+    int ptype_index = ds_amr.GetParticleIndex(ptype.c_str());
+    std::vector<long> prepare_count_list, nonlocal_count_list;
+    ds_amr.GetPythonBoundFullHierarchyGridParticleCount(
+        to_prepare_id_list, ptype_index, prepare_count_list);
+    ds_amr.GetPythonBoundFullHierarchyGridParticleCount(
+        nonlocal_id_list, ptype_index, nonlocal_count_list);
+
+    std::vector<long> prepare_id_list;
+    for (std::size_t i = 0; i < to_prepare_id_list.size(); i++) {
+      if (prepare_count_list[i] > 0) {
+        prepare_id_list.emplace_back(to_prepare_id_list[i]);
+      }
+    }
+    std::vector<CommMpiRmaQueryInfo> fetch_data_list;
+    std::vector<long> fetch_particle_count0_list;
+    for (int i = 0; i < len_nonlocal; i++) {
+      if (nonlocal_count_list[i] > 0) {
+        fetch_data_list.emplace_back(
+            CommMpiRmaQueryInfo{py_nonlocal_rank[i].cast<int>(), nonlocal_id_list[i]});
+      } else {
+        fetch_particle_count0_list.emplace_back(nonlocal_id_list[i]);
+      }
+    }
+
     for (auto& py_attr : py_ptf[py_ptype]) {
       // Prepare data for particle count > 0
-      std::string ptype = py_ptype.cast<std::string>();
       std::string attr = py_attr.cast<std::string>();
 
-      std::vector<long> prepare_id_list;
-      for (auto& py_gid : py_to_prepare) {
-        long count;
-        LibytProcessControl::Get()
-            .data_structure_amr_.GetPythonBoundFullHierarchyGridParticleCount(
-                py_gid.cast<long>(), ptype.c_str(), &count);
-        if (count > 0) {
-          prepare_id_list.emplace_back(py_gid.cast<long>());
-        }
-      }
-
       DataHubAmrParticle local_particle_data(false);
       DataHubReturn<AmrDataArray1D> prepared_data =
-          local_particle_data.GetLocalParticleData(
-              LibytProcessControl::Get().data_structure_amr_,
-              ptype,
-              attr,
-              prepare_id_list);
-      DataHubStatus all_status = static_cast<DataHubStatus>(
-          CommMpi::CheckAllStates(static_cast<int>(prepared_data.status),
-                                  static_cast<int>(DataHubStatus::kDataHubSuccess),
-                                  static_cast<int>(DataHubStatus::kDataHubSuccess),
-                                  static_cast<int>(DataHubStatus::kDataHubFailed)));
+          local_particle_data.GetLocalParticleData(ds_amr, ptype, attr, prepare_id_list);
+      DataHubStatus all_status = static_cast<DataHubStatus>(CallWithoutGil([&] {
+        return CommMpi::CheckAllStates(static_cast<int>(prepared_data.status),
+                                       static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                       static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                       static_cast<int>(DataHubStatus::kDataHubFailed));
+      }));
 
       if (all_status != DataHubStatus::kDataHubSuccess) {
         if (prepared_data.status == DataHubStatus::kDataHubFailed) {
@@ -570,26 +617,12 @@ pybind11::object GetParticleRemote(const pybind11::dict& py_ptf,
         throw pybind11::error_already_set();
       }
 
-      // Separate particle count > 0 and create fetch data list
-      std::vector<CommMpiRmaQueryInfo> fetch_data_list;
-      std::vector<long> fetch_particle_count0_list;
-      for (int i = 0; i < len_nonlocal; i++) {
-        long count;
-        LibytProcessControl::Get()
-            .data_structure_amr_.GetPythonBoundFullHierarchyGridParticleCount(
-                py_nonlocal_id[i].cast<long>(), ptype.c_str(), &count);
-        if (count > 0) {
-          fetch_data_list.emplace_back(CommMpiRmaQueryInfo{
-              py_nonlocal_rank[i].cast<int>(), py_nonlocal_id[i].cast<long>()});
-        } else {
-          fetch_particle_count0_list.emplace_back(py_nonlocal_id[i].cast<long>());
-        }
-      }
-
       // Call MPI RMA operation
       CommMpiRmaAmrDataArray1D comm_mpi_rma(ptype + "-" + attr, "amr_particle");
-      CommMpiRmaReturn<AmrDataArray1D> rma_return =
-          comm_mpi_rma.GetRemoteData(prepared_data.data_list, fetch_data_list);
+      SetRmaMemoryBudget(comm_mpi_rma);
+      CommMpiRmaReturn<AmrDataArray1D> rma_return = CallWithoutGil([&] {
+        return comm_mpi_rma.GetRemoteData(prepared_data.data_list, fetch_data_list);
+      });
       if (rma_return.all_status != CommMpiRmaStatus::kMpiSuccess) {
         if (rma_return.status != CommMpiRmaStatus::kMpiSuccess) {
           PyErr_SetString(PyExc_RuntimeError, comm_mpi_rma.GetErrorStr().c_str());
@@ -644,6 +677,188 @@ pybind11::object GetParticleRemote(const pybind11::dict& py_ptf,
 #endif  // #ifndef SERIAL_MODE
 }
 
+#ifndef SERIAL_MODE
+//-------------------------------------------------------------------------------------------------------
+// Class       :  PyRemoteDataIterator
+// Description :  Python iterator returned by get_field_remote_iter.
+//
+// Note        :  1. Each iteration is a collective operation.
+//-------------------------------------------------------------------------------------------------------
+class PyRemoteDataIterator {
+ private:
+  std::unique_ptr<RemoteDataIterator> iterator_;
+
+ public:
+  explicit PyRemoteDataIterator(RemoteDataIterator* iterator) : iterator_(iterator) {}
+  pybind11::object Next() {
+    PyObject* py_chunk;
+    RemoteDataIteratorStatus status = iterator_->Next(&py_chunk);
+    if (status == RemoteDataIteratorStatus::kIteratorEnd) {
+      throw pybind11::stop_iteration();
+    } else if (status == RemoteDataIteratorStatus::kIteratorFailed) {
+      PyErr_SetString(PyExc_RuntimeError, iterator_->GetErrorStr().c_str());
+      throw pybind11::error_already_set();
+    }
+    return pybind11::reinterpret_steal<pybind11::object>(py_chunk);
+  }
+};
+#endif
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetFieldRemoteIter
+// Description :  Get non-local field data from remote ranks chunk by chunk.
+//
+// Note        :  1. Return an iterator, which yields dict obj data[grid id][field_name]
+//                   for each chunk. Chunks are bounded by memory budget in
+//                   yt_param_libyt.
+//                2. Every MPI process must iterate through it until the end, since each
+//                   iteration is a collective operation.
+//                3. Directly return None if it is in SERIAL_MODE.
+//                4. In Python, it is called like:
+//                   for chunk in libyt.get_field_remote_iter(fname_list,
+//                                                            to_prepare,
+//                                                            nonlocal_id,
+//                                                            nonlocal_rank):
+//
+// Parameter   :  iterable obj : fname_list   : list of field name to get.
+//                list obj     : to_prepare   : list of grid ids you need to prepare.
+//                list obj     : nonlocal_id  : nonlocal grid id that you want to get.
+//                list obj     : nonlocal_rank: where to get those nonlocal grid.
+//
+// Return      :  iterator obj, or None if it is serial mode
+//-------------------------------------------------------------------------------------------------------
+pybind11::object GetFieldRemoteIter(const pybind11::iterable& py_fname_list,
+                                    const pybind11::list& py_to_prepare,
+                                    const pybind11::list& py_nonlocal_id,
+                                    const pybind11::list& py_nonlocal_rank) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+#ifndef SERIAL_MODE
+  std::vector<std::string> fname_list;
+  for (auto& py_fname : py_fname_list) {
+    fname_list.emplace_back(py_fname.cast<std::string>());
+  }
+
+  std::vector<long> prepare_id_list;
+  for (auto& py_gid : py_to_prepare) {
+    prepare_id_list.emplace_back(py_gid.cast<long>());
+  }
+
+  if (py_nonlocal_id.size() != py_nonlocal_rank.size()) {
+    throw pybind11::value_error("nonlocal_id and nonlocal_rank have different length.");
+  }
+  std::vector<CommMpiRmaQueryInfo> fetch_data_list;
+  fetch_data_list.reserve(py_nonlocal_id.size());
+  for (std::size_t i = 0; i < py_nonlocal_id.size(); i++) {
+    fetch_data_list.emplace_back(CommMpiRmaQueryInfo{py_nonlocal_rank[i].cast<int>(),
+                                                     py_nonlocal_id[i].cast<long>()});
+  }
+
+  RemoteDataIterator* iterator = CreateRemoteFieldIterator(
+      LibytProcessControl::Get().GetDataStructureAmr().GetDimensionality(),
+      fname_list,
+      prepare_id_list,
+      fetch_data_list);
+  return pybind11::cast(new PyRemoteDataIterator(iterator),
+                        pybind11::return_value_policy::take_ownership);
+#else   // #ifndef SERIAL_MODE
+  return pybind11::none();
+#endif  // #ifndef SERIAL_MODE
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetRemote
+// Description :  Get non-local field and particle data from remote ranks in one
+//                collective round.
+//
+// Note        :  1. Metadata of all the fields and particle attributes is exchanged once,
+//                   and the data is fetched in the same RMA epochs.
+//                2. Every MPI process must request the same fields and particle
+//                   attributes in the same order, since it is a collective operation.
+//                3. Field and particle names can be str or bytes.
+//                4. Directly return None if it is in SERIAL_MODE.
+//                5. In Python, it is called like:
+//                   field_data, particle_data = libyt.get_remote(
+//                       fields=fname_list,
+//                       particles={ptype: [attr1, attr2, ...]},
+//                       to_prepare=to_prepare,
+//                       nonlocal_id=nonlocal_id,
+//                       nonlocal_rank=nonlocal_rank)
+//
+// Parameter   :  iterable obj : fields       : list of field name to get.
+//                dict obj     : particles    : {<ptype>: [<attr1>, <attr2>, ...]}
+//                list obj     : to_prepare   : list of grid ids you need to prepare.
+//                list obj     : nonlocal_id  : nonlocal grid id that you want to get.
+//                list obj     : nonlocal_rank: where to get those nonlocal grid.
+//
+// Return      :  tuple obj (field_data[grid id][field_name],
+//                           particle_data[grid id][ptype][attribute])
+//-------------------------------------------------------------------------------------------------------
+pybind11::object GetRemote(const pybind11::object& py_fields,
+                           const pybind11::object& py_particles,
+                           const pybind11::object& py_to_prepare,
+                           const pybind11::object& py_nonlocal_id,
+                           const pybind11::object& py_nonlocal_rank) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+#ifndef SERIAL_MODE
+  std::vector<std::string> fname_list;
+  if (!py_fields.is_none()) {
+    for (auto& py_fname : pybind11::iterable(py_fields)) {
+      fname_list.emplace_back(py_fname.cast<std::string>());
+    }
+  }
+
+  std::vector<RemoteParticleRequest> particle_list;
+  if (!py_particles.is_none()) {
+    for (auto& py_item : pybind11::dict(py_particles)) {
+      particle_list.emplace_back();
+      particle_list.back().ptype = py_item.first.cast<std::string>();
+      for (auto& py_attr : pybind11::iterable(py_item.second)) {
+        particle_list.back().attr_list.emplace_back(py_attr.cast<std::string>());
+      }
+    }
+  }
+
+  std::vector<long> prepare_id_list;
+  if (!py_to_prepare.is_none()) {
+    for (auto& py_gid : pybind11::iterable(py_to_prepare)) {
+      prepare_id_list.emplace_back(py_gid.cast<long>());
+    }
+  }
+
+  std::vector<CommMpiRmaQueryInfo> fetch_data_list;
+  if (!py_nonlocal_id.is_none()) {
+    pybind11::list py_nonlocal_id_list(py_nonlocal_id);
+    pybind11::list py_nonlocal_rank_list(py_nonlocal_rank);
+    if (py_nonlocal_id_list.size() != py_nonlocal_rank_list.size()) {
+      throw pybind11::value_error("nonlocal_id and nonlocal_rank have different length.");
+    }
+    for (std::size_t i = 0; i < py_nonlocal_id_list.size(); i++) {
+      fetch_data_list.emplace_back(
+          CommMpiRmaQueryInfo{py_nonlocal_rank_list[i].cast<int>(),
+                              py_nonlocal_id_list[i].cast<long>()});
+    }
+  }
+
+  RemoteDataRequest remote_data_request(
+      fname_list, particle_list, prepare_id_list, fetch_data_list);
+  PyObject* py_field_output;
+  PyObject* py_particle_output;
+  if (remote_data_request.Fetch(&py_field_output, &py_particle_output) !=
+      RemoteDataRequestStatus::kRequestSuccess) {
+    PyErr_SetString(PyExc_RuntimeError, remote_data_request.GetErrorStr().c_str());
+    throw pybind11::error_already_set();
+  }
+
+  return pybind11::make_tuple(
+      pybind11::reinterpret_steal<pybind11::object>(py_field_output),
+      pybind11::reinterpret_steal<pybind11::object>(py_particle_output));
+#else   // #ifndef SERIAL_MODE
+  return pybind11::none();
+#endif  // #ifndef SERIAL_MODE
+}
+
 #ifdef SUPPORT_VALGRIND
 pybind11::object DumpValgrindDetailedSnapshot(const char* filename) {
   std::string valgrind_cmd = "detailed_snapshot ";
@@ -663,6 +878,7 @@ PYBIND11_EMBEDDED_MODULE(libyt, m) {
   m.attr("grid_data") = pybind11::dict();
   m.attr("particle_data") = pybind11::dict();
   m.attr("libyt_info") = pybind11::dict();
+  m.attr("perf") = pybind11::dict();
 #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
   m.attr("interactive_mode") = pybind11::dict();
 #endif
@@ -694,6 +910,11 @@ PYBIND11_EMBEDDED_MODULE(libyt, m) {
   m.attr("libyt_info")["SUPPORT_TIMER"] = pybind11::bool_(false);
 #endif
 
+#ifndef SERIAL_MODE
+  // Fortran handle of the libyt communicator, mpi4py gets it through MPI.Comm.f2py
+  m.attr("libyt_info")["mpi_comm"] = pybind11::int_(MPI_Comm_c2f(CommMpi::GetComm()));
+#endif
+
   m.def("derived_func", &DerivedFunc, pybind11::return_value_policy::take_ownership);
   m.def("get_particle", &GetParticle, pybind11::return_value_policy::take_ownership);
   m.def(
@@ -701,6 +922,25 @@ PYBIND11_EMBEDDED_MODULE(libyt, m) {
   m.def("get_particle_remote",
         &GetParticleRemote,
         pybind11::return_value_policy::take_ownership);
+#ifndef SERIAL_MODE
+  pybind11::class_<PyRemoteDataIterator>(m, "RemoteDataIterator")
+      .def("__iter__",
+           [](PyRemoteDataIterator& iterator) -> PyRemoteDataIterator& {
+             return iterator;
+           })
+      .def("__next__", &PyRemoteDataIterator::Next);
+#endif
+  m.def("get_field_remote_iter",
+        &GetFieldRemoteIter,
+        pybind11::return_value_policy::take_ownership);
+  m.def("get_remote",
+        &GetRemote,
+        pybind11::arg("fields") = pybind11::none(),
+        pybind11::arg("particles") = pybind11::none(),
+        pybind11::arg("to_prepare") = pybind11::none(),
+        pybind11::arg("nonlocal_id") = pybind11::none(),
+        pybind11::arg("nonlocal_rank") = pybind11::none(),
+        pybind11::return_value_policy::take_ownership);
 #ifdef SUPPORT_VALGRIND
   m.def("dump_valgrind_detailed_snapshot",
         &DumpValgrindDetailedSnapshot,
@@ -743,18 +983,18 @@ static PyObject* LibytFieldDerivedFunc(PyObject* self, PyObject* args) {
 
   // Grid info
   std::vector<long> gid_list = {gid};
-  int nd = LibytProcessControl::Get().data_structure_amr_.GetDimensionality();
+  int nd = LibytProcessControl::Get().GetDataStructureAmr().GetDimensionality();
 
   // Generate and wrap the data based on the dimension
   if (nd == 3) {
     std::vector<AmrDataArray3D> storage;
     DataStructureOutput status =
         LibytProcessControl::Get()
-            .data_structure_amr_.GenerateLocalFieldData<AmrDataArray3D>(
+            .GetDataStructureAmr().GenerateLocalFieldData<AmrDataArray3D>(
                 gid_list, field_name, storage);
     if (status.status != DataStructureStatus::kDataStructureSuccess) {
       for (const AmrDataArray3D& kData : storage) {
-        free(kData.data_ptr);
+        memory_tracker::Free(kData.data_ptr);
       }
       if (status.status == DataStructureStatus::kDataStructureNotImplemented) {
         PyErr_Format(PyExc_NotImplementedError, status.error.c_str());
@@ -773,11 +1013,11 @@ static PyObject* LibytFieldDerivedFunc(PyObject* self, PyObject* args) {
     std::vector<AmrDataArray2D> storage;
     DataStructureOutput status =
         LibytProcessControl::Get()
-            .data_structure_amr_.GenerateLocalFieldData<AmrDataArray2D>(
+            .GetDataStructureAmr().GenerateLocalFieldData<AmrDataArray2D>(
                 gid_list, field_name, storage);
     if (status.status != DataStructureStatus::kDataStructureSuccess) {
       for (const AmrDataArray2D& kData : storage) {
-        free(kData.data_ptr);
+        memory_tracker::Free(kData.data_ptr);
       }
       if (status.status == DataStructureStatus::kDataStructureNotImplemented) {
         PyErr_Format(PyExc_NotImplementedError, status.error.c_str());
@@ -795,11 +1035,11 @@ static PyObject* LibytFieldDerivedFunc(PyObject* self, PyObject* args) {
     std::vector<AmrDataArray1D> storage;
     DataStructureOutput status =
         LibytProcessControl::Get()
-            .data_structure_amr_.GenerateLocalFieldData<AmrDataArray1D>(
+            .GetDataStructureAmr().GenerateLocalFieldData<AmrDataArray1D>(
                 gid_list, field_name, storage);
     if (status.status != DataStructureStatus::kDataStructureSuccess) {
       for (const AmrDataArray1D& kData : storage) {
-        free(kData.data_ptr);
+        memory_tracker::Free(kData.data_ptr);
       }
       if (status.status == DataStructureStatus::kDataStructureNotImplemented) {
         PyErr_Format(PyExc_NotImplementedError, status.error.c_str());
@@ -856,7 +1096,7 @@ static PyObject* LibytParticleGetParticle(PyObject* self, PyObject* args) {
   std::vector<long> gid_list = {gid};
   std::vector<AmrDataArray1D> storage;
   DataStructureOutput status =
-      LibytProcessControl::Get().data_structure_amr_.GenerateLocalParticleData(
+      LibytProcessControl::Get().GetDataStructureAmr().GenerateLocalParticleData(
           gid_list, ptype, attr_name, storage);
   if (status.status != DataStructureStatus::kDataStructureSuccess) {
     if (status.status == DataStructureStatus::kDataStructureNotImplemented) {
@@ -958,7 +1198,8 @@ static PyObject* LibytFieldGetFieldRemote(PyObject* self, PyObject* args) {
     prepare_id_list.push_back(PyLong_AsLong(py_prepare_grid_id));
   }
 
-  int dimensionality = LibytProcessControl::Get().data_structure_amr_.GetDimensionality();
+  int dimensionality =
+      LibytProcessControl::Get().GetDataStructureAmr().GetDimensionality();
 
   // Create fetch data list
   std::vector<CommMpiRmaQueryInfo> fetch_data_list;
@@ -1161,12 +1402,50 @@ static PyObject* LibytParticleGetParticleRemote(PyObject* self, PyObject* args)
       py_deref_list;  // Dereference these PyObjects for early return when error occurs.
   py_deref_list.push_back(py_ptf_keys);
 
+  // Grid ids are the same for every particle type.
+  const DataStructureAmr& ds_amr = LibytProcessControl::Get().GetDataStructureAmr();
+  std::vector<long> to_prepare_id_list;
+  to_prepare_id_list.reserve(len_prepare);
+  for (int i = 0; i < len_prepare; i++) {
+    to_prepare_id_list.push_back(PyLong_AsLong(PyList_GetItem(py_prepare_list, i)));
+  }
+  std::vector<long> to_get_id_list;
+  to_get_id_list.reserve(len_to_get);
+  for (long i = 0; i < len_to_get; i++) {
+    to_get_id_list.push_back(PyLong_AsLong(PyList_GetItem(py_to_get_list, i)));
+  }
+
   // Run through all the py_ptf_dict and its value.
   PyObject* py_ptype;
   while ((py_ptype = PyIter_Next(py_ptf_keys))) {
     py_deref_list.push_back(py_ptype);
     char* ptype = PyBytes_AsString(py_ptype);
 
+    // Look up particle count once per ptype, and separate particle count > 0
+    int ptype_index = ds_amr.GetParticleIndex(ptype);
+    std::vector<long> prepare_count_list, to_get_count_list;
+    ds_amr.GetPythonBoundFullHierarchyGridParticleCount(
+        to_prepare_id_list, ptype_index, prepare_count_list);
+    ds_amr.GetPythonBoundFullHierarchyGridParticleCount(
+        to_get_id_list, ptype_index, to_get_count_list);
+
+    std::vector<long> prepare_id_list;
+    for (int i = 0; i < len_prepare; i++) {
+      if (prepare_count_list[i] > 0) {
+        prepare_id_list.push_back(to_prepare_id_list[i]);
+      }
+    }
+    std::vector<CommMpiRmaQueryInfo> fetch_data_list;
+    std::vector<long> fetch_particle_count0_list;
+    for (long i = 0; i < len_to_get; i++) {
+      if (to_get_count_list[i] > 0) {
+        int get_rank = (int)PyLong_AsLong(PyList_GetItem(py_get_rank_list, i));
+        fetch_data_list.emplace_back(CommMpiRmaQueryInfo{get_rank, to_get_id_list[i]});
+      } else {
+        fetch_particle_count0_list.emplace_back(to_get_id_list[i]);
+      }
+    }
+
     // Get attribute list inside key ptype in py_ptf_dict.
     PyObject* py_value = PyDict_GetItem(py_ptf_dict, py_ptype);
     PyObject* py_attr_iter = PyObject_GetIter(py_value);
@@ -1179,31 +1458,15 @@ static PyObject* LibytParticleGetParticleRemote(PyObject* self, PyObject* args)
       char* attr = PyBytes_AsString(py_attribute);
 
       // Prepare data for particle count > 0
-      std::vector<long> prepare_id_list;
-      prepare_id_list.reserve(len_prepare);
-      for (int i = 0; i < len_prepare; i++) {
-        PyObject* py_prepare_id = PyList_GetItem(py_prepare_list, i);
-        long gid = PyLong_AsLong(py_prepare_id);
-        long count;
-        LibytProcessControl::Get()
-            .data_structure_amr_.GetPythonBoundFullHierarchyGridParticleCount(
-                gid, ptype, &count);
-        if (count > 0) {
-          prepare_id_list.push_back(gid);
-        }
-      }
       DataHubAmrParticle local_particle_data(false);
       DataHubReturn<AmrDataArray1D> prepared_data =
-          local_particle_data.GetLocalParticleData(
-              LibytProcessControl::Get().data_structure_amr_,
-              ptype,
-              attr,
-              prepare_id_list);
-      DataHubStatus all_status = static_cast<DataHubStatus>(
-          CommMpi::CheckAllStates(static_cast<int>(prepared_data.status),
-                                  static_cast<int>(DataHubStatus::kDataHubSuccess),
-                                  static_cast<int>(DataHubStatus::kDataHubSuccess),
-                                  static_cast<int>(DataHubStatus::kDataHubFailed)));
+          local_particle_data.GetLocalParticleData(ds_amr, ptype, attr, prepare_id_list);
+      DataHubStatus all_status = static_cast<DataHubStatus>(CallWithoutGil([&] {
+        return CommMpi::CheckAllStates(static_cast<int>(prepared_data.status),
+                                       static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                       static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                       static_cast<int>(DataHubStatus::kDataHubFailed));
+      }));
       if (all_status != DataHubStatus::kDataHubSuccess) {
         if (prepared_data.status == DataHubStatus::kDataHubFailed) {
           PyErr_SetString(PyExc_RuntimeError, local_particle_data.GetErrorStr().c_str());
@@ -1216,30 +1479,13 @@ static PyObject* LibytParticleGetParticleRemote(PyObject* self, PyObject* args)
         return NULL;
       }
 
-      // Create fetch data list and separate particle count > 0
-      std::vector<CommMpiRmaQueryInfo> fetch_data_list;
-      std::vector<long> fetch_particle_count0_list;
-      for (int i = 0; i < len_to_get; i++) {
-        PyObject* py_get_id = PyList_GetItem(py_to_get_list, i);
-        PyObject* py_get_rank = PyList_GetItem(py_get_rank_list, i);
-        long get_gid = PyLong_AsLong(py_get_id);
-        int get_rank = (int)PyLong_AsLong(py_get_rank);
-        long count;
-        LibytProcessControl::Get()
-            .data_structure_amr_.GetPythonBoundFullHierarchyGridParticleCount(
-                get_gid, ptype, &count);
-        if (count > 0) {
-          fetch_data_list.emplace_back(CommMpiRmaQueryInfo{get_rank, get_gid});
-        } else {
-          fetch_particle_count0_list.emplace_back(get_gid);
-        }
-      }
-
       // Call Mpi RMA operation
       std::string rma_name = std::string(ptype) + "-" + std::string(attr);
       CommMpiRmaAmrDataArray1D comm_mpi_rma(rma_name, "amr_particle");
-      CommMpiRmaReturn<AmrDataArray1D> rma_return =
-          comm_mpi_rma.GetRemoteData(prepared_data.data_list, fetch_data_list);
+      SetRmaMemoryBudget(comm_mpi_rma);
+      CommMpiRmaReturn<AmrDataArray1D> rma_return = CallWithoutGil([&] {
+        return comm_mpi_rma.GetRemoteData(prepared_data.data_list, fetch_data_list);
+      });
       if (rma_return.all_status != CommMpiRmaStatus::kMpiSuccess) {
         if (rma_return.status != CommMpiRmaStatus::kMpiSuccess) {
           PyErr_SetString(PyExc_RuntimeError, comm_mpi_rma.GetErrorStr().c_str());
@@ -1339,6 +1585,288 @@ static PyObject* LibytParticleGetParticleRemote(PyObject* self, PyObject* args)
 #endif  // #ifndef SERIAL_MODE
 }
 
+#ifndef SERIAL_MODE
+//-------------------------------------------------------------------------------------------------------
+// Description :  libyt.RemoteDataIterator Python type
+//
+// Note        :  1. Python iterator returned by libyt.get_field_remote_iter, it owns a
+//                   RemoteDataIterator.
+//                2. Each iteration is a collective operation.
+//-------------------------------------------------------------------------------------------------------
+typedef struct {
+  PyObject_HEAD RemoteDataIterator* iterator;
+} LibytRemoteDataIteratorObject;
+
+static void LibytRemoteDataIteratorDealloc(PyObject* self) {
+  delete reinterpret_cast<LibytRemoteDataIteratorObject*>(self)->iterator;
+  Py_TYPE(self)->tp_free(self);
+}
+
+static PyObject* LibytRemoteDataIteratorNext(PyObject* self) {
+  RemoteDataIterator* iterator =
+      reinterpret_cast<LibytRemoteDataIteratorObject*>(self)->iterator;
+  PyObject* py_chunk;
+  RemoteDataIteratorStatus status = iterator->Next(&py_chunk);
+  if (status == RemoteDataIteratorStatus::kIteratorFailed) {
+    PyErr_SetString(PyExc_RuntimeError, iterator->GetErrorStr().c_str());
+    return NULL;
+  }
+  // Return NULL without setting error raises StopIteration when it ends.
+  return py_chunk;
+}
+
+static PyTypeObject libyt_remote_data_iterator_type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "libyt.RemoteDataIterator", /* tp_name */
+    sizeof(LibytRemoteDataIteratorObject),                     /* tp_basicsize */
+};
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : GetStringFromPyObject
+// Description     : Get string from Python str or bytes object.
+//-------------------------------------------------------------------------------------------------------
+static const char* GetStringFromPyObject(PyObject* py_str) {
+  if (PyUnicode_Check(py_str)) {
+    return PyUnicode_AsUTF8(py_str);
+  }
+  return PyBytes_AsString(py_str);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : GetStringListFromPyObject
+// Description     : Get list of strings from Python iterable of str or bytes objects.
+//
+// Notes           : 1. Return false and set Python error if it fails.
+//-------------------------------------------------------------------------------------------------------
+static bool GetStringListFromPyObject(PyObject* py_iterable,
+                                      std::vector<std::string>& str_list) {
+  PyObject* py_iter = PyObject_GetIter(py_iterable);
+  if (py_iter == NULL) {
+    return false;
+  }
+  PyObject* py_str;
+  while ((py_str = PyIter_Next(py_iter))) {
+    const char* str = GetStringFromPyObject(py_str);
+    if (str != NULL) {
+      str_list.emplace_back(str);
+    }
+    Py_DECREF(py_str);
+    if (str == NULL) {
+      Py_DECREF(py_iter);
+      return false;
+    }
+  }
+  Py_DECREF(py_iter);
+  return !PyErr_Occurred();
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  libyt_field_get_field_remote_iter
+// Description :  Get non-local field data from remote ranks chunk by chunk.
+//
+// Note        :  1. Return an iterator, which yields dict obj data[grid id][field_name]
+//                   for each chunk. Chunks are bounded by memory budget in
+//                   yt_param_libyt.
+//                2. Every MPI process must iterate through it until the end, since each
+//                   iteration is a collective operation.
+//                3. Directly return None if it is in SERIAL_MODE.
+//                4. In Python, it is called like:
+//                   for chunk in libyt.get_field_remote_iter(fname_list,
+//                                                            to_prepare,
+//                                                            nonlocal_id,
+//                                                            nonlocal_rank):
+//
+// Parameter   :  iterable obj : fname_list   : list of field name to get.
+//                list obj     : to_prepare   : list of grid ids you need to prepare.
+//                list obj     : nonlocal_id  : nonlocal grid id that you want to get.
+//                list obj     : nonlocal_rank: where to get those nonlocal grid.
+//
+// Return      :  libyt.RemoteDataIterator obj
+//-------------------------------------------------------------------------------------------------------
+static PyObject* LibytFieldGetFieldRemoteIter(PyObject* self, PyObject* args) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+#ifndef SERIAL_MODE
+  PyObject* py_fname_list;
+  PyObject* py_prepare_list;
+  PyObject* py_get_id_list;
+  PyObject* py_get_rank_list;
+  if (!PyArg_ParseTuple(args,
+                        "OOOO",
+                        &py_fname_list,
+                        &py_prepare_list,
+                        &py_get_id_list,
+                        &py_get_rank_list) ||
+      !PyList_Check(py_prepare_list) || !PyList_Check(py_get_id_list) ||
+      !PyList_Check(py_get_rank_list) ||
+      PyList_Size(py_get_id_list) != PyList_Size(py_get_rank_list)) {
+    PyErr_SetString(PyExc_TypeError,
+                    "Wrong input type, "
+                    "expect to be "
+                    "libyt.get_field_remote_iter(iter, list, list, list).\n");
+    return NULL;
+  }
+
+  // Get field name list
+  std::vector<std::string> fname_list;
+  if (!GetStringListFromPyObject(py_fname_list, fname_list)) {
+    return NULL;
+  }
+
+  // Create prepare id list and fetch data list
+  std::vector<long> prepare_id_list;
+  prepare_id_list.reserve(PyList_Size(py_prepare_list));
+  for (Py_ssize_t i = 0; i < PyList_Size(py_prepare_list); i++) {
+    prepare_id_list.push_back(PyLong_AsLong(PyList_GetItem(py_prepare_list, i)));
+  }
+  std::vector<CommMpiRmaQueryInfo> fetch_data_list;
+  fetch_data_list.reserve(PyList_Size(py_get_id_list));
+  for (Py_ssize_t i = 0; i < PyList_Size(py_get_id_list); i++) {
+    fetch_data_list.push_back(CommMpiRmaQueryInfo{
+        static_cast<int>(PyLong_AsLong(PyList_GetItem(py_get_rank_list, i))),
+        PyLong_AsLong(PyList_GetItem(py_get_id_list, i))});
+  }
+
+  // Create iterator
+  LibytRemoteDataIteratorObject* py_iterator = PyObject_New(
+      LibytRemoteDataIteratorObject, &libyt_remote_data_iterator_type);
+  if (py_iterator == NULL) {
+    return NULL;
+  }
+  py_iterator->iterator = CreateRemoteFieldIterator(
+      LibytProcessControl::Get().GetDataStructureAmr().GetDimensionality(),
+      fname_list,
+      prepare_id_list,
+      fetch_data_list);
+
+  return reinterpret_cast<PyObject*>(py_iterator);
+#else   // #ifndef SERIAL_MODE
+  Py_RETURN_NONE;
+#endif  // #ifndef SERIAL_MODE
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  libyt_get_remote
+// Description :  Get non-local field and particle data from remote ranks in one
+//                collective round.
+//
+// Note        :  1. Metadata of all the fields and particle attributes is exchanged once,
+//                   and the data is fetched in the same RMA epochs.
+//                2. Every MPI process must request the same fields and particle
+//                   attributes in the same order, since it is a collective operation.
+//                3. Field and particle names can be str or bytes.
+//                4. Directly return None if it is in SERIAL_MODE.
+//                5. In Python, it is called like:
+//                   field_data, particle_data = libyt.get_remote(
+//                       fields=fname_list,
+//                       particles={ptype: [attr1, attr2, ...]},
+//                       to_prepare=to_prepare,
+//                       nonlocal_id=nonlocal_id,
+//                       nonlocal_rank=nonlocal_rank)
+//
+// Parameter   :  iterable obj : fields       : list of field name to get.
+//                dict obj     : particles    : {<ptype>: [<attr1>, <attr2>, ...]}
+//                list obj     : to_prepare   : list of grid ids you need to prepare.
+//                list obj     : nonlocal_id  : nonlocal grid id that you want to get.
+//                list obj     : nonlocal_rank: where to get those nonlocal grid.
+//
+// Return      :  tuple obj (field_data[grid id][field_name],
+//                           particle_data[grid id][ptype][attribute])
+//-------------------------------------------------------------------------------------------------------
+static PyObject* LibytGetRemote(PyObject* self, PyObject* args, PyObject* kwargs) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+#ifndef SERIAL_MODE
+  static const char* kwlist[] = {
+      "fields", "particles", "to_prepare", "nonlocal_id", "nonlocal_rank", NULL};
+  PyObject* py_fields = Py_None;
+  PyObject* py_particles = Py_None;
+  PyObject* py_prepare_list = Py_None;
+  PyObject* py_get_id_list = Py_None;
+  PyObject* py_get_rank_list = Py_None;
+  if (!PyArg_ParseTupleAndKeywords(args,
+                                   kwargs,
+                                   "|OOOOO",
+                                   const_cast<char**>(kwlist),
+                                   &py_fields,
+                                   &py_particles,
+                                   &py_prepare_list,
+                                   &py_get_id_list,
+                                   &py_get_rank_list) ||
+      (py_particles != Py_None && !PyDict_Check(py_particles)) ||
+      (py_prepare_list != Py_None && !PyList_Check(py_prepare_list)) ||
+      (py_get_id_list == Py_None) != (py_get_rank_list == Py_None) ||
+      (py_get_id_list != Py_None &&
+       (!PyList_Check(py_get_id_list) || !PyList_Check(py_get_rank_list) ||
+        PyList_Size(py_get_id_list) != PyList_Size(py_get_rank_list)))) {
+    PyErr_SetString(PyExc_TypeError,
+                    "Wrong input type, "
+                    "expect to be libyt.get_remote(fields=iter, particles=dict, "
+                    "to_prepare=list, nonlocal_id=list, nonlocal_rank=list).\n");
+    return NULL;
+  }
+
+  // Get field name list and particle attribute list
+  std::vector<std::string> fname_list;
+  if (py_fields != Py_None && !GetStringListFromPyObject(py_fields, fname_list)) {
+    return NULL;
+  }
+  std::vector<RemoteParticleRequest> particle_list;
+  if (py_particles != Py_None) {
+    PyObject* py_ptype;
+    PyObject* py_attr_list;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(py_particles, &pos, &py_ptype, &py_attr_list)) {
+      const char* ptype = GetStringFromPyObject(py_ptype);
+      if (ptype == NULL) {
+        return NULL;
+      }
+      particle_list.emplace_back();
+      particle_list.back().ptype = ptype;
+      if (!GetStringListFromPyObject(py_attr_list, particle_list.back().attr_list)) {
+        return NULL;
+      }
+    }
+  }
+
+  // Create prepare id list and fetch data list
+  std::vector<long> prepare_id_list;
+  if (py_prepare_list != Py_None) {
+    prepare_id_list.reserve(PyList_Size(py_prepare_list));
+    for (Py_ssize_t i = 0; i < PyList_Size(py_prepare_list); i++) {
+      prepare_id_list.push_back(PyLong_AsLong(PyList_GetItem(py_prepare_list, i)));
+    }
+  }
+  std::vector<CommMpiRmaQueryInfo> fetch_data_list;
+  if (py_get_id_list != Py_None) {
+    fetch_data_list.reserve(PyList_Size(py_get_id_list));
+    for (Py_ssize_t i = 0; i < PyList_Size(py_get_id_list); i++) {
+      fetch_data_list.push_back(CommMpiRmaQueryInfo{
+          static_cast<int>(PyLong_AsLong(PyList_GetItem(py_get_rank_list, i))),
+          PyLong_AsLong(PyList_GetItem(py_get_id_list, i))});
+    }
+  }
+
+  // Fetch and wrap data
+  RemoteDataRequest remote_data_request(
+      fname_list, particle_list, prepare_id_list, fetch_data_list);
+  PyObject* py_field_output;
+  PyObject* py_particle_output;
+  if (remote_data_request.Fetch(&py_field_output, &py_particle_output) !=
+      RemoteDataRequestStatus::kRequestSuccess) {
+    PyErr_SetString(PyExc_RuntimeError, remote_data_request.GetErrorStr().c_str());
+    return NULL;
+  }
+  PyObject* py_output = PyTuple_Pack(2, py_field_output, py_particle_output);
+  Py_DECREF(py_field_output);
+  Py_DECREF(py_particle_output);
+
+  return py_output;
+#else   // #ifndef SERIAL_MODE
+  Py_RETURN_NONE;
+#endif  // #ifndef SERIAL_MODE
+}
+
 #ifdef SUPPORT_VALGRIND
 static PyObject* LibytDumpValgrindDetailedSnapshot(PyObject* self, PyObject* args) {
   char* filename;
@@ -1390,6 +1918,14 @@ static PyMethodDef libyt_method_list[] = {
      LibytParticleGetParticleRemote,
      METH_VARARGS,
      "Get remote particle attribute data."},
+    {"get_field_remote_iter",
+     LibytFieldGetFieldRemoteIter,
+     METH_VARARGS,
+     "Get remote field data chunk by chunk."},
+    {"get_remote",
+     (PyCFunction)(void (*)(void))LibytGetRemote,
+     METH_VARARGS | METH_KEYWORDS,
+     "Get remote field and particle data in one collective round."},
 #ifdef SUPPORT_VALGRIND
     {"dump_valgrind_detailed_snapshot",
      LibytDumpValgrindDetailedSnapshot,
@@ -1407,6 +1943,18 @@ static struct PyModuleDef libyt_module_definition = {
 static PyObject* PyInitLibyt(void) {
   SET_TIMER(__PRETTY_FUNCTION__);
 
+#ifndef SERIAL_MODE
+  // Set up Python types defined in libyt module
+  libyt_remote_data_iterator_type.tp_dealloc = LibytRemoteDataIteratorDealloc;
+  libyt_remote_data_iterator_type.tp_flags = Py_TPFLAGS_DEFAULT;
+  libyt_remote_data_iterator_type.tp_doc = "Iterator of remote data chunks.";
+  libyt_remote_data_iterator_type.tp_iter = PyObject_SelfIter;
+  libyt_remote_data_iterator_type.tp_iternext = LibytRemoteDataIteratorNext;
+  if (PyType_Ready(&libyt_remote_data_iterator_type) < 0) {
+    YT_ABORT("Initializing libyt.RemoteDataIterator type ... failed!\n");
+  }
+#endif
+
   // Create libyt module
   PyObject* libyt_module = PyModule_Create(&libyt_module_definition);
   if (libyt_module != nullptr) {
@@ -1424,6 +1972,7 @@ static PyObject* PyInitLibyt(void) {
   LibytProcessControl::Get().py_param_yt_ = PyDict_New();
   LibytProcessControl::Get().py_param_user_ = PyDict_New();
   LibytProcessControl::Get().py_libyt_info_ = PyDict_New();
+  LibytProcessControl::Get().py_perf_ = PyDict_New();
 #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
   LibytProcessControl::Get().py_interactive_mode_ = PyDict_New();
 #endif
@@ -1460,6 +2009,12 @@ static PyObject* PyInitLibyt(void) {
   PyDict_SetItemString(
       LibytProcessControl::Get().py_libyt_info_, "SUPPORT_TIMER", Py_False);
 #endif
+#ifndef SERIAL_MODE
+  // Fortran handle of the libyt communicator, mpi4py gets it through MPI.Comm.f2py
+  PyObject* py_mpi_comm = PyLong_FromLong(MPI_Comm_c2f(CommMpi::GetComm()));
+  PyDict_SetItemString(LibytProcessControl::Get().py_libyt_info_, "mpi_comm", py_mpi_comm);
+  Py_DECREF(py_mpi_comm);
+#endif
 
   // add dict object to libyt python module
   PyModule_AddObject(libyt_module, "grid_data", py_grid_data);
@@ -1470,6 +2025,7 @@ static PyObject* PyInitLibyt(void) {
       libyt_module, "param_user", LibytProcessControl::Get().py_param_user_);
   PyModule_AddObject(
       libyt_module, "libyt_info", LibytProcessControl::Get().py_libyt_info_);
+  PyModule_AddObject(libyt_module, "perf", LibytProcessControl::Get().py_perf_);
 #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
   PyModule_AddObject(
       libyt_module, "interactive_mode", LibytProcessControl::Get().py_interactive_mode_);
@@ -9,6 +9,7 @@
 #include "function_info.h"
 #include "libyt_process_control.h"
 #include "logging.h"
+#include "python_profiler.h"
 #include "timer.h"
 
 static std::vector<std::string> GenerateErrMsg(
@@ -610,7 +611,7 @@ PythonStatus LibytPythonShell::AllExecute(int python_input_type, const std::stri
                                           const std::string& cell_base_name, int src_rank,
                                           std::vector<PythonOutput>& output,
                                           int output_mpi_rank) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerPythonExec);
 
 #ifndef SERIAL_MODE
   // Sync the code and cell name
@@ -668,8 +669,10 @@ PythonStatus LibytPythonShell::AllExecute(int python_input_type, const std::stri
   PyObject* py_src = Py_CompileString(code_ptr, cell_base_name_ptr, python_input_type);
   bool has_error = false;
   if (py_src != NULL) {
+    python_profiler::Start(cell_base_name_ptr);
     PyObject* py_dump =
         PyEval_EvalCode(py_src, GetExecutionNamespace(), GetExecutionNamespace());
+    python_profiler::Stop();
     if (PyErr_Occurred()) {
       has_error = true;
       PyErr_Print();
@@ -771,7 +774,7 @@ PythonStatus LibytPythonShell::AllExecutePrompt(const std::string& code,
                                                 int src_rank,
                                                 std::vector<PythonOutput>& output,
                                                 int output_mpi_rank) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerPythonExec);
 
   PythonStatus status = AllExecute(
       Py_single_input, code, cell_base_name, src_rank, output, output_mpi_rank);
@@ -791,7 +794,7 @@ PythonStatus LibytPythonShell::AllExecuteFile(const std::string& code,
                                               int src_rank,
                                               std::vector<PythonOutput>& output,
                                               int output_mpi_rank) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerPythonExec);
 
   PythonStatus status =
       AllExecute(Py_file_input, code, cell_base_name, src_rank, output, output_mpi_rank);
@@ -823,7 +826,7 @@ PythonStatus LibytPythonShell::AllExecuteCell(const std::string& code,
                                               int src_rank,
                                               std::vector<PythonOutput>& output,
                                               int output_mpi_rank) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerPythonExec);
 
   // Parse the code using ast and separate the last statement on src_rank only
   std::array<std::string, 2> code_split = {std::string(""), std::string("")};
@@ -833,7 +836,7 @@ PythonStatus LibytPythonShell::AllExecuteCell(const std::string& code,
 
     // Early return if the code is invalid or its empty
 #ifndef SERIAL_MODE
-    MPI_Bcast(&last_statement_lineno, 1, MPI_LONG, src_rank, MPI_COMM_WORLD);
+    MPI_Bcast(&last_statement_lineno, 1, MPI_LONG, src_rank, CommMpi::GetComm());
 #endif
     if (last_statement_lineno > 0) {
       SplitOnLine(code, last_statement_lineno - 1, code_split);
@@ -849,7 +852,7 @@ PythonStatus LibytPythonShell::AllExecuteCell(const std::string& code,
   }
 #ifndef SERIAL_MODE
   else {
-    MPI_Bcast(&last_statement_lineno, 1, MPI_LONG, src_rank, MPI_COMM_WORLD);
+    MPI_Bcast(&last_statement_lineno, 1, MPI_LONG, src_rank, CommMpi::GetComm());
   }
 #endif
 
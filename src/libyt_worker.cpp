@@ -15,7 +15,7 @@
 // Notes       :  1. Assume only non-root rank will call this class.
 //
 // Arguments   :  int myrank : my MPI process num
-//                int mysize : my MPI size in MPI_COMM_WORLD
+//                int mysize : my MPI size in the libyt communicator
 //                int root   : MPI root rank
 //-------------------------------------------------------------------------------------------------------
 LibytWorker::LibytWorker(int myrank, int mysize, int root)
@@ -40,7 +40,7 @@ void LibytWorker::start() {
   bool done = false;
   while (!done) {
     int indicator;
-    MPI_Bcast(&indicator, 1, MPI_INT, m_mpi_root, MPI_COMM_WORLD);
+    MPI_Bcast(&indicator, 1, MPI_INT, m_mpi_root, CommMpi::GetComm());
 
     // Dispatch jobs
     switch (indicator) {
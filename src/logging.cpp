@@ -1,10 +1,189 @@
+#include "logging.h"
+
 #include <stdarg.h>
 
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
 #include "libyt_process_control.h"
+#include "node_aggregation.h"
 
 // width of log prefix ==> [LogPrefixWidth] messages
 static const int kLogPrefixWidth = 10;
 
+// Max number of distinct messages buffered on a process between two flushes
+static const std::size_t kMaxLogRecords = 1024;
+
+// Separators of fields and records when gathering buffered messages
+static const char kFieldSeparator = '\x1f';
+static const char kRecordSeparator = '\x1e';
+
+struct LogRecord {
+  std::string level;
+  std::string message;
+  long count;
+};
+
+// Buffered messages of this process, unflushed messages are written out at exit.
+class LogBuffer {
+ public:
+  bool aggregate_ = false;
+  std::string log_file_;
+  int mpi_rank_ = 0;
+  std::vector<LogRecord> record_list_;
+  std::unordered_map<std::string, std::size_t> record_index_;
+  long num_dropped_ = 0;
+  std::mutex mutex_;
+
+  ~LogBuffer() {
+    for (const LogRecord& record : record_list_) {
+      if (record.level != "YT_INFO" && record.level != "YT_ERROR") {
+        fprintf(stderr,
+                "[%-*s] rank %d: %s",
+                kLogPrefixWidth,
+                record.level.c_str(),
+                mpi_rank_,
+                record.message.c_str());
+      }
+    }
+    fflush(stderr);
+  }
+};
+static LogBuffer log_buffer;
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  FormatMessage
+// Description :  Format variable argument list to a string.
+//-------------------------------------------------------------------------------------------------------
+static std::string FormatMessage(const char* format, va_list arg) {
+  va_list arg_copy;
+  va_copy(arg_copy, arg);
+  int length = vsnprintf(nullptr, 0, format, arg_copy);
+  va_end(arg_copy);
+  if (length < 0) {
+    return std::string(format);
+  }
+  std::vector<char> buffer(length + 1);
+  vsnprintf(buffer.data(), buffer.size(), format, arg);
+  return std::string(buffer.data(), length);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  BufferMessage
+// Description :  Buffer message of level, identical messages are counted once.
+//-------------------------------------------------------------------------------------------------------
+static void BufferMessage(const char* level, const std::string& message) {
+  std::lock_guard<std::mutex> lock(log_buffer.mutex_);
+  std::string key = std::string(level) + kFieldSeparator + message;
+  auto it = log_buffer.record_index_.find(key);
+  if (it != log_buffer.record_index_.end()) {
+    log_buffer.record_list_[it->second].count++;
+  } else if (log_buffer.record_list_.size() < kMaxLogRecords) {
+    log_buffer.record_index_[key] = log_buffer.record_list_.size();
+    log_buffer.record_list_.push_back({level, message, 1});
+  } else {
+    log_buffer.num_dropped_++;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  WriteMessage
+// Description :  Write message of level to stream right away.
+//-------------------------------------------------------------------------------------------------------
+static void WriteMessage(FILE* stream, const char* level, const std::string& message) {
+  // flush previous messages
+  fflush(stream);
+
+  fprintf(stream, "[%-*s] %s", kLogPrefixWidth, level, message.c_str());
+  fflush(stream);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  LogMessage
+// Description :  Write message of level to stream, or buffer it if aggregation is on.
+//-------------------------------------------------------------------------------------------------------
+static void LogMessage(FILE* stream, const char* level, const char* format,
+                       va_list arg) {
+  std::string message = FormatMessage(format, arg);
+  if (log_buffer.aggregate_) {
+    BufferMessage(level, message);
+    return;
+  }
+  WriteMessage(stream, level, message);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  LogErrorMessage
+// Description :  Write error message to stderr right away, and also buffer it if
+//                aggregation is on.
+//
+// Note        :  1. Errors are never held back, since the caller usually returns YT_FAIL
+//                   and the simulation may abort before the next Flush.
+//-------------------------------------------------------------------------------------------------------
+static void LogErrorMessage(const std::string& message) {
+  if (log_buffer.aggregate_) {
+    BufferMessage("YT_ERROR", message);
+  }
+  WriteMessage(stderr, "YT_ERROR", message);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetRankRanges
+// Description :  Compress a sorted rank list to ranges, e.g. "0-3,7".
+//-------------------------------------------------------------------------------------------------------
+static std::string GetRankRanges(const std::vector<int>& rank_list) {
+  std::string ranges;
+  std::size_t i = 0;
+  while (i < rank_list.size()) {
+    std::size_t j = i;
+    while (j + 1 < rank_list.size() && rank_list[j + 1] == rank_list[j] + 1) {
+      j++;
+    }
+    ranges += (ranges.empty() ? "" : ",") + std::to_string(rank_list[i]);
+    if (j > i) {
+      ranges += "-" + std::to_string(rank_list[j]);
+    }
+    i = j + 1;
+  }
+  return ranges;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  EscapeJson
+// Description :  Escape string to be put inside double quotes in JSON.
+//-------------------------------------------------------------------------------------------------------
+static std::string EscapeJson(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char hex[8];
+          snprintf(hex, sizeof(hex), "\\u%04x", c);
+          escaped += hex;
+        } else {
+          escaped += c;
+        }
+    }
+  }
+  return escaped;
+}
+
 namespace logging {
 //-------------------------------------------------------------------------------------------------------
 // Function    :  LogInfo
@@ -18,7 +197,9 @@ namespace logging {
 //                3. Use the variable argument lists provided in "stdarg"
 //                   --> It is equivalent to call "fprintf( stdout, format, ... ); fflush(
 //                   Type );"
-//                4. Print INFO only in root rank.
+//                4. Print INFO only in root rank, and never in node members.
+//                5. INFO is always printed right away, and is also buffered for the log
+//                   file if it is set.
 //
 // Parameter   :  format : Output format
 //                ...    : Arguments in vfprintf
@@ -27,17 +208,26 @@ namespace logging {
 //-------------------------------------------------------------------------------------------------------
 void LogInfo(const char* format, ...) {
   if (LibytProcessControl::Get().mpi_rank_ != 0) return;
+  if (node_aggregation::IsMember()) return;
 
   // work only for verbose level >= YT_VERBOSE_INFO
   if (LibytProcessControl::Get().param_libyt_.verbose < YT_VERBOSE_INFO) return;
 
-  // flush previous messages
-  fflush(stdout);
-
   // print messages
   va_list arg;
   va_start(arg, format);
 
+  // keep a copy for log file
+  if (!log_buffer.log_file_.empty()) {
+    va_list arg_copy;
+    va_copy(arg_copy, arg);
+    BufferMessage("YT_INFO", FormatMessage(format, arg_copy));
+    va_end(arg_copy);
+  }
+
+  // flush previous messages
+  fflush(stdout);
+
   fprintf(stdout, "[%-*s] ", kLogPrefixWidth, "YT_INFO");
   vfprintf(stdout, format, arg);
   fflush(stdout);
@@ -53,6 +243,7 @@ void LogInfo(const char* format, ...) {
 // YT_VERBOSE_WARNING
 //                2. Messages are printed out to standard output with a prefix
 //                "[YT_WARNING] "
+//                3. Messages are buffered if aggregation is on.
 //
 // Parameter   :  format : Output format
 //                ...    : Arguments in vfprintf
@@ -63,17 +254,10 @@ void LogWarning(const char* format, ...) {
   // work only for verbose level >= YT_VERBOSE_WARNING
   if (LibytProcessControl::Get().param_libyt_.verbose < YT_VERBOSE_WARNING) return;
 
-  // flush previous messages
-  fflush(stderr);
-
   // print messages
   va_list arg;
   va_start(arg, format);
-
-  fprintf(stderr, "[%-*s] ", kLogPrefixWidth, "YT_WARNING");
-  vfprintf(stderr, format, arg);
-  fflush(stderr);
-
+  LogMessage(stderr, "YT_WARNING", format, arg);
   va_end(arg);
 }
 
@@ -85,6 +269,7 @@ void LogWarning(const char* format, ...) {
 // YT_VERBOSE_DEBUG
 //                2. Messages are printed out to standard output with a prefix "[YT_DEBUG]
 //                "
+//                3. Messages are buffered if aggregation is on.
 //
 // Parameter   :  format : Output format
 //                ...    : Arguments in vfprintf
@@ -95,17 +280,10 @@ void LogDebug(const char* format, ...) {
   // work only for verbose level >= YT_VERBOSE_DEBUG
   if (LibytProcessControl::Get().param_libyt_.verbose < YT_VERBOSE_DEBUG) return;
 
-  // flush previous messages
-  fflush(stderr);
-
   // print messages
   va_list arg;
   va_start(arg, format);
-
-  fprintf(stderr, "[%-*s] ", kLogPrefixWidth, "YT_DEBUG");
-  vfprintf(stderr, format, arg);
-  fflush(stderr);
-
+  LogMessage(stderr, "YT_DEBUG", format, arg);
   va_end(arg);
 }
 
@@ -118,9 +296,10 @@ void LogDebug(const char* format, ...) {
 //                   verbose level
 //                2. Messages are printed out to standard error with a prefix "[YT_ERROR]
 //                "
-//                3. A convenient macro "YT_ABORT" is defined in yt_macro.h, which calls
-//                LogError, print
-//                   out the line number, and returns YT_FAIL
+//                3. A convenient macro "YT_ABORT" is defined in logging.h, which calls
+//                   LogErrorAt to print out the line number, and returns YT_FAIL
+//                4. Messages are still printed right away if aggregation is on, and are
+//                   also buffered for the aggregated summary and the log file.
 //
 // Parameter   :  format : Output format
 //                ...    : Arguments in vfprintf
@@ -128,18 +307,175 @@ void LogDebug(const char* format, ...) {
 // Return      :  None
 //-------------------------------------------------------------------------------------------------------
 void LogError(const char* format, ...) {
-  // flush previous messages
-  fflush(stderr);
-
   // print messages
   va_list arg;
   va_start(arg, format);
+  std::string message = FormatMessage(format, arg);
+  va_end(arg);
+  LogErrorMessage(message);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  LogErrorAt
+// Description :  Print out error messages with the location where it happens
+//
+// Note        :  1. Same as LogError, followed by a line of file, line, and function.
+//                   Both lines are a single message if aggregation is on.
+//                2. Used by YT_ABORT.
+//-------------------------------------------------------------------------------------------------------
+void LogErrorAt(const char* file, int line, const char* function, const char* format,
+                ...) {
+  va_list arg;
+  va_start(arg, format);
+  std::string message = FormatMessage(format, arg);
+  va_end(arg);
+
+  char location[512];
+  snprintf(location,
+           sizeof(location),
+           "%13s==> file <%s>, line <%d>, function <%s>\n",
+           "",
+           file,
+           line,
+           function);
+
+  LogErrorMessage(message + location);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SetAggregation
+// Description :  Turn on or off aggregation of messages, and set the JSON-lines log file
+//
+// Note        :  1. A non-empty log_file turns on aggregation, since only flushed
+//                   messages are written to it.
+//                2. Should be set to the same value on every MPI process, since Flush is
+//                   a collective operation only when aggregation is on.
+//-------------------------------------------------------------------------------------------------------
+void SetAggregation(bool aggregate, const std::string& log_file) {
+  std::lock_guard<std::mutex> lock(log_buffer.mutex_);
+  log_buffer.aggregate_ = aggregate || !log_file.empty();
+  log_buffer.log_file_ = log_file;
+#ifndef SERIAL_MODE
+  log_buffer.mpi_rank_ = CommMpi::mpi_rank_;
+#endif
+}
 
-  fprintf(stderr, "[%-*s] ", kLogPrefixWidth, "YT_ERROR");
-  vfprintf(stderr, format, arg);
+//-------------------------------------------------------------------------------------------------------
+// Function    :  IsAggregated
+// Description :  Return true if messages are buffered and written out by Flush.
+//-------------------------------------------------------------------------------------------------------
+bool IsAggregated() { return log_buffer.aggregate_; }
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  Flush
+// Description :  Gather buffered messages of every MPI process to root, and write each
+//                distinct message once
+//
+// Note        :  1. Collective operation if aggregation is on, otherwise it does nothing.
+//                2. Messages are ordered by their first appearance in rank order. Each is
+//                   written as "[<level>] N ranks: <message>", or "rank r: <message>" if
+//                   only one process logs it.
+//                3. If the log file is set, each message is appended as a JSON line
+//                   {"level", "ranks", "num_ranks", "count", "message"}, where ranks are
+//                   ranges like "0-3,7" and count is the total over processes.
+//-------------------------------------------------------------------------------------------------------
+void Flush() {
+  if (!log_buffer.aggregate_) {
+    return;
+  }
+
+  // Serialize buffered messages of this process
+  std::string local_records;
+  {
+    std::lock_guard<std::mutex> lock(log_buffer.mutex_);
+    if (log_buffer.num_dropped_ > 0) {
+      log_buffer.record_list_.push_back(
+          {"YT_WARNING",
+           std::to_string(log_buffer.num_dropped_) +
+               " log messages dropped, too many distinct messages.\n",
+           1});
+    }
+    for (const LogRecord& record : log_buffer.record_list_) {
+      local_records += record.level + kFieldSeparator + std::to_string(record.count) +
+                       kFieldSeparator + record.message + kRecordSeparator;
+    }
+    log_buffer.record_list_.clear();
+    log_buffer.record_index_.clear();
+    log_buffer.num_dropped_ = 0;
+  }
+
+  std::vector<std::string> all_records;
+#ifndef SERIAL_MODE
+  CommMpi::GatherAllStringsToRank(all_records, local_records, CommMpi::mpi_root_);
+  if (CommMpi::mpi_rank_ != CommMpi::mpi_root_) {
+    return;
+  }
+#else
+  all_records.push_back(local_records);
+#endif
+
+  // Merge identical messages from different processes
+  struct MergedRecord {
+    std::string level;
+    std::string message;
+    long count;
+    std::vector<int> rank_list;
+  };
+  std::vector<MergedRecord> merged_list;
+  std::unordered_map<std::string, std::size_t> merged_index;
+  for (std::size_t r = 0; r < all_records.size(); r++) {
+    std::istringstream stream(all_records[r]);
+    std::string record;
+    while (std::getline(stream, record, kRecordSeparator)) {
+      std::size_t first = record.find(kFieldSeparator);
+      std::size_t second = record.find(kFieldSeparator, first + 1);
+      if (first == std::string::npos || second == std::string::npos) {
+        continue;
+      }
+      std::string level = record.substr(0, first);
+      long count = std::stol(record.substr(first + 1, second - first - 1));
+      std::string message = record.substr(second + 1);
+      std::string key = level + kFieldSeparator + message;
+      auto it = merged_index.find(key);
+      if (it == merged_index.end()) {
+        merged_index[key] = merged_list.size();
+        merged_list.push_back({level, message, count, {static_cast<int>(r)}});
+      } else {
+        merged_list[it->second].count += count;
+        merged_list[it->second].rank_list.push_back(static_cast<int>(r));
+      }
+    }
+  }
+
+  // Write messages, info is printed already, and errors are written again as a summary
+  for (const MergedRecord& merged : merged_list) {
+    if (merged.level == "YT_INFO") {
+      continue;
+    }
+    int num_ranks = static_cast<int>(merged.rank_list.size());
+    fprintf(stderr, "[%-*s] ", kLogPrefixWidth, merged.level.c_str());
+    if (num_ranks == 1) {
+      fprintf(stderr, "rank %d: %s", merged.rank_list[0], merged.message.c_str());
+    } else {
+      fprintf(stderr, "%d ranks: %s", num_ranks, merged.message.c_str());
+    }
+  }
   fflush(stderr);
 
-  va_end(arg);
+  if (!log_buffer.log_file_.empty() && !merged_list.empty()) {
+    std::ofstream file(log_buffer.log_file_, std::ios::out | std::ios::app);
+    for (const MergedRecord& merged : merged_list) {
+      std::string message = merged.message;
+      if (!message.empty() && message.back() == '\n') {
+        message.pop_back();
+      }
+      file << "{\"level\": \"" << merged.level << "\", \"ranks\": \""
+           << GetRankRanges(merged.rank_list)
+           << "\", \"num_ranks\": " << merged.rank_list.size()
+           << ", \"count\": " << merged.count << ", \"message\": \""
+           << EscapeJson(message) << "\"}\n";
+    }
+  }
 }
 
 }  // namespace logging
@@ -36,6 +36,59 @@ static std::vector<std::string> SplitBySpace(const std::string& code) {
   return output;
 }
 
+//-------------------------------------------------------------------------------------------------------
+// Method      :  GetLoadImbalanceStr
+// Description :  Get max/mean time over MPI processes and the slowest rank in the
+//                previous call, ex: "1.25 (3)"
+//
+// Notes       :  1. Return "-" if the function has not been executed in this step.
+//
+// Arguments   :  FunctionInfo& function_info : inline function
+//
+// Return      :  std::string
+//-------------------------------------------------------------------------------------------------------
+static std::string GetLoadImbalanceStr(FunctionInfo& function_info) {
+  if (!function_info.HasLoadImbalance()) {
+    return std::string("-");
+  }
+
+  const PerfLoadImbalance& load_imbalance = function_info.GetLoadImbalance();
+  double ratio = (load_imbalance.mean > 0.0) ? load_imbalance.max / load_imbalance.mean
+                                              : 1.0;
+  char dest[64];
+  snprintf(dest, sizeof(dest), "%.2f (%d)", ratio, load_imbalance.max_rank);
+  return std::string(dest);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Method      :  GetLoadImbalanceDetailStr
+// Description :  Get time spent in the previous call over MPI processes in one line
+//
+// Notes       :  1. Return empty string if the function has not been executed in this
+//                   step.
+//
+// Arguments   :  FunctionInfo& function_info : inline function
+//
+// Return      :  std::string
+//-------------------------------------------------------------------------------------------------------
+static std::string GetLoadImbalanceDetailStr(FunctionInfo& function_info) {
+  if (!function_info.HasLoadImbalance()) {
+    return std::string();
+  }
+
+  const PerfLoadImbalance& load_imbalance = function_info.GetLoadImbalance();
+  char dest[256];
+  snprintf(dest,
+           sizeof(dest),
+           "max/mean = %.3f/%.3f sec, slowest on MPI rank %d, max wait at barrier = "
+           "%.3f sec",
+           load_imbalance.max,
+           load_imbalance.mean,
+           load_imbalance.max_rank,
+           load_imbalance.wait_max);
+  return std::string(dest);
+}
+
 MagicCommand::MagicCommand(EntryPoint entry_point)
     : output_(), entry_point_(entry_point), command_undefined_(true) {
   SET_TIMER(__PRETTY_FUNCTION__);
@@ -117,6 +170,8 @@ MagicCommandOutput& MagicCommand::Run(const std::string& command) {
       write_to_history = SetFunctionRun(code_list);
     } else if (code_list[1] == "idle") {
       write_to_history = SetFunctionIdle(code_list);
+    } else if (code_list[1] == "profile") {
+      write_to_history = SetProfile(code_list);
     }
   }
 
@@ -217,7 +272,8 @@ int MagicCommand::GetStatusHtml() {
       "style=\"color:#F1C40F;font-weight:bold;font-family:'arial'\">X</span></td>";
 
   output_.output += "<table style=\"width: 100%\"><tr><th>Inline "
-                    "Function</th><th>Status</th><th>Run</th></tr>";
+                    "Function</th><th>Status</th><th>Run</th><th>Max/Mean "
+                    "(Rank)</th></tr>";
 
   for (int i = 0; i < LibytProcessControl::Get().function_info_list_.GetSize(); i++) {
     // Get function name
@@ -248,6 +304,12 @@ int MagicCommand::GetStatusHtml() {
       output_.output += kWillIdleCell;
     }
 
+    // Get load imbalance of the previous call
+    output_.output +=
+        std::string("<td>") +
+        GetLoadImbalanceStr(LibytProcessControl::Get().function_info_list_[i]) +
+        std::string("</td>");
+
     output_.output += "</tr>";
   }
 
@@ -298,22 +360,22 @@ int MagicCommand::GetStatusText() {
     output_.output += "\033[1;37m";
   }
 
+  const std::string kSeparatorLine = std::string(80, '=') + std::string("\n");
   snprintf(dest,
            kStringMaxSize,
-           "==========================================================================\n"
-           "  %-40s     %-12s   %s\n"
-           "--------------------------------------------------------------------------\n",
+           "  %-32s     %-12s   %-8s   %s\n",
            "Inline Function",
            "Status",
-           "Run/Idle");
-  output_.output += dest;
+           "Run/Idle",
+           "Max/Mean (Rank)");
+  output_.output += kSeparatorLine + dest + std::string(80, '-') + std::string("\n");
 
   for (int i = 0; i < LibytProcessControl::Get().function_info_list_.GetSize(); i++) {
     // Get function name
     snprintf_return = snprintf(
         dest,
         kStringMaxSize,
-        "  * %-43s",
+        "  * %-35s",
         LibytProcessControl::Get().function_info_list_[i].GetFunctionName().c_str());
     if (entry_point_ == kLibytInteractiveMode) {
       output_.output += "\033[1;37m";
@@ -349,17 +411,21 @@ int MagicCommand::GetStatusText() {
       output_.output += kX;
     }
 
+    // Get load imbalance of the previous call
+    if (entry_point_ == kLibytInteractiveMode) {
+      output_.output += "\033[0;37m";
+    }
+    output_.output +=
+        std::string("         ") +
+        GetLoadImbalanceStr(LibytProcessControl::Get().function_info_list_[i]);
+
     output_.output += "\n";
   }
 
   if (entry_point_ == kLibytInteractiveMode) {
-    output_.output +=
-        "\033[1;37m"
-        "==========================================================================\n"
-        "\033[0;37m";
+    output_.output += std::string("\033[1;37m") + kSeparatorLine + "\033[0;37m";
   } else {
-    output_.output +=
-        "==========================================================================\n";
+    output_.output += kSeparatorLine;
   }
 
   return YT_SUCCESS;
@@ -397,7 +463,9 @@ int MagicCommand::GetHelpMsgMarkdown() {
       "| run | function_name [arg1, arg2, ...] | Run `function_name` automatically by "
       "calling "
       "`function_name(arg1, arg2, ...)`. Arguments are optional. |\n"
-      "| idle | function_name | Make `function_name` idle. |");
+      "| idle | function_name | Make `function_name` idle. |\n"
+      "| profile | on/off [category1,category2,...] | Turn on/off time profiling of "
+      "categories, default is all of them. |");
 
   return YT_SUCCESS;
 }
@@ -439,7 +507,9 @@ int MagicCommand::GetHelpMsgText() {
                      "<function>(args) automatically in next iteration.\n"
                      "  \033[32;1midle  \033[1;31m  <function>  \033[0;37m              "
                      "Make <function> idle in next "
-                     "iteration.\n";
+                     "iteration.\n"
+                     "  \033[32;1mprofile\033[1;31m on/off     \033[0;37m "
+                     "[\033[1;31mcategory,...\033[0;37m] Turn on/off time profiling.\n";
   } else {
     output_.output =
         "Usage:  %libyt COMMAND\n"
@@ -452,7 +522,8 @@ int MagicCommand::GetHelpMsgText() {
         "  status  <function>               Get <function> status.\n"
         "  run     <function>  [arg1, ...]  Run <function>(args) automatically in next "
         "iteration.\n"
-        "  idle    <function>               Make <function> idle in next iteration.\n";
+        "  idle    <function>               Make <function> idle in next iteration.\n"
+        "  profile on/off [category,...]    Turn on/off time profiling.\n";
   }
 
   return YT_SUCCESS;
@@ -502,7 +573,7 @@ int MagicCommand::LoadScript(const std::vector<std::string>& args) {
     if (!stream) {
 #ifndef SERIAL_MODE
       int indicator = -1;
-      MPI_Bcast(&indicator, 1, MPI_INT, mpi_root_, MPI_COMM_WORLD);
+      MPI_Bcast(&indicator, 1, MPI_INT, mpi_root_, CommMpi::GetComm());
 #endif
       output_.status = "Error";
       output_.error = std::string("File ") + args[2] + std::string("doesn't exist.\n");
@@ -524,7 +595,7 @@ int MagicCommand::LoadScript(const std::vector<std::string>& args) {
       // Run file and format output from the results, and check if Python run successfully
 #ifndef SERIAL_MODE
       int indicator = 1;
-      MPI_Bcast(&indicator, 1, MPI_INT, mpi_root_, MPI_COMM_WORLD);
+      MPI_Bcast(&indicator, 1, MPI_INT, mpi_root_, CommMpi::GetComm());
 #endif
       std::vector<PythonOutput> output;
       PythonStatus all_execute_status =
@@ -588,7 +659,7 @@ int MagicCommand::LoadScript(const std::vector<std::string>& args) {
     } else {
 #ifndef SERIAL_MODE
       int indicator = -1;
-      MPI_Bcast(&indicator, 1, MPI_INT, mpi_root_, MPI_COMM_WORLD);
+      MPI_Bcast(&indicator, 1, MPI_INT, mpi_root_, CommMpi::GetComm());
 #endif
       output_.status = "Error";
       output_.error = code_validity.error_msg + std::string("\n");
@@ -601,7 +672,7 @@ int MagicCommand::LoadScript(const std::vector<std::string>& args) {
   else {
     // return YT_FAIL if no file found or file cannot compile
     int indicator;
-    MPI_Bcast(&indicator, 1, MPI_INT, mpi_root_, MPI_COMM_WORLD);
+    MPI_Bcast(&indicator, 1, MPI_INT, mpi_root_, CommMpi::GetComm());
 
     if (indicator < 0) {
       output_.status = "Error";
@@ -860,6 +931,14 @@ int MagicCommand::GetFunctionStatusMarkdown(const std::vector<std::string>& args
       output_.output += std::string("_Idle_\n");
     }
 
+    // Load imbalance
+    std::string load_imbalance_str =
+        GetLoadImbalanceDetailStr(LibytProcessControl::Get().function_info_list_[index]);
+    if (!load_imbalance_str.empty()) {
+      output_.output += std::string("- **Load imbalance in previous call:** ") +
+                        load_imbalance_str + std::string("\n");
+    }
+
     // Function call in next iteration
     output_.output += std::string("- **Function call in next iteration:** ");
     if (LibytProcessControl::Get().function_info_list_[index].GetRun() ==
@@ -984,6 +1063,18 @@ int MagicCommand::GetFunctionStatusText(const std::vector<std::string>& args) {
       output_.output += std::string("idle\n");
     }
 
+    // Get load imbalance
+    std::string load_imbalance_str =
+        GetLoadImbalanceDetailStr(LibytProcessControl::Get().function_info_list_[index]);
+    if (!load_imbalance_str.empty()) {
+      if (entry_point_ == kLibytInteractiveMode) {
+        output_.output += std::string("\033[1;35m[Load Imbalance]\033[0;37m\n");
+      } else {
+        output_.output += std::string("[Load Imbalance]\n");
+      }
+      output_.output += std::string("  ") + load_imbalance_str + std::string("\n");
+    }
+
     // Get function definition
     if (entry_point_ == kLibytInteractiveMode) {
       output_.output += std::string("\033[1;35m[Function Def]\033[0;37m\n");
@@ -1054,4 +1145,59 @@ int MagicCommand::GetFunctionStatusText(const std::vector<std::string>& args) {
   return YT_SUCCESS;
 }
 
+
+//-------------------------------------------------------------------------------------------------------
+// Class      :  MagicCommand
+// Method     :  SetProfile
+//
+// Notes      :  1. Turn on/off time profiling of categories at runtime, every MPI process
+//                  sets its own categories.
+//               2. If categories are not given, turn on/off all of them. Without on/off,
+//                  print enabled categories.
+//
+// Arguments  :  const std::vector<std::string>& args : Full magic commands. (ex: %libyt
+// profile on rma,commit)
+//
+// Return     :  YT_SUCCESS or YT_FAIL
+//-------------------------------------------------------------------------------------------------------
+int MagicCommand::SetProfile(const std::vector<std::string>& args) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  command_undefined_ = false;
+
+  const char* usage =
+      "Usage: %libyt profile on/off [category1,category2,...]\n"
+      "Description: Turn on/off time profiling of categories, default is all of them.\n"
+      "Categories: general, commit, hierarchy, rma, python-exec, derived-func\n";
+
+  unsigned int enabled = TimerControl::GetEnabledCategories();
+  if (args.size() == 2) {
+    output_.status = "Success";
+    output_.output = std::string("Profiling categories: ") +
+                     TimerControl::GetCategoriesStr(enabled) + std::string("\n");
+    return YT_SUCCESS;
+  }
+
+  unsigned int categories = kTimerAll;
+  if (args.size() > 4 || (args[2] != "on" && args[2] != "off") ||
+      (args.size() == 4 && !TimerControl::ParseCategories(args[3], &categories))) {
+    output_.status = "Error";
+    output_.error = std::string(usage);
+    return YT_FAIL;
+  }
+
+  if (args[2] == "on") {
+    enabled |= categories;
+  } else {
+    enabled &= ~categories;
+  }
+  TimerControl::SetEnabledCategories(enabled);
+
+  output_.status = "Success";
+  output_.output = std::string("Profiling categories: ") +
+                   TimerControl::GetCategoriesStr(enabled) + std::string("\n");
+
+  return YT_SUCCESS;
+}
+
 #endif  // #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
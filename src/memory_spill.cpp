@@ -0,0 +1,94 @@
+#include "memory_spill.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+// Size of every spill buffer that is still mapped, keyed by its address.
+static std::unordered_map<void*, long> spill_buffer_size_map;
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_spill
+// Function name : AllocateSpillBuffer
+//
+// Notes         :  1. Create a temporary file under spill_dir, resize it to size bytes,
+//                     and map it to memory with MAP_SHARED, so that dirty pages can be
+//                     written back to the file instead of staying resident.
+//                  2. The file is unlinked right after it is mapped.
+//                  3. Return nullptr if any of the steps failed or size <= 0.
+//-------------------------------------------------------------------------------------------------------
+void* memory_spill::AllocateSpillBuffer(const std::string& spill_dir, long size) {
+  if (size <= 0 || spill_dir.empty()) {
+    return nullptr;
+  }
+
+  std::string file_template = spill_dir + std::string("/libyt_spill_XXXXXX");
+  std::vector<char> file_name(file_template.begin(), file_template.end());
+  file_name.push_back('\0');
+
+  int fd = mkstemp(file_name.data());
+  if (fd < 0) {
+    return nullptr;
+  }
+  unlink(file_name.data());
+
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    return nullptr;
+  }
+
+  spill_buffer_size_map[ptr] = size;
+  return ptr;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_spill
+// Function name : IsSpillBuffer
+//
+// Notes         :  1. Check if ptr is allocated by AllocateSpillBuffer and is not freed
+//                     yet.
+//-------------------------------------------------------------------------------------------------------
+bool memory_spill::IsSpillBuffer(void* ptr) {
+  return spill_buffer_size_map.find(ptr) != spill_buffer_size_map.end();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_spill
+// Function name : ReleaseResidentPages
+//
+// Notes         :  1. Write the pages back to the backing file and drop them from
+//                     memory. Data is read back from the file when it is accessed again.
+//                  2. Do nothing if ptr is not a spill buffer.
+//-------------------------------------------------------------------------------------------------------
+void memory_spill::ReleaseResidentPages(void* ptr) {
+  auto it = spill_buffer_size_map.find(ptr);
+  if (it == spill_buffer_size_map.end()) {
+    return;
+  }
+  msync(ptr, it->second, MS_SYNC);
+  madvise(ptr, it->second, MADV_DONTNEED);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_spill
+// Function name : FreeSpillBuffer
+//
+// Notes         :  1. Unmap the spill buffer. Do nothing if ptr is not a spill buffer.
+//-------------------------------------------------------------------------------------------------------
+void memory_spill::FreeSpillBuffer(void* ptr) {
+  auto it = spill_buffer_size_map.find(ptr);
+  if (it == spill_buffer_size_map.end()) {
+    return;
+  }
+  munmap(ptr, it->second);
+  spill_buffer_size_map.erase(it);
+}
@@ -0,0 +1,213 @@
+#include "memory_tracker.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "logging.h"
+
+// Name of each category, in the same order as MemoryCategory.
+static const char* kMemoryCategoryNames[] = {"hierarchy", "data_hub", "rma"};
+static const int kNumMemoryCategories =
+    sizeof(kMemoryCategoryNames) / sizeof(kMemoryCategoryNames[0]);
+
+// Category and size of every tracked allocation, keyed by its address.
+static std::unordered_map<const void*, std::pair<int, std::size_t>> allocation_map;
+static std::size_t current_bytes[kNumMemoryCategories] = {0};
+static std::size_t peak_bytes[kNumMemoryCategories] = {0};
+static std::size_t total_current_bytes = 0;
+static std::size_t total_peak_bytes = 0;
+static std::mutex allocation_mutex;
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetCounterName
+// Description :  Get perf counter name "memory.<category>.<suffix>"
+//-------------------------------------------------------------------------------------------------------
+static std::string GetCounterName(const char* category_name, const char* suffix) {
+  return std::string("memory.") + category_name + "." + suffix;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  TrackAddress
+// Description :  Add size bytes at address to category, and update the peak.
+//
+// Notes       :  1. The address is passed by value instead of a pointer, so that the
+//                   compiler does not assume the newly allocated buffer is read here.
+//                2. If address is already tracked, it was freed without being untracked
+//                   and is reused, so the old entry is dropped first.
+//-------------------------------------------------------------------------------------------------------
+static void TrackAddress(MemoryCategory category, std::uintptr_t address,
+                         std::size_t size) {
+  const void* ptr = reinterpret_cast<const void*>(address);
+  int c = static_cast<int>(category);
+  std::lock_guard<std::mutex> lock(allocation_mutex);
+  auto it = allocation_map.find(ptr);
+  if (it != allocation_map.end()) {
+    current_bytes[it->second.first] -= it->second.second;
+    total_current_bytes -= it->second.second;
+  }
+  allocation_map[ptr] = std::make_pair(c, size);
+
+  current_bytes[c] += size;
+  total_current_bytes += size;
+  if (current_bytes[c] > peak_bytes[c]) {
+    peak_bytes[c] = current_bytes[c];
+  }
+  if (total_current_bytes > total_peak_bytes) {
+    total_peak_bytes = total_current_bytes;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : Allocate
+//
+// Notes         :  1. Allocate size bytes using malloc, and track it under category.
+//                  2. Return nullptr if malloc failed, in which case nothing is tracked.
+//-------------------------------------------------------------------------------------------------------
+void* memory_tracker::Allocate(MemoryCategory category, std::size_t size) {
+  void* ptr = malloc(size);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  TrackAddress(category, reinterpret_cast<std::uintptr_t>(ptr), size);
+  return ptr;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : Free
+//
+// Notes         :  1. Untrack and free ptr allocated by Allocate.
+//-------------------------------------------------------------------------------------------------------
+void memory_tracker::Free(void* ptr) {
+  Untrack(ptr);
+  free(ptr);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : Track
+//
+// Notes         :  1. Add size bytes to category, and update the peak.
+//-------------------------------------------------------------------------------------------------------
+void memory_tracker::Track(MemoryCategory category, const void* ptr, std::size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  TrackAddress(category, reinterpret_cast<std::uintptr_t>(ptr), size);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : Untrack
+//
+// Notes         :  1. Subtract the size of ptr from its category, do nothing if it is not
+//                     tracked.
+//-------------------------------------------------------------------------------------------------------
+void memory_tracker::Untrack(const void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(allocation_mutex);
+  auto it = allocation_map.find(ptr);
+  if (it == allocation_map.end()) {
+    return;
+  }
+  current_bytes[it->second.first] -= it->second.second;
+  total_current_bytes -= it->second.second;
+  allocation_map.erase(it);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : GetCurrentBytes
+//-------------------------------------------------------------------------------------------------------
+std::size_t memory_tracker::GetCurrentBytes(MemoryCategory category) {
+  std::lock_guard<std::mutex> lock(allocation_mutex);
+  return current_bytes[static_cast<int>(category)];
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : GetPeakBytes
+//-------------------------------------------------------------------------------------------------------
+std::size_t memory_tracker::GetPeakBytes(MemoryCategory category) {
+  std::lock_guard<std::mutex> lock(allocation_mutex);
+  return peak_bytes[static_cast<int>(category)];
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : GetTotalPeakBytes
+//
+// Notes         :  1. Peak of the sum over every category, which can be smaller than the
+//                     sum of each category's peak.
+//-------------------------------------------------------------------------------------------------------
+std::size_t memory_tracker::GetTotalPeakBytes() {
+  std::lock_guard<std::mutex> lock(allocation_mutex);
+  return total_peak_bytes;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : ResetPeak
+//
+// Notes         :  1. Reset peaks to the current bytes.
+//-------------------------------------------------------------------------------------------------------
+void memory_tracker::ResetPeak() {
+  std::lock_guard<std::mutex> lock(allocation_mutex);
+  for (int c = 0; c < kNumMemoryCategories; c++) {
+    peak_bytes[c] = current_bytes[c];
+  }
+  total_peak_bytes = total_current_bytes;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : AddToPerfCounters
+//
+// Notes         :  1. Add "memory.<category>.current_bytes" and
+//                     "memory.<category>.peak_bytes" of every category, and
+//                     "memory.total.peak_bytes" to perf counters.
+//-------------------------------------------------------------------------------------------------------
+void memory_tracker::AddToPerfCounters() {
+  std::lock_guard<std::mutex> lock(allocation_mutex);
+  for (int c = 0; c < kNumMemoryCategories; c++) {
+    perf_counter::Add(GetCounterName(kMemoryCategoryNames[c], "current_bytes"),
+                      static_cast<double>(current_bytes[c]));
+    perf_counter::Add(GetCounterName(kMemoryCategoryNames[c], "peak_bytes"),
+                      static_cast<double>(peak_bytes[c]));
+  }
+  perf_counter::Add(GetCounterName("total", "peak_bytes"),
+                    static_cast<double>(total_peak_bytes));
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : memory_tracker
+// Function name : LogPeak
+//
+// Notes         :  1. Log the max peak over MPI processes of every category, and the rank
+//                     holding it, using the reduced perf counters.
+//-------------------------------------------------------------------------------------------------------
+void memory_tracker::LogPeak(const std::vector<PerfCounterSummary>& summary_list) {
+  for (int c = 0; c <= kNumMemoryCategories; c++) {
+    const char* category_name = (c < kNumMemoryCategories) ? kMemoryCategoryNames[c]
+                                                           : "total";
+    std::string name = GetCounterName(category_name, "peak_bytes");
+    for (const PerfCounterSummary& summary : summary_list) {
+      if (summary.name == name) {
+        logging::LogInfo("Peak memory of %s = %.0f bytes on MPI rank %d (mean %.0f)\n",
+                         category_name,
+                         summary.max,
+                         summary.max_rank,
+                         summary.mean);
+        break;
+      }
+    }
+  }
+}
@@ -0,0 +1,552 @@
+#include "node_aggregation.h"
+
+#ifndef SERIAL_MODE
+#include <mpi.h>
+
+#include "comm_mpi.h"
+#endif
+
+#include <cstring>
+#include <vector>
+
+#include "dtype_utilities.h"
+#include "libyt.h"
+#include "libyt_process_control.h"
+#include "logging.h"
+#include "perf_counter.h"
+#include "timer.h"
+
+#ifndef SERIAL_MODE
+// Field data of a local grid in the shared memory window, offset is in bytes from the
+// start of the segment of the node member, or -1 if there is no data.
+struct SharedFieldData {
+  yt_data field_data;
+  long offset;
+};
+
+// Data a node member copies or generates to its segment after it is allocated.
+struct SharedDataCopy {
+  long offset;
+  long num_bytes;
+  long data_len;
+  const void* src;  // nullptr if it is generated by derived_func or get_par_attr
+  long gid;
+  int field_index;  // -1 if it is a particle attribute
+  int ptype_index;
+  int attr_index;
+};
+
+static bool enabled = false;
+static bool is_leader = false;
+static int num_grids_own = 0;
+static MPI_Comm node_comm = MPI_COMM_NULL;
+static MPI_Comm group_comm = MPI_COMM_NULL;
+static MPI_Win shared_win = MPI_WIN_NULL;
+
+// Segment of a node member starts with the number of grids, followed by a record of
+// fixed size for each grid, and then the data.
+static const long kHeaderSize = sizeof(long);
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetRecordSize
+// Description :  Get the size of the record of a local grid in the shared memory window.
+//
+// Notes       :  1. A record is yt_grid, par_count_list, SharedFieldData of each field,
+//                   and the offset of each particle attribute.
+//                2. Keep every record aligned to 8 bytes.
+//-------------------------------------------------------------------------------------------------------
+static long GetRecordSize(const yt_param_yt& param_yt) {
+  long size = sizeof(yt_grid) + param_yt.num_par_types * sizeof(long) +
+              param_yt.num_fields * sizeof(SharedFieldData);
+  for (int p = 0; p < param_yt.num_par_types; p++) {
+    size += param_yt.par_type_list[p].num_attr * sizeof(long);
+  }
+  return (size + 7) / 8 * 8;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ResolveFieldData
+// Description :  Resolve the data type and dimensions of field v in a local grid, and
+//                get its size in bytes.
+//
+// Notes       :  1. Derived fields are generated by node members, and are shared with
+//                   the dimensions of the grid.
+//                2. Data dimensions are resolved the same way as binding local data to
+//                   Python. Extra dimensions are filled with 1.
+//                3. num_bytes is 0 if there is no data. data_ptr is set to nullptr if the
+//                   data is generated.
+//-------------------------------------------------------------------------------------------------------
+static int ResolveFieldData(const yt_grid& grid, int v, yt_data* field_data,
+                            long* num_bytes, long* data_len) {
+  LibytProcessControl& control = LibytProcessControl::Get();
+  const yt_field& field = control.data_structure_amr_.GetFieldList()[v];
+  const int dimensionality = control.param_yt_.dimensionality;
+  const bool is_derived = (strcmp(field.field_type, "derived_func") == 0);
+
+  *field_data = grid.field_data[v];
+  *num_bytes = 0;
+  *data_len = 0;
+  if (!is_derived && field_data->data_ptr == nullptr) {
+    return YT_SUCCESS;
+  }
+  if (is_derived && field.derived_func == nullptr) {
+    return YT_SUCCESS;
+  }
+
+  if (is_derived) {
+    field_data->data_ptr = nullptr;
+  }
+  if (is_derived || dtype_utilities::GetYtDtypeSize(field_data->data_dtype) <= 0) {
+    field_data->data_dtype = field.field_dtype;
+  }
+  if (is_derived || strcmp(field.field_type, "cell-centered") == 0) {
+    for (int d = 0; d < dimensionality; d++) {
+      const int dim = field.contiguous_in_x ? (dimensionality - 1) - d : d;
+      field_data->data_dimensions[d] = grid.grid_dimensions[dim];
+    }
+    for (int d = 0; d < 2 * dimensionality && !is_derived; d++) {
+      field_data->data_dimensions[d / 2] += field.field_ghost_cell[d];
+    }
+  }
+  for (int d = dimensionality; d < 3; d++) {
+    field_data->data_dimensions[d] = 1;
+  }
+
+  long len = 1;
+  for (int d = 0; d < dimensionality; d++) {
+    len *= field_data->data_dimensions[d];
+  }
+  int dtype_size = dtype_utilities::GetYtDtypeSize(field_data->data_dtype);
+  if (len <= 0 || dtype_size <= 0) {
+    YT_ABORT("(grid id, field) = (%ld, %s) has unknown data type or size.\n",
+             grid.id,
+             field.field_name);
+  }
+
+  *num_bytes = len * dtype_size;
+  *data_len = len;
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ResolveParticleData
+// Description :  Get the size in bytes of attribute a of particle type p in a local grid.
+//
+// Notes       :  1. Attributes not set in particle_data are generated by get_par_attr.
+//                2. num_bytes is 0 if there is no data.
+//-------------------------------------------------------------------------------------------------------
+static int ResolveParticleData(const yt_grid& grid, int p, int a, long* num_bytes) {
+  const yt_particle& particle =
+      LibytProcessControl::Get().data_structure_amr_.GetParticleList()[p];
+  const yt_attribute& attr = particle.attr_list[a];
+  const long par_count = grid.par_count_list[p];
+  *num_bytes = 0;
+  const bool has_data = grid.particle_data[p][a].data_ptr != nullptr ||
+                        particle.get_par_attr != nullptr;
+  if (par_count <= 0 || !has_data) {
+    return YT_SUCCESS;
+  }
+
+  int dtype_size = dtype_utilities::GetYtDtypeSize(attr.attr_dtype);
+  if (dtype_size <= 0) {
+    YT_ABORT("(particle type, attribute) = (%s, %s) has unknown data type.\n",
+             particle.par_type,
+             attr.attr_name);
+  }
+
+  *num_bytes = par_count * dtype_size;
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  LayOutGrids
+// Description :  Write records of local grids, and list the data to copy or generate
+//                after the segment is allocated.
+//-------------------------------------------------------------------------------------------------------
+static int LayOutGrids(std::vector<char>& records, std::vector<SharedDataCopy>& copies,
+                       long* segment_size) {
+  LibytProcessControl& control = LibytProcessControl::Get();
+  const yt_param_yt& param_yt = control.param_yt_;
+  const yt_grid* grids_local = control.data_structure_amr_.GetGridsLocal();
+  const long record_size = GetRecordSize(param_yt);
+
+  records.assign(num_grids_own * record_size, 0);
+  long offset = kHeaderSize + static_cast<long>(records.size());
+  for (int g = 0; g < num_grids_own; g++) {
+    const yt_grid& grid = grids_local[g];
+    char* record = records.data() + g * record_size;
+    memcpy(record, &grid, sizeof(yt_grid));
+    record += sizeof(yt_grid);
+    if (param_yt.num_par_types > 0) {
+      memcpy(record, grid.par_count_list, param_yt.num_par_types * sizeof(long));
+      record += param_yt.num_par_types * sizeof(long);
+    }
+
+    for (int v = 0; v < param_yt.num_fields; v++) {
+      SharedFieldData shared;
+      long num_bytes = 0, data_len = 0;
+      if (ResolveFieldData(grid, v, &shared.field_data, &num_bytes, &data_len) !=
+          YT_SUCCESS) {
+        return YT_FAIL;
+      }
+      shared.offset = (num_bytes > 0) ? offset : -1;
+      if (num_bytes > 0) {
+        copies.push_back({offset,
+                          num_bytes,
+                          data_len,
+                          shared.field_data.data_ptr,
+                          grid.id,
+                          v,
+                          -1,
+                          -1});
+        offset += (num_bytes + 7) / 8 * 8;
+      }
+      memcpy(record, &shared, sizeof(SharedFieldData));
+      record += sizeof(SharedFieldData);
+    }
+
+    for (int p = 0; p < param_yt.num_par_types; p++) {
+      for (int a = 0; a < param_yt.par_type_list[p].num_attr; a++) {
+        long num_bytes = 0;
+        if (ResolveParticleData(grid, p, a, &num_bytes) != YT_SUCCESS) {
+          return YT_FAIL;
+        }
+        long attr_offset = (num_bytes > 0) ? offset : -1;
+        if (num_bytes > 0) {
+          copies.push_back({offset,
+                            num_bytes,
+                            grid.par_count_list[p],
+                            grid.particle_data[p][a].data_ptr,
+                            grid.id,
+                            -1,
+                            p,
+                            a});
+          offset += (num_bytes + 7) / 8 * 8;
+        }
+        memcpy(record, &attr_offset, sizeof(long));
+        record += sizeof(long);
+      }
+    }
+  }
+
+  *segment_size = offset;
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  CopyData
+// Description :  Copy or generate data listed in LayOutGrids to the segment.
+//-------------------------------------------------------------------------------------------------------
+static void CopyData(char* segment, const std::vector<SharedDataCopy>& copies) {
+  LibytProcessControl& control = LibytProcessControl::Get();
+  const yt_field* field_list = control.data_structure_amr_.GetFieldList();
+  const yt_particle* particle_list = control.data_structure_amr_.GetParticleList();
+
+  for (const SharedDataCopy& copy : copies) {
+    void* dest = segment + copy.offset;
+    if (copy.src != nullptr) {
+      memcpy(dest, copy.src, copy.num_bytes);
+      continue;
+    }
+    yt_array data_array[1];
+    data_array[0].gid = copy.gid;
+    data_array[0].data_length = copy.data_len;
+    data_array[0].data_ptr = dest;
+    long list_gid[1] = {copy.gid};
+    if (copy.field_index >= 0) {
+      const yt_field& field = field_list[copy.field_index];
+      (*field.derived_func)(1, list_gid, field.field_name, data_array);
+    } else {
+      const yt_particle& particle = particle_list[copy.ptype_index];
+      (*particle.get_par_attr)(1,
+                               list_gid,
+                               particle.par_type,
+                               particle.attr_list[copy.attr_index].attr_name,
+                               data_array);
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ReadGrids
+// Description :  Read records in the segment of a node member to local grids of the node
+//                leader starting at index lid.
+//-------------------------------------------------------------------------------------------------------
+static void ReadGrids(char* segment, long num_grids, int lid) {
+  LibytProcessControl& control = LibytProcessControl::Get();
+  const yt_param_yt& param_yt = control.param_yt_;
+  yt_grid* grids_local = control.data_structure_amr_.GetGridsLocal();
+  const long record_size = GetRecordSize(param_yt);
+
+  for (long g = 0; g < num_grids; g++, lid++) {
+    const char* record = segment + kHeaderSize + g * record_size;
+    yt_grid shared_grid;
+    memcpy(&shared_grid, record, sizeof(yt_grid));
+    record += sizeof(yt_grid);
+
+    yt_grid& grid = grids_local[lid];
+    for (int d = 0; d < 3; d++) {
+      grid.left_edge[d] = shared_grid.left_edge[d];
+      grid.right_edge[d] = shared_grid.right_edge[d];
+      grid.grid_dimensions[d] = shared_grid.grid_dimensions[d];
+    }
+    grid.id = shared_grid.id;
+    grid.parent_id = shared_grid.parent_id;
+    grid.level = shared_grid.level;
+    if (param_yt.num_par_types > 0) {
+      memcpy(grid.par_count_list, record, param_yt.num_par_types * sizeof(long));
+      record += param_yt.num_par_types * sizeof(long);
+    }
+
+    for (int v = 0; v < param_yt.num_fields; v++) {
+      SharedFieldData shared;
+      memcpy(&shared, record, sizeof(SharedFieldData));
+      record += sizeof(SharedFieldData);
+      grid.field_data[v] = shared.field_data;
+      grid.field_data[v].data_ptr =
+          (shared.offset >= 0) ? segment + shared.offset : nullptr;
+    }
+
+    for (int p = 0; p < param_yt.num_par_types; p++) {
+      for (int a = 0; a < param_yt.par_type_list[p].num_attr; a++) {
+        long offset;
+        memcpy(&offset, record, sizeof(long));
+        record += sizeof(long);
+        grid.particle_data[p][a].data_ptr = (offset >= 0) ? segment + offset : nullptr;
+      }
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  AllocateSharedWindow
+// Description :  Allocate the shared memory window on the node, and start an access
+//                epoch to every segment.
+//-------------------------------------------------------------------------------------------------------
+static char* AllocateSharedWindow(long segment_size) {
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "alloc_shared_noncontig", "true");
+  char* segment = nullptr;
+  MPI_Win_allocate_shared(
+      static_cast<MPI_Aint>(segment_size), 1, info, node_comm, &segment, &shared_win);
+  MPI_Info_free(&info);
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, shared_win);
+  return segment;
+}
+#endif  // #ifndef SERIAL_MODE
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : node_aggregation
+// Function name : Split
+//
+// Notes         :  1. Collective operation on the libyt communicator set in
+//                     yt_initialize, it must be called before anything else in libyt
+//                     communicates.
+//                  2. Processes on the same node are found by MPI_COMM_TYPE_SHARED, and
+//                     the one with the lowest rank is the node leader.
+//                  3. Return YT_FAIL in SERIAL_MODE, and it stays off.
+//-------------------------------------------------------------------------------------------------------
+int node_aggregation::Split() {
+#ifndef SERIAL_MODE
+  int rank = 0, node_rank = 0;
+  MPI_Comm_rank(CommMpi::GetComm(), &rank);
+  MPI_Comm_split_type(
+      CommMpi::GetComm(), MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+  MPI_Comm_rank(node_comm, &node_rank);
+
+  is_leader = (node_rank == 0);
+  MPI_Comm_split(CommMpi::GetComm(), is_leader ? 0 : 1, rank, &group_comm);
+  CommMpi::SetComm(group_comm);
+  enabled = true;
+
+  return YT_SUCCESS;
+#else
+  return YT_FAIL;
+#endif
+}
+
+bool node_aggregation::IsEnabled() {
+#ifndef SERIAL_MODE
+  return enabled;
+#else
+  return false;
+#endif
+}
+
+bool node_aggregation::IsLeader() {
+#ifndef SERIAL_MODE
+  return enabled && is_leader;
+#else
+  return false;
+#endif
+}
+
+bool node_aggregation::IsMember() {
+#ifndef SERIAL_MODE
+  return enabled && !is_leader;
+#else
+  return false;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : node_aggregation
+// Function name : AggregateNumGridsLocal
+//
+// Notes         :  1. Called in yt_set_Parameters, collective operation on the node.
+//                  2. Return the sum of num_grids_local on the node for the node leader,
+//                     and num_grids_local itself otherwise. Local grids set by the
+//                     simulation come first on the node leader.
+//-------------------------------------------------------------------------------------------------------
+int node_aggregation::AggregateNumGridsLocal(int num_grids_local) {
+#ifndef SERIAL_MODE
+  if (!enabled) {
+    return num_grids_local;
+  }
+
+  num_grids_own = num_grids_local;
+  int num_grids_node = 0;
+  MPI_Reduce(&num_grids_local, &num_grids_node, 1, MPI_INT, MPI_SUM, 0, node_comm);
+
+  return is_leader ? num_grids_node : num_grids_local;
+#else
+  return num_grids_local;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : node_aggregation
+// Function name : ShareGrids
+//
+// Notes         :  1. Called in yt_commit on node members, collective operation on the
+//                     node together with GatherGrids on the node leader.
+//                  2. Derived fields and particle attributes not set are generated here
+//                     with functions of this process, which may look up grids through
+//                     yt_getGridInfo_*.
+//                  3. The segment only holds the number of grids -1 if it fails, so that
+//                     the node leader fails as well.
+//-------------------------------------------------------------------------------------------------------
+int node_aggregation::ShareGrids() {
+#ifndef SERIAL_MODE
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  std::vector<char> records;
+  std::vector<SharedDataCopy> copies;
+  long segment_size = kHeaderSize;
+  int status = LayOutGrids(records, copies, &segment_size);
+  if (status != YT_SUCCESS) {
+    segment_size = kHeaderSize;
+  }
+
+  char* segment = AllocateSharedWindow(segment_size);
+  long num_grids = (status == YT_SUCCESS) ? num_grids_own : -1;
+  memcpy(segment, &num_grids, sizeof(long));
+  if (status == YT_SUCCESS) {
+    memcpy(segment + kHeaderSize, records.data(), records.size());
+    CopyData(segment, copies);
+  }
+
+  MPI_Win_sync(shared_win);
+  MPI_Barrier(node_comm);
+
+  return status;
+#else
+  return YT_FAIL;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : node_aggregation
+// Function name : GatherGrids
+//
+// Notes         :  1. Called in yt_commit on node leaders before binding anything to
+//                     Python, collective operation on the node together with ShareGrids
+//                     on node members.
+//                  2. Local grids of node members are appended to local grids set by the
+//                     simulation, and their data points to the shared memory window.
+//                  3. Local grids belong to the node leader afterward, so proc_num is its
+//                     rank among node leaders.
+//                  4. node_aggregation.gather_time includes waiting for node members to
+//                     copy their data, since they do not bind perf counters to Python.
+//-------------------------------------------------------------------------------------------------------
+int node_aggregation::GatherGrids() {
+#ifndef SERIAL_MODE
+  SET_TIMER(__PRETTY_FUNCTION__);
+  perf_counter::ScopedTimer perf_timer("node_aggregation.gather_time");
+
+  AllocateSharedWindow(0);
+  MPI_Barrier(node_comm);
+  MPI_Win_sync(shared_win);
+
+  int node_size = 1;
+  MPI_Comm_size(node_comm, &node_size);
+  int lid = num_grids_own;
+  int status = YT_SUCCESS;
+  long gather_bytes = 0;
+  for (int r = 1; r < node_size; r++) {
+    MPI_Aint segment_size = 0;
+    int disp_unit = 1;
+    char* segment = nullptr;
+    MPI_Win_shared_query(shared_win, r, &segment_size, &disp_unit, &segment);
+    long num_grids = 0;
+    memcpy(&num_grids, segment, sizeof(long));
+    gather_bytes += static_cast<long>(segment_size);
+    if (num_grids < 0) {
+      logging::LogError("Node member %d failed to share local grids.\n", r);
+      status = YT_FAIL;
+      continue;
+    }
+    ReadGrids(segment, num_grids, lid);
+    lid += static_cast<int>(num_grids);
+  }
+
+  yt_grid* grids_local = LibytProcessControl::Get().data_structure_amr_.GetGridsLocal();
+  for (int g = 0; g < lid; g++) {
+    grids_local[g].proc_num = CommMpi::mpi_rank_;
+  }
+  perf_counter::Add("node_aggregation.gather_bytes", static_cast<double>(gather_bytes));
+
+  return status;
+#else
+  return YT_FAIL;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : node_aggregation
+// Function name : FreeSharedGrids
+//
+// Notes         :  1. Called in yt_free, collective operation on the node.
+//                  2. Node members wait here until the node leader is done with the data.
+//-------------------------------------------------------------------------------------------------------
+void node_aggregation::FreeSharedGrids() {
+#ifndef SERIAL_MODE
+  if (shared_win == MPI_WIN_NULL) {
+    return;
+  }
+  SET_TIMER(__PRETTY_FUNCTION__);
+  MPI_Win_unlock_all(shared_win);
+  MPI_Win_free(&shared_win);
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : node_aggregation
+// Function name : Finalize
+//
+// Notes         :  1. Called at the end of yt_finalize.
+//                  2. Free the node and group communicators. yt_finalize resets the
+//                     libyt communicator afterward.
+//-------------------------------------------------------------------------------------------------------
+void node_aggregation::Finalize() {
+#ifndef SERIAL_MODE
+  if (!enabled) {
+    return;
+  }
+  FreeSharedGrids();
+  MPI_Comm_free(&node_comm);
+  MPI_Comm_free(&group_comm);
+  enabled = false;
+#endif
+}
@@ -2,6 +2,18 @@
 #include "numpy_controller.h"
 
 #include "dtype_utilities.h"
+#include "memory_spill.h"
+#include "memory_tracker.h"
+
+//-------------------------------------------------------------------------------------------------------
+// Function name : FreeSpillBufferCapsule
+//
+// Notes         :  1. Capsule destructor for NumPy array base object that owns a spill
+//                     buffer, since the buffer is unmapped instead of being freed.
+//-------------------------------------------------------------------------------------------------------
+static void FreeSpillBufferCapsule(PyObject* capsule) {
+  memory_spill::FreeSpillBuffer(PyCapsule_GetPointer(capsule, nullptr));
+}
 
 //-------------------------------------------------------------------------------------------------------
 // Namespace     : numpy_controller
@@ -31,6 +43,10 @@ NumPyStatus numpy_controller::InitializeNumPy() {
 //                  once it is attached
 //                     to something, say a dictionary.
 //                  3. We assume it is C-contiguous.
+//                  4. If the data is owned by Python and it is a spill buffer, the
+//                     buffer is owned by a capsule base object which unmaps it.
+//                  5. If the data is owned by Python, it is no longer tracked by
+//                     memory_tracker.
 //-------------------------------------------------------------------------------------------------------
 PyObject* numpy_controller::ArrayToNumPyArray(int dim, npy_intp* npy_dim,
                                               yt_dtype data_dtype, void* data_ptr,
@@ -43,7 +59,13 @@ PyObject* numpy_controller::ArrayToNumPyArray(int dim, npy_intp* npy_dim,
   }
 
   if (owned_by_python) {
-    PyArray_ENABLEFLAGS((PyArrayObject*)py_data, NPY_ARRAY_OWNDATA);
+    if (memory_spill::IsSpillBuffer(data_ptr)) {
+      PyObject* py_base = PyCapsule_New(data_ptr, nullptr, FreeSpillBufferCapsule);
+      PyArray_SetBaseObject((PyArrayObject*)py_data, py_base);
+    } else {
+      PyArray_ENABLEFLAGS((PyArrayObject*)py_data, NPY_ARRAY_OWNDATA);
+      memory_tracker::Untrack(data_ptr);
+    }
   }
 
   return py_data;
@@ -66,3 +88,29 @@ NumPyArray numpy_controller::GetNumPyArrayInfo(PyObject* py_array) {
 
   return array_info;
 }
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : numpy_controller
+// Function name : CopyNumPyArray
+//
+// Notes         :  1. Deep copy the array to a C-contiguous array which owns its data.
+//                  2. Return a new reference, or nullptr with Python error set if it
+//                     failed.
+//-------------------------------------------------------------------------------------------------------
+PyObject* numpy_controller::CopyNumPyArray(PyObject* py_array, bool readonly) {
+  PyObject* py_copy = PyArray_NewCopy((PyArrayObject*)py_array, NPY_CORDER);
+  if (py_copy != nullptr && readonly) {
+    PyArray_CLEARFLAGS((PyArrayObject*)py_copy, NPY_ARRAY_WRITEABLE);
+  }
+  return py_copy;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : numpy_controller
+// Function name : GetNumPyArrayNumBytes
+//
+// Notes         :  1. Return the number of bytes of the array data.
+//-------------------------------------------------------------------------------------------------------
+long numpy_controller::GetNumPyArrayNumBytes(PyObject* py_array) {
+  return static_cast<long>(PyArray_NBYTES((PyArrayObject*)py_array));
+}
@@ -0,0 +1,281 @@
+#include "perf_counter.h"
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#ifndef SERIAL_MODE
+#include "comm_mpi.h"
+#endif
+#include "timer.h"
+
+// Counters accumulated in this step, keyed by name, sorted so that output is stable.
+static std::map<std::string, double> counter_map;
+static std::mutex counter_mutex;
+
+#ifndef SERIAL_MODE
+// Layout of MPI_DOUBLE_INT, used in MPI_MAXLOC.
+struct DoubleInt {
+  double value;
+  int rank;
+};
+#endif
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetImbalance
+// Description :  Get max/mean of a counter, which is 1 if the mean is 0.
+//-------------------------------------------------------------------------------------------------------
+static double GetImbalance(const PerfCounterSummary& summary) {
+  return (summary.mean > 0.0) ? summary.max / summary.mean : 1.0;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : perf_counter
+// Function name : Add
+//
+// Notes         :  1. Add value to counter name, the counter is created if it does not
+//                     exist yet.
+//-------------------------------------------------------------------------------------------------------
+void perf_counter::Add(const std::string& name, double value) {
+  std::lock_guard<std::mutex> lock(counter_mutex);
+  counter_map[name] += value;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : perf_counter
+// Function name : Get
+//
+// Notes         :  1. Get local value of counter name, return 0 if it does not exist.
+//-------------------------------------------------------------------------------------------------------
+double perf_counter::Get(const std::string& name) {
+  std::lock_guard<std::mutex> lock(counter_mutex);
+  auto it = counter_map.find(name);
+  return (it != counter_map.end()) ? it->second : 0.0;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : perf_counter
+// Function name : Reset
+//
+// Notes         :  1. Clear every counter.
+//-------------------------------------------------------------------------------------------------------
+void perf_counter::Reset() {
+  std::lock_guard<std::mutex> lock(counter_mutex);
+  counter_map.clear();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : perf_counter
+// Function name : Summarize
+//
+// Notes         :  1. Collective operation, every MPI process must call it.
+//                  2. Counter names are unioned on root rank and broadcast, so that
+//                     every process reduces the same list in the same order.
+//                  3. Min and max are reduced together by a single MPI_MAXLOC on
+//                     [value, -value], so that the rank holding the max is also known.
+//                     Mean is reduced by MPI_SUM.
+//-------------------------------------------------------------------------------------------------------
+std::vector<PerfCounterSummary> perf_counter::Summarize() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  std::map<std::string, double> local_map;
+  {
+    std::lock_guard<std::mutex> lock(counter_mutex);
+    local_map = counter_map;
+  }
+
+  std::vector<PerfCounterSummary> summary_list;
+#ifndef SERIAL_MODE
+  // Get the union of counter names on every process
+  std::string local_names;
+  for (const auto& counter : local_map) {
+    local_names += counter.first + "\n";
+  }
+  std::vector<std::string> all_names;
+  CommMpi::GatherAllStringsToRank(all_names, local_names, CommMpi::mpi_root_);
+  std::string union_names;
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_root_) {
+    std::set<std::string> name_set;
+    for (const std::string& names : all_names) {
+      std::istringstream stream(names);
+      std::string name;
+      while (std::getline(stream, name)) {
+        name_set.insert(name);
+      }
+    }
+    for (const std::string& name : name_set) {
+      union_names += name + "\n";
+    }
+  }
+  CommMpi::SetStringUsingValueOnRank(union_names, CommMpi::mpi_root_);
+
+  std::istringstream stream(union_names);
+  std::string name;
+  while (std::getline(stream, name)) {
+    summary_list.push_back({name, 0.0, 0.0, 0.0, 0});
+  }
+
+  // Reduce min, max, and mean
+  std::size_t num_counters = summary_list.size();
+  std::vector<DoubleInt> max_list(2 * num_counters);
+  std::vector<double> sum_list(num_counters);
+  for (std::size_t i = 0; i < num_counters; i++) {
+    auto it = local_map.find(summary_list[i].name);
+    double value = (it != local_map.end()) ? it->second : 0.0;
+    max_list[2 * i] = {value, CommMpi::mpi_rank_};
+    max_list[2 * i + 1] = {-value, CommMpi::mpi_rank_};
+    sum_list[i] = value;
+  }
+  MPI_Allreduce(MPI_IN_PLACE,
+                max_list.data(),
+                static_cast<int>(max_list.size()),
+                MPI_DOUBLE_INT,
+                MPI_MAXLOC,
+                CommMpi::GetComm());
+  MPI_Allreduce(MPI_IN_PLACE,
+                sum_list.data(),
+                static_cast<int>(sum_list.size()),
+                MPI_DOUBLE,
+                MPI_SUM,
+                CommMpi::GetComm());
+  for (std::size_t i = 0; i < num_counters; i++) {
+    summary_list[i].max = max_list[2 * i].value;
+    summary_list[i].max_rank = max_list[2 * i].rank;
+    summary_list[i].min = -max_list[2 * i + 1].value;
+    summary_list[i].mean = sum_list[i] / CommMpi::mpi_size_;
+  }
+#else
+  for (const auto& counter : local_map) {
+    summary_list.push_back(
+        {counter.first, counter.second, counter.second, counter.second, 0});
+  }
+#endif
+
+  return summary_list;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : perf_counter
+// Function name : GetLoadImbalance
+//
+// Notes         :  1. times and wait_times are indexed by rank, and must not be empty.
+//                  2. Get the max, the mean, and the slowest rank of times, and the max
+//                     of wait_times.
+//-------------------------------------------------------------------------------------------------------
+PerfLoadImbalance perf_counter::GetLoadImbalance(const std::vector<double>& times,
+                                                 const std::vector<double>& wait_times) {
+  PerfLoadImbalance imbalance = {times[0], times[0], 0, wait_times[0]};
+  double sum = 0.0;
+  for (std::size_t r = 0; r < times.size(); r++) {
+    sum += times[r];
+    if (times[r] > times[imbalance.max_rank]) {
+      imbalance.max_rank = static_cast<int>(r);
+    }
+    if (wait_times[r] > imbalance.wait_max) {
+      imbalance.wait_max = wait_times[r];
+    }
+  }
+  imbalance.max = times[imbalance.max_rank];
+  imbalance.mean = sum / static_cast<double>(times.size());
+
+  return imbalance;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : perf_counter
+// Function name : BindToPython
+//
+// Notes         :  1. Replace the content of py_perf with
+//                     {"step": step, <name>: {"min", "max", "mean", "max_rank",
+//                     "imbalance"}, ...}.
+//                  2. Return 0 on success, -1 on failure.
+//-------------------------------------------------------------------------------------------------------
+int perf_counter::BindToPython(PyObject* py_perf, long step,
+                               const std::vector<PerfCounterSummary>& summary_list) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  if (py_perf == nullptr) {
+    return -1;
+  }
+  PyDict_Clear(py_perf);
+
+  PyObject* py_step = PyLong_FromLong(step);
+  PyDict_SetItemString(py_perf, "step", py_step);
+  Py_DECREF(py_step);
+
+  for (const PerfCounterSummary& summary : summary_list) {
+    PyObject* py_summary = Py_BuildValue("{s:d,s:d,s:d,s:i,s:d}",
+                                         "min",
+                                         summary.min,
+                                         "max",
+                                         summary.max,
+                                         "mean",
+                                         summary.mean,
+                                         "max_rank",
+                                         summary.max_rank,
+                                         "imbalance",
+                                         GetImbalance(summary));
+    if (py_summary == nullptr) {
+      PyErr_Clear();
+      return -1;
+    }
+    PyDict_SetItemString(py_perf, summary.name.c_str(), py_summary);
+    Py_DECREF(py_summary);
+  }
+
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : perf_counter
+// Function name : AppendToFile
+//
+// Notes         :  1. If filename ends with ".csv", append rows
+//                     "step,name,min,max,mean,max_rank,imbalance", and write the header
+//                     if the file is empty.
+//                  2. Otherwise, append one JSON object per line,
+//                     {"step": ..., "counters": {<name>: {"min", "max", "mean",
+//                     "max_rank", "imbalance"}}}.
+//                  3. Return 0 on success, -1 if the file cannot be opened.
+//-------------------------------------------------------------------------------------------------------
+int perf_counter::AppendToFile(const std::string& filename, long step,
+                               const std::vector<PerfCounterSummary>& summary_list) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  std::ofstream file(filename, std::ios::out | std::ios::app);
+  if (!file.is_open()) {
+    return -1;
+  }
+  file.precision(12);
+
+  const std::string csv_extension(".csv");
+  bool is_csv = filename.size() >= csv_extension.size() &&
+                filename.compare(filename.size() - csv_extension.size(),
+                                 csv_extension.size(),
+                                 csv_extension) == 0;
+  if (is_csv) {
+    file.seekp(0, std::ios::end);
+    if (file.tellp() == 0) {
+      file << "step,name,min,max,mean,max_rank,imbalance\n";
+    }
+    for (const PerfCounterSummary& summary : summary_list) {
+      file << step << "," << summary.name << "," << summary.min << "," << summary.max
+           << "," << summary.mean << "," << summary.max_rank << ","
+           << GetImbalance(summary) << "\n";
+    }
+  } else {
+    file << "{\"step\": " << step << ", \"counters\": {";
+    for (std::size_t i = 0; i < summary_list.size(); i++) {
+      const PerfCounterSummary& summary = summary_list[i];
+      file << (i == 0 ? "" : ", ") << "\"" << summary.name << "\": {\"min\": "
+           << summary.min << ", \"max\": " << summary.max
+           << ", \"mean\": " << summary.mean << ", \"max_rank\": " << summary.max_rank
+           << ", \"imbalance\": " << GetImbalance(summary) << "}";
+    }
+    file << "}}\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,195 @@
+#include "python_profiler.h"
+
+#include <Python.h>
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#ifndef SERIAL_MODE
+#include "comm_mpi.h"
+#endif
+#include "timer.h"
+
+// Seconds between two samples.
+static const double kSampleInterval = 0.005;
+
+// Sampler running in a Python thread, it samples the thread that calls start().
+static const char* kSamplerSource =
+    "import sys, threading\n"
+    "class Sampler:\n"
+    "    def __init__(self, interval):\n"
+    "        self.interval = interval\n"
+    "        self.counts = {}\n"
+    "        self.thread = None\n"
+    "        self.stop_event = threading.Event()\n"
+    "    def start(self, label):\n"
+    "        self.label = label.replace(';', ':')\n"
+    "        self.target = threading.get_ident()\n"
+    "        self.stop_event.clear()\n"
+    "        self.thread = threading.Thread(target=self.run, daemon=True)\n"
+    "        self.thread.start()\n"
+    "    def stop(self):\n"
+    "        if self.thread is not None:\n"
+    "            self.stop_event.set()\n"
+    "            self.thread.join()\n"
+    "            self.thread = None\n"
+    "    def run(self):\n"
+    "        while not self.stop_event.wait(self.interval):\n"
+    "            frame = sys._current_frames().get(self.target)\n"
+    "            stack = []\n"
+    "            while frame is not None:\n"
+    "                code = frame.f_code\n"
+    "                stack.append('%s (%s:%d)' % (code.co_name, code.co_filename,\n"
+    "                                             code.co_firstlineno))\n"
+    "                frame = frame.f_back\n"
+    "            stack.append(self.label)\n"
+    "            key = ';'.join(reversed(stack)).replace('\\n', ' ')\n"
+    "            self.counts[key] = self.counts.get(key, 0) + 1\n"
+    "    def pop_collapsed(self):\n"
+    "        lines = ['%s %d\\n' % (k, v) for k, v in self.counts.items()]\n"
+    "        self.counts = {}\n"
+    "        return ''.join(lines)\n";
+
+static PyObject* py_sampler = nullptr;
+static std::string profile_filename;
+// Samples of every step so far, only used on root.
+static std::map<std::string, long> all_counts;
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : python_profiler
+// Function name : Enable
+//
+// Notes         :  1. Create the sampler, Python must be initialized.
+//                  2. Return false if the sampler cannot be created, and the profiler
+//                     stays disabled.
+//-------------------------------------------------------------------------------------------------------
+bool python_profiler::Enable(const std::string& filename) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  if (py_sampler != nullptr) {
+    return true;
+  }
+
+  PyObject* py_namespace = PyDict_New();
+  PyDict_SetItemString(py_namespace, "__builtins__", PyEval_GetBuiltins());
+  PyObject* py_result =
+      PyRun_String(kSamplerSource, Py_file_input, py_namespace, py_namespace);
+  if (py_result != nullptr) {
+    PyObject* py_class = PyDict_GetItemString(py_namespace, "Sampler");
+    py_sampler = PyObject_CallFunction(py_class, "d", kSampleInterval);
+  }
+  Py_XDECREF(py_result);
+  Py_DECREF(py_namespace);
+
+  if (py_sampler == nullptr) {
+    PyErr_Print();
+    return false;
+  }
+  profile_filename = filename;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : python_profiler
+// Function name : IsEnabled
+//-------------------------------------------------------------------------------------------------------
+bool python_profiler::IsEnabled() { return py_sampler != nullptr; }
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : python_profiler
+// Function name : Start
+//
+// Notes         :  1. Start sampling the calling thread, samples are rooted at label.
+//                  2. Do nothing if the profiler is not enabled.
+//-------------------------------------------------------------------------------------------------------
+void python_profiler::Start(const std::string& label) {
+  if (py_sampler == nullptr) {
+    return;
+  }
+
+  PyObject* py_result = PyObject_CallMethod(py_sampler, "start", "s", label.c_str());
+  if (py_result == nullptr) {
+    PyErr_Print();
+  }
+  Py_XDECREF(py_result);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : python_profiler
+// Function name : Stop
+//
+// Notes         :  1. Stop sampling, and wait for the sampler thread to exit.
+//                  2. Do nothing if the profiler is not enabled.
+//-------------------------------------------------------------------------------------------------------
+void python_profiler::Stop() {
+  if (py_sampler == nullptr) {
+    return;
+  }
+
+  PyObject* py_result = PyObject_CallMethod(py_sampler, "stop", nullptr);
+  if (py_result == nullptr) {
+    PyErr_Print();
+  }
+  Py_XDECREF(py_result);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : python_profiler
+// Function name : Flush
+//
+// Notes         :  1. Collective operation, every MPI process must call it.
+//                  2. Gather samples recorded since the last flush to root, and add them
+//                     to the samples of previous steps. Root rewrites the file with all
+//                     of them in collapsed stack format.
+//                  3. Return 0 on success, -1 if the file cannot be opened on root. Do
+//                     nothing if the profiler is not enabled.
+//-------------------------------------------------------------------------------------------------------
+int python_profiler::Flush() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  if (py_sampler == nullptr) {
+    return 0;
+  }
+
+  std::string collapsed;
+  PyObject* py_collapsed = PyObject_CallMethod(py_sampler, "pop_collapsed", nullptr);
+  if (py_collapsed != nullptr && PyUnicode_Check(py_collapsed)) {
+    collapsed = PyUnicode_AsUTF8(py_collapsed);
+  } else {
+    PyErr_Print();
+  }
+  Py_XDECREF(py_collapsed);
+
+  std::vector<std::string> all_collapsed;
+#ifndef SERIAL_MODE
+  CommMpi::GatherAllStringsToRank(all_collapsed, collapsed, CommMpi::mpi_root_);
+  if (CommMpi::mpi_rank_ != CommMpi::mpi_root_) {
+    return 0;
+  }
+#else
+  all_collapsed.push_back(collapsed);
+#endif
+
+  // Each line is "<stack> <count>", and stack may contain spaces
+  for (const std::string& rank_collapsed : all_collapsed) {
+    std::istringstream stream(rank_collapsed);
+    std::string line;
+    while (std::getline(stream, line)) {
+      std::size_t pos = line.rfind(' ');
+      if (pos == std::string::npos) continue;
+      all_counts[line.substr(0, pos)] += std::stol(line.substr(pos + 1));
+    }
+  }
+
+  std::ofstream file(profile_filename, std::ios::out | std::ios::trunc);
+  if (!file.is_open()) {
+    return -1;
+  }
+  for (const auto& stack : all_counts) {
+    file << stack.first << " " << stack.second << "\n";
+  }
+
+  return 0;
+}
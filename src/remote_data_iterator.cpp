@@ -0,0 +1,239 @@
+#ifndef SERIAL_MODE
+#include "remote_data_iterator.h"
+
+#include "async_analysis.h"
+#include "comm_mpi.h"
+#include "libyt_process_control.h"
+#include "memory_spill.h"
+#include "memory_tracker.h"
+#include "numpy_controller.h"
+#include "timer.h"
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : GetNumPyDim
+// Description     : Get the NumPy dimensions of AmrDataArray3D/2D/1D, and return the
+//                   dimensionality.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass>
+static int GetNumPyDim(const DataClass& data, npy_intp* npy_dim) {
+  int dim = sizeof(data.data_dim) / sizeof(data.data_dim[0]);
+  for (int d = 0; d < dim; d++) {
+    npy_dim[d] = data.data_dim[d];
+  }
+  return dim;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : FreeFetchedBuffer
+// Description     : Free fetched buffer that is not yet owned by Python.
+//-------------------------------------------------------------------------------------------------------
+static void FreeFetchedBuffer(void* data_ptr) {
+  if (memory_spill::IsSpillBuffer(data_ptr)) {
+    memory_spill::FreeSpillBuffer(data_ptr);
+  } else {
+    memory_tracker::Free(data_ptr);
+  }
+}
+
+template<typename DataClass, typename RmaDataClass>
+RemoteFieldIterator<DataClass, RmaDataClass>::RemoteFieldIterator(
+    const std::vector<std::string>& fname_list, const std::vector<long>& prepare_id_list,
+    const std::vector<CommMpiRmaQueryInfo>& fetch_data_list)
+    : fname_list_(fname_list),
+      prepare_id_list_(prepare_id_list),
+      fetch_data_list_(fetch_data_list),
+      field_index_(0),
+      is_fetching_(false),
+      prepared_data_list_(nullptr),
+      local_amr_data_(false) {}
+
+//-------------------------------------------------------------------------------------------------------
+// Class      :  RemoteFieldIterator<DataClass, RmaDataClass>
+// Destructor :
+//
+// Notes      :  1. If it is destroyed in the middle of a field, the RMA window is freed,
+//                  which is a collective operation.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass, typename RmaDataClass>
+RemoteFieldIterator<DataClass, RmaDataClass>::~RemoteFieldIterator() {
+  if (is_fetching_) {
+    EndField();
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  RemoteFieldIterator<DataClass, RmaDataClass>
+// Private Method :  BeginField
+//
+// Notes          :  1. Prepare local data of the current field, and begin chunked RMA
+//                      operation. Every process fails fast.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass, typename RmaDataClass>
+RemoteDataIteratorStatus RemoteFieldIterator<DataClass, RmaDataClass>::BeginField() {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
+
+  const std::string& fname = fname_list_[field_index_];
+
+  // Prepare data for the field on each MPI rank, fail fast if any process fails.
+  DataHubReturn<DataClass> prepared_data = local_amr_data_.GetLocalFieldData(
+      LibytProcessControl::Get().GetDataStructureAmr(), fname, prepare_id_list_);
+  DataHubStatus all_status = static_cast<DataHubStatus>(CallWithoutGil([&] {
+    return CommMpi::CheckAllStates(static_cast<int>(prepared_data.status),
+                                   static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                   static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                   static_cast<int>(DataHubStatus::kDataHubFailed));
+  }));
+  if (all_status != DataHubStatus::kDataHubSuccess) {
+    if (prepared_data.status == DataHubStatus::kDataHubFailed) {
+      error_str_ = local_amr_data_.GetErrorStr();
+    } else {
+      error_str_ = std::string("Error occurred in other MPI process.");
+    }
+    local_amr_data_.ClearCache();
+    return RemoteDataIteratorStatus::kIteratorFailed;
+  }
+  prepared_data_list_ = &prepared_data.data_list;
+
+  // Begin chunked MPI RMA operation
+  const yt_param_libyt& param_libyt = LibytProcessControl::Get().param_libyt_;
+  rma_.reset(new RmaDataClass(fname, "amr_grid"));
+  std::string spill_dir;
+  if (param_libyt.spill_dir != nullptr) {
+    spill_dir = param_libyt.spill_dir;
+  }
+  rma_->SetMemoryBudget(param_libyt.memory_budget, spill_dir);
+  CommMpiRmaReturn<DataClass> rma_return = CallWithoutGil([&] {
+    return rma_->BeginChunkedRemoteData(*prepared_data_list_, fetch_data_list_);
+  });
+  if (rma_return.all_status != CommMpiRmaStatus::kMpiSuccess) {
+    if (rma_return.status != CommMpiRmaStatus::kMpiSuccess) {
+      error_str_ = rma_->GetErrorStr();
+    } else {
+      error_str_ = std::string("Error occurred in other MPI process.");
+    }
+    rma_.reset();
+    local_amr_data_.ClearCache();
+    return RemoteDataIteratorStatus::kIteratorFailed;
+  }
+
+  is_fetching_ = true;
+  return RemoteDataIteratorStatus::kIteratorSuccess;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  RemoteFieldIterator<DataClass, RmaDataClass>
+// Private Method :  EndField
+//
+// Notes          :  1. End chunked RMA operation of the current field, and free the
+//                      prepared data.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass, typename RmaDataClass>
+void RemoteFieldIterator<DataClass, RmaDataClass>::EndField() {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
+
+  CallWithoutGil([&] { rma_->EndChunkedRemoteData(*prepared_data_list_); });
+  rma_.reset();
+  local_amr_data_.ClearCache();
+  prepared_data_list_ = nullptr;
+  is_fetching_ = false;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class         :  RemoteFieldIterator<DataClass, RmaDataClass>
+// Public Method :  Next
+//
+// Notes         :  1. Fetch the next chunk of the current field, and wrap it to a new
+//                     Python dictionary py_chunk[grid id][field name].
+//                  2. Every process gets the same number of chunks, some of them may be
+//                     an empty dictionary.
+//                  3. Return kIteratorEnd if all the fields are fetched, and stops the
+//                     iteration after it failed.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass, typename RmaDataClass>
+RemoteDataIteratorStatus RemoteFieldIterator<DataClass, RmaDataClass>::Next(
+    PyObject** py_chunk) {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
+
+  *py_chunk = nullptr;
+  while (field_index_ < fname_list_.size()) {
+    if (!is_fetching_ && BeginField() != RemoteDataIteratorStatus::kIteratorSuccess) {
+      field_index_ = fname_list_.size();
+      return RemoteDataIteratorStatus::kIteratorFailed;
+    }
+
+    if (!rma_->HasNextRemoteDataChunk()) {
+      EndField();
+      field_index_++;
+      continue;
+    }
+
+    CommMpiRmaReturn<DataClass> rma_return =
+        CallWithoutGil([&] { return rma_->GetNextRemoteDataChunk(); });
+    if (rma_return.all_status != CommMpiRmaStatus::kMpiSuccess) {
+      if (rma_return.status != CommMpiRmaStatus::kMpiSuccess) {
+        error_str_ = rma_->GetErrorStr();
+      } else {
+        error_str_ = std::string("Error occurred in other MPI process.");
+      }
+      for (const DataClass& fetched_data : rma_return.data_list) {
+        FreeFetchedBuffer(fetched_data.data_ptr);
+      }
+      EndField();
+      field_index_ = fname_list_.size();
+      return RemoteDataIteratorStatus::kIteratorFailed;
+    }
+
+    // Wrap the data to Python dictionary py_chunk[grid id][field name]
+    const char* fname = fname_list_[field_index_].c_str();
+    *py_chunk = PyDict_New();
+    for (const DataClass& fetched_data : rma_return.data_list) {
+      PyObject* py_grid_id = PyLong_FromLong(fetched_data.id);
+      PyObject* py_field_label = PyDict_GetItem(*py_chunk, py_grid_id);
+      if (py_field_label == nullptr) {
+        py_field_label = PyDict_New();
+        PyDict_SetItem(*py_chunk, py_grid_id, py_field_label);
+        Py_DECREF(py_field_label);
+      }
+      Py_DECREF(py_grid_id);
+
+      npy_intp npy_dim[3];
+      int dim = GetNumPyDim(fetched_data, npy_dim);
+      PyObject* py_field_data = numpy_controller::ArrayToNumPyArray(
+          dim, npy_dim, fetched_data.data_dtype, fetched_data.data_ptr, false, true);
+      PyDict_SetItemString(py_field_label, fname, py_field_data);
+      Py_DECREF(py_field_data);
+    }
+
+    return RemoteDataIteratorStatus::kIteratorSuccess;
+  }
+
+  return RemoteDataIteratorStatus::kIteratorEnd;
+}
+
+template class RemoteFieldIterator<AmrDataArray3D, CommMpiRmaAmrDataArray3D>;
+template class RemoteFieldIterator<AmrDataArray2D, CommMpiRmaAmrDataArray2D>;
+template class RemoteFieldIterator<AmrDataArray1D, CommMpiRmaAmrDataArray1D>;
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  CreateRemoteFieldIterator
+//
+// Notes       :  1. Create RemoteFieldIterator based on dimensionality. Caller owns the
+//                   returned object.
+//-------------------------------------------------------------------------------------------------------
+RemoteDataIterator* CreateRemoteFieldIterator(
+    int dimensionality, const std::vector<std::string>& fname_list,
+    const std::vector<long>& prepare_id_list,
+    const std::vector<CommMpiRmaQueryInfo>& fetch_data_list) {
+  if (dimensionality == 3) {
+    return new RemoteFieldIterator<AmrDataArray3D, CommMpiRmaAmrDataArray3D>(
+        fname_list, prepare_id_list, fetch_data_list);
+  } else if (dimensionality == 2) {
+    return new RemoteFieldIterator<AmrDataArray2D, CommMpiRmaAmrDataArray2D>(
+        fname_list, prepare_id_list, fetch_data_list);
+  } else {
+    return new RemoteFieldIterator<AmrDataArray1D, CommMpiRmaAmrDataArray1D>(
+        fname_list, prepare_id_list, fetch_data_list);
+  }
+}
+
+#endif  // #ifndef SERIAL_MODE
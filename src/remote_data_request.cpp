@@ -0,0 +1,293 @@
+#ifndef SERIAL_MODE
+#include "remote_data_request.h"
+
+#include <memory>
+
+#include "async_analysis.h"
+#include "comm_mpi.h"
+#include "data_hub_amr.h"
+#include "libyt_process_control.h"
+#include "numpy_controller.h"
+#include "timer.h"
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : ToLabeledData
+// Description     : Convert AmrDataArray3D/2D/1D to AmrDataArrayLabeled with label.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass>
+static AmrDataArrayLabeled ToLabeledData(const DataClass& data, int label) {
+  AmrDataArrayLabeled labeled_data;
+  labeled_data.id = data.id;
+  labeled_data.label = label;
+  labeled_data.data_dtype = data.data_dtype;
+  int dim = sizeof(data.data_dim) / sizeof(data.data_dim[0]);
+  for (int d = 0; d < dim; d++) {
+    labeled_data.data_dim[d] = data.data_dim[d];
+  }
+  labeled_data.data_ptr = data.data_ptr;
+  labeled_data.contiguous_in_x = data.contiguous_in_x;
+  return labeled_data;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : GetOrCreateDict
+// Description     : Get py_dict[py_key], create an empty dictionary if it does not exist.
+//
+// Notes           : 1. Return borrowed reference.
+//-------------------------------------------------------------------------------------------------------
+static PyObject* GetOrCreateDict(PyObject* py_dict, PyObject* py_key) {
+  PyObject* py_value = PyDict_GetItem(py_dict, py_key);
+  if (py_value == nullptr) {
+    py_value = PyDict_New();
+    PyDict_SetItem(py_dict, py_key, py_value);
+    Py_DECREF(py_value);
+  }
+  return py_value;
+}
+
+RemoteDataRequest::RemoteDataRequest(
+    const std::vector<std::string>& fname_list,
+    const std::vector<RemoteParticleRequest>& particle_list,
+    const std::vector<long>& prepare_id_list,
+    const std::vector<CommMpiRmaQueryInfo>& fetch_data_list)
+    : fname_list_(fname_list),
+      particle_list_(particle_list),
+      prepare_id_list_(prepare_id_list),
+      fetch_data_list_(fetch_data_list) {}
+
+//-------------------------------------------------------------------------------------------------------
+// Class         :  RemoteDataRequest
+// Public Method :  Fetch
+//
+// Notes         :  1. Fetch all the requested fields and particle attributes, and wrap
+//                     them to new Python dictionaries:
+//                       py_field_output[grid id][field name]
+//                       py_particle_output[grid id][ptype][attribute]
+//                  2. It is a collective operation. If it fails in any process, both
+//                     outputs are set to nullptr.
+//-------------------------------------------------------------------------------------------------------
+RemoteDataRequestStatus RemoteDataRequest::Fetch(PyObject** py_field_output,
+                                                 PyObject** py_particle_output) {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
+
+  error_str_ = std::string();
+  *py_field_output = PyDict_New();
+  *py_particle_output = PyDict_New();
+
+  RemoteDataRequestStatus status;
+  int dimensionality =
+      LibytProcessControl::Get().GetDataStructureAmr().GetDimensionality();
+  if (dimensionality == 3) {
+    status = FetchWithFieldType<AmrDataArray3D>(*py_field_output, *py_particle_output);
+  } else if (dimensionality == 2) {
+    status = FetchWithFieldType<AmrDataArray2D>(*py_field_output, *py_particle_output);
+  } else {
+    status = FetchWithFieldType<AmrDataArray1D>(*py_field_output, *py_particle_output);
+  }
+
+  if (status != RemoteDataRequestStatus::kRequestSuccess) {
+    Py_DECREF(*py_field_output);
+    Py_DECREF(*py_particle_output);
+    *py_field_output = nullptr;
+    *py_particle_output = nullptr;
+  }
+
+  return status;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  RemoteDataRequest
+// Private Method :  FetchWithFieldType
+//
+// Notes          :  1. Labels are assigned to fields first, then to each particle
+//                      attribute, in the order they are requested.
+//                   2. Prepare local data of every label, and check the status once.
+//                      Then gather metadata and fetch data using a single RMA window.
+//                   3. Particle count is looked up once per particle type. Grids with no
+//                      particles are not exchanged, and are set to None like
+//                      get_particle_remote.
+//                   4. Data hubs keep the prepared data alive until the RMA window is
+//                      freed, and free newly allocated buffers when they are destroyed.
+//-------------------------------------------------------------------------------------------------------
+template<typename DataClass>
+RemoteDataRequestStatus RemoteDataRequest::FetchWithFieldType(
+    PyObject* py_field_output, PyObject* py_particle_output) {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerRma);
+
+  const DataStructureAmr& ds_amr = LibytProcessControl::Get().GetDataStructureAmr();
+  const int num_fields = static_cast<int>(fname_list_.size());
+
+  std::vector<AmrDataArrayLabeled> prepared_data_list;
+  std::vector<CommMpiRmaQueryInfo> fetch_data_list;
+  std::vector<std::unique_ptr<DataHubAmrField<DataClass>>> field_hub_list;
+  std::vector<std::unique_ptr<DataHubAmrParticle>> particle_hub_list;
+  DataHubStatus status = DataHubStatus::kDataHubSuccess;
+
+  // Prepare field data
+  for (int label = 0; label < num_fields; label++) {
+    field_hub_list.emplace_back(new DataHubAmrField<DataClass>(false));
+    DataHubReturn<DataClass> prepared_data = field_hub_list.back()->GetLocalFieldData(
+        ds_amr, fname_list_[label], prepare_id_list_);
+    if (prepared_data.status != DataHubStatus::kDataHubSuccess) {
+      error_str_ = field_hub_list.back()->GetErrorStr();
+      status = DataHubStatus::kDataHubFailed;
+      break;
+    }
+    for (const DataClass& data : prepared_data.data_list) {
+      prepared_data_list.emplace_back(ToLabeledData(data, label));
+    }
+    for (const CommMpiRmaQueryInfo& fetch_data : fetch_data_list_) {
+      fetch_data_list.emplace_back(
+          CommMpiRmaQueryInfo{fetch_data.mpi_rank, fetch_data.id, label});
+    }
+  }
+
+  // Prepare particle data, and record grids that have no particles
+  std::vector<std::pair<int, int>> particle_label_list;
+  std::vector<std::vector<long>> particle_count0_list(particle_list_.size());
+  int label = num_fields;
+  for (std::size_t p = 0; p < particle_list_.size(); p++) {
+    if (status != DataHubStatus::kDataHubSuccess) {
+      break;
+    }
+    int ptype_index = ds_amr.GetParticleIndex(particle_list_[p].ptype.c_str());
+
+    std::vector<long> count_list;
+    ds_amr.GetPythonBoundFullHierarchyGridParticleCount(
+        prepare_id_list_, ptype_index, count_list);
+    std::vector<long> prepare_id_list;
+    for (std::size_t i = 0; i < prepare_id_list_.size(); i++) {
+      if (count_list[i] > 0) {
+        prepare_id_list.emplace_back(prepare_id_list_[i]);
+      }
+    }
+
+    std::vector<long> fetch_id_list;
+    for (const CommMpiRmaQueryInfo& fetch_data : fetch_data_list_) {
+      fetch_id_list.emplace_back(fetch_data.id);
+    }
+    ds_amr.GetPythonBoundFullHierarchyGridParticleCount(
+        fetch_id_list, ptype_index, count_list);
+    std::vector<CommMpiRmaQueryInfo> ptype_fetch_data_list;
+    for (std::size_t i = 0; i < fetch_data_list_.size(); i++) {
+      if (count_list[i] > 0) {
+        ptype_fetch_data_list.emplace_back(fetch_data_list_[i]);
+      } else {
+        particle_count0_list[p].emplace_back(fetch_data_list_[i].id);
+      }
+    }
+
+    for (std::size_t a = 0; a < particle_list_[p].attr_list.size(); a++) {
+      particle_hub_list.emplace_back(new DataHubAmrParticle(false));
+      DataHubReturn<AmrDataArray1D> prepared_data =
+          particle_hub_list.back()->GetLocalParticleData(
+              ds_amr, particle_list_[p].ptype, particle_list_[p].attr_list[a],
+              prepare_id_list);
+      if (prepared_data.status != DataHubStatus::kDataHubSuccess) {
+        error_str_ = particle_hub_list.back()->GetErrorStr();
+        status = DataHubStatus::kDataHubFailed;
+        break;
+      }
+      for (const AmrDataArray1D& data : prepared_data.data_list) {
+        prepared_data_list.emplace_back(ToLabeledData(data, label));
+      }
+      for (const CommMpiRmaQueryInfo& fetch_data : ptype_fetch_data_list) {
+        fetch_data_list.emplace_back(
+            CommMpiRmaQueryInfo{fetch_data.mpi_rank, fetch_data.id, label});
+      }
+      particle_label_list.emplace_back(static_cast<int>(p), static_cast<int>(a));
+      label++;
+    }
+  }
+
+  // Fail fast if any process fails to prepare data
+  DataHubStatus all_status = static_cast<DataHubStatus>(CallWithoutGil([&] {
+    return CommMpi::CheckAllStates(static_cast<int>(status),
+                                   static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                   static_cast<int>(DataHubStatus::kDataHubSuccess),
+                                   static_cast<int>(DataHubStatus::kDataHubFailed));
+  }));
+  if (all_status != DataHubStatus::kDataHubSuccess) {
+    if (status == DataHubStatus::kDataHubSuccess) {
+      error_str_ = std::string("Error occurred in other MPI process.");
+    }
+    return RemoteDataRequestStatus::kRequestFailed;
+  }
+
+  // Call MPI RMA operation for all the labels at once
+  const yt_param_libyt& param_libyt = LibytProcessControl::Get().param_libyt_;
+  std::string spill_dir;
+  if (param_libyt.spill_dir != nullptr) {
+    spill_dir = param_libyt.spill_dir;
+  }
+  CommMpiRmaAmrDataArrayLabeled rma("remote_data", "amr_grid");
+  rma.SetMemoryBudget(param_libyt.memory_budget, spill_dir);
+  CommMpiRmaReturn<AmrDataArrayLabeled> rma_return = CallWithoutGil([&] {
+    return rma.GetRemoteData(prepared_data_list, fetch_data_list);
+  });
+  if (rma_return.all_status != CommMpiRmaStatus::kMpiSuccess) {
+    if (rma_return.status != CommMpiRmaStatus::kMpiSuccess) {
+      error_str_ = rma.GetErrorStr();
+    } else {
+      error_str_ = std::string("Error occurred in other MPI process.");
+    }
+    return RemoteDataRequestStatus::kRequestFailed;
+  }
+
+  // Wrap fetched data to Python dictionaries
+  const int field_dim = sizeof(DataClass::data_dim) / sizeof(DataClass::data_dim[0]);
+  for (const AmrDataArrayLabeled& fetched_data : rma_return.data_list) {
+    PyObject* py_grid_id = PyLong_FromLong(fetched_data.id);
+    PyObject* py_label_dict;
+    const char* label_name;
+    int dim;
+    if (fetched_data.label < num_fields) {
+      py_label_dict = GetOrCreateDict(py_field_output, py_grid_id);
+      label_name = fname_list_[fetched_data.label].c_str();
+      dim = field_dim;
+    } else {
+      const std::pair<int, int>& particle_label =
+          particle_label_list[fetched_data.label - num_fields];
+      const RemoteParticleRequest& particle = particle_list_[particle_label.first];
+      PyObject* py_ptype = PyUnicode_FromString(particle.ptype.c_str());
+      py_label_dict =
+          GetOrCreateDict(GetOrCreateDict(py_particle_output, py_grid_id), py_ptype);
+      Py_DECREF(py_ptype);
+      label_name = particle.attr_list[particle_label.second].c_str();
+      dim = 1;
+    }
+    Py_DECREF(py_grid_id);
+
+    if (fetched_data.data_ptr == nullptr) {
+      PyDict_SetItemString(py_label_dict, label_name, Py_None);
+      continue;
+    }
+    npy_intp npy_dim[3];
+    for (int d = 0; d < dim; d++) {
+      npy_dim[d] = fetched_data.data_dim[d];
+    }
+    PyObject* py_data = numpy_controller::ArrayToNumPyArray(
+        dim, npy_dim, fetched_data.data_dtype, fetched_data.data_ptr, false, true);
+    PyDict_SetItemString(py_label_dict, label_name, py_data);
+    Py_DECREF(py_data);
+  }
+
+  // Wrap grids that have no particles
+  for (std::size_t p = 0; p < particle_list_.size(); p++) {
+    PyObject* py_ptype = PyUnicode_FromString(particle_list_[p].ptype.c_str());
+    for (const long& gid : particle_count0_list[p]) {
+      PyObject* py_grid_id = PyLong_FromLong(gid);
+      PyObject* py_attr_dict =
+          GetOrCreateDict(GetOrCreateDict(py_particle_output, py_grid_id), py_ptype);
+      Py_DECREF(py_grid_id);
+      for (const std::string& attr : particle_list_[p].attr_list) {
+        PyDict_SetItemString(py_attr_dict, attr.c_str(), Py_None);
+      }
+    }
+    Py_DECREF(py_ptype);
+  }
+
+  return RemoteDataRequestStatus::kRequestSuccess;
+}
+
+#endif  // #ifndef SERIAL_MODE
@@ -1,19 +1,21 @@
-#ifdef SUPPORT_TIMER
-
 #include "timer.h"
 
-#include <iostream>
-#include <thread>
-
 #include "libyt_process_control.h"
 
 //-------------------------------------------------------------------------------------------------------
 // Class       :  Timer
 // Method      :  Constructor
 // Description :  Record start time
+//
+// Notes       :  1. If the category is not enabled, it doesn't read the clock and does
+//                   nothing when it is destroyed.
 //-------------------------------------------------------------------------------------------------------
-Timer::Timer(const char* func_name) : m_FuncName(func_name), m_Stopped(false) {
-  m_StartTime = std::chrono::high_resolution_clock::now();
+Timer::Timer(const char* func_name, TimerCategory category)
+    : m_FuncName(func_name), m_Category(category), m_Stopped(true) {
+  if (TimerControl::IsEnabled(category)) {
+    m_StartTime = std::chrono::high_resolution_clock::now();
+    m_Stopped = false;
+  }
 }
 
 //-------------------------------------------------------------------------------------------------------
@@ -28,7 +30,7 @@ Timer::~Timer() {
 //-------------------------------------------------------------------------------------------------------
 // Class       :  Timer
 // Method      :  Stop
-// Description :  Write profile
+// Description :  Record profile, it is written to file when the buffer is flushed
 //-------------------------------------------------------------------------------------------------------
 void Timer::Stop() {
   std::chrono::time_point<std::chrono::high_resolution_clock> endTime =
@@ -40,11 +42,9 @@ void Timer::Stop() {
   long long end = std::chrono::time_point_cast<std::chrono::microseconds>(endTime)
                       .time_since_epoch()
                       .count();
-  uint32_t threadID = std::hash<std::thread::id>{}(std::this_thread::get_id());
 
-  LibytProcessControl::Get().timer_control.WriteProfile(m_FuncName, start, end, threadID);
+  LibytProcessControl::Get().timer_control.WriteProfile(
+      m_FuncName, m_Category, start, end);
 
   m_Stopped = true;
 }
-
-#endif  // #ifdef SUPPORT_TIMER
@@ -1,96 +1,534 @@
-#ifdef SUPPORT_TIMER
-
 #include "timer_control.h"
 
-#include <string.h>
-
 #include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
+#ifndef SERIAL_MODE
+#include "comm_mpi.h"
+#endif
 #include "libyt.h"
 
+// Number of events each thread can hold before it has to flush, must be power of 2.
+static const std::size_t kTimerBufferCapacity = 8192;
+
+// Name of each category, in the same order as the bits in TimerCategory.
+static const char* kTimerCategoryNames[] = {
+    "general", "commit", "hierarchy", "rma", "python-exec", "derived-func"};
+static const int kNumTimerCategories =
+    sizeof(kTimerCategoryNames) / sizeof(kTimerCategoryNames[0]);
+
+// Number of ping-pongs between root and each process when synchronizing clocks.
+static const int kClockSyncRounds = 5;
+
+#ifdef SUPPORT_TIMER
+std::atomic<unsigned int> TimerControl::m_EnabledCategories(kTimerAll);
+#else
+std::atomic<unsigned int> TimerControl::m_EnabledCategories(kTimerNone);
+#endif
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetCategoryName
+// Description :  Get the name of a single category
+//-------------------------------------------------------------------------------------------------------
+static const char* GetCategoryName(TimerCategory category) {
+  for (int c = 0; c < kNumTimerCategories; c++) {
+    if (category == (1u << c)) {
+      return kTimerCategoryNames[c];
+    }
+  }
+  return "general";
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  WriteHeading
+// Description :  Write heading and basic info of the profile file
+//-------------------------------------------------------------------------------------------------------
+static void WriteHeading(std::ostream& file_out) {
+  file_out << "{\"otherData\": {" << "\"version\": \"" << LIBYT_MAJOR_VERSION << "."
+           << LIBYT_MINOR_VERSION << "." << LIBYT_MICRO_VERSION << "\","
+           << "\"mode\": "
+#if defined(INTERACTIVE_MODE)
+           << "\"interactive_mode\""
+#elif defined(JUPYTER_KERNEL)
+           << "\"jupyter_kernel_mode\""
+#else
+           << "\"normal_mode\""
+#endif
+           << "},";
+  file_out << "\"traceEvents\":[";
+}
+
+#ifndef SERIAL_MODE
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetClockNow
+// Description :  Read the clock used by Timer, in microseconds
+//-------------------------------------------------------------------------------------------------------
+static long long GetClockNow() {
+  return std::chrono::time_point_cast<std::chrono::microseconds>(
+             std::chrono::high_resolution_clock::now())
+      .time_since_epoch()
+      .count();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetClockOffsetToRoot
+// Description :  Get the offset of the clock on this process to the one on root, in
+//                microseconds
+//
+// Notes       :  1. Collective operation, every MPI process must call it.
+//                2. If MPI_Wtime is synchronized (MPI_WTIME_IS_GLOBAL), each process
+//                   measures its clock against MPI_Wtime, and only root's result is
+//                   broadcast.
+//                3. Otherwise, root exchanges kClockSyncRounds ping-pongs with each
+//                   process in turn, and takes the one with the shortest round trip,
+//                   assuming the reply is sent halfway through it.
+//                4. Messages are sent in a duplicated communicator, so that they never
+//                   match the ones sent by the simulation.
+//-------------------------------------------------------------------------------------------------------
+static long long GetClockOffsetToRoot(int rank, int root) {
+  MPI_Comm comm;
+  MPI_Comm_dup(CommMpi::GetComm(), &comm);
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  int* wtime_is_global = nullptr;
+  int flag = 0;
+  MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_WTIME_IS_GLOBAL, &wtime_is_global, &flag);
+
+  long long offset = 0;
+  if (flag && *wtime_is_global) {
+    long long wtime_offset = GetClockNow() - static_cast<long long>(MPI_Wtime() * 1.0e6);
+    long long root_wtime_offset = wtime_offset;
+    MPI_Bcast(&root_wtime_offset, 1, MPI_LONG_LONG, root, comm);
+    offset = wtime_offset - root_wtime_offset;
+  } else if (rank == root) {
+    for (int r = 0; r < size; r++) {
+      if (r == root) continue;
+      long long min_round_trip = -1;
+      long long rank_offset = 0;
+      for (int i = 0; i < kClockSyncRounds; i++) {
+        long long send_time = GetClockNow();
+        long long remote_time;
+        MPI_Sendrecv(&send_time,
+                     1,
+                     MPI_LONG_LONG,
+                     r,
+                     0,
+                     &remote_time,
+                     1,
+                     MPI_LONG_LONG,
+                     r,
+                     0,
+                     comm,
+                     MPI_STATUS_IGNORE);
+        long long round_trip = GetClockNow() - send_time;
+        if (min_round_trip < 0 || round_trip < min_round_trip) {
+          min_round_trip = round_trip;
+          rank_offset = remote_time - (send_time + round_trip / 2);
+        }
+      }
+      MPI_Send(&rank_offset, 1, MPI_LONG_LONG, r, 1, comm);
+    }
+  } else {
+    for (int i = 0; i < kClockSyncRounds; i++) {
+      long long send_time;
+      MPI_Recv(&send_time, 1, MPI_LONG_LONG, root, 0, comm, MPI_STATUS_IGNORE);
+      long long local_time = GetClockNow();
+      MPI_Send(&local_time, 1, MPI_LONG_LONG, root, 0, comm);
+    }
+    MPI_Recv(&offset, 1, MPI_LONG_LONG, root, 1, comm, MPI_STATUS_IGNORE);
+  }
+
+  MPI_Comm_free(&comm);
+  return offset;
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerBuffer
+// Method      :  Constructor
+// Description :  Allocate ring buffer, capacity is rounded up to power of 2.
+//-------------------------------------------------------------------------------------------------------
+TimerBuffer::TimerBuffer(std::size_t capacity, uint32_t thread_id)
+    : m_ThreadId(thread_id), m_Head(0), m_Tail(0) {
+  std::size_t size = 1;
+  while (size < capacity) size <<= 1;
+  m_Events.resize(size);
+  m_Mask = size - 1;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerBuffer
+// Method      :  Push
+// Description :  Append event to ring buffer
+//
+// Notes       :  1. Only called by the owner thread.
+//                2. Return false if the buffer is full.
+//-------------------------------------------------------------------------------------------------------
+bool TimerBuffer::Push(const TimerEvent& event) {
+  std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+  std::size_t head = m_Head.load(std::memory_order_acquire);
+  if (tail - head > m_Mask) {
+    return false;
+  }
+  m_Events[tail & m_Mask] = event;
+  m_Tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerBuffer
+// Method      :  Drain
+// Description :  Move every event pushed so far to events
+//
+// Notes       :  1. Caller must make sure there is only one consumer at a time.
+//-------------------------------------------------------------------------------------------------------
+void TimerBuffer::Drain(std::vector<TimerEvent>& events) {
+  std::size_t head = m_Head.load(std::memory_order_relaxed);
+  std::size_t tail = m_Tail.load(std::memory_order_acquire);
+  for (std::size_t i = head; i < tail; i++) {
+    events.push_back(m_Events[i & m_Mask]);
+  }
+  m_Head.store(tail, std::memory_order_release);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Method      :  Destructor
+// Description :  Flush events that are recorded after the last flush (ex: yt_finalize)
+//
+// Notes       :  1. If ranks are merged, it cannot gather events from other processes,
+//                   since MPI may have been finalized. Only root writes its own events.
+//-------------------------------------------------------------------------------------------------------
+TimerControl::~TimerControl() {
+  if (!m_MergeRanks) {
+    Flush();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_Lock);
+  if (m_MPIRank == m_MPIRoot) {
+    std::vector<std::string> all_profiles(1);
+    all_profiles[0].swap(m_PendingProfile);
+    for (const std::shared_ptr<TimerBuffer>& buffer : m_Buffers) {
+      WriteBuffer(*buffer, all_profiles[0]);
+    }
+    AppendToMergedFile(all_profiles);
+  }
+}
+
 //-------------------------------------------------------------------------------------------------------
 // Class       :  TimerControl
 // Method      :  CreateFile
-// Description :  Create profile result file and write headings
+// Description :  Set profile result file name, the file is created at the first write
 //-------------------------------------------------------------------------------------------------------
 void TimerControl::CreateFile(const char* filename, int rank) {
-  // Initialize
+  std::lock_guard<std::mutex> lock(m_Lock);
+
+  // Initialize, the file is overwritten when the first event is written to it.
   m_FileName = std::string(filename);
   m_MPIRank = rank;
   m_FirstLine = true;
+  m_FileCreated = false;
+  m_MergeRanks = false;
+  m_ClockOffset = 0;
+}
 
-  // Overwrite and create profile file
-  std::ofstream file_out;
-  file_out.open(m_FileName.c_str(), std::ofstream::out);
-
-  // Write heading and basic info
-  if (m_MPIRank == 0) {
-    file_out << "{\"otherData\": {" << "\"version\": \"" << LIBYT_MAJOR_VERSION << "."
-             << LIBYT_MINOR_VERSION << "." << LIBYT_MICRO_VERSION << "\"," << "\"mode\": "
-#if defined(INTERACTIVE_MODE)
-             << "\"interactive_mode\""
-#elif defined(JUPYTER_KERNEL)
-             << "\"jupyter_kernel_mode\""
-#else
-             << "\"normal_mode\""
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Method      :  CreateMergedFile
+// Description :  Set the file name that root writes every MPI process's profile to
+//
+// Notes       :  1. Collective operation, every MPI process must call it.
+//                2. Clocks are synchronized to root here, and timestamps written
+//                   afterwards are shifted by the offset, so that events of different
+//                   processes line up in the same timeline.
+//                3. Flush becomes a collective operation.
+//-------------------------------------------------------------------------------------------------------
+void TimerControl::CreateMergedFile(const char* filename, int rank, int root) {
+  int size = 1;
+  long long clock_offset = 0;
+#ifndef SERIAL_MODE
+  MPI_Comm_size(CommMpi::GetComm(), &size);
+  clock_offset = GetClockOffsetToRoot(rank, root);
 #endif
-             << "},";
-    file_out << "\"traceEvents\":[";
+
+  std::lock_guard<std::mutex> lock(m_Lock);
+  m_FileName = std::string(filename);
+  m_MPIRank = rank;
+  m_MPIRoot = root;
+  m_MPISize = size;
+  m_FirstLine = true;
+  m_FileCreated = false;
+  m_MergeRanks = true;
+  m_ClockOffset = clock_offset;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Method      :  ParseCategories
+// Description :  Parse comma-separated category names to bits of TimerCategory
+//
+// Notes       :  1. "all"/"on"/"1" enables every category, and "none"/"off"/"0"/""
+//                   disables all of them.
+//                2. Return false if there is unknown category, and categories is not
+//                   changed.
+//-------------------------------------------------------------------------------------------------------
+bool TimerControl::ParseCategories(const std::string& categories_str,
+                                   unsigned int* categories) {
+  unsigned int result = kTimerNone;
+  std::stringstream ss(categories_str);
+  std::string name;
+  while (std::getline(ss, name, ',')) {
+    name.erase(0, name.find_first_not_of(" \t"));
+    name.erase(name.find_last_not_of(" \t") + 1);
+    if (name.empty() || name == "none" || name == "off" || name == "0") {
+      continue;
+    } else if (name == "all" || name == "on" || name == "1") {
+      result |= kTimerAll;
+      continue;
+    }
+
+    bool found = false;
+    for (int c = 0; c < kNumTimerCategories; c++) {
+      if (name == kTimerCategoryNames[c]) {
+        result |= (1u << c);
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      return false;
+    }
   }
 
-  file_out.close();
+  *categories = result;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Method      :  GetCategoriesStr
+// Description :  Get comma-separated category names, or "none" if none of them is set
+//-------------------------------------------------------------------------------------------------------
+std::string TimerControl::GetCategoriesStr(unsigned int categories) {
+  std::string result;
+  for (int c = 0; c < kNumTimerCategories; c++) {
+    if (categories & (1u << c)) {
+      if (!result.empty()) result += ",";
+      result += kTimerCategoryNames[c];
+    }
+  }
+  return result.empty() ? std::string("none") : result;
 }
 
 //-------------------------------------------------------------------------------------------------------
 // Class       :  TimerControl
 // Method      :  WriteProfile
-// Description :  Write profile to file
+// Description :  Record profile in the calling thread's buffer
 //
-// Notes       :  1. Please refer to chrome tracing format
-//                   (https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU/preview#heading=h.uxpopqvbjezh)
+// Notes       :  1. It does not take a lock unless the buffer is full, in which case the
+//                   buffer is flushed to file first. If ranks are merged, it is kept in
+//                   memory until the next flush instead.
 //                2. This is thread-safe.
-//                3. Function name cannot contain " double-quote, it will be replaced to
-//                '.
 //
 // Parameters  :  func_name : function name
+//                category  : category of the event
 //                start     : start time
 //                end       : end time
-//                thread_id : thread id
 //-------------------------------------------------------------------------------------------------------
-void TimerControl::WriteProfile(const char* func_name, long long start, long long end,
-                                uint32_t thread_id) {
-  std::lock_guard<std::mutex> lock(m_Lock);
+void TimerControl::WriteProfile(const char* func_name, TimerCategory category,
+                                long long start, long long end) {
+  TimerBuffer& buffer = GetThreadBuffer();
+  TimerEvent event{func_name, category, start, end};
+  if (buffer.Push(event)) {
+    return;
+  }
 
-  // replace " to ' in func_name;
-  std::string func_name_str = std::string(func_name);
-  std::replace(func_name_str.begin(), func_name_str.end(), '"', '\'');
-
-  // Set profile string, write to file
-  char profile[1000];
-  sprintf(profile,
-          "%s{\"name\":\"%s\","
-          "\"cat\":\"function\","
-          "\"dur\":%lld,"
-          "\"ph\":\"X\","
-          "\"pid\":%d,"
-          "\"tid\":%llu,"
-          "\"ts\":%lld"
-          "}",
-          m_FirstLine ? "" : ",",
-          func_name_str.c_str(),
-          end - start,
-          m_MPIRank,
-          (long long int)thread_id,
-          start);
+  std::string profile;
+  {
+    std::lock_guard<std::mutex> lock(m_Lock);
+    WriteBuffer(buffer, profile);
+    if (m_MergeRanks) {
+      m_PendingProfile += profile;
+    } else {
+      AppendToFile(profile);
+    }
+  }
+  buffer.Push(event);
+}
 
-  std::ofstream file_out;
-  file_out.open(m_FileName.c_str(), std::ofstream::out | std::ofstream::app);
-  file_out.write(profile, strlen(profile));
-  m_FirstLine = false;
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Method      :  Flush
+// Description :  Write events in every thread's buffer to file
+//
+// Notes       :  1. It is called in yt_free and yt_finalize, so the file is opened only
+//                   once per step.
+//                2. This is thread-safe.
+//                3. If ranks are merged, this is a collective operation. Events are
+//                   gathered to root without holding the lock, since gathering is also
+//                   profiled.
+//-------------------------------------------------------------------------------------------------------
+void TimerControl::Flush() {
+  std::string profile;
+  {
+    std::lock_guard<std::mutex> lock(m_Lock);
+    profile.swap(m_PendingProfile);
+    for (const std::shared_ptr<TimerBuffer>& buffer : m_Buffers) {
+      WriteBuffer(*buffer, profile);
+    }
+    if (!m_MergeRanks) {
+      AppendToFile(profile);
+      return;
+    }
+  }
+
+  std::vector<std::string> all_profiles;
+#ifndef SERIAL_MODE
+  CommMpi::GatherAllStringsToRank(all_profiles, profile, m_MPIRoot);
+#else
+  all_profiles.push_back(profile);
+#endif
+  if (m_MPIRank == m_MPIRoot) {
+    std::lock_guard<std::mutex> lock(m_Lock);
+    AppendToMergedFile(all_profiles);
+  }
+}
 
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Method      :  GetThreadBuffer
+// Description :  Get the buffer of the calling thread, create and register one if it
+//                doesn't exist yet.
+//
+// Notes       :  1. TimerControl shares ownership of the buffer, so events of a thread
+//                   that has already exited are still flushed.
+//-------------------------------------------------------------------------------------------------------
+TimerBuffer& TimerControl::GetThreadBuffer() {
+  thread_local std::shared_ptr<TimerBuffer> thread_buffer;
+  if (thread_buffer == nullptr) {
+    uint32_t thread_id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    thread_buffer = std::make_shared<TimerBuffer>(kTimerBufferCapacity, thread_id);
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_Buffers.push_back(thread_buffer);
+  }
+  return *thread_buffer;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Method      :  WriteBuffer
+// Description :  Drain buffer and append the events to profile in chrome tracing format
+//
+// Notes       :  1. Please refer to chrome tracing format
+//                   (https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU/preview#heading=h.uxpopqvbjezh)
+//                2. m_Lock must be held by the caller.
+//                3. Function name cannot contain " double-quote, it will be replaced to
+//                '.
+//-------------------------------------------------------------------------------------------------------
+void TimerControl::WriteBuffer(TimerBuffer& buffer, std::string& profile) {
+  m_DrainedEvents.clear();
+  buffer.Drain(m_DrainedEvents);
+
+  std::string tid = std::to_string((long long int)buffer.GetThreadId());
+  std::string pid = std::to_string(m_MPIRank);
+  for (const TimerEvent& event : m_DrainedEvents) {
+    // replace " to ' in func_name;
+    std::string func_name_str = std::string(event.func_name);
+    std::replace(func_name_str.begin(), func_name_str.end(), '"', '\'');
+
+    profile += m_FirstLine ? "{\"name\":\"" : ",{\"name\":\"";
+    profile += func_name_str;
+    profile += "\",\"cat\":\"";
+    profile += GetCategoryName(event.category);
+    profile += "\",\"dur\":";
+    profile += std::to_string(event.end - event.start);
+    profile += ",\"ph\":\"X\",\"pid\":";
+    profile += pid;
+    profile += ",\"tid\":";
+    profile += tid;
+    profile += ",\"ts\":";
+    profile += std::to_string(event.start - m_ClockOffset);
+    profile += "}";
+    m_FirstLine = false;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Method      :  AppendToFile
+// Description :  Append profile to file
+//
+// Notes       :  1. m_Lock must be held by the caller.
+//                2. Do nothing if the file name is not set or profile is empty.
+//                3. Create the file and write headings at the first call.
+//-------------------------------------------------------------------------------------------------------
+void TimerControl::AppendToFile(const std::string& profile) {
+  if (m_FileName.empty() || profile.empty()) {
+    return;
+  }
+
+  std::ofstream file_out;
+  if (m_FileCreated) {
+    file_out.open(m_FileName.c_str(), std::ofstream::out | std::ofstream::app);
+  } else {
+    // Overwrite and create profile file, and write heading and basic info
+    file_out.open(m_FileName.c_str(), std::ofstream::out);
+    if (m_MPIRank == 0) {
+      WriteHeading(file_out);
+    }
+    m_FileCreated = true;
+  }
+  file_out.write(profile.c_str(), profile.size());
   file_out.close();
 }
 
-#endif  // #ifdef SUPPORT_TIMER
+//-------------------------------------------------------------------------------------------------------
+// Class       :  TimerControl
+// Method      :  AppendToMergedFile
+// Description :  Append profiles of every MPI process to the merged file
+//
+// Notes       :  1. m_Lock must be held by the caller, and it is only called on root.
+//                2. Do nothing if the file name is not set or every profile is empty.
+//                3. Create the file and write headings and the name of each process at
+//                   the first call.
+//                4. The file always ends with "]}", so that it is a valid JSON file even
+//                   if the simulation crashes. The closing is overwritten by the next
+//                   append.
+//-------------------------------------------------------------------------------------------------------
+void TimerControl::AppendToMergedFile(const std::vector<std::string>& all_profiles) {
+  // Each profile starts with a comma unless it is the first one of the process.
+  std::string profile;
+  for (const std::string& rank_profile : all_profiles) {
+    if (rank_profile.empty()) continue;
+    profile += ",";
+    profile.append(rank_profile, (rank_profile[0] == ',') ? 1 : 0, std::string::npos);
+  }
+  if (m_FileName.empty() || profile.empty()) {
+    return;
+  }
+
+  std::fstream file_out;
+  if (m_FileCreated) {
+    file_out.open(m_FileName.c_str(), std::fstream::in | std::fstream::out);
+    file_out.seekp(-2, std::fstream::end);
+  } else {
+    file_out.open(m_FileName.c_str(), std::fstream::out | std::fstream::trunc);
+    WriteHeading(file_out);
+    for (int r = 0; r < m_MPISize; r++) {
+      file_out << (r == 0 ? "" : ",")
+               << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << r
+               << ",\"args\":{\"name\":\"MPI rank " << r << "\"}}";
+    }
+    m_FileCreated = true;
+  }
+  file_out.write(profile.c_str(), profile.size());
+  file_out << "]}";
+  file_out.close();
+}
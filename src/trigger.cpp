@@ -0,0 +1,329 @@
+#include "trigger.h"
+
+#ifndef SERIAL_MODE
+#include <mpi.h>
+
+#include "comm_mpi.h"
+#endif
+
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "dtype_utilities.h"
+#include "libyt.h"
+#include "libyt_process_control.h"
+#include "logging.h"
+#include "perf_counter.h"
+#include "timer.h"
+
+struct Trigger {
+  yt_trigger trigger;
+  std::string field_name;  // owns trigger.field_name
+  bool is_fired = false;
+  bool has_fired = false;  // for YT_TRIGGER_EVERY_TIME
+  double last_fired_time = 0.0;
+};
+
+// Ordered by function name, so that field triggers are reduced in the same order on
+// every process.
+static std::map<std::string, Trigger> triggers;
+static long evaluated_step = -1;
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ReduceFieldData
+// Description :  Update the maximum and minimum with a C-contiguous array of dimensions
+//                dims, excluding ghost_lo and ghost_hi cells on each side.
+//-------------------------------------------------------------------------------------------------------
+template<typename T>
+static void ReduceFieldData(const T* data, const int* dims, const int* ghost_lo,
+                            const int* ghost_hi, double* local_max, double* local_min) {
+  for (int i = ghost_lo[0]; i < dims[0] - ghost_hi[0]; i++) {
+    for (int j = ghost_lo[1]; j < dims[1] - ghost_hi[1]; j++) {
+      const T* row = data + (static_cast<long>(i) * dims[1] + j) * dims[2];
+      for (int k = ghost_lo[2]; k < dims[2] - ghost_hi[2]; k++) {
+        double value = static_cast<double>(row[k]);
+        if (value > *local_max) *local_max = value;
+        if (value < *local_min) *local_min = value;
+      }
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ReduceLocalField
+// Description :  Get the maximum and minimum of field v over local grids.
+//
+// Notes       :  1. Data dimensions are resolved the same way as binding local data to
+//                   Python, and ghost cells of cell-centered fields are excluded.
+//                2. Grids without data are skipped, so derived fields never trigger.
+//                3. local_max and local_min stay -inf and inf if there is no data.
+//-------------------------------------------------------------------------------------------------------
+static void ReduceLocalField(int v, double* local_max, double* local_min) {
+  LibytProcessControl& control = LibytProcessControl::Get();
+  const yt_field& field = control.data_structure_amr_.GetFieldList()[v];
+  const yt_grid* grids_local = control.data_structure_amr_.GetGridsLocal();
+  const int dimensionality = control.param_yt_.dimensionality;
+  const bool is_cell_centered = (strcmp(field.field_type, "cell-centered") == 0);
+
+  *local_max = -std::numeric_limits<double>::infinity();
+  *local_min = std::numeric_limits<double>::infinity();
+  for (int g = 0; g < control.param_yt_.num_grids_local; g++) {
+    const yt_grid& grid = grids_local[g];
+    if (grid.field_data == nullptr || grid.field_data[v].data_ptr == nullptr) {
+      continue;
+    }
+    const yt_data& field_data = grid.field_data[v];
+    yt_dtype data_dtype = (dtype_utilities::GetYtDtypeSize(field_data.data_dtype) > 0)
+                              ? field_data.data_dtype
+                              : field.field_dtype;
+
+    int dims[3] = {1, 1, 1}, ghost_lo[3] = {0, 0, 0}, ghost_hi[3] = {0, 0, 0};
+    for (int d = 0; d < dimensionality; d++) {
+      if (is_cell_centered) {
+        ghost_lo[d] = field.field_ghost_cell[2 * d];
+        ghost_hi[d] = field.field_ghost_cell[2 * d + 1];
+        dims[d] = (field.contiguous_in_x ? grid.grid_dimensions[(dimensionality - 1) - d]
+                                         : grid.grid_dimensions[d]) +
+                  ghost_lo[d] + ghost_hi[d];
+      } else {
+        dims[d] = field_data.data_dimensions[d];
+      }
+    }
+
+    const void* data = field_data.data_ptr;
+    switch (data_dtype) {
+      case YT_FLOAT:
+        ReduceFieldData(static_cast<const float*>(data), dims, ghost_lo, ghost_hi,
+                        local_max, local_min);
+        break;
+      case YT_DOUBLE:
+        ReduceFieldData(static_cast<const double*>(data), dims, ghost_lo, ghost_hi,
+                        local_max, local_min);
+        break;
+      case YT_LONGDOUBLE:
+        ReduceFieldData(static_cast<const long double*>(data), dims, ghost_lo,
+                        ghost_hi, local_max, local_min);
+        break;
+      case YT_CHAR:
+        ReduceFieldData(static_cast<const signed char*>(data), dims, ghost_lo,
+                        ghost_hi, local_max, local_min);
+        break;
+      case YT_UCHAR:
+        ReduceFieldData(static_cast<const unsigned char*>(data), dims, ghost_lo,
+                        ghost_hi, local_max, local_min);
+        break;
+      case YT_SHORT:
+        ReduceFieldData(static_cast<const short*>(data), dims, ghost_lo, ghost_hi,
+                        local_max, local_min);
+        break;
+      case YT_USHORT:
+        ReduceFieldData(static_cast<const unsigned short*>(data), dims, ghost_lo,
+                        ghost_hi, local_max, local_min);
+        break;
+      case YT_INT:
+        ReduceFieldData(static_cast<const int*>(data), dims, ghost_lo, ghost_hi,
+                        local_max, local_min);
+        break;
+      case YT_UINT:
+        ReduceFieldData(static_cast<const unsigned int*>(data), dims, ghost_lo,
+                        ghost_hi, local_max, local_min);
+        break;
+      case YT_LONG:
+        ReduceFieldData(static_cast<const long*>(data), dims, ghost_lo, ghost_hi,
+                        local_max, local_min);
+        break;
+      case YT_ULONG:
+        ReduceFieldData(static_cast<const unsigned long*>(data), dims, ghost_lo,
+                        ghost_hi, local_max, local_min);
+        break;
+      case YT_LONGLONG:
+        ReduceFieldData(static_cast<const long long*>(data), dims, ghost_lo, ghost_hi,
+                        local_max, local_min);
+        break;
+      case YT_ULONGLONG:
+        ReduceFieldData(static_cast<const unsigned long long*>(data), dims, ghost_lo,
+                        ghost_hi, local_max, local_min);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : trigger
+// Function name : Set
+//
+// Notes         :  1. Replace the trigger of the function, or remove it if trigger is
+//                     nullptr.
+//                  2. Field names are copied, and they are looked up when the trigger is
+//                     evaluated, since fields may not be set yet.
+//-------------------------------------------------------------------------------------------------------
+int trigger::Set(const char* function_name, const yt_trigger* trigger) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  if (trigger == nullptr) {
+    triggers.erase(function_name);
+    return YT_SUCCESS;
+  }
+
+  switch (trigger->trigger_type) {
+    case YT_TRIGGER_EVERY_STEPS: {
+      if (trigger->every_steps <= 0) {
+        YT_ABORT("Trigger of \"%s\" has every_steps = %ld <= 0.\n",
+                 function_name,
+                 trigger->every_steps);
+      }
+      break;
+    }
+    case YT_TRIGGER_EVERY_TIME: {
+      if (!(trigger->every_time > 0.0)) {
+        YT_ABORT("Trigger of \"%s\" has every_time = %f <= 0.\n",
+                 function_name,
+                 trigger->every_time);
+      }
+      break;
+    }
+    case YT_TRIGGER_FIELD_MAX_ABOVE:
+    case YT_TRIGGER_FIELD_MIN_BELOW: {
+      if (trigger->field_name == nullptr) {
+        YT_ABORT("Trigger of \"%s\" has no field_name.\n", function_name);
+      }
+      break;
+    }
+    default: {
+      YT_ABORT("Trigger of \"%s\" has unknown trigger_type.\n", function_name);
+    }
+  }
+
+  Trigger& item = triggers[function_name];
+  item = Trigger();
+  item.trigger = *trigger;
+  if (trigger->field_name != nullptr) {
+    item.field_name = trigger->field_name;
+  }
+  item.trigger.field_name = nullptr;
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : trigger
+// Function name : Evaluate
+//
+// Notes         :  1. Collective operation on the libyt communicator if any field trigger
+//                     is set. It must be called after BindInfoToPython, which builds the
+//                     field name lookup table, and before local grids are cleaned up.
+//                  2. A field trigger of an unknown field or a derived field never fires.
+//-------------------------------------------------------------------------------------------------------
+int trigger::Evaluate() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  LibytProcessControl& control = LibytProcessControl::Get();
+  evaluated_step = control.param_libyt_.counter;
+  if (triggers.empty()) {
+    return YT_SUCCESS;
+  }
+  perf_counter::ScopedTimer perf_timer("trigger.eval_time");
+
+  std::vector<Trigger*> field_triggers;
+  std::vector<double> local_values;
+  for (auto& item : triggers) {
+    Trigger& t = item.second;
+    switch (t.trigger.trigger_type) {
+      case YT_TRIGGER_EVERY_STEPS: {
+        t.is_fired = (control.param_libyt_.counter % t.trigger.every_steps == 0);
+        break;
+      }
+      case YT_TRIGGER_EVERY_TIME: {
+        double current_time = control.param_yt_.current_time;
+        t.is_fired =
+            !t.has_fired || current_time >= t.last_fired_time + t.trigger.every_time;
+        if (t.is_fired) {
+          t.has_fired = true;
+          t.last_fired_time = current_time;
+        }
+        break;
+      }
+      case YT_TRIGGER_FIELD_MAX_ABOVE:
+      case YT_TRIGGER_FIELD_MIN_BELOW: {
+        // Reduce -min with MPI_MAX, so that every field trigger is in one reduction
+        double local_max = -std::numeric_limits<double>::infinity();
+        double local_min = std::numeric_limits<double>::infinity();
+        int v = control.data_structure_amr_.GetFieldIndex(t.field_name.c_str());
+        if (v >= 0) {
+          ReduceLocalField(v, &local_max, &local_min);
+        } else {
+          logging::LogWarning("Trigger of \"%s\": field \"%s\" is not found.\n",
+                              item.first.c_str(),
+                              t.field_name.c_str());
+        }
+        field_triggers.push_back(&t);
+        local_values.push_back(
+            (t.trigger.trigger_type == YT_TRIGGER_FIELD_MAX_ABOVE) ? local_max
+                                                                   : -local_min);
+        break;
+      }
+      default: {
+        t.is_fired = false;
+        break;
+      }
+    }
+  }
+
+  if (!field_triggers.empty()) {
+    std::vector<double> values(local_values);
+#ifndef SERIAL_MODE
+    MPI_Allreduce(local_values.data(),
+                  values.data(),
+                  static_cast<int>(local_values.size()),
+                  MPI_DOUBLE,
+                  MPI_MAX,
+                  CommMpi::GetComm());
+#endif
+    for (std::size_t i = 0; i < field_triggers.size(); i++) {
+      Trigger& t = *field_triggers[i];
+      t.is_fired = (t.trigger.trigger_type == YT_TRIGGER_FIELD_MAX_ABOVE)
+                       ? values[i] > t.trigger.threshold
+                       : -values[i] < t.trigger.threshold;
+    }
+  }
+
+  for (const auto& item : triggers) {
+    logging::LogDebug("Trigger of \"%s\" ... %s\n",
+                      item.first.c_str(),
+                      item.second.is_fired ? "fired" : "not fired");
+  }
+
+  return YT_SUCCESS;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : trigger
+// Function name : IsFired
+//
+// Notes         :  1. Return true if the function has no trigger, or its trigger fired in
+//                     this step.
+//-------------------------------------------------------------------------------------------------------
+bool trigger::IsFired(const char* function_name) {
+  auto it = triggers.find(function_name);
+  if (it == triggers.end()) {
+    return true;
+  }
+  return it->second.is_fired &&
+         evaluated_step == LibytProcessControl::Get().param_libyt_.counter;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Namespace     : trigger
+// Function name : Finalize
+//
+// Notes         :  1. Remove every trigger.
+//-------------------------------------------------------------------------------------------------------
+void trigger::Finalize() {
+  triggers.clear();
+  evaluated_step = -1;
+}
@@ -1,8 +1,14 @@
+#include "async_analysis.h"
 #include "big_mpi.h"
+#include "deferred_binding.h"
+#include "in_transit.h"
 #include "libyt.h"
 #include "libyt_process_control.h"
 #include "logging.h"
+#include "node_aggregation.h"
+#include "perf_counter.h"
 #include "timer.h"
+#include "trigger.h"
 
 #ifdef SUPPORT_VALGRIND
 #include <valgrind/valgrind.h>
@@ -17,11 +23,22 @@
  * 1. Must call \ref yt_get_FieldsPtr (if num_fields>0),
  *    \ref yt_get_ParticlesPtr (if num_par_types>0), and \ref yt_get_GridsPtr.
  * 2. Call DataStructureAmr to bind info, bind hierarchy, and bind local data to Python.
+ * 3. Simulation processes in in-transit mode do not have Python. They only bind data to
+ *    the local hierarchy, send local grids and data to analysis processes, and return
+ *    once the data is staged.
+ * 4. Node members in node aggregation only share local grids and data with their node
+ *    leader, which gathers them before binding them to Python. It is a collective
+ *    operation on the node.
+ * 5. Triggers set by \ref yt_set_FunctionTrigger are evaluated on the committed data.
+ * 6. Binding the full hierarchy and local data is deferred until an inline function
+ *    runs, if none of the functions called in the previous step will run in this step.
  *
  * @return \ref YT_SUCCESS or \ref YT_FAIL
  */
 int yt_commit() {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerCommit);
+  perf_counter::ScopedTimer perf_timer("commit.total_time");
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_) {
@@ -54,12 +71,85 @@ int yt_commit() {
     YT_ABORT("Please invoke yt_get_GridsPtr() before calling %s()!\n", __FUNCTION__);
   }
 
+  // Share local grids with the node leader. Data is bound to the local hierarchy first,
+  // since derived field and particle functions called while copying it look up grids
+  // through yt_getGridInfo_*.
+  if (node_aggregation::IsMember()) {
+    LibytProcessControl::Get().commit_grids_ = true;
+    DataStructureOutput status =
+        LibytProcessControl::Get().data_structure_amr_.BindLocalHierarchy();
+    if (status.status != DataStructureStatus::kDataStructureSuccess) {
+      logging::LogError(status.error.c_str());
+      YT_ABORT("Loading local hierarchy to libyt ... failed!\n");
+    }
+    if (node_aggregation::ShareGrids() != YT_SUCCESS) {
+      YT_ABORT("Sharing local grids and data with node leader ... failed!\n");
+    }
+    LibytProcessControl::Get().data_structure_amr_.CleanUpGridsLocal();
+    logging::LogDebug("Sharing local grids and data with node leader ... done!\n");
+    return YT_SUCCESS;
+  }
+
+  // Ship local grids to analysis processes in in-transit mode. Data is bound to the local
+  // hierarchy first for the same reason, and local grids are kept until yt_free, so that
+  // yt_getGridInfo_* still works on them afterward.
+  if (in_transit::IsSimulationRank()) {
+    LibytProcessControl::Get().commit_grids_ = true;
+    DataStructureOutput status =
+        LibytProcessControl::Get().data_structure_amr_.CheckLocalData();
+    if (status.status == DataStructureStatus::kDataStructureSuccess) {
+      status = LibytProcessControl::Get().data_structure_amr_.BindLocalHierarchy();
+    }
+    if (status.status != DataStructureStatus::kDataStructureSuccess) {
+      logging::LogError(status.error.c_str());
+      YT_ABORT("Loading local hierarchy to libyt ... failed!\n");
+    }
+    if (trigger::Evaluate() != YT_SUCCESS) {
+      YT_ABORT("Evaluating triggers of inline functions ... failed!\n");
+    }
+    logging::LogInfo("Sending local grids and data to analysis processes ...\n");
+    if (in_transit::SendCommit() != YT_SUCCESS) {
+      YT_ABORT("Sending local grids and data ... failed!\n");
+    }
+    logging::LogInfo("Sending local grids and data ... done.\n");
+    return YT_SUCCESS;
+  }
+
+  // Finish inline functions run asynchronously in previous steps that are done, and
+  // apply backpressure if the snapshot ring is still full
+  if (async_analysis::IsEnabled()) {
+    std::vector<AsyncAnalysisJob> finished_jobs;
+    {
+      perf_counter::ScopedTimer perf_wait_timer("commit.async_wait_time");
+      async_analysis::BeginStep(finished_jobs);
+    }
+    for (const AsyncAnalysisJob& job : finished_jobs) {
+      async_analysis::FinishJob(job);
+    }
+    if (async_analysis::IsStepSkipped()) {
+      logging::LogWarning("Inline functions in step %ld are skipped, since %d steps are "
+                          "still running.\n",
+                          LibytProcessControl::Get().param_libyt_.counter,
+                          async_analysis::GetMaxSteps());
+    }
+  }
+
   logging::LogInfo("Loading full hierarchy and local data to libyt ...\n");
 
+  if (node_aggregation::IsLeader()) {
+    if (node_aggregation::GatherGrids() != YT_SUCCESS) {
+      YT_ABORT("Gathering local grids and data from node members ... failed!\n");
+    }
+    logging::LogDebug("Gathering local grids and data from node members ... done!\n");
+  }
+
   // Add field_list to libyt.param_yt['field_list'] dictionary
   DataStructureOutput status;
-  status = LibytProcessControl::Get().data_structure_amr_.BindInfoToPython(
-      "libyt.param_yt", LibytProcessControl::Get().py_param_yt_);
+  {
+    perf_counter::ScopedTimer perf_bind_timer("commit.bind_time");
+    status = LibytProcessControl::Get().data_structure_amr_.BindInfoToPython(
+        "libyt.param_yt", LibytProcessControl::Get().py_param_yt_);
+  }
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
     logging::LogDebug("Loading field/particle info to libyt ... done!\n");
   } else {
@@ -67,26 +157,27 @@ int yt_commit() {
     YT_ABORT("Loading field/particle info to libyt ... failed!\n");
   }
 
-  int root_rank = 0;
-  status =
-      LibytProcessControl::Get().data_structure_amr_.BindAllHierarchyToPython(root_rank);
-  if (status.status == DataStructureStatus::kDataStructureSuccess) {
-    logging::LogDebug("Loading full hierarchy to libyt ... done!\n");
-  } else {
-    logging::LogError(status.error.c_str());
-    YT_ABORT("Loading full hierarchy to libyt ... failed!\n");
+  // Decide which inline functions run in this step, before local grids are cleaned up
+  if (trigger::Evaluate() != YT_SUCCESS) {
+    YT_ABORT("Evaluating triggers of inline functions ... failed!\n");
   }
 
-  status = LibytProcessControl::Get().data_structure_amr_.BindLocalDataToPython();
-  if (status.status == DataStructureStatus::kDataStructureSuccess) {
-    logging::LogDebug("Loading local data to libyt ... done!\n");
+  // If binding is deferrable, bind only if any inline function will run in this step,
+  // otherwise defer it until the first one does
+  if (!LibytProcessControl::Get().param_libyt_.defer_binding ||
+      deferred_binding::WillAnyFunctionRun()) {
+    if (deferred_binding::Bind() != YT_SUCCESS) {
+      YT_ABORT("Loading full hierarchy and local data ... failed!\n");
+    }
   } else {
-    logging::LogError(status.error.c_str());
-    YT_ABORT("Loading local data to libyt ... failed!\n");
+    deferred_binding::Defer();
+    logging::LogInfo("No inline function will run in this step, binding is deferred.\n");
   }
 
-  // Free grids_local
-  LibytProcessControl::Get().data_structure_amr_.CleanUpGridsLocal();
+  // Free grids_local, unless they are bound later
+  if (!deferred_binding::IsDeferred()) {
+    LibytProcessControl::Get().data_structure_amr_.CleanUpGridsLocal();
+  }
 
   // Above all works like charm
   LibytProcessControl::Get().commit_grids_ = true;
@@ -1,7 +1,13 @@
+#include "async_analysis.h"
+#include "deferred_binding.h"
+#include "in_transit.h"
+#include "inline_function.h"
 #include "libyt.h"
 #include "libyt_process_control.h"
 #include "logging.h"
+#include "node_aggregation.h"
 #include "timer.h"
+#include "trigger.h"
 
 #ifdef USE_PYBIND11
 #include "pybind11/embed.h"
@@ -34,14 +40,43 @@ int yt_finalize() {
     YT_ABORT("Please invoke yt_free() before calling yt_finalize().\n");
   }
 
+  // Stop the analysis thread and acquire the GIL back before Python is finalized
+  yt_wait();
+  async_analysis::Finalize();
+
+  // Python is not initialized on node members and simulation processes in in-transit
+  // mode
+  if (!node_aggregation::IsMember() && !in_transit::IsSimulationRank()) {
+    inline_function::InvalidateCache();
 #ifndef USE_PYBIND11
-  Py_Finalize();
+    Py_Finalize();
 #else
-  pybind11::finalize_interpreter();
+    pybind11::finalize_interpreter();
 #endif
+  }
 
   LibytProcessControl::Get().libyt_initialized_ = false;
 
+  // Write the rest of the time profile to file
+  LibytProcessControl::Get().timer_control.Flush();
+
+  // Write the rest of the aggregated log messages
+  logging::Flush();
+
+  // Let analysis processes return from yt_run_InTransit in in-transit mode
+  in_transit::Finalize();
+  node_aggregation::Finalize();
+  trigger::Finalize();
+  deferred_binding::Finalize();
+
+#ifndef SERIAL_MODE
+  // Free the duplicate of comm made in yt_initialize, after the group communicators split
+  // from it are freed
+  MPI_Comm libyt_comm = MPI_Comm_f2c(LibytProcessControl::Get().param_libyt_.comm_f);
+  MPI_Comm_free(&libyt_comm);
+  CommMpi::SetComm(MPI_COMM_WORLD);
+#endif
+
   return YT_SUCCESS;
 
 }  // FUNCTION : yt_finalize
@@ -1,13 +1,22 @@
+#include "async_analysis.h"
+#include "deferred_binding.h"
 #include "function_info.h"
+#include "in_transit.h"
 #include "libyt.h"
 #include "libyt_process_control.h"
 #include "logging.h"
+#include "memory_tracker.h"
+#include "node_aggregation.h"
+#include "perf_counter.h"
+#include "python_profiler.h"
 #include "timer.h"
 
 #ifdef USE_PYBIND11
 #include "pybind11/embed.h"
 #endif
 
+static void ClearLibytModule();
+
 /**
  * \defgroup api_yt_free libyt API: yt_free
  * \fn int yt_free()
@@ -16,11 +25,16 @@
  * \details
  * 1. Call this after finishing in situ analysis in this round, or when we want to free
  *    everything allocated by libyt.
+ * 2. Node members in node aggregation wait here until their node leader is done with
+ *    the data they share.
+ * 3. Status and load imbalance of inline functions called in this step are
+ *    synchronized here, in a single collective.
  *
  * @return \ref YT_SUCCESS or \ref YT_FAIL
  */
 int yt_free() {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_) {
@@ -34,16 +48,102 @@ int yt_free() {
         "even though the inline-analysis procedure has not finished yet!\n");
   }
 
+  // Inline functions run asynchronously keep running on the data of this step if there
+  // is a snapshot ring, otherwise wait for them, since their data is freed below
+  if (async_analysis::IsEnabled() && async_analysis::GetMaxSteps() > 0) {
+    async_analysis::RetireStep(LibytProcessControl::Get().param_libyt_.counter,
+                               LibytProcessControl::Get().data_structure_amr_,
+                               LibytProcessControl::Get().py_param_yt_,
+                               LibytProcessControl::Get().py_param_user_);
+  } else if (yt_wait() != YT_SUCCESS) {
+    logging::LogWarning("Inline functions run asynchronously failed in step %ld.\n",
+                        LibytProcessControl::Get().param_libyt_.counter);
+  }
+
+  // Synchronize status and load imbalance of inline functions finished in this step in
+  // a single collective, yt_wait has already done it if it is called above
+  if (async_analysis::SyncStatus() != YT_SUCCESS) {
+    logging::LogWarning("Inline functions failed in step %ld.\n",
+                        LibytProcessControl::Get().param_libyt_.counter);
+  }
+
 #ifndef SERIAL_MODE
   // Make sure every rank has reach to this point
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Barrier(CommMpi::GetComm());
 #endif
 
-  // Free resource allocated for data structure amr
+  // Analysis processes free this step after running inline functions in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    in_transit::SendFree();
+  }
+
+  // Free resource allocated for data structure amr, including local grids if binding
+  // is still deferred
   LibytProcessControl::Get().data_structure_amr_.CleanUp();
+  deferred_binding::EndStep();
+
+  // Free local grids node members share after the node leader is done with them
+  node_aggregation::FreeSharedGrids();
 
+  // Node members and simulation processes in in-transit mode do not have the libyt
+  // Python module
+  const bool has_python =
+      !node_aggregation::IsMember() && !in_transit::IsSimulationRank();
+  if (has_python) {
+    ClearLibytModule();
+  }
+
+  // Reduce perf counters and memory peaks of this step to libyt.perf and perf_file,
+  // then reset them
+  const long step = LibytProcessControl::Get().param_libyt_.counter;
+  memory_tracker::AddToPerfCounters();
+  std::vector<PerfCounterSummary> perf_summary = perf_counter::Summarize();
+  memory_tracker::LogPeak(perf_summary);
+  PyObject* py_perf = LibytProcessControl::Get().py_perf_;
+  if (has_python && perf_counter::BindToPython(py_perf, step, perf_summary) != 0) {
+    logging::LogWarning("Unable to update libyt.perf in step %ld.\n", step);
+  }
+  const char* perf_file = LibytProcessControl::Get().param_libyt_.perf_file;
+  if (perf_file != nullptr && !node_aggregation::IsMember() &&
+      LibytProcessControl::Get().mpi_rank_ == LibytProcessControl::Get().mpi_root_) {
+    if (perf_counter::AppendToFile(perf_file, step, perf_summary) != 0) {
+      logging::LogWarning("Unable to write perf counters to file %s.\n", perf_file);
+    }
+  }
+  perf_counter::Reset();
+  memory_tracker::ResetPeak();
+
+  // Write Python stacks sampled so far
+  if (python_profiler::Flush() != 0) {
+    logging::LogWarning("Unable to write Python profile to file %s.\n",
+                        LibytProcessControl::Get().param_libyt_.python_profile);
+  }
+
+  // Reset check points
+  LibytProcessControl::Get().param_yt_set_ = false;
+  LibytProcessControl::Get().get_fields_ptr_ = false;
+  LibytProcessControl::Get().get_particles_ptr_ = false;
+  LibytProcessControl::Get().get_grids_ptr_ = false;
+  LibytProcessControl::Get().commit_grids_ = false;
+  LibytProcessControl::Get().need_free_ = false;
+  LibytProcessControl::Get().param_libyt_.counter++;
+
+  // Write time profile recorded in this step to file
+  LibytProcessControl::Get().timer_control.Flush();
+
+  // Write log messages aggregated in this step
+  logging::Flush();
+
+  return YT_SUCCESS;
+}  // FUNCTION: yt_free()
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ClearLibytModule
+// Description :  Reset data in libyt Python module and inline function status for the
+//                next step.
+//-------------------------------------------------------------------------------------------------------
+static void ClearLibytModule() {
 #ifndef USE_PYBIND11
-  // Reset data in libyt module
   PyDict_Clear(LibytProcessControl::Get().py_param_yt_);
   PyDict_Clear(LibytProcessControl::Get().py_param_user_);
 #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
@@ -51,16 +151,17 @@ int yt_free() {
                                     "func_err_msg"));
 #endif
 #else  // #ifndef USE_PYBIND11
-  pybind11::module_ libyt = pybind11::module_::import("libyt");
-
-  const char* keys_to_clear[] = {"param_yt", "param_user"};
-  const int keys_len = 2;
-  for (int i = 0; i < keys_len; i++) {
-    pybind11::dict py_dict = libyt.attr(keys_to_clear[i]);
+  PyObject* dicts_to_clear[] = {LibytProcessControl::Get().py_param_yt_,
+                                LibytProcessControl::Get().py_param_user_};
+  const int dicts_len = 2;
+  for (int i = 0; i < dicts_len; i++) {
+    pybind11::dict py_dict =
+        pybind11::reinterpret_borrow<pybind11::dict>(dicts_to_clear[i]);
     py_dict.clear();
   }
 #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
-  pybind11::dict py_interactive_mode = libyt.attr("interactive_mode");
+  pybind11::dict py_interactive_mode = pybind11::reinterpret_borrow<pybind11::dict>(
+      LibytProcessControl::Get().py_interactive_mode_);
   pybind11::dict py_func_err_msg = py_interactive_mode["func_err_msg"];
   py_func_err_msg.clear();
 #endif
@@ -72,14 +173,4 @@ int yt_free() {
   // Reset LibytProcessControl::Get().function_info_list_ status
   LibytProcessControl::Get().function_info_list_.ResetEveryFunctionStatus();
 #endif
-  // Reset check points
-  LibytProcessControl::Get().param_yt_set_ = false;
-  LibytProcessControl::Get().get_fields_ptr_ = false;
-  LibytProcessControl::Get().get_particles_ptr_ = false;
-  LibytProcessControl::Get().get_grids_ptr_ = false;
-  LibytProcessControl::Get().commit_grids_ = false;
-  LibytProcessControl::Get().need_free_ = false;
-  LibytProcessControl::Get().param_libyt_.counter++;
-
-  return YT_SUCCESS;
-}  // FUNCTION: yt_free()
+}
@@ -1,3 +1,4 @@
+#include "async_analysis.h"
 #include "libyt.h"
 #include "libyt_process_control.h"
 #include "logging.h"
@@ -34,8 +35,9 @@
  */
 int yt_getGridInfo_Dimensions(const long gid, int (*dimensions)[3]) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
-  if (!LibytProcessControl::Get().commit_grids_) {
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
     YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
              "calling %s()!\n",
              __FUNCTION__);
@@ -43,7 +45,7 @@ int yt_getGridInfo_Dimensions(const long gid, int (*dimensions)[3]) {
 
   DataStructureOutput status =
       LibytProcessControl::Get()
-          .data_structure_amr_.GetPythonBoundFullHierarchyGridDimensions(
+          .GetDataStructureAmr().GetPythonBoundFullHierarchyGridDimensions(
               gid, &(*dimensions)[0]);
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
@@ -77,8 +79,9 @@ int yt_getGridInfo_Dimensions(const long gid, int (*dimensions)[3]) {
  */
 int yt_getGridInfo_LeftEdge(const long gid, double (*left_edge)[3]) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
-  if (!LibytProcessControl::Get().commit_grids_) {
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
     YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
              "calling %s()!\n",
              __FUNCTION__);
@@ -86,8 +89,8 @@ int yt_getGridInfo_LeftEdge(const long gid, double (*left_edge)[3]) {
 
   DataStructureOutput status =
       LibytProcessControl::Get()
-          .data_structure_amr_.GetPythonBoundFullHierarchyGridLeftEdge(gid,
-                                                                       &(*left_edge)[0]);
+          .GetDataStructureAmr()
+          .GetPythonBoundFullHierarchyGridLeftEdge(gid, &(*left_edge)[0]);
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
     return YT_SUCCESS;
@@ -120,8 +123,9 @@ int yt_getGridInfo_LeftEdge(const long gid, double (*left_edge)[3]) {
  */
 int yt_getGridInfo_RightEdge(const long gid, double (*right_edge)[3]) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
-  if (!LibytProcessControl::Get().commit_grids_) {
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
     YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
              "calling %s()!\n",
              __FUNCTION__);
@@ -129,7 +133,7 @@ int yt_getGridInfo_RightEdge(const long gid, double (*right_edge)[3]) {
 
   DataStructureOutput status =
       LibytProcessControl::Get()
-          .data_structure_amr_.GetPythonBoundFullHierarchyGridRightEdge(
+          .GetDataStructureAmr().GetPythonBoundFullHierarchyGridRightEdge(
               gid, &(*right_edge)[0]);
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
@@ -160,8 +164,9 @@ int yt_getGridInfo_RightEdge(const long gid, double (*right_edge)[3]) {
  */
 int yt_getGridInfo_ParentId(const long gid, long* parent_id) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
-  if (!LibytProcessControl::Get().commit_grids_) {
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
     YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
              "calling %s()!\n",
              __FUNCTION__);
@@ -169,7 +174,7 @@ int yt_getGridInfo_ParentId(const long gid, long* parent_id) {
 
   DataStructureOutput status =
       LibytProcessControl::Get()
-          .data_structure_amr_.GetPythonBoundFullHierarchyGridParentId(gid, parent_id);
+          .GetDataStructureAmr().GetPythonBoundFullHierarchyGridParentId(gid, parent_id);
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
     return YT_SUCCESS;
@@ -200,16 +205,18 @@ int yt_getGridInfo_ParentId(const long gid, long* parent_id) {
  */
 int yt_getGridInfo_Level(const long gid, int* level) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
-  if (!LibytProcessControl::Get().commit_grids_) {
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
     YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
              "calling %s()!\n",
              __FUNCTION__);
   }
 
   DataStructureOutput status =
-      LibytProcessControl::Get().data_structure_amr_.GetPythonBoundFullHierarchyGridLevel(
-          gid, level);
+      LibytProcessControl::Get()
+          .GetDataStructureAmr()
+          .GetPythonBoundFullHierarchyGridLevel(gid, level);
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
     return YT_SUCCESS;
@@ -240,8 +247,9 @@ int yt_getGridInfo_Level(const long gid, int* level) {
  */
 int yt_getGridInfo_ProcNum(const long gid, int* proc_num) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
-  if (!LibytProcessControl::Get().commit_grids_) {
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
     YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
              "calling %s()!\n",
              __FUNCTION__);
@@ -249,7 +257,7 @@ int yt_getGridInfo_ProcNum(const long gid, int* proc_num) {
 
   DataStructureOutput status =
       LibytProcessControl::Get()
-          .data_structure_amr_.GetPythonBoundFullHierarchyGridProcNum(gid, proc_num);
+          .GetDataStructureAmr().GetPythonBoundFullHierarchyGridProcNum(gid, proc_num);
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
     return YT_SUCCESS;
@@ -279,8 +287,9 @@ int yt_getGridInfo_ProcNum(const long gid, int* proc_num) {
  */
 int yt_getGridInfo_ParticleCount(const long gid, const char* ptype, long* par_count) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
-  if (!LibytProcessControl::Get().commit_grids_) {
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
     YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
              "calling %s()!\n",
              __FUNCTION__);
@@ -288,7 +297,7 @@ int yt_getGridInfo_ParticleCount(const long gid, const char* ptype, long* par_co
 
   DataStructureOutput status =
       LibytProcessControl::Get()
-          .data_structure_amr_.GetPythonBoundFullHierarchyGridParticleCount(
+          .GetDataStructureAmr().GetPythonBoundFullHierarchyGridParticleCount(
               gid, ptype, par_count);
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
@@ -326,15 +335,16 @@ int yt_getGridInfo_ParticleCount(const long gid, const char* ptype, long* par_co
 int yt_getGridInfo_FieldData(const long gid, const char* field_name,
                              yt_data* field_data) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
-  if (!LibytProcessControl::Get().commit_grids_) {
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
     YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
              "calling %s()!\n",
              __FUNCTION__);
   }
 
   DataStructureOutput status =
-      LibytProcessControl::Get().data_structure_amr_.GetPythonBoundLocalFieldData(
+      LibytProcessControl::Get().GetDataStructureAmr().GetPythonBoundLocalFieldData(
           gid, field_name, field_data);
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
@@ -387,15 +397,16 @@ int yt_getGridInfo_FieldData(const long gid, const char* field_name,
 int yt_getGridInfo_ParticleData(const long gid, const char* ptype, const char* attr,
                                 yt_data* par_data) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
-  if (!LibytProcessControl::Get().commit_grids_) {
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
     YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
              "calling %s()!\n",
              __FUNCTION__);
   }
 
   DataStructureOutput status =
-      LibytProcessControl::Get().data_structure_amr_.GetPythonBoundLocalParticleData(
+      LibytProcessControl::Get().GetDataStructureAmr().GetPythonBoundLocalParticleData(
           gid, ptype, attr, par_data);
 
   if (status.status == DataStructureStatus::kDataStructureSuccess) {
@@ -405,3 +416,138 @@ int yt_getGridInfo_ParticleData(const long gid, const char* ptype, const char* a
     return YT_FAIL;
   }
 }
+
+/**
+ * \brief Get particle count of the ptype_index-th particle type inside grid with grid
+ *        id = gid.
+ * \details
+ * 1. Same as \ref yt_getGridInfo_ParticleCount, but the particle type is referred to
+ *    by its index in the particle type list passed in \ref yt_set_Parameters, so that
+ *    the name is not looked up on every call.
+ *
+ * @param gid[in] grid id
+ * @param ptype_index[in] particle type index
+ * @param par_count[out] particle count
+ * @return \ref YT_SUCCESS or \ref YT_FAIL
+ *
+ * \verbatim embed:rst:leading-asterisk
+ * .. code-block:: c
+ *
+ *    long par_count;
+ *    yt_getGridInfo_ParticleCountByIndex( gid, 0, &par_count );
+ * \endverbatim
+ */
+int yt_getGridInfo_ParticleCountByIndex(const long gid, const int ptype_index,
+                                        long* par_count) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
+
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
+    YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
+             "calling %s()!\n",
+             __FUNCTION__);
+  }
+
+  DataStructureOutput status =
+      LibytProcessControl::Get()
+          .GetDataStructureAmr().GetPythonBoundFullHierarchyGridParticleCountByIndex(
+              gid, ptype_index, par_count);
+
+  if (status.status == DataStructureStatus::kDataStructureSuccess) {
+    return YT_SUCCESS;
+  } else {
+    logging::LogError(status.error.c_str());
+    return YT_FAIL;
+  }
+}
+
+/**
+ * \brief Get field data of the field_index-th field of grid with grid id = gid.
+ * \details
+ * 1. Same as \ref yt_getGridInfo_FieldData, but the field is referred to by its index
+ *    in the field list set through \ref yt_get_FieldsPtr, so that the name is not
+ *    looked up on every call.
+ *
+ * @param gid[in] grid id
+ * @param field_index[in] queried field index
+ * @param field_data[out] field data pointer and metadata
+ * @return \ref YT_SUCCESS or \ref YT_FAIL
+ *
+ * \verbatim embed:rst:leading-asterisk
+ * .. code-block:: c
+ *
+ *    yt_data data;
+ *    yt_getGridInfo_FieldDataByIndex(gid, 0, &data);
+ *    double *field_data = (double *) data.data_ptr;
+ * \endverbatim
+ */
+int yt_getGridInfo_FieldDataByIndex(const long gid, const int field_index,
+                                    yt_data* field_data) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
+
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
+    YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
+             "calling %s()!\n",
+             __FUNCTION__);
+  }
+
+  DataStructureOutput status =
+      LibytProcessControl::Get()
+          .GetDataStructureAmr()
+          .GetPythonBoundLocalFieldDataByIndex(gid, field_index, field_data);
+
+  if (status.status == DataStructureStatus::kDataStructureSuccess) {
+    return YT_SUCCESS;
+  } else {
+    logging::LogError(status.error.c_str());
+    return YT_FAIL;
+  }
+}
+
+/**
+ * \brief Get particle data of grid with grid id = gid, where the particle type and
+ *        attribute are referred to by index.
+ * \details
+ * 1. Same as \ref yt_getGridInfo_ParticleData, but the particle type is referred to by
+ *    its index in the particle type list passed in \ref yt_set_Parameters, and the
+ *    attribute by its index in the attribute list of that particle type set through
+ *    \ref yt_get_ParticlesPtr.
+ *
+ * @param gid[in] grid id
+ * @param ptype_index[in] queried particle type index
+ * @param attr_index[in] queried attribute index
+ * @param par_data[out] particle data pointer and metadata
+ * @return \ref YT_SUCCESS or \ref YT_FAIL
+ *
+ * \verbatim embed:rst:leading-asterisk
+ * .. code-block:: c
+ *
+ *    yt_data data;
+ *    yt_getGridInfo_ParticleDataByIndex(gid, 0, 0, &data);
+ *    double *par_data = (double *) data.data_ptr;
+ * \endverbatim
+ */
+int yt_getGridInfo_ParticleDataByIndex(const long gid, const int ptype_index,
+                                       const int attr_index, yt_data* par_data) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
+
+  if (!LibytProcessControl::Get().IsGridsCommitted()) {
+    YT_ABORT("Please follow the libyt procedure, forgot to invoke yt_commit() before "
+             "calling %s()!\n",
+             __FUNCTION__);
+  }
+
+  DataStructureOutput status =
+      LibytProcessControl::Get()
+          .GetDataStructureAmr().GetPythonBoundLocalParticleDataByIndex(
+              gid, ptype_index, attr_index, par_data);
+
+  if (status.status == DataStructureStatus::kDataStructureSuccess) {
+    return YT_SUCCESS;
+  } else {
+    logging::LogError(status.error.c_str());
+    return YT_FAIL;
+  }
+}
@@ -1,10 +1,29 @@
+#include <cstdlib>
+#include <string>
+
+#include "async_analysis.h"
+#include "in_transit.h"
 #include "libyt.h"
 #include "libyt_process_control.h"
 #include "logging.h"
+#include "node_aggregation.h"
 #include "python_controller.h"
+#include "python_profiler.h"
 #include "timer.h"
 
+static bool GetEnvBool(const char* name, bool default_value);
 static void PrintLibytInfo();
+static void SetTimerCategories();
+static void SetTimerOutput();
+static void SetPythonProfiler();
+static void SetLogging();
+static void SetAsyncAnalysis();
+static void SetCallBarrier();
+static void SetDeferBinding();
+static int GetInTransitRanks(const yt_param_libyt* param_libyt);
+static void LogInTransit(int in_transit_ranks, int split_result);
+static bool GetNodeAggregate(const yt_param_libyt* param_libyt);
+static void LogNodeAggregate(bool node_aggregate);
 
 /**
  * \defgroup api_yt_initialize libyt API: yt_initialize
@@ -13,6 +32,10 @@ static void PrintLibytInfo();
  * \details
  * 1. This function should not be called more than once.
  * 2. Initialize libyt workflow, Python interpreter, and import libyt module.
+ * 3. It is a collective operation on the communicator of param_libyt->comm_f. Processes
+ *    outside of it should not call any libyt API.
+ * 4. Python is not initialized on node members in node aggregation, and on simulation
+ *    processes in in-transit mode.
  *
  * @param argc[in]
  * @param argv[in]
@@ -20,11 +43,8 @@ static void PrintLibytInfo();
  * @return \ref YT_SUCCESS or \ref YT_FAIL
  */
 int yt_initialize(int argc, char* argv[], const yt_param_libyt* param_libyt) {
-  LibytProcessControl::Get().Initialize();
-
-  SET_TIMER(__PRETTY_FUNCTION__);
-
-  // yt_initialize should only be called once
+  // yt_initialize should only be called once, check it before touching the communicator
+  // and process control of the live instance
   static int init_count = 0;
   init_count++;
 
@@ -34,6 +54,25 @@ int yt_initialize(int argc, char* argv[], const yt_param_libyt* param_libyt) {
     YT_ABORT("yt_initialize() should not be called more than once!\n");
   }
 
+#ifndef SERIAL_MODE
+  // communicate on a duplicate of comm, so that messages never match the simulation's,
+  // and split it before anything in libyt communicates
+  MPI_Comm libyt_comm;
+  MPI_Comm_dup(param_libyt->comm_f == -1 ? MPI_COMM_WORLD
+                                         : MPI_Comm_f2c(param_libyt->comm_f),
+               &libyt_comm);
+  CommMpi::SetComm(libyt_comm);
+#endif
+  const int in_transit_ranks = GetInTransitRanks(param_libyt);
+  const int split_result = in_transit::Split(in_transit_ranks);
+  const bool node_aggregate = GetNodeAggregate(param_libyt);
+  if (node_aggregate && !in_transit::IsEnabled()) {
+    node_aggregation::Split();
+  }
+  LibytProcessControl::Get().Initialize();
+
+  SET_TIMER(__PRETTY_FUNCTION__);
+
   // store user-provided parameters to a libyt internal variable
   // --> better do it **before** calling any log function since they will query
   // param_libyt.verbose
@@ -43,6 +82,30 @@ int yt_initialize(int argc, char* argv[], const yt_param_libyt* param_libyt) {
       param_libyt
           ->counter;  // useful during restart, where the initial counter can be non-zero
   LibytProcessControl::Get().param_libyt_.check_data = param_libyt->check_data;
+  LibytProcessControl::Get().param_libyt_.memory_budget = param_libyt->memory_budget;
+  LibytProcessControl::Get().param_libyt_.spill_dir = param_libyt->spill_dir;
+  LibytProcessControl::Get().param_libyt_.trace = param_libyt->trace;
+  LibytProcessControl::Get().param_libyt_.trace_merge = param_libyt->trace_merge;
+  LibytProcessControl::Get().param_libyt_.python_profile = param_libyt->python_profile;
+  LibytProcessControl::Get().param_libyt_.perf_file = param_libyt->perf_file;
+  LibytProcessControl::Get().param_libyt_.log_aggregate = param_libyt->log_aggregate;
+  LibytProcessControl::Get().param_libyt_.log_file = param_libyt->log_file;
+  LibytProcessControl::Get().param_libyt_.async_analysis = param_libyt->async_analysis;
+  LibytProcessControl::Get().param_libyt_.async_max_steps = param_libyt->async_max_steps;
+  LibytProcessControl::Get().param_libyt_.async_policy = param_libyt->async_policy;
+  LibytProcessControl::Get().param_libyt_.call_barrier = param_libyt->call_barrier;
+  LibytProcessControl::Get().param_libyt_.defer_binding = param_libyt->defer_binding;
+  LibytProcessControl::Get().param_libyt_.in_transit_ranks =
+      in_transit::GetNumAnalysisRanks();
+  LibytProcessControl::Get().param_libyt_.node_aggregate = node_aggregation::IsEnabled();
+#ifndef SERIAL_MODE
+  LibytProcessControl::Get().param_libyt_.comm_f = MPI_Comm_c2f(libyt_comm);
+#endif
+  if (in_transit::IsAnalysisRank()) {
+    // input is checked on simulation processes, and get_par_attr is not sent
+    LibytProcessControl::Get().param_libyt_.check_data = false;
+  }
+  SetLogging();
 
   logging::LogInfo("******libyt version******\n");
   logging::LogInfo("         %d.%d.%d\n",
@@ -59,6 +122,36 @@ int yt_initialize(int argc, char* argv[], const yt_param_libyt* param_libyt) {
   logging::LogInfo(
       "check_data = %s\n",
       (LibytProcessControl::Get().param_libyt_.check_data ? "true" : "false"));
+  logging::LogInfo("memory_budget = %ld\n",
+                   LibytProcessControl::Get().param_libyt_.memory_budget);
+  logging::LogInfo(
+      "spill_dir = %s\n",
+      (LibytProcessControl::Get().param_libyt_.spill_dir != nullptr
+           ? LibytProcessControl::Get().param_libyt_.spill_dir
+           : "(none)"));
+  logging::LogInfo(
+      "perf_file = %s\n",
+      (LibytProcessControl::Get().param_libyt_.perf_file != nullptr
+           ? LibytProcessControl::Get().param_libyt_.perf_file
+           : "(none)"));
+  logging::LogInfo("log_aggregate = %s\n",
+                   (logging::IsAggregated() ? "true" : "false"));
+  logging::LogInfo(
+      "  log_file = %s\n",
+      (LibytProcessControl::Get().param_libyt_.log_file != nullptr
+           ? LibytProcessControl::Get().param_libyt_.log_file
+           : "(none)"));
+  LogInTransit(in_transit_ranks, split_result);
+  LogNodeAggregate(node_aggregate);
+  SetTimerCategories();
+  SetTimerOutput();
+
+  // processes without Python only share local grids with their node leader, or send them
+  // to analysis processes
+  if (node_aggregation::IsMember() || in_transit::IsSimulationRank()) {
+    LibytProcessControl::Get().libyt_initialized_ = true;
+    return YT_SUCCESS;
+  }
 
 #ifndef USE_PYBIND11
   // create libyt module, should be before init_python
@@ -74,6 +167,10 @@ int yt_initialize(int argc, char* argv[], const yt_param_libyt* param_libyt) {
   if (python_controller::PreparePythonEnvForLibyt() == YT_FAIL) {
     return YT_FAIL;
   }
+  SetPythonProfiler();
+  SetAsyncAnalysis();
+  SetCallBarrier();
+  SetDeferBinding();
 
 #if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
   // set python exception hook and set not-yet-done error msg
@@ -98,10 +195,39 @@ int yt_initialize(int argc, char* argv[], const yt_param_libyt* param_libyt) {
 
   LibytProcessControl::Get().libyt_initialized_ = true;
 
+  // The analysis thread needs the GIL while the simulation advances
+  if (async_analysis::IsEnabled()) {
+    async_analysis::ReleaseMainThreadGil();
+  }
+
   return YT_SUCCESS;
 
 }  // FUNCTION : yt_initialize
 
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetEnvBool
+// Description :  Get the on/off value of environment variable name, or default_value if
+//                it is not set.
+//
+// Notes       :  1. "1", "on", and "true" are on. "0", "off", "false", and empty are off.
+//                   Other values are warned and ignored.
+//-------------------------------------------------------------------------------------------------------
+static bool GetEnvBool(const char* name, bool default_value) {
+  const char* env_value = std::getenv(name);
+  if (env_value == nullptr) {
+    return default_value;
+  }
+
+  std::string value(env_value);
+  if (value == "1" || value == "on" || value == "true") {
+    return true;
+  } else if (value == "0" || value == "off" || value == "false" || value.empty()) {
+    return false;
+  }
+  logging::LogWarning("Unknown value in %s = %s, ignored.\n", name, env_value);
+  return default_value;
+}
+
 static void PrintLibytInfo() {
 #ifdef SERIAL_MODE
   logging::LogInfo("  SERIAL_MODE: ON\n");
@@ -127,3 +253,280 @@ static void PrintLibytInfo() {
   logging::LogInfo("  SUPPORT_TIMER: OFF\n");
 #endif
 }
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SetTimerCategories
+// Description :  Turn on time profiling categories set in yt_param_libyt trace, and
+//                environment variable LIBYT_TRACE, which has higher priority.
+//
+// Notes       :  1. If neither of them is set, categories are all on if libyt is compiled
+//                   with SUPPORT_TIMER, otherwise all off.
+//-------------------------------------------------------------------------------------------------------
+static void SetTimerCategories() {
+  const char* trace_source[2] = {"trace", "LIBYT_TRACE"};
+  const char* trace_value[2] = {LibytProcessControl::Get().param_libyt_.trace,
+                                std::getenv("LIBYT_TRACE")};
+  for (int i = 0; i < 2; i++) {
+    if (trace_value[i] == nullptr) {
+      continue;
+    }
+    unsigned int categories;
+    if (TimerControl::ParseCategories(trace_value[i], &categories)) {
+      TimerControl::SetEnabledCategories(categories);
+    } else {
+      logging::LogWarning("Unknown time profiling category in %s = %s, ignored.\n",
+                          trace_source[i],
+                          trace_value[i]);
+    }
+  }
+
+  logging::LogInfo(
+      "     trace = %s\n",
+      TimerControl::GetCategoriesStr(TimerControl::GetEnabledCategories()).c_str());
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SetTimerOutput
+// Description :  Merge time profile of every MPI process into libytTimeProfile.json if
+//                yt_param_libyt trace_merge is set, or if environment variable
+//                LIBYT_TRACE_MERGE is on, which has higher priority.
+//
+// Notes       :  1. Collective operation, LIBYT_TRACE_MERGE must be the same on every MPI
+//                   process.
+//                2. Otherwise, each process writes to its own libytTimeProfile_MPI*.json.
+//                3. Analysis processes in in-transit mode and node members in node
+//                   aggregation write to files with _Analysis and _NodeMember appended to
+//                   libytTimeProfile.
+//-------------------------------------------------------------------------------------------------------
+static void SetTimerOutput() {
+  bool& trace_merge = LibytProcessControl::Get().param_libyt_.trace_merge;
+  trace_merge = GetEnvBool("LIBYT_TRACE_MERGE", trace_merge);
+
+  if (trace_merge) {
+    const char* filename = "libytTimeProfile.json";
+    if (in_transit::IsAnalysisRank()) {
+      filename = "libytTimeProfile_Analysis.json";
+    } else if (node_aggregation::IsMember()) {
+      filename = "libytTimeProfile_NodeMember.json";
+    }
+    LibytProcessControl::Get().timer_control.CreateMergedFile(
+        filename,
+        LibytProcessControl::Get().mpi_rank_,
+        LibytProcessControl::Get().mpi_root_);
+  }
+
+  logging::LogInfo("trace_merge = %s\n", (trace_merge ? "true" : "false"));
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SetPythonProfiler
+// Description :  Turn on Python sampling profiler if yt_param_libyt python_profile is
+//                set, or if environment variable LIBYT_PYTHON_PROFILE is set, which has
+//                higher priority.
+//
+// Notes       :  1. Python must be initialized.
+//                2. An empty LIBYT_PYTHON_PROFILE turns it off.
+//-------------------------------------------------------------------------------------------------------
+static void SetPythonProfiler() {
+  const char*& python_profile = LibytProcessControl::Get().param_libyt_.python_profile;
+  const char* env_value = std::getenv("LIBYT_PYTHON_PROFILE");
+  if (env_value != nullptr) {
+    python_profile = (env_value[0] != '\0') ? env_value : nullptr;
+  }
+
+  if (python_profile != nullptr && !python_profiler::Enable(python_profile)) {
+    logging::LogWarning("Unable to start Python profiler, python_profile = %s ignored.\n",
+                        python_profile);
+    python_profile = nullptr;
+  }
+
+  logging::LogInfo("python_profile = %s\n",
+                   (python_profile != nullptr ? python_profile : "(none)"));
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SetLogging
+// Description :  Aggregate log messages of every MPI process if yt_param_libyt
+//                log_aggregate or log_file is set. Environment variables
+//                LIBYT_LOG_AGGREGATE and LIBYT_LOG_FILE have higher priority.
+//
+// Notes       :  1. Must be the same on every MPI process, since flushing aggregated
+//                   messages is a collective operation.
+//                2. An empty LIBYT_LOG_FILE turns the log file off.
+//-------------------------------------------------------------------------------------------------------
+static void SetLogging() {
+  yt_param_libyt& param_libyt = LibytProcessControl::Get().param_libyt_;
+  param_libyt.log_aggregate =
+      GetEnvBool("LIBYT_LOG_AGGREGATE", param_libyt.log_aggregate);
+  const char* env_value = std::getenv("LIBYT_LOG_FILE");
+  if (env_value != nullptr) {
+    param_libyt.log_file = (env_value[0] != '\0') ? env_value : nullptr;
+  }
+
+  logging::SetAggregation(param_libyt.log_aggregate,
+                          (param_libyt.log_file != nullptr) ? param_libyt.log_file : "");
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SetAsyncAnalysis
+// Description :  Run inline functions asynchronously if yt_param_libyt async_analysis is
+//                set. Environment variables LIBYT_ASYNC_ANALYSIS, LIBYT_ASYNC_MAX_STEPS,
+//                and LIBYT_ASYNC_POLICY have higher priority.
+//
+// Notes       :  1. Must be the same on every MPI process, since yt_wait is a collective
+//                   operation.
+//                2. Inline functions communicate on the analysis thread while the
+//                   simulation advances, which requires MPI_THREAD_MULTIPLE.
+//                3. LIBYT_ASYNC_POLICY is one of "block", "skip", and "drop_oldest".
+//-------------------------------------------------------------------------------------------------------
+static void SetAsyncAnalysis() {
+  yt_param_libyt& param_libyt = LibytProcessControl::Get().param_libyt_;
+  param_libyt.async_analysis =
+      GetEnvBool("LIBYT_ASYNC_ANALYSIS", param_libyt.async_analysis);
+
+  const char* env_value = std::getenv("LIBYT_ASYNC_MAX_STEPS");
+  if (env_value != nullptr) {
+    param_libyt.async_max_steps = std::atoi(env_value);
+  }
+  if (param_libyt.async_max_steps < 0) {
+    logging::LogWarning("async_max_steps = %d is negative, set to 0.\n",
+                        param_libyt.async_max_steps);
+    param_libyt.async_max_steps = 0;
+  }
+
+  env_value = std::getenv("LIBYT_ASYNC_POLICY");
+  if (env_value != nullptr) {
+    std::string value(env_value);
+    if (value == "block") {
+      param_libyt.async_policy = YT_ASYNC_BLOCK;
+    } else if (value == "skip") {
+      param_libyt.async_policy = YT_ASYNC_SKIP_STEP;
+    } else if (value == "drop_oldest") {
+      param_libyt.async_policy = YT_ASYNC_DROP_OLDEST;
+    } else {
+      logging::LogWarning("Unknown value in LIBYT_ASYNC_POLICY = %s, ignored.\n",
+                          env_value);
+    }
+  }
+
+#ifndef SERIAL_MODE
+  int thread_level = MPI_THREAD_SINGLE;
+  MPI_Query_thread(&thread_level);
+  if (param_libyt.async_analysis && thread_level < MPI_THREAD_MULTIPLE) {
+    logging::LogWarning("MPI is not initialized with MPI_THREAD_MULTIPLE, inline "
+                        "functions run asynchronously must not communicate, e.g. "
+                        "accessing remote data.\n");
+  }
+#endif
+
+  if (param_libyt.async_analysis && in_transit::IsEnabled()) {
+    logging::LogWarning("async_analysis is ignored in in-transit mode, since inline "
+                        "functions already run on analysis processes.\n");
+    param_libyt.async_analysis = false;
+  }
+
+  async_analysis::Enable(
+      param_libyt.async_analysis, param_libyt.async_max_steps, param_libyt.async_policy);
+  logging::LogInfo("async_analysis = %s\n",
+                   (param_libyt.async_analysis ? "true" : "false"));
+  if (param_libyt.async_analysis) {
+    const char* policy_names[] = {"block", "skip", "drop_oldest"};
+    logging::LogInfo("async_max_steps = %d, async_policy = %s\n",
+                     param_libyt.async_max_steps,
+                     policy_names[param_libyt.async_policy]);
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SetCallBarrier
+// Description :  Synchronize every MPI process before calling an inline function if
+//                yt_param_libyt call_barrier is set, or if environment variable
+//                LIBYT_CALL_BARRIER is on, which has higher priority.
+//
+// Notes       :  1. Must be the same on every MPI process, since MPI_Barrier is a
+//                   collective operation.
+//                2. Without the barrier, wait time of inline functions is not measured,
+//                   and time spent includes waiting for other processes inside them.
+//-------------------------------------------------------------------------------------------------------
+static void SetCallBarrier() {
+  bool& call_barrier = LibytProcessControl::Get().param_libyt_.call_barrier;
+  call_barrier = GetEnvBool("LIBYT_CALL_BARRIER", call_barrier);
+
+  logging::LogInfo("call_barrier = %s\n", (call_barrier ? "true" : "false"));
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  SetDeferBinding
+// Description :  Defer binding data to Python in yt_commit in steps where no inline
+//                function will run, if yt_param_libyt defer_binding is set, or if
+//                environment variable LIBYT_DEFER_BINDING is on, which has higher
+//                priority.
+//
+// Notes       :  1. Must be the same on every MPI process, since binding is a collective
+//                   operation.
+//                2. yt_getGridInfo_* fail outside inline functions in a deferred step, so
+//                   it is off by default.
+//-------------------------------------------------------------------------------------------------------
+static void SetDeferBinding() {
+  bool& defer_binding = LibytProcessControl::Get().param_libyt_.defer_binding;
+  defer_binding = GetEnvBool("LIBYT_DEFER_BINDING", defer_binding);
+
+  logging::LogInfo("defer_binding = %s\n", (defer_binding ? "true" : "false"));
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetInTransitRanks
+// Description :  Get the number of analysis processes in in-transit mode set in
+//                yt_param_libyt in_transit_ranks, or in environment variable
+//                LIBYT_IN_TRANSIT_RANKS, which has higher priority.
+//
+// Notes       :  1. It is called before logging is set, since the libyt communicator
+//                   must be split first. Messages are logged in LogInTransit.
+//-------------------------------------------------------------------------------------------------------
+static int GetInTransitRanks(const yt_param_libyt* param_libyt) {
+  const char* env_value = std::getenv("LIBYT_IN_TRANSIT_RANKS");
+  if (env_value != nullptr) {
+    return std::atoi(env_value);
+  }
+  return param_libyt->in_transit_ranks;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  LogInTransit
+// Description :  Log in-transit mode, and warn if in_transit_ranks is ignored.
+//-------------------------------------------------------------------------------------------------------
+static void LogInTransit(int in_transit_ranks, int split_result) {
+  if (split_result != YT_SUCCESS) {
+    logging::LogWarning("in_transit_ranks = %d leaves no simulation process or MPI is "
+                        "not supported, ignored.\n",
+                        in_transit_ranks);
+  }
+  logging::LogInfo("in_transit_ranks = %d\n", in_transit::GetNumAnalysisRanks());
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetNodeAggregate
+// Description :  Get whether to run Python only on one process per node set in
+//                yt_param_libyt node_aggregate, or in environment variable
+//                LIBYT_NODE_AGGREGATE, which has higher priority.
+//
+// Notes       :  1. It is called before logging is set, since the libyt communicator
+//                   must be split first. Messages are logged in LogNodeAggregate, except
+//                   that an unknown LIBYT_NODE_AGGREGATE is warned on every process.
+//-------------------------------------------------------------------------------------------------------
+static bool GetNodeAggregate(const yt_param_libyt* param_libyt) {
+  return GetEnvBool("LIBYT_NODE_AGGREGATE", param_libyt->node_aggregate);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  LogNodeAggregate
+// Description :  Log node aggregation, and warn if node_aggregate is ignored.
+//-------------------------------------------------------------------------------------------------------
+static void LogNodeAggregate(bool node_aggregate) {
+  if (node_aggregate && !node_aggregation::IsEnabled()) {
+    logging::LogWarning("node_aggregate is ignored in in-transit mode, or if MPI is not "
+                        "supported.\n");
+  }
+  logging::LogInfo("node_aggregate = %s\n",
+                   (node_aggregation::IsEnabled() ? "true" : "false"));
+}
@@ -1,11 +1,286 @@
+#include <chrono>
 #include <cstdarg>
 #include <string>
+#include <vector>
 
+#include "async_analysis.h"
+#include "deferred_binding.h"
 #include "function_info.h"
+#include "in_transit.h"
 #include "libyt.h"
 #include "libyt_process_control.h"
 #include "logging.h"
+#include "node_aggregation.h"
+#include "numpy_controller.h"
+#include "perf_counter.h"
 #include "timer.h"
+#include "trigger.h"
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  IsSkippedOnThisProcess
+// Description :  Check if the inline function does not run on this process in this step.
+//
+// Notes       :  1. Functions are skipped in the step if the snapshot ring is full and
+//                   the policy is to skip the step, or if their trigger does not fire.
+//                2. They only run on node leaders in node aggregation.
+//-------------------------------------------------------------------------------------------------------
+static bool IsSkippedOnThisProcess(const char* function_name) {
+  // the snapshot ring is full, and the policy is to skip this step
+  if (async_analysis::IsEnabled() && async_analysis::IsStepSkipped()) {
+    logging::LogInfo("YT inline function \"%s\" is skipped in this step ... idle\n",
+                     function_name);
+    return true;
+  }
+
+  // run on node leaders only in node aggregation
+  if (node_aggregation::IsMember()) {
+    logging::LogDebug("YT inline function \"%s\" runs on node leader.\n", function_name);
+    return true;
+  }
+
+  // the trigger set by yt_set_FunctionTrigger does not fire in this step
+  if (!trigger::IsFired(function_name)) {
+    logging::LogInfo("YT inline function \"%s\" is not triggered in this step ... idle\n",
+                     function_name);
+    return true;
+  }
+
+  return false;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  CheckIdleAndMarkToRun
+// Description :  Check if the inline function is set to idle, otherwise mark it to run.
+//
+// Notes       :  1. Only under INTERACTIVE_MODE and JUPYTER_KERNEL, functions can be set
+//                   to idle.
+//                2. The check itself is FunctionInfoList::IsSetToIdle, which
+//                   deferred_binding also uses to predict the next step.
+//                3. Unknown functions are added and always run, and let Python generate
+//                   function-not-defined error.
+//-------------------------------------------------------------------------------------------------------
+#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
+static bool CheckIdleAndMarkToRun(const char* function_name) {
+  FunctionInfoList& function_info_list = LibytProcessControl::Get().function_info_list_;
+  if (function_info_list.IsSetToIdle(function_name)) {
+    logging::LogInfo("YT inline function \"%s\" was set to idle ... idle\n",
+                     function_name);
+    return true;
+  }
+
+  // always run m_Run = -1 function, and set 1.
+  // always run unknown function and let Python generates function-not-defined error.
+  int func_index = function_info_list.GetFunctionIndex(function_name);
+  if (func_index != -1) {
+    if (function_info_list[func_index].GetRun() == FunctionInfo::RunStatus::kNotSetYet)
+      function_info_list[func_index].SetRun(FunctionInfo::RunStatus::kWillRun);
+  } else {
+    func_index = function_info_list.AddNewFunction(function_name,
+                                                   FunctionInfo::RunStatus::kWillRun);
+  }
+  function_info_list[func_index].SetStatus(FunctionInfo::ExecuteStatus::kNeedUpdate);
+
+  return false;
+}
+#else
+static bool CheckIdleAndMarkToRun(const char*) { return false; }
+#endif
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  RunInlineFunction
+// Description :  Run the inline function of the job, or submit it to the analysis thread.
+//
+// Notes       :  1. Collective operation if the function runs synchronously and
+//                   call_barrier is on, or if binding data is deferred.
+//                2. job must have function_name and str_function set, and either
+//                   arguments or py_arguments.
+//-------------------------------------------------------------------------------------------------------
+static int RunInlineFunction(AsyncAnalysisJob& job) {
+  const char* function_name = job.function_name.c_str();
+
+  // the first function that runs in this step binds data if yt_commit deferred it
+  if (deferred_binding::EnsureBound() != YT_SUCCESS) {
+    YT_ABORT("Unable to bind data for \"%s\".\n", function_name);
+  }
+
+  // start running inline function when every rank come to this stage, and record the
+  // time waiting for other ranks. Functions run asynchronously do not wait, and the
+  // barrier can be turned off by yt_param_libyt call_barrier.
+  std::chrono::steady_clock::time_point wait_start = std::chrono::steady_clock::now();
+#ifndef SERIAL_MODE
+  if (!async_analysis::IsEnabled() &&
+      LibytProcessControl::Get().param_libyt_.call_barrier) {
+    MPI_Barrier(CommMpi::GetComm());
+  }
+#endif
+  std::chrono::duration<double> wait_time = std::chrono::steady_clock::now() - wait_start;
+  perf_counter::Add(std::string("python.wait_time.") + function_name, wait_time.count());
+  job.wait_time = wait_time.count();
+
+  logging::LogInfo("Performing YT inline analysis %s ...\n", job.str_function.c_str());
+
+  // Run on the analysis thread, the result is handled in yt_commit or yt_wait
+  if (async_analysis::IsEnabled()) {
+    async_analysis::Submit(job);
+    logging::LogInfo("Performing YT inline analysis %s ... submitted to analysis "
+                     "thread.\n",
+                     job.str_function.c_str());
+    return YT_SUCCESS;
+  }
+
+  // Execute
+  async_analysis::RunJob(job);
+
+  return async_analysis::FinishJob(job);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ScalarToPython
+// Description :  Convert a scalar of data_dtype to a Python int or float.
+//
+// Notes       :  1. long double is converted to double.
+//                2. Return a new reference, or nullptr with Python error set.
+//-------------------------------------------------------------------------------------------------------
+static PyObject* ScalarToPython(yt_dtype data_dtype, const void* data_ptr) {
+  switch (data_dtype) {
+    case YT_FLOAT:
+      return PyFloat_FromDouble(*static_cast<const float*>(data_ptr));
+    case YT_DOUBLE:
+      return PyFloat_FromDouble(*static_cast<const double*>(data_ptr));
+    case YT_LONGDOUBLE:
+      return PyFloat_FromDouble(
+          static_cast<double>(*static_cast<const long double*>(data_ptr)));
+    case YT_CHAR:
+      return PyLong_FromLong(*static_cast<const signed char*>(data_ptr));
+    case YT_UCHAR:
+      return PyLong_FromUnsignedLong(*static_cast<const unsigned char*>(data_ptr));
+    case YT_SHORT:
+      return PyLong_FromLong(*static_cast<const short*>(data_ptr));
+    case YT_USHORT:
+      return PyLong_FromUnsignedLong(*static_cast<const unsigned short*>(data_ptr));
+    case YT_INT:
+      return PyLong_FromLong(*static_cast<const int*>(data_ptr));
+    case YT_UINT:
+      return PyLong_FromUnsignedLong(*static_cast<const unsigned int*>(data_ptr));
+    case YT_LONG:
+      return PyLong_FromLong(*static_cast<const long*>(data_ptr));
+    case YT_ULONG:
+      return PyLong_FromUnsignedLong(*static_cast<const unsigned long*>(data_ptr));
+    case YT_LONGLONG:
+      return PyLong_FromLongLong(*static_cast<const long long*>(data_ptr));
+    case YT_ULONGLONG:
+      return PyLong_FromUnsignedLongLong(
+          *static_cast<const unsigned long long*>(data_ptr));
+    default:
+      PyErr_SetString(PyExc_TypeError, "Unknown yt_dtype of scalar argument.");
+      return nullptr;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  TypedArgumentToPython
+// Description :  Convert a typed argument to a Python object.
+//
+// Notes       :  1. Arrays are wrapped by a read-only NumPy array without copying. If
+//                   copy_array is true, they are deep copied instead, since the
+//                   simulation may update its buffer before an asynchronous function
+//                   runs.
+//                2. Return a new reference, or nullptr with Python error set.
+//-------------------------------------------------------------------------------------------------------
+static PyObject* TypedArgumentToPython(const yt_arg& arg, bool copy_array) {
+  switch (arg.arg_type) {
+    case YT_ARG_SCALAR: {
+      return ScalarToPython(arg.data_dtype, arg.data_ptr);
+    }
+    case YT_ARG_STRING: {
+      return PyUnicode_FromString(static_cast<const char*>(arg.data_ptr));
+    }
+    case YT_ARG_ARRAY: {
+      npy_intp npy_dim[3];
+      for (int d = 0; d < arg.num_dims; d++) {
+        npy_dim[d] = arg.data_dimensions[d];
+      }
+      PyObject* py_view = numpy_controller::ArrayToNumPyArray(
+          arg.num_dims, npy_dim, arg.data_dtype, const_cast<void*>(arg.data_ptr), true);
+      if (!copy_array || py_view == nullptr) {
+        return py_view;
+      }
+      PyObject* py_copy = numpy_controller::CopyNumPyArray(py_view, true);
+      Py_DECREF(py_view);
+      return py_copy;
+    }
+    default: {
+      PyErr_SetString(PyExc_TypeError, "Unknown yt_arg_type.");
+      return nullptr;
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  ReleaseTypedArguments
+// Description :  Deleter of the typed arguments held by AsyncAnalysisJob.
+//-------------------------------------------------------------------------------------------------------
+static void ReleaseTypedArguments(PyObject* py_arguments) {
+  if (Py_IsInitialized()) {
+    PythonGilGuard gil_guard;
+    Py_DECREF(py_arguments);
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  PackTypedArguments
+// Description :  Pack typed arguments to (args, kwargs) of the job, and describe the call
+//                for logging.
+//
+// Notes       :  1. kwargs is None if there is no keyword argument.
+//                2. Return YT_SUCCESS or YT_FAIL.
+//-------------------------------------------------------------------------------------------------------
+static int PackTypedArguments(const yt_arg* args, int num_args, bool copy_array,
+                              AsyncAnalysisJob& job) {
+  PyObject* py_args = PyList_New(0);
+  PyObject* py_kwargs = PyDict_New();
+  std::string description;
+  for (int i = 0; i < num_args; i++) {
+    PyObject* py_value = TypedArgumentToPython(args[i], copy_array);
+    if (py_value == nullptr) {
+      PyErr_Print();
+      Py_DECREF(py_args);
+      Py_DECREF(py_kwargs);
+      YT_ABORT("Unable to convert argument %d of \"%s\" to Python.\n",
+               i,
+               job.function_name.c_str());
+    }
+
+    if (i != 0) description += ", ";
+    if (args[i].keyword != nullptr) {
+      PyDict_SetItemString(py_kwargs, args[i].keyword, py_value);
+      description += std::string(args[i].keyword) + "=";
+    } else {
+      PyList_Append(py_args, py_value);
+    }
+    if (args[i].arg_type == YT_ARG_ARRAY) {
+      description += "<array>";
+    } else {
+      PyObject* py_repr = PyObject_Repr(py_value);
+      description += PyUnicode_AsUTF8(py_repr);
+      Py_DECREF(py_repr);
+    }
+    Py_DECREF(py_value);
+  }
+
+  if (PyDict_Size(py_kwargs) == 0) {
+    Py_DECREF(py_kwargs);
+    Py_INCREF(Py_None);
+    py_kwargs = Py_None;
+  }
+  PyObject* py_args_tuple = PyList_AsTuple(py_args);
+  Py_DECREF(py_args);
+  job.py_arguments.reset(Py_BuildValue("(NN)", py_args_tuple, py_kwargs),
+                         ReleaseTypedArguments);
+  job.str_function = job.function_name + "(" + description + ")";
+
+  return YT_SUCCESS;
+}
 
 /**
  * \addtogroup api_yt_run_Function libyt API: yt_run_FunctionArguments / yt_run_Function
@@ -22,11 +297,15 @@
  *    in \ref yt_initialize and \ref yt_param_libyt. Which means the script contains the
  *    function name you called.
  * 2. Must give argc (argument count), even if there are no arguments.
- * 3. libyt wraps function and its arguments using either \c """ or \c ''' triple quotes,
- *    so we must avoid using both of these triple quotes in function arguments.
- * 4. Under INTERACTIVE_MODE, function will be wrapped inside try/except.
- *    If an error occurred, it will be stored under
- *    \c libyt.interactive_mode.
+ * 3. The function object is looked up once and cached, and arguments are compiled once
+ *    as long as they stay the same. Arguments are evaluated in the inline script
+ *    namespace on every call, and may be keyword arguments.
+ * 4. Under INTERACTIVE_MODE, if an exception is raised, its traceback will be stored
+ *    under \c libyt.interactive_mode.
+ * 5. In in-transit mode, simulation processes send the call to analysis processes and
+ *    return right away, the function only runs on analysis processes.
+ * 6. In node aggregation, node members return right away, the function only runs on
+ *    node leaders.
  *
  * @param function_name[in] Python function name
  * @param argc[in] Number of arguments
@@ -41,144 +320,46 @@
  * \endrst
  */
 int yt_run_FunctionArguments(const char* function_name, int argc, ...) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerPythonExec);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_) {
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
   }
 
-#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
-  // always run m_Run = -1 function, and set 1.
-  // always run unknown function and let Python generates function-not-defined error.
-  int func_index =
-      LibytProcessControl::Get().function_info_list_.GetFunctionIndex(function_name);
-  if (func_index != -1) {
-    if (LibytProcessControl::Get().function_info_list_[func_index].GetRun() ==
-        FunctionInfo::RunStatus::kWillIdle) {
-      logging::LogInfo("YT inline function \"%s\" was set to idle ... idle\n",
-                       function_name);
-      return YT_SUCCESS;
-    } else if (LibytProcessControl::Get().function_info_list_[func_index].GetRun() ==
-               FunctionInfo::RunStatus::kNotSetYet)
-      LibytProcessControl::Get().function_info_list_[func_index].SetRun(
-          FunctionInfo::RunStatus::kWillRun);
-  } else {
-    func_index = LibytProcessControl::Get().function_info_list_.AddNewFunction(
-        function_name, FunctionInfo::RunStatus::kWillRun);
+  deferred_binding::RecordCall(function_name);
+  if (IsSkippedOnThisProcess(function_name)) {
+    return YT_SUCCESS;
   }
-  LibytProcessControl::Get().function_info_list_[func_index].SetStatus(
-      FunctionInfo::ExecuteStatus::kNeedUpdate);
-#endif
 
-#ifndef SERIAL_MODE
-  // start running inline function when every rank come to this stage.
-  MPI_Barrier(MPI_COMM_WORLD);
-#endif
-
-  // join function name and input arguments and
-  // detect whether to use ''' or """ to wrap the function with arguments (default uses
-  // """ to wrap)
-  va_list Args;
-  va_start(Args, argc);
-  std::string str_wrapper("\"\"\"");
-  bool wrapper_detected = false, unable_to_wrapped = false;
-
-  std::string str_function(std::string(function_name) + std::string("("));
+  // join input arguments, they are parsed once and cached with the function object
+  va_list args;
+  va_start(args, argc);
+  std::string arguments;
   for (int i = 0; i < argc; i++) {
-    if (i != 0) str_function += std::string(",");
-
-    // find what wrapper to use, raise error msg if it uses both """ and '''.
-    std::string str_va_arg(va_arg(Args, const char*));
-    if (!wrapper_detected) {
-      if (str_va_arg.find("\"\"\"") != std::string::npos) {
-        wrapper_detected = true;
-        str_wrapper = std::string("'''");
-      } else if (str_va_arg.find("'''") != std::string::npos) {
-        wrapper_detected = true;
-        str_wrapper = std::string("\"\"\"");
-      }
-    } else {
-      // using both """ and ''' for triple quotes, unable to wrap
-      if (str_va_arg.find(str_wrapper.c_str()) != std::string::npos) {
-        unable_to_wrapped = true;
-      }
-    }
-
-    // join arguments
-    str_function += str_va_arg;
+    if (i != 0) arguments += std::string(",");
+    arguments += std::string(va_arg(args, const char*));
   }
-  str_function += std::string(")");
-  va_end(Args);
+  va_end(args);
 
-  if (unable_to_wrapped) {
-#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
-    // set error msg in interactive mode before returning YT_FAIL.
-    std::string str_set_error =
-        std::string("libyt.interactive_mode[\"func_err_msg\"][\"") +
-        std::string(function_name) +
-        std::string("\"] = \"LIBYT Error: Please avoid using both \\\"\\\"\\\" and "
-                    "\'\'\' for triple quotes.\\n\"");
-    LibytProcessControl::Get().function_info_list_[func_index].SetStatus(
-        FunctionInfo::ExecuteStatus::kFailed);
-    if (PyRun_SimpleString(str_set_error.c_str()) != 0) {
-      logging::LogError("Unexpected error occurred when setting unable to wrap error "
-                        "message in interactive mode.\n");
-    }
-#endif
-    // return YT_FAIL
-    logging::LogError("Please avoid using both \"\"\" and ''' for triple quotes.\n");
-    YT_ABORT("Invoking %s ... failed\n", str_function.c_str());
+  // run on analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    logging::LogInfo("YT inline function \"%s\" is sent to analysis processes.\n",
+                     function_name);
+    return in_transit::SendRun(function_name, arguments);
   }
 
-  // join function and input arguments into string wrapped by exec()
-  std::string str_CallYT(std::string("exec(") + str_wrapper + str_function + str_wrapper +
-                         std::string(", sys.modules[\"") +
-                         std::string(LibytProcessControl::Get().param_libyt_.script) +
-                         std::string("\"].__dict__)"));
-
-  logging::LogInfo("Performing YT inline analysis %s ...\n", str_function.c_str());
-
-#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
-  std::string str_CallYT_TryExcept;
-  str_CallYT_TryExcept =
-      std::string("try:\n") + std::string("    ") + str_CallYT + std::string("\n") +
-      std::string("except Exception as e:\n"
-                  "    libyt.interactive_mode[\"func_err_msg\"][\"") +
-      std::string(function_name) + std::string("\"] = traceback.format_exc()\n");
-#endif
-
-#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
-  if (PyRun_SimpleString(str_CallYT_TryExcept.c_str()) != 0)
-#else
-  if (PyRun_SimpleString(str_CallYT.c_str()) != 0)
-#endif
-  {
-#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
-    LibytProcessControl::Get().function_info_list_[func_index].SetStatus(
-        FunctionInfo::ExecuteStatus::kFailed);
-#endif
-    YT_ABORT("Unexpected error occurred while executing %s in script's namespace.\n",
-             str_function.c_str());
+  if (CheckIdleAndMarkToRun(function_name)) {
+    return YT_SUCCESS;
   }
 
-#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
-  // update status in LibytProcessControl::Get().function_info_list_
-  LibytProcessControl::Get().function_info_list_[func_index].SetStatusUsingPythonResult();
-  FunctionInfo::ExecuteStatus all_status =
-      LibytProcessControl::Get().function_info_list_[func_index].GetAllStatus();
-#endif
-
-#if defined(INTERACTIVE_MODE) || defined(JUPYTER_KERNEL)
-  logging::LogInfo(
-      "Performing YT inline analysis %s ... %s.\n",
-      str_function.c_str(),
-      (all_status == FunctionInfo::ExecuteStatus::kSuccess) ? "done" : "failed");
-#else
-  logging::LogInfo("Performing YT inline analysis %s ... done.\n", str_function.c_str());
-#endif
+  AsyncAnalysisJob job;
+  job.function_name = function_name;
+  job.str_function = std::string(function_name) + "(" + arguments + ")";
+  job.arguments = arguments;
 
-  return YT_SUCCESS;
+  return RunInlineFunction(job);
 }
 
 /**
@@ -198,9 +379,190 @@ int yt_run_FunctionArguments(const char* function_name, int argc, ...) {
  * \endrst
  */
 int yt_run_Function(const char* function_name) {
-  SET_TIMER(__PRETTY_FUNCTION__);
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerPythonExec);
 
   int result = yt_run_FunctionArguments(function_name, 0);
 
   return result;
-}
\ No newline at end of file
+}
+
+/**
+ * \brief Call Python function with typed arguments in in situ process
+ * \fn int yt_run_FunctionWithArgs(const char* function_name, const yt_arg* args,
+ *                                 int num_args)
+ * \details
+ * 1. Same as \ref yt_run_FunctionArguments, except that arguments are passed by value
+ *    as \ref yt_arg instead of source strings, so nothing is evaluated.
+ * 2. Scalars are passed as Python int or float, strings as Python str, and arrays as
+ *    read-only NumPy arrays wrapping the C arrays without copying. The arrays must stay
+ *    valid until the function returns.
+ * 3. If \ref yt_param_libyt async_analysis is on, arrays are copied when the function is
+ *    submitted, since the simulation may update them before the function runs.
+ * 4. In in-transit mode, the root simulation process sends the arguments to analysis
+ *    processes, so the arguments on the other simulation processes are ignored.
+ *
+ * @param function_name[in] Python function name
+ * @param args[in] Array of arguments, can be NULL if num_args is 0
+ * @param num_args[in] Number of arguments
+ * @return \ref YT_SUCCESS or \ref YT_FAIL
+ *
+ * \rst
+ * .. code-block:: c
+ *
+ *    // Equivalent to Python: function_name(10, temperature, label='step')
+ *    int step = 10;
+ *    yt_arg args[3];
+ *    args[0].arg_type = YT_ARG_SCALAR;
+ *    args[0].data_dtype = YT_INT;
+ *    args[0].data_ptr = &step;
+ *    args[1].arg_type = YT_ARG_ARRAY;
+ *    args[1].data_dtype = YT_DOUBLE;
+ *    args[1].data_ptr = temperature;
+ *    args[1].num_dims = 1;
+ *    args[1].data_dimensions[0] = num_cells;
+ *    args[2].arg_type = YT_ARG_STRING;
+ *    args[2].keyword = "label";
+ *    args[2].data_ptr = "step";
+ *    yt_run_FunctionWithArgs("function_name", args, 3);
+ * \endrst
+ */
+int yt_run_FunctionWithArgs(const char* function_name, const yt_arg* args,
+                            int num_args) {
+  SET_TIMER_CATEGORY(__PRETTY_FUNCTION__, kTimerPythonExec);
+  PythonGilGuard gil_guard;
+
+  // check if libyt has been initialized
+  if (!LibytProcessControl::Get().libyt_initialized_) {
+    YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
+  }
+
+  // check arguments
+  if (num_args > 0 && args == nullptr) {
+    YT_ABORT("Arguments of \"%s\" is NULL, but num_args = %d.\n",
+             function_name,
+             num_args);
+  }
+  for (int i = 0; i < num_args; i++) {
+    if (args[i].data_ptr == nullptr) {
+      YT_ABORT("data_ptr of argument %d of \"%s\" is not set.\n", i, function_name);
+    }
+    if (args[i].arg_type != YT_ARG_STRING && args[i].data_dtype == YT_DTYPE_UNKNOWN) {
+      YT_ABORT("data_dtype of argument %d of \"%s\" is not set.\n", i, function_name);
+    }
+    if (args[i].arg_type == YT_ARG_ARRAY) {
+      if (args[i].num_dims < 1 || args[i].num_dims > 3) {
+        YT_ABORT("num_dims of argument %d of \"%s\" should be 1 to 3, but get %d.\n",
+                 i,
+                 function_name,
+                 args[i].num_dims);
+      }
+      for (int d = 0; d < args[i].num_dims; d++) {
+        if (args[i].data_dimensions[d] < 0) {
+          YT_ABORT("data_dimensions[%d] of argument %d of \"%s\" is negative.\n",
+                   d,
+                   i,
+                   function_name);
+        }
+      }
+    }
+  }
+
+  deferred_binding::RecordCall(function_name);
+  if (IsSkippedOnThisProcess(function_name)) {
+    return YT_SUCCESS;
+  }
+
+  // run on analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    logging::LogInfo("YT inline function \"%s\" is sent to analysis processes.\n",
+                     function_name);
+    return in_transit::SendRunWithArgs(function_name, args, num_args);
+  }
+
+  if (CheckIdleAndMarkToRun(function_name)) {
+    return YT_SUCCESS;
+  }
+
+  AsyncAnalysisJob job;
+  job.function_name = function_name;
+  if (PackTypedArguments(args, num_args, async_analysis::IsEnabled(), job) !=
+      YT_SUCCESS) {
+    YT_ABORT("Unable to pack arguments of \"%s\".\n", function_name);
+  }
+
+  return RunInlineFunction(job);
+}
+
+/**
+ * \defgroup api_yt_wait libyt API: yt_wait / yt_test
+ * \name api_yt_wait
+ * Wait for or check the completion of inline functions run asynchronously, when
+ * \ref yt_param_libyt async_analysis is on.
+ */
+
+/**
+ * \brief Wait for inline functions run asynchronously to finish
+ * \fn int yt_wait()
+ * \details
+ * 1. Block until every inline function submitted by \ref yt_run_FunctionArguments and
+ *    \ref yt_run_Function is done, then gather the time spent on each rank and the
+ *    status of every function finished so far in a single collective.
+ * 2. This is a collective operation, every MPI process must call it.
+ * 3. Return immediately if there is nothing to wait for, e.g. async_analysis is off.
+ * 4. \ref yt_free calls this function implicitly if \ref yt_param_libyt async_max_steps
+ *    is 0. Otherwise, functions of previous steps are finished in \ref yt_commit once
+ *    they are done, and this function is only needed to wait for all of them.
+ *
+ * @return \ref YT_SUCCESS, or \ref YT_FAIL if any of the functions failed
+ */
+int yt_wait() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
+
+  // check if libyt has been initialized
+  if (!LibytProcessControl::Get().libyt_initialized_) {
+    YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
+  }
+
+  if (!async_analysis::HasPendingJobs()) {
+    return YT_SUCCESS;
+  }
+
+  std::chrono::steady_clock::time_point wait_start = std::chrono::steady_clock::now();
+  std::vector<AsyncAnalysisJob> job_list = async_analysis::Wait();
+  std::chrono::duration<double> wait_time = std::chrono::steady_clock::now() - wait_start;
+  perf_counter::Add("python.async_wait_time", wait_time.count());
+
+  int result = YT_SUCCESS;
+  for (const AsyncAnalysisJob& job : job_list) {
+    if (async_analysis::FinishJob(job) != YT_SUCCESS) {
+      result = YT_FAIL;
+    }
+  }
+  if (async_analysis::SyncStatus() != YT_SUCCESS) {
+    result = YT_FAIL;
+  }
+
+  return result;
+}
+
+/**
+ * \brief Check if inline functions run asynchronously are done
+ * \fn int yt_test(bool* is_done)
+ * \details
+ * 1. This is a local operation, it does not block and does not touch Python.
+ * 2. Still need to call \ref yt_wait, \ref yt_commit, or \ref yt_free afterward to
+ *    finish them, even if it is done.
+ *
+ * @param is_done[out] true if every submitted inline function is done
+ * @return \ref YT_SUCCESS or \ref YT_FAIL
+ */
+int yt_test(bool* is_done) {
+  if (!LibytProcessControl::Get().libyt_initialized_) {
+    YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
+  }
+
+  *is_done = async_analysis::IsDone();
+
+  return YT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#include "in_transit.h"
+#include "libyt.h"
+#include "libyt_process_control.h"
+#include "logging.h"
+#include "timer.h"
+
+/**
+ * \defgroup api_yt_run_InTransit libyt API: yt_run_InTransit / yt_get_InTransitRole
+ * \name api_yt_run_InTransit
+ * Run inline analysis on processes dedicated to it, when \ref yt_param_libyt
+ * in_transit_ranks is set.
+ */
+
+/**
+ * \brief Check if this process is an analysis process in in-transit mode
+ * \fn int yt_get_InTransitRole(bool* is_analysis_rank)
+ * \details
+ * 1. Analysis processes are the last in_transit_ranks processes in the communicator
+ *    passed to \ref yt_initialize.
+ * 2. It is false on every process if in-transit mode is off.
+ *
+ * @param is_analysis_rank[out] true if this process should call \ref yt_run_InTransit
+ * @return \ref YT_SUCCESS or \ref YT_FAIL
+ */
+int yt_get_InTransitRole(bool* is_analysis_rank) {
+  if (!LibytProcessControl::Get().libyt_initialized_) {
+    YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
+  }
+
+  *is_analysis_rank = in_transit::IsAnalysisRank();
+
+  return YT_SUCCESS;
+}
+
+/**
+ * \brief Run inline analysis on data shipped from simulation processes
+ * \fn int yt_run_InTransit()
+ * \details
+ * 1. Only analysis processes call this function, and it returns after simulation
+ *    processes call \ref yt_finalize. Call \ref yt_finalize afterward.
+ * 2. Each step committed, each inline function run, and each \ref yt_free called on
+ *    simulation processes are replayed in the same order, so inline functions see the
+ *    same libyt Python module as they do without in-transit mode.
+ * 3. This is a collective operation among analysis processes.
+ *
+ * @return \ref YT_SUCCESS or \ref YT_FAIL
+ */
+int yt_run_InTransit() {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  if (!LibytProcessControl::Get().libyt_initialized_) {
+    YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
+  }
+
+  if (!in_transit::IsAnalysisRank()) {
+    YT_ABORT("%s() should only be called on analysis processes in in-transit mode!\n",
+             __FUNCTION__);
+  }
+
+  logging::LogInfo("Running inline analysis on data from simulation processes ...\n");
+  if (in_transit::Serve() != YT_SUCCESS) {
+    YT_ABORT("Running inline analysis on data from simulation processes ... failed!\n");
+  }
+  logging::LogInfo("Running inline analysis on data from simulation processes ... "
+                   "done.\n");
+
+  return YT_SUCCESS;
+}
@@ -1,5 +1,6 @@
 #include "libyt.h"
 #include "logging.h"
+#include "node_aggregation.h"
 #include "timer.h"
 
 #ifdef INTERACTIVE_MODE
@@ -8,7 +9,10 @@
 #include <iostream>
 #include <string>
 
+#include "async_analysis.h"
+#include "deferred_binding.h"
 #include "function_info.h"
+#include "in_transit.h"
 #include "libyt_process_control.h"
 #include "libyt_utilities.h"
 #include "magic_command.h"
@@ -46,6 +50,20 @@ int yt_run_InteractiveMode(const char* flag_file_name) {
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
   }
 
+  // simulation and analysis processes do not run the same code in in-transit mode
+  if (in_transit::IsEnabled()) {
+    YT_ABORT("%s() is not supported in in-transit mode!\n", __FUNCTION__);
+  }
+
+  // node members do not have Python
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // inline functions run asynchronously must be done, since Python is used here
+  yt_wait();
+  PythonGilGuard gil_guard;
+
   fflush(stdout);
   fflush(stderr);
 
@@ -71,6 +89,11 @@ int yt_run_InteractiveMode(const char* flag_file_name) {
     return YT_SUCCESS;
   }
 
+  // bind data if yt_commit deferred it, since it is accessible in the prompt
+  if (deferred_binding::EnsureBound() != YT_SUCCESS) {
+    YT_ABORT("Unable to bind data before entering interactive mode!\n");
+  }
+
   // create prompt interface
   const char* ps1 = ">>> ";
   const char* ps2 = "... ";
@@ -86,7 +109,7 @@ int yt_run_InteractiveMode(const char* flag_file_name) {
   fflush(stdout);
   fflush(stderr);
 #ifndef SERIAL_MODE
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Barrier(CommMpi::GetComm());
 #endif
 
   // enter interactive loop
@@ -116,7 +139,7 @@ int yt_run_InteractiveMode(const char* flag_file_name) {
 #ifndef SERIAL_MODE
           // Send call libyt define command code (indicator = 0)
           int indicator = 0;
-          MPI_Bcast(&indicator, 1, MPI_INT, root, MPI_COMM_WORLD);
+          MPI_Bcast(&indicator, 1, MPI_INT, root, CommMpi::GetComm());
 #endif
           // run libyt command
           command_result = command.Run(&(input_line[first_char]));
@@ -124,7 +147,7 @@ int yt_run_InteractiveMode(const char* flag_file_name) {
           std::cout << command_result.error << std::endl;
           done = command_result.exit_entry_point;
 #ifndef SERIAL_MODE
-          MPI_Barrier(MPI_COMM_WORLD);
+          MPI_Barrier(CommMpi::GetComm());
 #endif
 
           // clean up
@@ -159,7 +182,7 @@ int yt_run_InteractiveMode(const char* flag_file_name) {
 #ifndef SERIAL_MODE
           // Send call libyt execute code (indicator = 1)
           int indicator = 1;
-          MPI_Bcast(&indicator, 1, MPI_INT, root, MPI_COMM_WORLD);
+          MPI_Bcast(&indicator, 1, MPI_INT, root, CommMpi::GetComm());
 #endif
 
           // Execute code and print result
@@ -207,7 +230,7 @@ int yt_run_InteractiveMode(const char* flag_file_name) {
           fflush(stdout);
           fflush(stderr);
 #ifndef SERIAL_MODE
-          MPI_Barrier(MPI_COMM_WORLD);
+          MPI_Barrier(CommMpi::GetComm());
 #endif
         }
       } else if (code_validity.is_valid == "incomplete") {
@@ -227,7 +250,7 @@ int yt_run_InteractiveMode(const char* flag_file_name) {
     else {
       // TODO: (this is a bad practice.) Get code for further instructions
       int indicator = -1;
-      MPI_Bcast(&indicator, 1, MPI_INT, root, MPI_COMM_WORLD);
+      MPI_Bcast(&indicator, 1, MPI_INT, root, CommMpi::GetComm());
 
       if (indicator == 0) {
         // call libyt command, if indicator is 0
@@ -244,7 +267,7 @@ int yt_run_InteractiveMode(const char* flag_file_name) {
       // clean up and wait
       fflush(stdout);
       fflush(stderr);
-      MPI_Barrier(MPI_COMM_WORLD);
+      MPI_Barrier(CommMpi::GetComm());
     }
 #endif  // #ifndef SERIAL_MODE
   }
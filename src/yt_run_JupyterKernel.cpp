@@ -1,5 +1,6 @@
 #include "libyt.h"
 #include "logging.h"
+#include "node_aggregation.h"
 #include "timer.h"
 
 #ifdef JUPYTER_KERNEL
@@ -11,7 +12,10 @@
 #include <xeus/xkernel.hpp>
 #include <xeus/xkernel_configuration.hpp>
 
+#include "async_analysis.h"
+#include "deferred_binding.h"
 #include "function_info.h"
+#include "in_transit.h"
 #include "libyt_kernel.h"
 #include "libyt_process_control.h"
 #include "libyt_utilities.h"
@@ -55,6 +59,20 @@ int yt_run_JupyterKernel(const char* flag_file_name, bool use_connection_file) {
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
   }
 
+  // simulation and analysis processes do not run the same code in in-transit mode
+  if (in_transit::IsEnabled()) {
+    YT_ABORT("%s() is not supported in in-transit mode!\n", __FUNCTION__);
+  }
+
+  // node members do not have Python
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // inline functions run asynchronously must be done, since Python is used here
+  yt_wait();
+  PythonGilGuard gil_guard;
+
   // run new added functions
   LibytProcessControl::Get().function_info_list_.RunEveryFunction();
 
@@ -70,8 +88,13 @@ int yt_run_JupyterKernel(const char* flag_file_name, bool use_connection_file) {
     return YT_SUCCESS;
   }
 
+  // bind data if yt_commit deferred it, since it is accessible in the kernel
+  if (deferred_binding::EnsureBound() != YT_SUCCESS) {
+    YT_ABORT("Unable to bind data before starting libyt kernel!\n");
+  }
+
 #ifndef SERIAL_MODE
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Barrier(CommMpi::GetComm());
 #endif
   // Basic libyt kernel info
   const char* kernel_pid_filename = "libyt_kernel_pid.txt";
@@ -235,7 +258,7 @@ int yt_run_JupyterKernel(const char* flag_file_name, bool use_connection_file) {
 #endif
 
 #ifndef SERIAL_MODE
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Barrier(CommMpi::GetComm());
 #endif
 
   return YT_SUCCESS;
@@ -1,5 +1,7 @@
+#include "inline_function.h"
 #include "libyt.h"
 #include "logging.h"
+#include "node_aggregation.h"
 #include "timer.h"
 
 #ifdef INTERACTIVE_MODE
@@ -11,6 +13,9 @@
 #include <string>
 #include <thread>
 
+#include "async_analysis.h"
+#include "deferred_binding.h"
+#include "in_transit.h"
 #include "libyt_process_control.h"
 #include "libyt_utilities.h"
 #include "magic_command.h"
@@ -64,6 +69,20 @@ int yt_run_ReloadScript(const char* flag_file_name, const char* reload_file_name
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
   }
 
+  // simulation and analysis processes do not run the same code in in-transit mode
+  if (in_transit::IsEnabled()) {
+    YT_ABORT("%s() is not supported in in-transit mode!\n", __FUNCTION__);
+  }
+
+  // node members do not have Python
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // inline functions run asynchronously must be done, since Python is used here
+  yt_wait();
+  PythonGilGuard gil_guard;
+
   fflush(stdout);
   fflush(stderr);
 
@@ -115,11 +134,16 @@ int yt_run_ReloadScript(const char* flag_file_name, const char* reload_file_name
                      flag_file_name);
   }
 
+  // bind data if yt_commit deferred it, since reloaded scripts run on it
+  if (deferred_binding::EnsureBound() != YT_SUCCESS) {
+    YT_ABORT("Unable to bind data before entering reload script mode!\n");
+  }
+
   // make sure every process has reached here
   fflush(stdout);
   fflush(stderr);
 #ifndef SERIAL_MODE
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Barrier(CommMpi::GetComm());
 #endif
 
   // setting up reading file
@@ -157,7 +181,7 @@ int yt_run_ReloadScript(const char* flag_file_name, const char* reload_file_name
       if (done) {
 #ifndef SERIAL_MODE
         int indicator = -1;
-        MPI_Bcast(&indicator, 1, MPI_INT, mpi_root, MPI_COMM_WORLD);
+        MPI_Bcast(&indicator, 1, MPI_INT, mpi_root, CommMpi::GetComm());
 #endif
         LibytProcessControl::Get().python_shell_.ClearHistory();
         logging::LogInfo("Detect '%s' file ... exiting reload script\n",
@@ -222,7 +246,7 @@ int yt_run_ReloadScript(const char* flag_file_name, const char* reload_file_name
         if (code_validity.is_valid == "complete") {
 #ifndef SERIAL_MODE
           int indicator = 1;
-          MPI_Bcast(&indicator, 1, MPI_INT, mpi_root, MPI_COMM_WORLD);
+          MPI_Bcast(&indicator, 1, MPI_INT, mpi_root, CommMpi::GetComm());
 #endif
           std::vector<PythonOutput> output;
           PythonStatus all_execute_status =
@@ -272,7 +296,7 @@ int yt_run_ReloadScript(const char* flag_file_name, const char* reload_file_name
         while (std::getline(libyt_command_buffer, line, '\n')) {
 #ifndef SERIAL_MODE
           int indicator = 0;
-          MPI_Bcast(&indicator, 1, MPI_INT, mpi_root, MPI_COMM_WORLD);
+          MPI_Bcast(&indicator, 1, MPI_INT, mpi_root, CommMpi::GetComm());
 #endif
           command_result = command.Run(line);
           reload_result_file << "====== Libyt Command: " << line << " ======\n";
@@ -322,7 +346,7 @@ int yt_run_ReloadScript(const char* flag_file_name, const char* reload_file_name
     else {
       // TODO: (this is a bad practice.) Get code for further instructions
       int indicator = -2;
-      MPI_Bcast(&indicator, 1, MPI_INT, mpi_root, MPI_COMM_WORLD);
+      MPI_Bcast(&indicator, 1, MPI_INT, mpi_root, CommMpi::GetComm());
 
       switch (indicator) {
         case -1: {
@@ -354,6 +378,9 @@ int yt_run_ReloadScript(const char* flag_file_name, const char* reload_file_name
     std::remove(flag_file_name);
   }
 
+  // inline functions may be redefined in the reloaded script
+  inline_function::InvalidateCache();
+
   logging::LogInfo("Exit reloading script\n");
 
   return YT_SUCCESS;
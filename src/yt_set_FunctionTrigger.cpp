@@ -0,0 +1,55 @@
+#include "libyt.h"
+#include "libyt_process_control.h"
+#include "logging.h"
+#include "timer.h"
+#include "trigger.h"
+
+/**
+ * \defgroup api_yt_set_FunctionTrigger libyt API: yt_set_FunctionTrigger
+ * \fn int yt_set_FunctionTrigger(const char* function_name, const yt_trigger* trigger)
+ * \brief Set a trigger that decides whether an inline function runs in a step.
+ * \details
+ * 1. The trigger is evaluated on committed data in \ref yt_commit. If it does not fire,
+ *    \ref yt_run_Function, \ref yt_run_FunctionArguments, and
+ *    \ref yt_run_FunctionWithArgs return \ref YT_SUCCESS right away for the function in
+ *    this step, without waiting for other processes.
+ * 2. Field triggers of every function are reduced in a single MPI_Allreduce in
+ *    \ref yt_commit.
+ * 3. Every MPI process must set the same triggers. A function has at most one trigger,
+ *    setting it again replaces the old one, and passing NULL removes it.
+ * 4. The trigger is kept until \ref yt_finalize.
+ *
+ * @param function_name[in] Python function name
+ * @param trigger[in] Trigger, or NULL to remove the trigger
+ * @return \ref YT_SUCCESS or \ref YT_FAIL
+ *
+ * \rst
+ * .. code-block:: c
+ *
+ *    // Run "function_name" only if the maximum density is above 100.0
+ *    yt_trigger trigger;
+ *    trigger.trigger_type = YT_TRIGGER_FIELD_MAX_ABOVE;
+ *    trigger.field_name = "Dens";
+ *    trigger.threshold = 100.0;
+ *    yt_set_FunctionTrigger("function_name", &trigger);
+ * \endrst
+ */
+int yt_set_FunctionTrigger(const char* function_name, const yt_trigger* trigger) {
+  SET_TIMER(__PRETTY_FUNCTION__);
+
+  // check if libyt has been initialized
+  if (!LibytProcessControl::Get().libyt_initialized_) {
+    YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
+  }
+
+  if (function_name == nullptr) {
+    YT_ABORT("function_name is NULL in %s()!\n", __FUNCTION__);
+  }
+
+  if (trigger::Set(function_name, trigger) != YT_SUCCESS) {
+    YT_ABORT("Setting trigger of \"%s\" ... failed!\n", function_name);
+  }
+  logging::LogDebug("Setting trigger of \"%s\" ... done\n", function_name);
+
+  return YT_SUCCESS;
+}
@@ -1,6 +1,9 @@
+#include "async_analysis.h"
+#include "in_transit.h"
 #include "libyt.h"
 #include "libyt_process_control.h"
 #include "logging.h"
+#include "node_aggregation.h"
 #include "python_controller.h"
 #include "timer.h"
 
@@ -19,6 +22,10 @@ static int PrintYtParamYt(const yt_param_yt& param_yt);
  * 1. Store yt relevant data to libyt Python module `libyt.param_yt`.
  * 2. Initialize AMR data structure and storage.
  * 3. Should be called after \ref yt_initialize.
+ * 4. It is a collective operation on the node in node aggregation, and node leaders
+ *    allocate storage for the local grids of every process on the node.
+ * 5. Processes without Python, which are node members in node aggregation and
+ *    simulation processes in in-transit mode, do not set `libyt.param_yt`.
  *
  * @param input_param_yt[in] YT-specific parameters and parameters for initializing AMR
  *                           data structure
@@ -26,6 +33,7 @@ static int PrintYtParamYt(const yt_param_yt& param_yt);
  */
 int yt_set_Parameters(yt_param_yt* input_param_yt) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_) {
@@ -66,6 +74,10 @@ int yt_set_Parameters(yt_param_yt* input_param_yt) {
   LibytProcessControl::Get().param_yt_ = *input_param_yt;
   yt_param_yt& param_yt = LibytProcessControl::Get().param_yt_;
 
+  // node leaders also hold local grids of node members
+  param_yt.num_grids_local =
+      node_aggregation::AggregateNumGridsLocal(param_yt.num_grids_local);
+
   // Set up DataStructureAmr
   DataStructureOutput status;
   if (param_yt.num_par_types > 0) {
@@ -111,9 +123,21 @@ int yt_set_Parameters(yt_param_yt* input_param_yt) {
     param_yt.fig_basename = fig_basename;
   }
 
+  // simulation processes send fig_basename to analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    in_transit::RecordFigBasename(input_param_yt->fig_basename);
+  }
+
+  if (node_aggregation::IsMember() || in_transit::IsSimulationRank()) {
+    LibytProcessControl::Get().param_yt_set_ = true;
+    LibytProcessControl::Get().need_free_ = true;
+    logging::LogDebug("Setting YT parameters ... done.\n");
+    return YT_SUCCESS;
+  }
+
 #ifdef USE_PYBIND11
-  pybind11::module_ libyt = pybind11::module_::import("libyt");
-  pybind11::dict py_param_yt = libyt.attr("param_yt");
+  pybind11::dict py_param_yt = pybind11::reinterpret_borrow<pybind11::dict>(
+      LibytProcessControl::Get().py_param_yt_);
 
   py_param_yt["frontend"] = param_yt.frontend;
   py_param_yt["fig_basename"] = param_yt.fig_basename;
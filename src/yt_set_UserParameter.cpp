@@ -1,8 +1,12 @@
+#include <cstring>
 #include <typeinfo>
 
+#include "async_analysis.h"
+#include "in_transit.h"
 #include "libyt.h"
 #include "libyt_process_control.h"
 #include "logging.h"
+#include "node_aggregation.h"
 #include "python_controller.h"
 #include "timer.h"
 
@@ -17,8 +21,8 @@ static int add_string(const char* key, const char* input);
 #else
 #define ADD_NONSTRING_TO_PARAM_USER()                                                    \
   {                                                                                      \
-    pybind11::module_ libyt = pybind11::module_::import("libyt");                        \
-    pybind11::dict py_param_user = libyt.attr("param_user");                             \
+    pybind11::dict py_param_user = pybind11::reinterpret_borrow<pybind11::dict>(         \
+        LibytProcessControl::Get().py_param_user_);                                      \
     if (n == 1) {                                                                        \
       py_param_user[key] = *input;                                                       \
     } else {                                                                             \
@@ -42,7 +46,9 @@ static const int MaxParamNameWidth = 15;
  * \addtogroup api_yt_set_UserParameter
  * \name api_yt_set_UserParameter
  * Set user or code-specific parameters. All the parameters will be put under
- * @verbatim libyt.param_user["key"] = value @endverbatim.
+ * @verbatim libyt.param_user["key"] = value @endverbatim. They are only set on node
+ * leaders in node aggregation. Simulation processes in in-transit mode send them to
+ * analysis processes with the next \ref yt_commit.
  */
 
 /**
@@ -58,12 +64,23 @@ static const int MaxParamNameWidth = 15;
  */
 int yt_set_UserParameterInt(const char* key, const int n, const int* input) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_) {
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
   }
 
+  // node members do not have libyt.param_user
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // simulation processes send it to analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    return in_transit::RecordUserParameter(key, YT_INT, n, input);
+  }
+
 #ifndef USE_PYBIND11
   return add_nonstring(key, n, input);
 #else
@@ -84,11 +101,22 @@ int yt_set_UserParameterInt(const char* key, const int n, const int* input) {
  */
 int yt_set_UserParameterLong(const char* key, const int n, const long* input) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_)
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
 
+  // node members do not have libyt.param_user
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // simulation processes send it to analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    return in_transit::RecordUserParameter(key, YT_LONG, n, input);
+  }
+
 #ifndef USE_PYBIND11
   return add_nonstring(key, n, input);
 #else
@@ -109,11 +137,22 @@ int yt_set_UserParameterLong(const char* key, const int n, const long* input) {
  */
 int yt_set_UserParameterLongLong(const char* key, const int n, const long long* input) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_)
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
 
+  // node members do not have libyt.param_user
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // simulation processes send it to analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    return in_transit::RecordUserParameter(key, YT_LONGLONG, n, input);
+  }
+
 #ifndef USE_PYBIND11
   return add_nonstring(key, n, input);
 #else
@@ -134,11 +173,22 @@ int yt_set_UserParameterLongLong(const char* key, const int n, const long long*
  */
 int yt_set_UserParameterUint(const char* key, const int n, const unsigned int* input) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_)
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
 
+  // node members do not have libyt.param_user
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // simulation processes send it to analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    return in_transit::RecordUserParameter(key, YT_UINT, n, input);
+  }
+
 #ifndef USE_PYBIND11
   return add_nonstring(key, n, input);
 #else
@@ -159,11 +209,22 @@ int yt_set_UserParameterUint(const char* key, const int n, const unsigned int* i
  */
 int yt_set_UserParameterUlong(const char* key, const int n, const unsigned long* input) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_)
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
 
+  // node members do not have libyt.param_user
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // simulation processes send it to analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    return in_transit::RecordUserParameter(key, YT_ULONG, n, input);
+  }
+
 #ifndef USE_PYBIND11
   return add_nonstring(key, n, input);
 #else
@@ -184,11 +245,22 @@ int yt_set_UserParameterUlong(const char* key, const int n, const unsigned long*
  */
 int yt_set_UserParameterFloat(const char* key, const int n, const float* input) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_)
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
 
+  // node members do not have libyt.param_user
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // simulation processes send it to analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    return in_transit::RecordUserParameter(key, YT_FLOAT, n, input);
+  }
+
 #ifndef USE_PYBIND11
   return add_nonstring(key, n, input);
 #else
@@ -209,11 +281,22 @@ int yt_set_UserParameterFloat(const char* key, const int n, const float* input)
  */
 int yt_set_UserParameterDouble(const char* key, const int n, const double* input) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_)
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
 
+  // node members do not have libyt.param_user
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // simulation processes send it to analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    return in_transit::RecordUserParameter(key, YT_DOUBLE, n, input);
+  }
+
 #ifndef USE_PYBIND11
   return add_nonstring(key, n, input);
 #else
@@ -233,16 +316,28 @@ int yt_set_UserParameterDouble(const char* key, const int n, const double* input
  */
 int yt_set_UserParameterString(const char* key, const char* input) {
   SET_TIMER(__PRETTY_FUNCTION__);
+  PythonGilGuard gil_guard;
 
   // check if libyt has been initialized
   if (!LibytProcessControl::Get().libyt_initialized_)
     YT_ABORT("Please invoke yt_initialize() before calling %s()!\n", __FUNCTION__);
 
+  // node members do not have libyt.param_user
+  if (node_aggregation::IsMember()) {
+    return YT_SUCCESS;
+  }
+
+  // simulation processes send it to analysis processes in in-transit mode
+  if (in_transit::IsSimulationRank()) {
+    int n = (input != nullptr) ? static_cast<int>(strlen(input)) + 1 : 0;
+    return in_transit::RecordUserParameter(key, YT_CHAR, n, input);
+  }
+
 #ifndef USE_PYBIND11
   return add_string(key, input);
 #else
-  pybind11::module_ libyt = pybind11::module_::import("libyt");
-  pybind11::dict py_param_user = libyt.attr("param_user");
+  pybind11::dict py_param_user = pybind11::reinterpret_borrow<pybind11::dict>(
+      LibytProcessControl::Get().py_param_user_);
   py_param_user[key] = input;
   return YT_SUCCESS;
 #endif
@@ -0,0 +1,316 @@
+#include <Python.h>
+
+#ifndef SERIAL_MODE
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "data_hub_amr.h"
+#include "libyt.h"
+#include "libyt_process_control.h"
+#include "perf_counter.h"
+#include "synthetic_amr.h"
+#ifndef SERIAL_MODE
+#include "comm_mpi_rma.h"
+#include "memory_spill.h"
+#include "memory_tracker.h"
+#endif
+
+//-------------------------------------------------------------------------------------------------------
+// Description :  Benchmark suite for yt_commit, hierarchy gather, remote field exchange,
+//                and derived field generation.
+//
+// Notes       :  1. Usage: Benchmark [--repeat N] [--output <file>] [--quick]
+//                2. Each measurement is the max wall time over MPI processes, since the
+//                   slowest process decides how long the simulation is blocked.
+//                3. Results are written by root rank as one JSON object per line, to
+//                   stdout or to the output file.
+//-------------------------------------------------------------------------------------------------------
+
+struct BenchmarkOptions {
+  int repeat = 5;
+  bool quick = false;
+  std::string output;
+};
+
+struct BenchmarkResult {
+  std::string name{};
+  std::vector<std::pair<std::string, long>> params{};
+  std::vector<double> time_list{};
+  double work = 0.0;  // bytes or cells handled in one repetition
+  std::string work_unit{};
+};
+
+static int my_rank = 0;
+static int my_size = 1;
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetMaxTimeOverRanks
+// Description :  Synchronize every process, run func, and get the max wall time.
+//-------------------------------------------------------------------------------------------------------
+template<typename Func>
+static double GetMaxTimeOverRanks(Func func) {
+#ifndef SERIAL_MODE
+  MPI_Barrier(MPI_COMM_WORLD);
+#endif
+  auto start = std::chrono::steady_clock::now();
+  func();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  double time = elapsed.count();
+#ifndef SERIAL_MODE
+  MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+  return time;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  WriteResult
+// Description :  Write {"benchmark", <params>, "mpi_size", "repeat", "min", "mean",
+//                "max", <work_unit>, <work_unit>_per_sec} on root rank.
+//-------------------------------------------------------------------------------------------------------
+static void WriteResult(std::ostream& stream, const BenchmarkResult& result) {
+  if (my_rank != 0 || result.time_list.empty()) {
+    return;
+  }
+  double min = *std::min_element(result.time_list.begin(), result.time_list.end());
+  double max = *std::max_element(result.time_list.begin(), result.time_list.end());
+  double mean = 0.0;
+  for (double time : result.time_list) {
+    mean += time;
+  }
+  mean /= result.time_list.size();
+
+  std::ostringstream line;
+  line.precision(9);
+  line << "{\"benchmark\": \"" << result.name << "\"";
+  for (const auto& param : result.params) {
+    line << ", \"" << param.first << "\": " << param.second;
+  }
+  line << ", \"mpi_size\": " << my_size << ", \"repeat\": " << result.time_list.size()
+       << ", \"min\": " << min << ", \"mean\": " << mean << ", \"max\": " << max;
+  if (!result.work_unit.empty()) {
+    line << ", \"" << result.work_unit << "\": " << result.work << ", \""
+         << result.work_unit << "_per_sec\": " << ((min > 0.0) ? result.work / min : 0.0);
+  }
+  line << "}\n";
+  stream << line.str();
+  stream.flush();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetUniformConfig
+// Description :  Config of num_grids root grids of grid_size^3 cells, laid out as
+//                (num_grids / 16) x 4 x 4.
+//-------------------------------------------------------------------------------------------------------
+static SyntheticAmrConfig GetUniformConfig(long num_grids, int grid_size) {
+  SyntheticAmrConfig config;
+  config.num_root_grids[0] = static_cast<int>(std::max(1L, num_grids / 16));
+  config.num_root_grids[1] = 4;
+  config.num_root_grids[2] = 4;
+  config.grid_size = grid_size;
+  return config;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  GetMaxCounterOverRanks
+// Description :  Get the max of the sum of perf counters in name_list over MPI processes.
+//-------------------------------------------------------------------------------------------------------
+static double GetMaxCounterOverRanks(const std::vector<std::string>& name_list) {
+  double value = 0.0;
+  for (const std::string& name : name_list) {
+    value += perf_counter::Get(name);
+  }
+#ifndef SERIAL_MODE
+  MPI_Allreduce(MPI_IN_PLACE, &value, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+#endif
+  return value;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  BenchmarkCommit
+// Description :  Latency of yt_commit and of BindAllHierarchyToPython vs number of grids.
+//
+// Notes       :  1. yt_commit frees local grids after binding, so the hierarchy cannot
+//                   be bound again. Time of BindAllHierarchyToPython is taken from the
+//                   commit perf counters it adds to, before they are reset in yt_free.
+//-------------------------------------------------------------------------------------------------------
+static void BenchmarkCommit(std::ostream& stream, const BenchmarkOptions& options,
+                            long num_grids) {
+  SyntheticAmr amr(GetUniformConfig(num_grids, 8), my_size, my_rank);
+  BenchmarkResult commit{"yt_commit", {{"num_grids", amr.GetNumGrids()}}};
+  BenchmarkResult bind{"bind_all_hierarchy", {{"num_grids", amr.GetNumGrids()}}};
+
+  for (int i = 0; i < options.repeat; i++) {
+    amr.SetLibytStep(0.0);
+    commit.time_list.push_back(GetMaxTimeOverRanks([]() { yt_commit(); }));
+    bind.time_list.push_back(GetMaxCounterOverRanks(
+        {"commit.check_time", "commit.gather_time", "commit.bind_time"}));
+    yt_free();
+  }
+
+  WriteResult(stream, commit);
+  WriteResult(stream, bind);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Function    :  BenchmarkDerivedFunc
+// Description :  Throughput of generating derived field on all local grids.
+//-------------------------------------------------------------------------------------------------------
+static void BenchmarkDerivedFunc(std::ostream& stream, const BenchmarkOptions& options,
+                                 int grid_size) {
+  const long num_grids_per_rank = 64;
+  SyntheticAmrConfig config = GetUniformConfig(num_grids_per_rank * my_size, grid_size);
+  config.derived_field = true;
+  SyntheticAmr amr(config, my_size, my_rank);
+  BenchmarkResult result{"derived_func", {{"grid_size", grid_size}}};
+  result.work_unit = "cells";
+  result.work = (double)num_grids_per_rank * amr.GetNumCellsPerGrid();
+
+  amr.SetLibytStep(0.0);
+  yt_commit();
+  const std::vector<long>& id_list = amr.GetLocalIdList();
+  for (int i = 0; i < options.repeat; i++) {
+    result.time_list.push_back(GetMaxTimeOverRanks([&id_list]() {
+      DataHubAmrField<AmrDataArray3D> local_amr_data(false);
+      local_amr_data.GetLocalFieldData(
+          LibytProcessControl::Get().data_structure_amr_, "DerivedField", id_list);
+    }));
+  }
+  yt_free();
+
+  WriteResult(stream, result);
+}
+
+#ifndef SERIAL_MODE
+//-------------------------------------------------------------------------------------------------------
+// Function    :  BenchmarkRemoteData
+// Description :  Bandwidth of CommMpiRma::GetRemoteData vs grid size, each process
+//                fetches every grid of the next process.
+//-------------------------------------------------------------------------------------------------------
+static void BenchmarkRemoteData(std::ostream& stream, const BenchmarkOptions& options,
+                                int grid_size) {
+  const long num_grids_per_rank = 16;
+  SyntheticAmr amr(
+      GetUniformConfig(num_grids_per_rank * my_size, grid_size), my_size, my_rank);
+  BenchmarkResult result{"get_remote_data", {{"grid_size", grid_size}}};
+  result.work_unit = "bytes";
+  result.work = (double)num_grids_per_rank * amr.GetNumCellsPerGrid() * sizeof(double) *
+                my_size;
+
+  amr.SetLibytStep(0.0);
+  yt_commit();
+  DataHubAmrField<AmrDataArray3D> local_amr_data(false);
+  DataHubReturn<AmrDataArray3D> prepared_data = local_amr_data.GetLocalFieldData(
+      LibytProcessControl::Get().data_structure_amr_, "Field0", amr.GetLocalIdList());
+  int next_rank = (my_rank + 1) % my_size;
+  std::vector<CommMpiRmaQueryInfo> fetch_list;
+  for (const SyntheticGrid& grid : amr.GetGridList()) {
+    if (grid.mpi_rank == next_rank) {
+      fetch_list.push_back({next_rank, grid.id});
+    }
+  }
+
+  for (int i = 0; i < options.repeat; i++) {
+    CommMpiRmaAmrDataArray3D rma("Field0", "amr_grid");
+    result.time_list.push_back(GetMaxTimeOverRanks([&]() {
+      CommMpiRmaReturn<AmrDataArray3D> rma_return =
+          rma.GetRemoteData(prepared_data.data_list, fetch_list);
+      if (rma_return.all_status != CommMpiRmaStatus::kMpiSuccess) {
+        std::cerr << "GetRemoteData failed: " << rma.GetErrorStr() << std::endl;
+      }
+    }));
+    for (const AmrDataArray3D& fetched_data : rma.GetFetchedData()) {
+      if (memory_spill::IsSpillBuffer(fetched_data.data_ptr)) {
+        memory_spill::FreeSpillBuffer(fetched_data.data_ptr);
+      } else {
+        memory_tracker::Free(fetched_data.data_ptr);
+      }
+    }
+  }
+  local_amr_data.ClearCache();
+  yt_free();
+
+  WriteResult(stream, result);
+}
+#endif
+
+int main(int argc, char* argv[]) {
+#ifndef SERIAL_MODE
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &my_size);
+#endif
+
+  BenchmarkOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      options.repeat = std::max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+      options.output = argv[++i];
+    } else if (strcmp(argv[i], "--quick") == 0) {
+      options.quick = true;
+    } else {
+      if (my_rank == 0) {
+        printf("Usage: %s [--repeat N] [--output <file>] [--quick]\n", argv[0]);
+      }
+#ifndef SERIAL_MODE
+      MPI_Finalize();
+#endif
+      return EXIT_FAILURE;
+    }
+  }
+
+  yt_param_libyt param_libyt;
+  param_libyt.verbose = YT_VERBOSE_OFF;
+  param_libyt.script = "benchmark_script";
+  param_libyt.check_data = false;
+  if (yt_initialize(argc, argv, &param_libyt) != YT_SUCCESS) {
+    printf("yt_initialize failed!\n");
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream file;
+  if (my_rank == 0 && !options.output.empty()) {
+    file.open(options.output, std::ios::out | std::ios::trunc);
+  }
+  std::ostream& stream = file.is_open() ? file : std::cout;
+
+  std::vector<long> num_grids_list = {1000, 10000, 100000};
+  std::vector<int> grid_size_list = {8, 16, 32, 64};
+  if (options.quick) {
+    num_grids_list = {100, 1000};
+    grid_size_list = {8, 16};
+  }
+
+  for (long num_grids : num_grids_list) {
+    BenchmarkCommit(stream, options, num_grids);
+  }
+  for (int grid_size : grid_size_list) {
+    BenchmarkDerivedFunc(stream, options, grid_size);
+  }
+#ifndef SERIAL_MODE
+  for (int grid_size : grid_size_list) {
+    BenchmarkRemoteData(stream, options, grid_size);
+  }
+#endif
+
+  if (yt_finalize() != YT_SUCCESS) {
+    printf("yt_finalize failed!\n");
+  }
+
+#ifndef SERIAL_MODE
+  MPI_Finalize();
+#endif
+
+  return 0;
+}
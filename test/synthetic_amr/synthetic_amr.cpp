@@ -0,0 +1,374 @@
+#include "synthetic_amr.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <random>
+
+#include "libyt.h"
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : HashToUnit
+// Description     : Hash grid id, particle index, and axis to [0, 1) by splitmix64, so
+//                   that particle positions are reproducible without storing them.
+//-------------------------------------------------------------------------------------------------------
+static double HashToUnit(long gid, long index, int axis) {
+  uint64_t x = static_cast<uint64_t>(gid) * 0x9E3779B97F4A7C15ULL +
+               static_cast<uint64_t>(index) * 0xBF58476D1CE4E5B9ULL +
+               static_cast<uint64_t>(axis + 1);
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  x = x ^ (x >> 31);
+  return static_cast<double>(x >> 11) / static_cast<double>(1ULL << 53);
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : GetMortonKey
+// Description     : Interleave 21 bits of each normalized coordinate in [0, 1).
+//-------------------------------------------------------------------------------------------------------
+static uint64_t GetMortonKey(const double (&coordinate)[3]) {
+  const uint64_t kMaxIndex = (1ULL << 21) - 1;
+  uint64_t key = 0;
+  uint64_t index[3];
+  for (int d = 0; d < 3; d++) {
+    double scaled = coordinate[d] * (kMaxIndex + 1);
+    index[d] = std::min(kMaxIndex, static_cast<uint64_t>(std::max(0.0, scaled)));
+  }
+  for (int b = 20; b >= 0; b--) {
+    for (int d = 2; d >= 0; d--) {
+      key = (key << 1) | ((index[d] >> b) & 1ULL);
+    }
+  }
+  return key;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : DerivedField
+// Description     : Derived function of "DerivedField", fill in grid level.
+//-------------------------------------------------------------------------------------------------------
+static void DerivedField(const int len, const long* list_gid, const char* /*field_name*/,
+                         yt_array* data_array) {
+  for (int l = 0; l < len; l++) {
+    int level = 0;
+    yt_getGridInfo_Level(list_gid[l], &level);
+    for (long idx = 0; idx < data_array[l].data_length; idx++) {
+      ((double*)data_array[l].data_ptr)[idx] = static_cast<double>(level);
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Helper function : GetParticleAttribute
+// Description     : Fill in particle position uniformly distributed inside the grid.
+//-------------------------------------------------------------------------------------------------------
+static void GetParticleAttribute(const int len, const long* list_gid,
+                                 const char* /*par_type*/, const char* attribute,
+                                 yt_array* data_array) {
+  int axis = attribute[strlen(attribute) - 1] - 'X';
+  for (int l = 0; l < len; l++) {
+    double left_edge[3], right_edge[3];
+    yt_getGridInfo_LeftEdge(list_gid[l], &left_edge);
+    yt_getGridInfo_RightEdge(list_gid[l], &right_edge);
+    for (long i = 0; i < data_array[l].data_length; i++) {
+      ((double*)data_array[l].data_ptr)[i] =
+          left_edge[axis] +
+          (right_edge[axis] - left_edge[axis]) * HashToUnit(list_gid[l], i, axis);
+    }
+  }
+}
+
+SyntheticAmr::SyntheticAmr(const SyntheticAmrConfig& config, int mpi_size, int mpi_rank)
+    : config_(config), mpi_size_(mpi_size), mpi_rank_(mpi_rank) {
+  for (int v = 0; v < config_.num_fields; v++) {
+    field_name_list_.push_back("Field" + std::to_string(v));
+  }
+  if (config_.derived_field) {
+    field_name_list_.push_back("DerivedField");
+  }
+  for (std::size_t s = 0; s < config_.particle_count_list.size(); s++) {
+    par_type_name_list_.push_back("par" + std::to_string(s));
+  }
+
+  GenerateHierarchy();
+  DistributeGrids();
+  GenerateFieldData();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  SyntheticAmr
+// Private Method :  GenerateHierarchy
+//
+// Notes          :  1. Root grids are ordered x-fastest. Grids on each level are refined
+//                      in the order of a shuffle seeded by config, so that every process
+//                      gets the same hierarchy.
+//                   2. Grid id is the index in grid_list_, and children of a parent are
+//                      numbered x-fastest.
+//-------------------------------------------------------------------------------------------------------
+void SyntheticAmr::GenerateHierarchy() {
+  grid_list_.clear();
+  for (int k = 0; k < config_.num_root_grids[2]; k++) {
+    for (int j = 0; j < config_.num_root_grids[1]; j++) {
+      for (int i = 0; i < config_.num_root_grids[0]; i++) {
+        SyntheticGrid grid{static_cast<long>(grid_list_.size()), -1, 0, 0};
+        int index[3] = {i, j, k};
+        for (int d = 0; d < 3; d++) {
+          grid.left_edge[d] = static_cast<double>(index[d]);
+          grid.right_edge[d] = static_cast<double>(index[d] + 1);
+        }
+        grid_list_.push_back(grid);
+      }
+    }
+  }
+
+  std::mt19937 generator(config_.seed);
+  long level_start = 0;
+  for (int level = 1; level < config_.num_levels; level++) {
+    long level_end = static_cast<long>(grid_list_.size());
+    std::vector<long> parent_list(level_end - level_start);
+    std::iota(parent_list.begin(), parent_list.end(), level_start);
+    std::shuffle(parent_list.begin(), parent_list.end(), generator);
+    long num_refined = std::lround(config_.refine_fraction * parent_list.size());
+    parent_list.resize(std::min<long>(num_refined, parent_list.size()));
+    std::sort(parent_list.begin(), parent_list.end());
+
+    int r = config_.refine_by;
+    for (long parent_id : parent_list) {
+      SyntheticGrid parent = grid_list_[parent_id];
+      for (int k = 0; k < r; k++) {
+        for (int j = 0; j < r; j++) {
+          for (int i = 0; i < r; i++) {
+            SyntheticGrid grid{static_cast<long>(grid_list_.size()), parent_id, level, 0};
+            int index[3] = {i, j, k};
+            for (int d = 0; d < 3; d++) {
+              double width = (parent.right_edge[d] - parent.left_edge[d]) / r;
+              grid.left_edge[d] = parent.left_edge[d] + width * index[d];
+              grid.right_edge[d] = grid.left_edge[d] + width;
+            }
+            grid_list_.push_back(grid);
+          }
+        }
+      }
+    }
+    level_start = level_end;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  SyntheticAmr
+// Private Method :  DistributeGrids
+//
+// Notes          :  1. Grids are ordered by the distribution, and split into contiguous
+//                      chunks that differ by at most one grid.
+//                   2. Local grids are sorted by id.
+//-------------------------------------------------------------------------------------------------------
+void SyntheticAmr::DistributeGrids() {
+  long num_grids = GetNumGrids();
+  std::vector<long> order(num_grids);
+  std::iota(order.begin(), order.end(), 0);
+
+  if (config_.distribution == SyntheticAmrDistribution::kDistributionMorton) {
+    std::vector<uint64_t> key_list(num_grids);
+    for (long gid = 0; gid < num_grids; gid++) {
+      double center[3];
+      for (int d = 0; d < 3; d++) {
+        center[d] = 0.5 * (grid_list_[gid].left_edge[d] + grid_list_[gid].right_edge[d]) /
+                    config_.num_root_grids[d];
+      }
+      key_list[gid] = GetMortonKey(center);
+    }
+    std::stable_sort(order.begin(), order.end(), [&key_list](long a, long b) {
+      return key_list[a] < key_list[b];
+    });
+  } else if (config_.distribution == SyntheticAmrDistribution::kDistributionRandom) {
+    std::mt19937 generator(config_.seed + 1);
+    std::shuffle(order.begin(), order.end(), generator);
+  }
+
+  local_id_list_.clear();
+  for (int r = 0; r < mpi_size_; r++) {
+    long start = num_grids * r / mpi_size_;
+    long end = num_grids * (r + 1) / mpi_size_;
+    for (long i = start; i < end; i++) {
+      grid_list_[order[i]].mpi_rank = r;
+      if (r == mpi_rank_) {
+        local_id_list_.push_back(order[i]);
+      }
+    }
+  }
+  std::sort(local_id_list_.begin(), local_id_list_.end());
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class          :  SyntheticAmr
+// Private Method :  GenerateFieldData
+//
+// Notes          :  1. Field v is (v + 1) * exp(-|x - c|^2), where c is the domain
+//                      center, including ghost cells. Data is contiguous in x.
+//-------------------------------------------------------------------------------------------------------
+void SyntheticAmr::GenerateFieldData() {
+  int ghost = config_.num_ghost_cells;
+  int data_size = config_.grid_size + 2 * ghost;
+  double domain_center[3];
+  for (int d = 0; d < 3; d++) {
+    domain_center[d] = 0.5 * config_.num_root_grids[d];
+  }
+
+  field_data_list_.assign(GetNumGridsLocal() * config_.num_fields,
+                          std::vector<double>(GetNumCellsPerGrid()));
+  for (long lid = 0; lid < GetNumGridsLocal(); lid++) {
+    const SyntheticGrid& grid = grid_list_[local_id_list_[lid]];
+    double dx = (grid.right_edge[0] - grid.left_edge[0]) / config_.grid_size;
+    for (int v = 0; v < config_.num_fields; v++) {
+      std::vector<double>& data = field_data_list_[lid * config_.num_fields + v];
+      long idx = 0;
+      for (int k = 0; k < data_size; k++) {
+        for (int j = 0; j < data_size; j++) {
+          for (int i = 0; i < data_size; i++) {
+            int index[3] = {i, j, k};
+            double distance = 0.0;
+            for (int d = 0; d < 3; d++) {
+              double x = grid.left_edge[d] + (index[d] - ghost + 0.5) * dx;
+              distance += (x - domain_center[d]) * (x - domain_center[d]);
+            }
+            data[idx++] = (v + 1) * std::exp(-distance);
+          }
+        }
+      }
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class         :  SyntheticAmr
+// Public Method :  GetNumCellsPerGrid
+// Description   :  Number of cells in the field data of a grid, including ghost cells.
+//-------------------------------------------------------------------------------------------------------
+long SyntheticAmr::GetNumCellsPerGrid() const {
+  long data_size = config_.grid_size + 2 * config_.num_ghost_cells;
+  return data_size * data_size * data_size;
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class         :  SyntheticAmr
+// Public Method :  GetFieldData
+// Description   :  Get field data of the local_index-th local grid, nullptr if out of
+//                  range.
+//-------------------------------------------------------------------------------------------------------
+const double* SyntheticAmr::GetFieldData(long local_index, int field_index) const {
+  if (local_index < 0 || local_index >= GetNumGridsLocal() || field_index < 0 ||
+      field_index >= config_.num_fields) {
+    return nullptr;
+  }
+  return field_data_list_[local_index * config_.num_fields + field_index].data();
+}
+
+//-------------------------------------------------------------------------------------------------------
+// Class         :  SyntheticAmr
+// Public Method :  SetLibytStep
+//
+// Notes         :  1. Call yt_set_Parameters, yt_set_UserParameter*, yt_get_FieldsPtr,
+//                     yt_get_ParticlesPtr, and yt_get_GridsPtr, and fill in the data set.
+//                     Caller calls yt_commit afterwards.
+//                  2. Return YT_SUCCESS or YT_FAIL.
+//-------------------------------------------------------------------------------------------------------
+int SyntheticAmr::SetLibytStep(double current_time) {
+  int num_par_types = static_cast<int>(par_type_name_list_.size());
+  par_type_list_.assign(num_par_types, yt_par_type());
+  for (int s = 0; s < num_par_types; s++) {
+    par_type_list_[s].par_type = par_type_name_list_[s].c_str();
+    par_type_list_[s].num_attr = 3;
+  }
+
+  yt_param_yt param_yt;
+  param_yt.frontend = "gamer";
+  param_yt.fig_basename = "FigName";
+  param_yt.length_unit = 3.0857e21;
+  param_yt.mass_unit = 1.9885e33;
+  param_yt.time_unit = 3.1557e13;
+  param_yt.velocity_unit = param_yt.length_unit / param_yt.time_unit;
+  param_yt.current_time = current_time;
+  param_yt.dimensionality = 3;
+  param_yt.refine_by = config_.refine_by;
+  param_yt.cosmological_simulation = 0;
+  param_yt.num_grids = GetNumGrids();
+  param_yt.num_grids_local = static_cast<int>(GetNumGridsLocal());
+  param_yt.num_fields = static_cast<int>(field_name_list_.size());
+  param_yt.num_par_types = num_par_types;
+  param_yt.par_type_list = par_type_list_.empty() ? nullptr : par_type_list_.data();
+  for (int d = 0; d < 3; d++) {
+    param_yt.domain_dimensions[d] = config_.num_root_grids[d] * config_.grid_size;
+    param_yt.domain_left_edge[d] = 0.0;
+    param_yt.domain_right_edge[d] = static_cast<double>(config_.num_root_grids[d]);
+    param_yt.periodicity[d] = 0;
+  }
+  if (yt_set_Parameters(&param_yt) != YT_SUCCESS) {
+    return YT_FAIL;
+  }
+  const int synthetic = 1;
+  yt_set_UserParameterInt("synthetic", 1, &synthetic);
+
+  if (!field_name_list_.empty()) {
+    yt_field* field_list;
+    yt_get_FieldsPtr(&field_list);
+    for (int v = 0; v < config_.num_fields; v++) {
+      field_list[v].field_name = field_name_list_[v].c_str();
+      field_list[v].field_type = "cell-centered";
+      field_list[v].contiguous_in_x = true;
+      field_list[v].field_dtype = YT_DOUBLE;
+      for (int d = 0; d < 6; d++) {
+        field_list[v].field_ghost_cell[d] = static_cast<short>(config_.num_ghost_cells);
+      }
+    }
+    if (config_.derived_field) {
+      yt_field& derived = field_list[config_.num_fields];
+      derived.field_name = field_name_list_[config_.num_fields].c_str();
+      derived.field_type = "derived_func";
+      derived.contiguous_in_x = true;
+      derived.field_dtype = YT_DOUBLE;
+      derived.derived_func = DerivedField;
+    }
+  }
+
+  static const char* attr_name[] = {"ParPosX", "ParPosY", "ParPosZ"};
+  if (num_par_types > 0) {
+    yt_particle* particle_list;
+    yt_get_ParticlesPtr(&particle_list);
+    for (int s = 0; s < num_par_types; s++) {
+      for (int a = 0; a < 3; a++) {
+        particle_list[s].attr_list[a].attr_name = attr_name[a];
+        particle_list[s].attr_list[a].attr_dtype = YT_DOUBLE;
+      }
+      particle_list[s].coor_x = attr_name[0];
+      particle_list[s].coor_y = attr_name[1];
+      particle_list[s].coor_z = attr_name[2];
+      particle_list[s].get_par_attr = GetParticleAttribute;
+    }
+  }
+
+  if (GetNumGridsLocal() > 0) {
+    yt_grid* grids_local;
+    yt_get_GridsPtr(&grids_local);
+    for (long lid = 0; lid < GetNumGridsLocal(); lid++) {
+      const SyntheticGrid& grid = grid_list_[local_id_list_[lid]];
+      for (int d = 0; d < 3; d++) {
+        grids_local[lid].left_edge[d] = grid.left_edge[d];
+        grids_local[lid].right_edge[d] = grid.right_edge[d];
+        grids_local[lid].grid_dimensions[d] = config_.grid_size;
+      }
+      grids_local[lid].id = grid.id;
+      grids_local[lid].parent_id = grid.parent_id;
+      grids_local[lid].level = grid.level;
+      for (int v = 0; v < config_.num_fields; v++) {
+        grids_local[lid].field_data[v].data_ptr =
+            field_data_list_[lid * config_.num_fields + v].data();
+      }
+      for (int s = 0; s < num_par_types; s++) {
+        grids_local[lid].par_count_list[s] = config_.particle_count_list[s];
+      }
+    }
+  }
+
+  return YT_SUCCESS;
+}
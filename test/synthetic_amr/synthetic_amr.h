@@ -0,0 +1,90 @@
+#ifndef LIBYT_PROJECT_TEST_SYNTHETIC_AMR_SYNTHETIC_AMR_H_
+#define LIBYT_PROJECT_TEST_SYNTHETIC_AMR_SYNTHETIC_AMR_H_
+
+#include <string>
+#include <vector>
+
+#include "yt_type.h"
+
+enum class SyntheticAmrDistribution : int {
+  kDistributionBlock = 0,   ///< Contiguous range of grid id on each rank
+  kDistributionMorton = 1,  ///< Contiguous range along Morton curve of grid center
+  kDistributionRandom = 2   ///< Randomly shuffled, but balanced in count
+};
+
+/**
+ * \struct SyntheticAmrConfig
+ * \brief Configuration of a synthetic AMR workload.
+ * \details
+ * 1. Root level is num_root_grids[0] x num_root_grids[1] x num_root_grids[2] grids.
+ * 2. At each level above root, refine_fraction of the grids on the level below are
+ *    refined, each of them is covered by refine_by^3 child grids.
+ * 3. Every grid has grid_size^3 cells, and num_ghost_cells on each side of the field
+ *    data.
+ * 4. particle_count_list[s] is the number of particles in each grid of species s.
+ */
+struct SyntheticAmrConfig {
+  int num_root_grids[3] = {4, 4, 4};
+  int grid_size = 8;
+  int num_levels = 1;
+  int refine_by = 2;
+  double refine_fraction = 0.125;
+  int num_ghost_cells = 0;
+  int num_fields = 1;
+  bool derived_field = false;
+  std::vector<long> particle_count_list;
+  SyntheticAmrDistribution distribution = SyntheticAmrDistribution::kDistributionMorton;
+  unsigned int seed = 1234;
+};
+
+struct SyntheticGrid {
+  long id = 0;
+  long parent_id = -1;
+  int level = 0;
+  int mpi_rank = 0;
+  double left_edge[3] = {0.0, 0.0, 0.0};
+  double right_edge[3] = {0.0, 0.0, 0.0};
+};
+
+/**
+ * \class SyntheticAmr
+ * \brief Generate a synthetic AMR data set, and set it as one in situ step through
+ *        libyt API.
+ * \details
+ * 1. Every MPI process generates the same hierarchy from the same config, so that no
+ *    communication is needed, and only allocates field data of its own grids.
+ * 2. Cell-centered fields are "Field0", "Field1", ..., filled with a Gaussian of cell
+ *    center. The derived field is "DerivedField", filled with the grid level.
+ * 3. Particle species are "par0", "par1", ..., with attributes "ParPosX", "ParPosY", and
+ *    "ParPosZ", which are uniformly distributed inside the grid and are generated by
+ *    hashing grid id and particle index.
+ */
+class SyntheticAmr {
+ private:
+  SyntheticAmrConfig config_;
+  int mpi_size_;
+  int mpi_rank_;
+  std::vector<SyntheticGrid> grid_list_;
+  std::vector<long> local_id_list_;
+  std::vector<std::vector<double>> field_data_list_;
+  std::vector<std::string> field_name_list_;
+  std::vector<std::string> par_type_name_list_;
+  std::vector<yt_par_type> par_type_list_;
+
+  void GenerateHierarchy();
+  void DistributeGrids();
+  void GenerateFieldData();
+
+ public:
+  SyntheticAmr(const SyntheticAmrConfig& config, int mpi_size, int mpi_rank);
+  long GetNumGrids() const { return static_cast<long>(grid_list_.size()); }
+  long GetNumGridsLocal() const { return static_cast<long>(local_id_list_.size()); }
+  long GetNumCellsPerGrid() const;
+  const std::vector<SyntheticGrid>& GetGridList() const { return grid_list_; }
+  const std::vector<long>& GetLocalIdList() const { return local_id_list_; }
+  const std::vector<std::string>& GetFieldNameList() const { return field_name_list_; }
+  const double* GetFieldData(long local_index, int field_index) const;
+  int SetLibytStep(double current_time);
+};
+
+#endif  // LIBYT_PROJECT_TEST_SYNTHETIC_AMR_SYNTHETIC_AMR_H_
@@ -1,11 +1,24 @@
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
 
 #include "big_mpi.h"
 #include "comm_mpi.h"
 #include "comm_mpi_rma.h"
 #include "data_structure_amr.h"
+#include "libyt.h"
+#include "libyt_process_control.h"
+#include "logging.h"
+#include "memory_spill.h"
+#include "memory_tracker.h"
+#include "node_aggregation.h"
+#include "perf_counter.h"
+#include "trigger.h"
 
 class CommMpiFixture : public testing::Test {
  protected:
@@ -29,6 +42,137 @@ class TestBigMpi : public CommMpiFixture {};
 class TestRma : public CommMpiFixture {};
 class TestUtility : public CommMpiFixture {};
 
+class TestInTransit : public CommMpiFixture {
+ protected:
+  static void DerivedFunc(const int list_len, const long* list_gid,
+                          const char* field_name, yt_array* data_array) {
+    for (int l = 0; l < list_len; l++) {
+      double* data = static_cast<double*>(data_array[l].data_ptr);
+      for (long i = 0; i < data_array[l].data_length; i++) {
+        data[i] = list_gid[l] * 100.0 + i;
+      }
+    }
+  }
+
+  static void GetParAttr(const int list_len, const long* list_gid, const char* par_type,
+                         const char* attribute, yt_array* data_array) {
+    for (int l = 0; l < list_len; l++) {
+      double* data = static_cast<double*>(data_array[l].data_ptr);
+      for (long i = 0; i < data_array[l].data_length; i++) {
+        data[i] = (strcmp(attribute, "PosX") == 0) ? list_gid[l] + 0.25 * (i + 1) : 0.5;
+      }
+    }
+  }
+};
+
+class TestNodeAggregation : public CommMpiFixture {
+ protected:
+  // Get world ranks on the node of this process, the first one is the node leader.
+  static std::vector<int> GetNodeWorldRanks() {
+    int world_rank = 0, node_size = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(
+        MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_size(node_comm, &node_size);
+    std::vector<int> node_world_ranks(node_size);
+    MPI_Allgather(
+        &world_rank, 1, MPI_INT, node_world_ranks.data(), 1, MPI_INT, node_comm);
+    MPI_Comm_free(&node_comm);
+    return node_world_ranks;
+  }
+
+  static void DerivedFunc(const int list_len, const long* list_gid,
+                          const char* field_name, yt_array* data_array) {
+    for (int l = 0; l < list_len; l++) {
+      double* data = static_cast<double*>(data_array[l].data_ptr);
+      for (long i = 0; i < data_array[l].data_length; i++) {
+        data[i] = list_gid[l] * 1000.0 + i;
+      }
+    }
+  }
+
+  static void GetParAttr(const int list_len, const long* list_gid, const char* par_type,
+                         const char* attribute, yt_array* data_array) {
+    for (int l = 0; l < list_len; l++) {
+      long* data = static_cast<long*>(data_array[l].data_ptr);
+      for (long i = 0; i < data_array[l].data_length; i++) {
+        data[i] = list_gid[l] * 20 + i;
+      }
+    }
+  }
+
+  // Set up num_grids_local grids, and fill the first one with data of this process.
+  // Dens has a ghost cell at the beginning of z, Derived is generated, particle
+  // attribute PosX is set and Id is generated.
+  void SetUpLocalGrids(int num_grids_local) {
+    int world_rank = 0, world_size = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    LibytProcessControl& control = LibytProcessControl::Get();
+    DataStructureAmr& ds_amr = control.data_structure_amr_;
+    par_type_list_[0].par_type = "Par";
+    par_type_list_[0].num_attr = 2;
+    control.param_yt_.dimensionality = 3;
+    control.param_yt_.num_grids_local = num_grids_local;
+    control.param_yt_.num_fields = 2;
+    control.param_yt_.num_par_types = 1;
+    control.param_yt_.par_type_list = par_type_list_;
+    ds_amr.AllocateStorage(
+        world_size, num_grids_local, 2, 1, par_type_list_, 0, 3, false);
+
+    yt_field* field_list = ds_amr.GetFieldList();
+    field_list[0].field_name = "Dens";
+    field_list[0].field_dtype = YT_DOUBLE;
+    field_list[0].field_ghost_cell[0] = 1;
+    field_list[1].field_name = "Derived";
+    field_list[1].field_type = "derived_func";
+    field_list[1].field_dtype = YT_DOUBLE;
+    field_list[1].derived_func = DerivedFunc;
+    yt_particle* particle_list = ds_amr.GetParticleList();
+    particle_list[0].attr_list[0].attr_name = "PosX";
+    particle_list[0].attr_list[0].attr_dtype = YT_DOUBLE;
+    particle_list[0].attr_list[1].attr_name = "Id";
+    particle_list[0].attr_list[1].attr_dtype = YT_LONG;
+    particle_list[0].get_par_attr = GetParAttr;
+
+    dens_.resize(5 * 3 * 2);
+    for (std::size_t i = 0; i < dens_.size(); i++) {
+      dens_[i] = world_rank * 100.0 + i;
+    }
+    pos_x_.resize(3);
+    for (std::size_t i = 0; i < pos_x_.size(); i++) {
+      pos_x_[i] = world_rank * 10.0 + i;
+    }
+    yt_grid& grid = ds_amr.GetGridsLocal()[0];
+    grid.id = world_rank;
+    grid.parent_id = -1;
+    grid.level = 0;
+    for (int d = 0; d < 3; d++) {
+      grid.left_edge[d] = world_rank;
+      grid.right_edge[d] = world_rank + 1.0;
+      grid.grid_dimensions[d] = d + 2;
+    }
+    grid.par_count_list[0] = static_cast<long>(pos_x_.size());
+    grid.field_data[0].data_ptr = dens_.data();
+    grid.particle_data[0][0].data_ptr = pos_x_.data();
+  }
+
+  void TearDown() override {
+    node_aggregation::FreeSharedGrids();
+    node_aggregation::Finalize();
+    LibytProcessControl::Get().data_structure_amr_.CleanUp();
+    LibytProcessControl::Get().param_yt_ = yt_param_yt();
+    CommMpi::SetComm(MPI_COMM_WORLD);
+    CommMpi::InitializeInfo(0);
+  }
+
+ private:
+  yt_par_type par_type_list_[1];
+  std::vector<double> dens_;
+  std::vector<double> pos_x_;
+};
+
 TEST_F(TestBigMpi, BigMpiAllgatherv_can_pass_yt_hierarchy) {
   // Arrange
   int mpi_size = CommMpi::mpi_size_;
@@ -682,6 +826,461 @@ TEST_F(TestUtility, GatherAllIntsToRank_can_gather_all_ints_to_dest_rank) {
   }
 }
 
+TEST_F(TestUtility, SetComm_can_run_collectives_on_a_subset_of_ranks) {
+  // Arrange
+  int world_rank = CommMpi::mpi_rank_;
+  MPI_Comm sub_comm;
+  MPI_Comm_split(MPI_COMM_WORLD, world_rank % 2, world_rank, &sub_comm);
+  int sub_size = 0;
+  MPI_Comm_size(sub_comm, &sub_size);
+
+  // Act
+  CommMpi::SetComm(sub_comm);
+  CommMpi::InitializeInfo(0);
+  std::vector<int> all_ints;
+  CommMpi::GatherAllIntsToRank(all_ints, world_rank, 0);
+  int sub_rank = CommMpi::mpi_rank_;
+  int sub_size_in_comm_mpi = CommMpi::mpi_size_;
+  CommMpi::SetComm(MPI_COMM_WORLD);
+  CommMpi::InitializeInfo(0);
+  MPI_Comm_free(&sub_comm);
+
+  // Assert
+  EXPECT_EQ(sub_rank, world_rank / 2);
+  EXPECT_EQ(sub_size_in_comm_mpi, sub_size);
+  if (sub_rank == 0) {
+    EXPECT_EQ(all_ints.size(), sub_size);
+    for (int r = 0; r < sub_size; r++) {
+      EXPECT_EQ(all_ints[r], world_rank % 2 + 2 * r);
+    }
+  } else {
+    EXPECT_EQ(all_ints.size(), 0);
+  }
+}
+
+TEST_F(TestUtility, PerfCounterSummarize_can_reduce_counters_missing_on_some_ranks) {
+  // Arrange
+  perf_counter::Reset();
+  perf_counter::Add("test.rank", static_cast<double>(CommMpi::mpi_rank_));
+  perf_counter::Add("test.rank", static_cast<double>(CommMpi::mpi_rank_));
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_size_ - 1) {
+    perf_counter::Add("test.last_rank_only", 3.0);
+  }
+
+  // Act
+  std::vector<PerfCounterSummary> summary_list = perf_counter::Summarize();
+  perf_counter::Reset();
+
+  // Assert
+  ASSERT_EQ(summary_list.size(), 2);
+  EXPECT_EQ(summary_list[0].name, "test.last_rank_only");
+  EXPECT_DOUBLE_EQ(summary_list[0].min, (CommMpi::mpi_size_ > 1) ? 0.0 : 3.0);
+  EXPECT_DOUBLE_EQ(summary_list[0].max, 3.0);
+  EXPECT_DOUBLE_EQ(summary_list[0].mean, 3.0 / CommMpi::mpi_size_);
+  EXPECT_EQ(summary_list[1].name, "test.rank");
+  EXPECT_DOUBLE_EQ(summary_list[1].min, 0.0);
+  EXPECT_DOUBLE_EQ(summary_list[1].max, 2.0 * (CommMpi::mpi_size_ - 1));
+  EXPECT_DOUBLE_EQ(summary_list[1].mean, CommMpi::mpi_size_ - 1.0);
+  EXPECT_EQ(summary_list[1].max_rank, CommMpi::mpi_size_ - 1);
+}
+
+TEST_F(TestUtility, PerfCounterGetLoadImbalance_can_find_first_slowest_rank) {
+  // Arrange
+  std::vector<double> times = {1.0, 3.0, 2.0, 3.0};
+  std::vector<double> wait_times = {2.0, 0.0, 1.0, 0.5};
+
+  // Act
+  PerfLoadImbalance load_imbalance = perf_counter::GetLoadImbalance(times, wait_times);
+
+  // Assert
+  EXPECT_DOUBLE_EQ(load_imbalance.max, 3.0);
+  EXPECT_DOUBLE_EQ(load_imbalance.mean, 2.25);
+  EXPECT_EQ(load_imbalance.max_rank, 1);
+  EXPECT_DOUBLE_EQ(load_imbalance.wait_max, 2.0);
+}
+
+TEST_F(TestUtility, MemoryTracker_can_track_current_and_peak_bytes_by_category) {
+  // Arrange
+  memory_tracker::ResetPeak();
+  std::size_t hierarchy_bytes =
+      memory_tracker::GetCurrentBytes(MemoryCategory::kMemoryHierarchy);
+  std::size_t rma_bytes = memory_tracker::GetCurrentBytes(MemoryCategory::kMemoryRma);
+
+  // Act
+  long* array = memory_tracker::NewArray<long>(MemoryCategory::kMemoryHierarchy, 100);
+  void* buffer = memory_tracker::Allocate(MemoryCategory::kMemoryRma, 64);
+  std::size_t hierarchy_current =
+      memory_tracker::GetCurrentBytes(MemoryCategory::kMemoryHierarchy);
+  memory_tracker::DeleteArray(array);
+  memory_tracker::Free(buffer);
+
+  // Assert
+  EXPECT_EQ(hierarchy_current, hierarchy_bytes + 100 * sizeof(long));
+  EXPECT_EQ(memory_tracker::GetCurrentBytes(MemoryCategory::kMemoryHierarchy),
+            hierarchy_bytes);
+  EXPECT_EQ(memory_tracker::GetCurrentBytes(MemoryCategory::kMemoryRma), rma_bytes);
+  EXPECT_EQ(memory_tracker::GetPeakBytes(MemoryCategory::kMemoryHierarchy),
+            hierarchy_bytes + 100 * sizeof(long));
+  EXPECT_EQ(memory_tracker::GetPeakBytes(MemoryCategory::kMemoryRma), rma_bytes + 64);
+  EXPECT_GE(memory_tracker::GetTotalPeakBytes(),
+            hierarchy_bytes + rma_bytes + 100 * sizeof(long) + 64);
+}
+
+TEST_F(TestUtility, TimerControlCreateMergedFile_can_merge_events_of_all_ranks) {
+  // Arrange
+  const char* filename = "TestTimerControlMergedFile.json";
+  TimerControl& timer_control = LibytProcessControl::Get().timer_control;
+  timer_control.CreateMergedFile(filename, CommMpi::mpi_rank_, CommMpi::mpi_root_);
+
+  // Act
+  timer_control.WriteProfile("MergedEvent", kTimerGeneral, 10, 20);
+  timer_control.Flush();
+  timer_control.WriteProfile("MergedEvent", kTimerGeneral, 30, 40);
+  timer_control.Flush();
+
+  // Assert
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_root_) {
+    std::ifstream file(filename);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    std::string profile = ss.str();
+    EXPECT_EQ(profile.compare(0, 14, "{\"otherData\": "), 0);
+    EXPECT_EQ(profile.compare(profile.size() - 2, 2, "]}"), 0);
+    for (int r = 0; r < CommMpi::mpi_size_; r++) {
+      std::string event = "{\"name\":\"MergedEvent\",\"cat\":\"general\",\"dur\":10,"
+                          "\"ph\":\"X\",\"pid\":" +
+                          std::to_string(r) + ",";
+      std::size_t first = profile.find(event);
+      EXPECT_NE(first, std::string::npos);
+      EXPECT_NE(profile.find(event, first + 1), std::string::npos);
+    }
+  }
+
+  // Clean up
+  timer_control.CreateFile("", CommMpi::mpi_rank_);
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_root_) {
+    std::remove(filename);
+  }
+}
+
+TEST_F(TestUtility, LoggingFlush_can_merge_identical_messages_of_all_ranks) {
+  // Arrange
+  const char* filename = "TestLoggingFlush.jsonl";
+  yt_verbose verbose = LibytProcessControl::Get().param_libyt_.verbose;
+  LibytProcessControl::Get().param_libyt_.verbose = YT_VERBOSE_WARNING;
+  logging::SetAggregation(true, filename);
+
+  // Act
+  logging::LogWarning("Same \"message\" on every rank.\n");
+  logging::LogWarning("Same \"message\" on every rank.\n");
+  logging::LogWarning("Message on rank %d.\n", CommMpi::mpi_rank_);
+  logging::Flush();
+
+  // Assert
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_root_) {
+    std::ifstream file(filename);
+    std::string line;
+    std::vector<std::string> line_list;
+    while (std::getline(file, line)) {
+      line_list.push_back(line);
+    }
+    ASSERT_EQ(line_list.size(), CommMpi::mpi_size_ + 1);
+    std::string all_ranks =
+        (CommMpi::mpi_size_ > 1) ? "0-" + std::to_string(CommMpi::mpi_size_ - 1) : "0";
+    EXPECT_EQ(line_list[0],
+              "{\"level\": \"YT_WARNING\", \"ranks\": \"" + all_ranks +
+                  "\", \"num_ranks\": " + std::to_string(CommMpi::mpi_size_) +
+                  ", \"count\": " + std::to_string(2 * CommMpi::mpi_size_) +
+                  ", \"message\": \"Same \\\"message\\\" on every rank.\"}");
+    for (int r = 0; r < CommMpi::mpi_size_; r++) {
+      EXPECT_NE(line_list[r + 1].find("\"ranks\": \"" + std::to_string(r) + "\""),
+                std::string::npos);
+      EXPECT_NE(line_list[r + 1].find("Message on rank " + std::to_string(r) + "."),
+                std::string::npos);
+    }
+  }
+
+  // Clean up
+  logging::SetAggregation(false, "");
+  LibytProcessControl::Get().param_libyt_.verbose = verbose;
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_root_) {
+    std::remove(filename);
+  }
+}
+
+TEST_F(TestUtility, LoggingLogError_is_written_right_away_when_aggregated) {
+  // Arrange
+  const char* filename = "TestLoggingError.jsonl";
+  logging::SetAggregation(true, filename);
+
+  // Act
+  testing::internal::CaptureStderr();
+  logging::LogError("Error on every rank.\n");
+  std::string written_before_flush = testing::internal::GetCapturedStderr();
+  logging::Flush();
+
+  // Assert
+  EXPECT_EQ(written_before_flush, "[YT_ERROR  ] Error on every rank.\n");
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_root_) {
+    std::ifstream file(filename);
+    std::string line;
+    ASSERT_TRUE(std::getline(file, line));
+    EXPECT_NE(line.find("\"level\": \"YT_ERROR\""), std::string::npos);
+    EXPECT_NE(line.find("\"num_ranks\": " + std::to_string(CommMpi::mpi_size_)),
+              std::string::npos);
+  }
+
+  // Clean up
+  logging::SetAggregation(false, "");
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_root_) {
+    std::remove(filename);
+  }
+}
+
+TEST_F(TestUtility, TriggerEvaluate_can_fire_every_steps_and_every_time) {
+  // Arrange
+  LibytProcessControl& control = LibytProcessControl::Get();
+  long counter = control.param_libyt_.counter;
+  double current_time = control.param_yt_.current_time;
+  yt_trigger every_steps;
+  every_steps.trigger_type = YT_TRIGGER_EVERY_STEPS;
+  every_steps.every_steps = 2;
+  yt_trigger every_time;
+  every_time.trigger_type = YT_TRIGGER_EVERY_TIME;
+  every_time.every_time = 1.0;
+  ASSERT_EQ(trigger::Set("every_steps", &every_steps), YT_SUCCESS);
+  ASSERT_EQ(trigger::Set("every_time", &every_time), YT_SUCCESS);
+  const int num_steps = 5;
+  const double time_list[num_steps] = {0.0, 0.5, 1.25, 2.0, 2.25};
+  bool every_steps_fired[num_steps], every_time_fired[num_steps];
+  bool no_trigger_fired[num_steps];
+
+  // Act
+  for (int step = 0; step < num_steps; step++) {
+    control.param_libyt_.counter = step;
+    control.param_yt_.current_time = time_list[step];
+    ASSERT_EQ(trigger::Evaluate(), YT_SUCCESS);
+    every_steps_fired[step] = trigger::IsFired("every_steps");
+    every_time_fired[step] = trigger::IsFired("every_time");
+    no_trigger_fired[step] = trigger::IsFired("no_trigger");
+  }
+  control.param_libyt_.counter = num_steps + 1;
+  bool is_fired_without_evaluate = trigger::IsFired("every_steps");
+
+  // Assert
+  // Time 2.0 does not fire, since the last fired time is updated to 1.25
+  const bool expected_fired[num_steps] = {true, false, true, false, true};
+  for (int step = 0; step < num_steps; step++) {
+    EXPECT_EQ(every_steps_fired[step], expected_fired[step]) << "step = " << step;
+    EXPECT_EQ(every_time_fired[step], expected_fired[step]) << "step = " << step;
+    EXPECT_TRUE(no_trigger_fired[step]) << "step = " << step;
+  }
+  EXPECT_FALSE(is_fired_without_evaluate);
+
+  // Clean up
+  trigger::Finalize();
+  control.param_libyt_.counter = counter;
+  control.param_yt_.current_time = current_time;
+}
+
+TEST_F(TestUtility, TriggerEvaluate_can_reduce_field_triggers_on_all_ranks) {
+  // Arrange
+  LibytProcessControl& control = LibytProcessControl::Get();
+  DataStructureAmr& ds_amr = control.data_structure_amr_;
+  int dimensionality = control.param_yt_.dimensionality;
+  int num_grids_local = control.param_yt_.num_grids_local;
+  control.param_yt_.dimensionality = 3;
+  control.param_yt_.num_grids_local = 1;
+  ASSERT_EQ(ds_amr.AllocateStorage(CommMpi::mpi_size_, 1, 3, 0, nullptr, 0, 3, false)
+                .status,
+            DataStructureStatus::kDataStructureSuccess);
+
+  // Dens is [z][y][x] with one ghost cell on each side, ghost cells are +-100,
+  // interior cells are 2, except 1 on the first rank and 10 on the last rank.
+  yt_field* field_list = ds_amr.GetFieldList();
+  field_list[0].field_name = "Dens";
+  field_list[0].field_dtype = YT_DOUBLE;
+  for (int d = 0; d < 6; d++) {
+    field_list[0].field_ghost_cell[d] = 1;
+  }
+  // Temp is [x][y][z] with one ghost cell at the beginning of x, ghost cells are 100,
+  // interior cells are 3.
+  field_list[1].field_name = "Temp";
+  field_list[1].field_dtype = YT_FLOAT;
+  field_list[1].contiguous_in_x = false;
+  field_list[1].field_ghost_cell[0] = 1;
+  field_list[2].field_name = "Derived";
+  field_list[2].field_type = "derived_func";
+  field_list[2].field_dtype = YT_DOUBLE;
+
+  yt_grid& grid = ds_amr.GetGridsLocal()[0];
+  grid.id = CommMpi::mpi_rank_;
+  grid.grid_dimensions[0] = 2;
+  grid.grid_dimensions[1] = 3;
+  grid.grid_dimensions[2] = 4;
+  std::vector<double> dens(6 * 5 * 4);
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 5; j++) {
+      for (int k = 0; k < 4; k++) {
+        int idx = (i * 5 + j) * 4 + k;
+        bool is_ghost = i == 0 || i == 5 || j == 0 || j == 4 || k == 0 || k == 3;
+        dens[idx] = is_ghost ? ((idx % 2 == 0) ? 100.0 : -100.0) : 2.0;
+      }
+    }
+  }
+  if (CommMpi::mpi_rank_ == 0) {
+    dens[(1 * 5 + 1) * 4 + 1] = 1.0;
+  }
+  if (CommMpi::mpi_rank_ == CommMpi::mpi_size_ - 1) {
+    dens[(4 * 5 + 3) * 4 + 2] = 10.0;
+  }
+  std::vector<float> temp(3 * 3 * 4, 3.0f);
+  for (int jk = 0; jk < 3 * 4; jk++) {
+    temp[jk] = 100.0f;
+  }
+  grid.field_data[0].data_ptr = dens.data();
+  grid.field_data[1].data_ptr = temp.data();
+
+  struct {
+    const char* name;
+    yt_trigger_type trigger_type;
+    const char* field_name;
+    double threshold;
+    bool expected_fired;
+  } test_cases[] = {
+      {"max_above", YT_TRIGGER_FIELD_MAX_ABOVE, "Dens", 9.5, true},
+      {"max_not_above", YT_TRIGGER_FIELD_MAX_ABOVE, "Dens", 10.0, false},
+      {"min_below", YT_TRIGGER_FIELD_MIN_BELOW, "Dens", 1.5, true},
+      {"min_not_below", YT_TRIGGER_FIELD_MIN_BELOW, "Dens", 1.0, false},
+      {"temp_above", YT_TRIGGER_FIELD_MAX_ABOVE, "Temp", 2.5, true},
+      {"temp_not_above", YT_TRIGGER_FIELD_MAX_ABOVE, "Temp", 50.0, false},
+      {"unknown_field", YT_TRIGGER_FIELD_MAX_ABOVE, "NotAField", -1.0e30, false},
+      {"derived_field", YT_TRIGGER_FIELD_MAX_ABOVE, "Derived", -1.0e30, false},
+  };
+  for (const auto& test_case : test_cases) {
+    yt_trigger field_trigger;
+    field_trigger.trigger_type = test_case.trigger_type;
+    field_trigger.field_name = test_case.field_name;
+    field_trigger.threshold = test_case.threshold;
+    ASSERT_EQ(trigger::Set(test_case.name, &field_trigger), YT_SUCCESS);
+  }
+
+  // Act
+  int result = trigger::Evaluate();
+
+  // Assert
+  EXPECT_EQ(result, YT_SUCCESS);
+  for (const auto& test_case : test_cases) {
+    EXPECT_EQ(trigger::IsFired(test_case.name), test_case.expected_fired)
+        << "trigger = " << test_case.name;
+  }
+
+  // Clean up
+  trigger::Finalize();
+  ds_amr.CleanUp();
+  control.param_yt_.dimensionality = dimensionality;
+  control.param_yt_.num_grids_local = num_grids_local;
+}
+
+TEST_F(TestNodeAggregation, GatherGrids_can_point_to_grids_shared_by_node_members) {
+  // Arrange
+  std::vector<int> node_world_ranks = GetNodeWorldRanks();
+  ASSERT_EQ(node_aggregation::Split(), YT_SUCCESS);
+  CommMpi::InitializeInfo(0);
+  int num_grids_local = node_aggregation::AggregateNumGridsLocal(1);
+  SetUpLocalGrids(num_grids_local);
+
+  // Act
+  int result = node_aggregation::IsLeader() ? node_aggregation::GatherGrids()
+                                            : node_aggregation::ShareGrids();
+
+  // Assert
+  EXPECT_EQ(result, YT_SUCCESS);
+  if (!node_aggregation::IsLeader()) {
+    return;
+  }
+  ASSERT_EQ(num_grids_local, static_cast<int>(node_world_ranks.size()));
+  const yt_grid* grids_local =
+      LibytProcessControl::Get().data_structure_amr_.GetGridsLocal();
+  for (int g = 0; g < num_grids_local; g++) {
+    const yt_grid& grid = grids_local[g];
+    const long gid = node_world_ranks[g];
+    EXPECT_EQ(grid.id, gid);
+    EXPECT_EQ(grid.parent_id, -1);
+    EXPECT_EQ(grid.level, 0);
+    EXPECT_EQ(grid.proc_num, CommMpi::mpi_rank_);
+    for (int d = 0; d < 3; d++) {
+      EXPECT_EQ(grid.left_edge[d], gid);
+      EXPECT_EQ(grid.right_edge[d], gid + 1.0);
+      EXPECT_EQ(grid.grid_dimensions[d], d + 2);
+    }
+    ASSERT_EQ(grid.par_count_list[0], 3);
+    if (g == 0) {
+      continue;
+    }
+
+    // Data of node members is resolved and points to 8-byte aligned shared memory
+    const yt_data& dens = grid.field_data[0];
+    const yt_data& derived = grid.field_data[1];
+    const int dens_dims[3] = {5, 3, 2}, derived_dims[3] = {4, 3, 2};
+    EXPECT_EQ(dens.data_dtype, YT_DOUBLE);
+    EXPECT_EQ(derived.data_dtype, YT_DOUBLE);
+    for (int d = 0; d < 3; d++) {
+      EXPECT_EQ(dens.data_dimensions[d], dens_dims[d]);
+      EXPECT_EQ(derived.data_dimensions[d], derived_dims[d]);
+    }
+    const void* data_ptr_list[4] = {dens.data_ptr,
+                                    derived.data_ptr,
+                                    grid.particle_data[0][0].data_ptr,
+                                    grid.particle_data[0][1].data_ptr};
+    for (const void* data_ptr : data_ptr_list) {
+      ASSERT_NE(data_ptr, nullptr);
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(data_ptr) % 8, 0u);
+    }
+    for (int i = 0; i < 5 * 3 * 2; i++) {
+      EXPECT_EQ(static_cast<const double*>(dens.data_ptr)[i], gid * 100.0 + i);
+    }
+    for (int i = 0; i < 4 * 3 * 2; i++) {
+      EXPECT_EQ(static_cast<const double*>(derived.data_ptr)[i], gid * 1000.0 + i);
+    }
+    for (int i = 0; i < 3; i++) {
+      EXPECT_EQ(static_cast<const double*>(data_ptr_list[2])[i], gid * 10.0 + i);
+      EXPECT_EQ(static_cast<const long*>(data_ptr_list[3])[i], gid * 20 + i);
+    }
+  }
+}
+
+TEST_F(TestNodeAggregation, GatherGrids_can_report_failure_of_node_members) {
+  // Arrange
+  std::vector<int> node_world_ranks = GetNodeWorldRanks();
+  int world_rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  ASSERT_EQ(node_aggregation::Split(), YT_SUCCESS);
+  CommMpi::InitializeInfo(0);
+  int num_grids_local = node_aggregation::AggregateNumGridsLocal(1);
+  SetUpLocalGrids(num_grids_local);
+
+  // The last process on the node has an attribute of unknown data type
+  bool is_failed_member =
+      node_world_ranks.size() > 1 && world_rank == node_world_ranks.back();
+  if (is_failed_member) {
+    LibytProcessControl::Get().data_structure_amr_.GetParticleList()[0]
+        .attr_list[1]
+        .attr_dtype = YT_DTYPE_UNKNOWN;
+  }
+
+  // Act
+  int result = node_aggregation::IsLeader() ? node_aggregation::GatherGrids()
+                                            : node_aggregation::ShareGrids();
+
+  // Assert
+  if (node_aggregation::IsLeader()) {
+    EXPECT_EQ(result, node_world_ranks.size() > 1 ? YT_FAIL : YT_SUCCESS);
+  } else {
+    EXPECT_EQ(result, is_failed_member ? YT_FAIL : YT_SUCCESS);
+  }
+}
+
 TEST_F(TestRma, CommMpiRma_with_AmrDataArray3D_can_distribute_data) {
   // Arrange
   std::vector<AmrDataArray3D> prepared_data_list;
@@ -724,6 +1323,62 @@ TEST_F(TestRma, CommMpiRma_with_AmrDataArray3D_can_distribute_data) {
   }
 }
 
+TEST_F(TestRma, CommMpiRma_with_AmrDataArrayLabeled_can_distribute_data_with_same_id) {
+  // Arrange
+  std::vector<AmrDataArrayLabeled> prepared_data_list;
+  std::vector<CommMpiRmaQueryInfo> fetch_id_list;
+
+  // Create two labels with the same id equal to mpi rank
+  int* int_buffer = new int[10];
+  double* double_buffer = new double[5];
+  for (int i = 0; i < 10; i++) {
+    int_buffer[i] = CommMpi::mpi_rank_;
+  }
+  for (int i = 0; i < 5; i++) {
+    double_buffer[i] = CommMpi::mpi_rank_ + 0.5;
+  }
+  prepared_data_list.emplace_back(
+      AmrDataArrayLabeled{CommMpi::mpi_rank_, 0, YT_INT, {10, 1, 1}, int_buffer, false});
+  prepared_data_list.emplace_back(AmrDataArrayLabeled{
+      CommMpi::mpi_rank_, 1, YT_DOUBLE, {5, 1, 1}, double_buffer, false});
+
+  // Create fetch id list which gets the other mpi rank's data in both labels
+  for (int r = 0; r < CommMpi::mpi_size_; r++) {
+    if (r != CommMpi::mpi_rank_) {
+      fetch_id_list.emplace_back(CommMpiRmaQueryInfo{r, r, 1});
+      fetch_id_list.emplace_back(CommMpiRmaQueryInfo{r, r, 0});
+    }
+  }
+
+  // Act
+  CommMpiRmaAmrDataArrayLabeled comm_mpi_rma("test", "amr_grid");
+  CommMpiRmaReturn<AmrDataArrayLabeled> result =
+      comm_mpi_rma.GetRemoteData(prepared_data_list, fetch_id_list);
+
+  // Assert
+  EXPECT_EQ(result.status, CommMpiRmaStatus::kMpiSuccess)
+      << "Error: " << comm_mpi_rma.GetErrorStr();
+  EXPECT_EQ(result.data_list.size(), fetch_id_list.size());
+  for (std::size_t i = 0; i < result.data_list.size(); i++) {
+    const AmrDataArrayLabeled& fetched_data = result.data_list[i];
+    EXPECT_EQ(fetched_data.label, fetch_id_list[i].label);
+    if (fetched_data.label == 0) {
+      EXPECT_EQ(fetched_data.data_dim[0], 10);
+      EXPECT_EQ(((int*)fetched_data.data_ptr)[9], fetched_data.id);
+    } else {
+      EXPECT_EQ(fetched_data.data_dim[0], 5);
+      EXPECT_EQ(((double*)fetched_data.data_ptr)[4], fetched_data.id + 0.5);
+    }
+  }
+
+  // Clean up
+  delete[] int_buffer;
+  delete[] double_buffer;
+  for (const AmrDataArrayLabeled& fetched_data : result.data_list) {
+    free(fetched_data.data_ptr);
+  }
+}
+
 TEST_F(TestRma, CommMpiRma_with_AmrDataArray3D_can_handle_nullptr) {
   // Arrange
   std::vector<AmrDataArray3D> prepared_data_list;
@@ -858,6 +1513,100 @@ TEST_F(TestRma, CommMpiRma_with_AmrDataArray3D_can_handle_fetch_id_not_found_err
   }
 }
 
+TEST_F(TestRma, CommMpiRma_with_AmrDataArray3D_can_chunk_and_spill_over_memory_budget) {
+  // Arrange
+  std::vector<AmrDataArray3D> prepared_data_list;
+  std::vector<CommMpiRmaQueryInfo> fetch_id_list;
+
+  // Create two data buffers with array values and id equal to 2 * mpi rank + i
+  int* data_buffer[2];
+  for (int i = 0; i < 2; i++) {
+    data_buffer[i] = new int[10];
+    for (int j = 0; j < 10; j++) {
+      data_buffer[i][j] = 2 * CommMpi::mpi_rank_ + i;
+    }
+    prepared_data_list.emplace_back(AmrDataArray3D{
+        2 * CommMpi::mpi_rank_ + i, YT_INT, {10, 1, 1}, data_buffer[i], false});
+  }
+
+  // Create fetch id list which gets all the other mpi rank's data
+  for (int r = 0; r < CommMpi::mpi_size_; r++) {
+    if (r != CommMpi::mpi_rank_) {
+      fetch_id_list.emplace_back(CommMpiRmaQueryInfo{r, 2 * r});
+      fetch_id_list.emplace_back(CommMpiRmaQueryInfo{r, 2 * r + 1});
+    }
+  }
+
+  // Act
+  // Memory budget only holds one buffer, the rest are spilled.
+  CommMpiRmaAmrDataArray3D comm_mpi_rma("test", "amr_grid");
+  comm_mpi_rma.SetMemoryBudget(10 * sizeof(int), "/tmp");
+  CommMpiRmaReturn<AmrDataArray3D> result =
+      comm_mpi_rma.GetRemoteData(prepared_data_list, fetch_id_list);
+
+  // Assert
+  EXPECT_EQ(result.status, CommMpiRmaStatus::kMpiSuccess)
+      << "Error: " << comm_mpi_rma.GetErrorStr();
+  EXPECT_EQ(result.data_list.size(), fetch_id_list.size());
+  for (std::size_t i = 0; i < result.data_list.size(); i++) {
+    EXPECT_EQ(result.data_list[i].id, fetch_id_list[i].id);
+    EXPECT_EQ(memory_spill::IsSpillBuffer(result.data_list[i].data_ptr), i > 0);
+    for (int j = 0; j < 10; j++) {
+      EXPECT_EQ(((int*)result.data_list[i].data_ptr)[j], result.data_list[i].id);
+    }
+  }
+
+  // Clean up
+  for (int i = 0; i < 2; i++) {
+    delete[] data_buffer[i];
+  }
+  for (const AmrDataArray3D& fetched_data : result.data_list) {
+    if (memory_spill::IsSpillBuffer(fetched_data.data_ptr)) {
+      memory_spill::FreeSpillBuffer(fetched_data.data_ptr);
+    } else {
+      free(fetched_data.data_ptr);
+    }
+  }
+}
+
+TEST_F(TestRma, CommMpiRma_with_AmrDataArray3D_can_handle_exceeding_memory_budget_error) {
+  // Arrange
+  std::vector<AmrDataArray3D> prepared_data_list;
+  std::vector<CommMpiRmaQueryInfo> fetch_id_list;
+
+  // Create data buffer with array values and id equal to mpi rank
+  int* data_buffer = new int[10];
+  for (int i = 0; i < 10; i++) {
+    data_buffer[i] = CommMpi::mpi_rank_;
+  }
+  prepared_data_list.emplace_back(
+      AmrDataArray3D{CommMpi::mpi_rank_, YT_INT, {10, 1, 1}, data_buffer, false});
+
+  // Create fetch id list which gets the other mpi rank's data
+  for (int r = 0; r < CommMpi::mpi_size_; r++) {
+    if (r != CommMpi::mpi_rank_) {
+      fetch_id_list.emplace_back(CommMpiRmaQueryInfo{r, r});
+    }
+  }
+
+  // Act
+  // Memory budget is smaller than a buffer, and there is no spill directory.
+  CommMpiRmaAmrDataArray3D comm_mpi_rma("test", "amr_grid");
+  comm_mpi_rma.SetMemoryBudget(sizeof(int), "");
+  CommMpiRmaReturn<AmrDataArray3D> result =
+      comm_mpi_rma.GetRemoteData(prepared_data_list, fetch_id_list);
+
+  // Assert
+  if (CommMpi::mpi_size_ > 1) {
+    EXPECT_EQ(result.all_status, CommMpiRmaStatus::kMpiFailed);
+    EXPECT_EQ(result.status, CommMpiRmaStatus::kMpiFailed);
+    EXPECT_EQ(result.data_list.size(), 0);
+  }
+
+  // Clean up
+  delete[] data_buffer;
+}
+
 TEST_F(TestRma, CommMpiRma_with_AmrDataArray1D_can_distribute_data) {
   // Arrange
   std::vector<AmrDataArray1D> prepared_data_list;
@@ -899,6 +1648,205 @@ TEST_F(TestRma, CommMpiRma_with_AmrDataArray1D_can_distribute_data) {
   }
 }
 
+// libyt can only be initialized once in a process, so this must be the last test.
+TEST_F(TestInTransit, yt_run_InTransit_can_commit_and_run_functions_on_analysis_rank) {
+  // Arrange
+  int world_rank = 0, world_size = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+  if (world_size < 2) {
+    GTEST_SKIP() << "In-transit mode needs at least 2 processes.";
+  }
+  const char* script_name = "TestInTransitScript";
+  const char* output_filename = "TestInTransit.txt";
+  const bool is_analysis_rank = (world_rank == world_size - 1);
+  if (is_analysis_rank) {
+    std::ofstream script(std::string(script_name) + ".py");
+    script << "import libyt\n"
+              "import numpy as np\n"
+              "\n"
+              "def check_in_transit(filename, scale=1, weights=None):\n"
+              "    h = libyt.hierarchy\n"
+              "    lines = ['num_grids %d' % len(h['grid_levels'])]\n"
+              "    proc_num = sorted(set(h['proc_num'].flatten().tolist()))\n"
+              "    lines.append('proc_num %s' % proc_num)\n"
+              "    for gid in sorted(libyt.grid_data):\n"
+              "        dens = libyt.grid_data[gid]['Dens']\n"
+              "        derived = libyt.grid_data[gid]['Derived']\n"
+              "        pos_x = libyt.particle_data[gid]['Par']['PosX']\n"
+              "        values = (gid, int(np.sum(dens)) * scale, int(np.sum(derived)),\n"
+              "                  len(pos_x), np.sum(pos_x))\n"
+              "        lines.append('grid %d %d %d %d %.2f' % values)\n"
+              "    lines.append('weights %.2f' % np.sum(weights))\n"
+              "    p = libyt.param_user\n"
+              "    lines.append('user_int %d' % int(p['user_int']))\n"
+              "    lines.append('user_int3 %s' % [int(x) for x in p['user_int3']])\n"
+              "    lines.append('user_double %.2f' % float(p['user_double']))\n"
+              "    lines.append('user_string %s' % p['user_string'])\n"
+              "    with open(filename, 'w') as f:\n"
+              "        f.write('\\n'.join(lines) + '\\n')\n";
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  yt_param_libyt param_libyt;
+  param_libyt.verbose = YT_VERBOSE_WARNING;
+  param_libyt.script = script_name;
+  param_libyt.in_transit_ranks = 1;
+  ASSERT_EQ(yt_initialize(0, nullptr, &param_libyt), YT_SUCCESS);
+  bool is_analysis = false;
+  yt_get_InTransitRole(&is_analysis);
+  ASSERT_EQ(is_analysis, is_analysis_rank);
+
+  // Each simulation process has 2 grids along x with 2^3 cells and 3 particles
+  const int num_simulation_ranks = world_size - 1;
+  const int num_grids_local = 2;
+  const long num_grids = num_grids_local * num_simulation_ranks;
+  std::vector<double> dens(num_grids_local * 8);
+
+  // Act
+  int result = YT_SUCCESS;
+  if (is_analysis) {
+    result = yt_run_InTransit();
+  } else {
+    yt_param_yt param_yt;
+    yt_par_type par_type_list[1];
+    par_type_list[0].par_type = "Par";
+    par_type_list[0].num_attr = 3;
+    param_yt.frontend = "gamer";
+    param_yt.fig_basename = "FigName";
+    param_yt.length_unit = 1.0;
+    param_yt.mass_unit = 1.0;
+    param_yt.time_unit = 1.0;
+    param_yt.velocity_unit = 1.0;
+    param_yt.current_time = 0.0;
+    param_yt.current_redshift = 0.0;
+    param_yt.omega_lambda = 0.7;
+    param_yt.omega_matter = 0.3;
+    param_yt.hubble_constant = 0.7;
+    param_yt.cosmological_simulation = 0;
+    param_yt.dimensionality = 3;
+    param_yt.refine_by = 2;
+    param_yt.num_grids = num_grids;
+    param_yt.num_grids_local = num_grids_local;
+    param_yt.num_fields = 2;
+    param_yt.num_par_types = 1;
+    param_yt.par_type_list = par_type_list;
+    for (int d = 0; d < 3; d++) {
+      param_yt.domain_dimensions[d] = (d == 0) ? 2 * num_grids : 2;
+      param_yt.domain_left_edge[d] = 0.0;
+      param_yt.domain_right_edge[d] = (d == 0) ? num_grids : 1.0;
+      param_yt.periodicity[d] = 0;
+    }
+    ASSERT_EQ(yt_set_Parameters(&param_yt), YT_SUCCESS);
+    int user_int = 7;
+    int user_int3[3] = {1, 2, 3};
+    double user_double = 0.5;
+    yt_set_UserParameterInt("user_int", 1, &user_int);
+    yt_set_UserParameterInt("user_int3", 3, user_int3);
+    yt_set_UserParameterDouble("user_double", 1, &user_double);
+    yt_set_UserParameterString("user_string", "libyt");
+
+    yt_field* field_list = nullptr;
+    yt_get_FieldsPtr(&field_list);
+    field_list[0].field_name = "Dens";
+    field_list[0].field_type = "cell-centered";
+    field_list[0].field_dtype = YT_DOUBLE;
+    field_list[1].field_name = "Derived";
+    field_list[1].field_type = "derived_func";
+    field_list[1].field_dtype = YT_DOUBLE;
+    field_list[1].derived_func = DerivedFunc;
+
+    const char* attr_name[3] = {"PosX", "PosY", "PosZ"};
+    yt_particle* particle_list = nullptr;
+    yt_get_ParticlesPtr(&particle_list);
+    for (int a = 0; a < 3; a++) {
+      particle_list[0].attr_list[a].attr_name = attr_name[a];
+      particle_list[0].attr_list[a].attr_dtype = YT_DOUBLE;
+    }
+    particle_list[0].coor_x = attr_name[0];
+    particle_list[0].coor_y = attr_name[1];
+    particle_list[0].coor_z = attr_name[2];
+    particle_list[0].get_par_attr = GetParAttr;
+
+    yt_grid* grids_local = nullptr;
+    yt_get_GridsPtr(&grids_local);
+    for (int g = 0; g < num_grids_local; g++) {
+      long gid = world_rank * num_grids_local + g;
+      grids_local[g].id = gid;
+      grids_local[g].parent_id = -1;
+      grids_local[g].level = 0;
+      for (int d = 0; d < 3; d++) {
+        grids_local[g].left_edge[d] = (d == 0) ? gid : 0.0;
+        grids_local[g].right_edge[d] = (d == 0) ? gid + 1.0 : 1.0;
+        grids_local[g].grid_dimensions[d] = 2;
+      }
+      grids_local[g].par_count_list[0] = 3;
+      for (int i = 0; i < 8; i++) {
+        dens[g * 8 + i] = gid * 10.0 + i;
+      }
+      grids_local[g].field_data[0].data_ptr = &dens[g * 8];
+    }
+    EXPECT_EQ(yt_commit(), YT_SUCCESS);
+
+    int scale = 2;
+    double weights[2] = {1.5, 2.5};
+    yt_arg args[3];
+    args[0].arg_type = YT_ARG_STRING;
+    args[0].data_ptr = output_filename;
+    args[1].keyword = "scale";
+    args[1].data_ptr = &scale;
+    args[1].data_dtype = YT_INT;
+    args[2].arg_type = YT_ARG_ARRAY;
+    args[2].keyword = "weights";
+    args[2].data_ptr = weights;
+    args[2].data_dtype = YT_DOUBLE;
+    args[2].data_dimensions[0] = 2;
+    result = yt_run_FunctionWithArgs("check_in_transit", args, 3);
+    scale = 0;  // values are sent when the function is called
+    yt_free();
+  }
+  yt_finalize();
+
+  // Assert
+  EXPECT_EQ(result, YT_SUCCESS);
+  if (is_analysis_rank) {
+    std::vector<std::string> expected_lines;
+    expected_lines.push_back("num_grids " + std::to_string(num_grids));
+    expected_lines.push_back("proc_num [0]");
+    for (long gid = 0; gid < num_grids; gid++) {
+      char line[100];
+      snprintf(line,
+               sizeof(line),
+               "grid %ld %ld %ld 3 %.2f",
+               gid,
+               (80 * gid + 28) * 2,
+               800 * gid + 28,
+               3 * gid + 1.5);
+      expected_lines.push_back(line);
+    }
+    expected_lines.push_back("weights 4.00");
+    expected_lines.push_back("user_int 7");
+    expected_lines.push_back("user_int3 [1, 2, 3]");
+    expected_lines.push_back("user_double 0.50");
+    expected_lines.push_back("user_string libyt");
+
+    std::ifstream file(output_filename);
+    std::vector<std::string> line_list;
+    std::string line;
+    while (std::getline(file, line)) {
+      line_list.push_back(line);
+    }
+    EXPECT_EQ(line_list, expected_lines);
+  }
+
+  // Clean up
+  if (is_analysis_rank) {
+    std::remove(output_filename);
+    std::remove((std::string(script_name) + ".py").c_str());
+  }
+  CommMpi::InitializeInfo(0);
+}
+
 int main(int argc, char* argv[]) {
   int result = 0;
 
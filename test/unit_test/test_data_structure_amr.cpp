@@ -5,7 +5,10 @@
 #include <Python.h>
 
 #include "data_structure_amr.h"
+#include "deferred_binding.h"
+#include "libyt_process_control.h"
 #include "numpy_controller.h"
+#include "trigger.h"
 
 class PythonFixture : public testing::Test {
  private:
@@ -132,6 +135,7 @@ class TestDataStructureAmrBindLocalData :
 class TestDataStructureAmrGenerateLocalData :
     public PythonFixture,
     public testing::WithParamInterface<int> {};
+class TestDeferredBinding : public PythonFixture {};
 
 TEST_F(TestDataStructureAmrBindFieldParticleInfo, Can_bind_field_info_to_Python) {
   // Arrange
@@ -351,6 +355,25 @@ TEST_P(TestDataStructureAmrBindHierarchy,
     }
   }
 
+  // Assert it can look up particle count of a list of grids at once
+  std::vector<long> gid_list;
+  for (long gid = index_offset; gid < num_grids + index_offset; gid++) {
+    gid_list.emplace_back(gid);
+  }
+  for (int p = 0; p < num_par_types; p++) {
+    std::vector<long> par_count_list;
+    status = ds_amr.GetPythonBoundFullHierarchyGridParticleCount(
+        gid_list, ds_amr.GetParticleIndex(par_type_list[p].par_type), par_count_list);
+    EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess) << status.error;
+    ASSERT_EQ(par_count_list.size(), gid_list.size());
+    for (std::size_t i = 0; i < gid_list.size(); i++) {
+      long par_count = -2;
+      ds_amr.GetPythonBoundFullHierarchyGridParticleCount(
+          gid_list[i], par_type_list[p].par_type, &par_count);
+      EXPECT_EQ(par_count_list[i], par_count);
+    }
+  }
+
   // Clean up
   ds_amr.CleanUp();
 }
@@ -530,6 +553,245 @@ TEST_P(TestDataStructureAmrBindLocalData, Can_bind_local_particle_data_to_Python
   }
 }
 
+TEST_P(TestDataStructureAmrBindLocalData, Can_look_up_local_data_by_index) {
+  // Arrange
+  DataStructureAmr ds_amr;
+  ds_amr.SetPythonBindings(GetPyHierarchy(), GetPyGridData(), GetPyParticleData());
+
+  int index_offset = GetParam();
+  bool check_data = false;
+  int num_grids_local = 2;
+  long num_grids = num_grids_local * GetMpiSize();
+  int num_fields = 2;
+  int num_par_types = 2;
+  yt_par_type par_type_list[2];
+  par_type_list[0].par_type = "Par1";
+  par_type_list[1].par_type = "Par2";
+  par_type_list[0].num_attr = 3;
+  par_type_list[1].num_attr = 3;
+  ds_amr.AllocateStorage(num_grids,
+                         num_grids_local,
+                         num_fields,
+                         num_par_types,
+                         par_type_list,
+                         index_offset,
+                         3,
+                         check_data);
+  GenerateLocalHierarchy(
+      num_grids, index_offset, ds_amr.GetGridsLocal(), num_grids_local, num_par_types);
+
+  yt_field* field_list = ds_amr.GetFieldList();
+  field_list[0].field_name = "Field1";
+  field_list[0].field_dtype = YT_DOUBLE;
+  field_list[1].field_name = "Field2";
+  field_list[1].field_dtype = YT_DOUBLE;
+  yt_particle* particle_list = ds_amr.GetParticleList();
+  const char* attr_name_list[3] = {"PosX", "PosY", "PosZ"};
+  for (int p = 0; p < num_par_types; p++) {
+    for (int a = 0; a < particle_list[p].num_attr; a++) {
+      particle_list[p].attr_list[a].attr_name = attr_name_list[a];
+      particle_list[p].attr_list[a].attr_dtype = YT_DOUBLE;
+    }
+    particle_list[p].coor_x = "PosX";
+    particle_list[p].coor_y = "PosY";
+    particle_list[p].coor_z = "PosZ";
+  }
+
+  yt_grid* grids_local = ds_amr.GetGridsLocal();
+  long field_length = grids_local[0].grid_dimensions[0] *
+                      grids_local[0].grid_dimensions[1] *
+                      grids_local[0].grid_dimensions[2];
+  long par_length = grids_local[0].par_count_list[0];
+  double* field_data = new double[field_length];
+  double* par_data = new double[par_length];
+  for (int lid = 0; lid < num_grids_local; lid++) {
+    for (int v = 0; v < num_fields; v++) {
+      grids_local[lid].field_data[v].data_ptr = field_data;
+    }
+    for (int p = 0; p < num_par_types; p++) {
+      for (int a = 0; a < particle_list[p].num_attr; a++) {
+        grids_local[lid].particle_data[p][a].data_ptr = par_data;
+      }
+    }
+  }
+
+  // Act
+  DataStructureOutput status =
+      ds_amr.BindInfoToPython("sys.TEMPLATE_DICT_STORAGE", GetPyTemplateDictStorage());
+  EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess) << status.error;
+  status = ds_amr.BindLocalDataToPython();
+  EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess) << status.error;
+
+  // Assert
+  EXPECT_EQ(ds_amr.GetFieldIndex("Field2"), 1);
+  EXPECT_EQ(ds_amr.GetFieldIndex("NotAField"), -1);
+  EXPECT_EQ(ds_amr.GetParticleIndex("Par2"), 1);
+  EXPECT_EQ(ds_amr.GetParticleIndex("NotAParticle"), -1);
+  EXPECT_EQ(ds_amr.GetParticleAttributeIndex(1, "PosZ"), 2);
+  EXPECT_EQ(ds_amr.GetParticleAttributeIndex(1, "NotAnAttr"), -1);
+
+  yt_data query_data;
+  for (int i = 0; i < num_grids_local; i++) {
+    long gid = num_grids_local * GetMpiRank() + i + index_offset;
+    for (int v = 0; v < num_fields; v++) {
+      status = ds_amr.GetPythonBoundLocalFieldDataByIndex(gid, v, &query_data);
+      EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess)
+          << status.error;
+      EXPECT_EQ(query_data.data_ptr, field_data);
+    }
+    for (int p = 0; p < num_par_types; p++) {
+      for (int a = 0; a < particle_list[p].num_attr; a++) {
+        status = ds_amr.GetPythonBoundLocalParticleDataByIndex(gid, p, a, &query_data);
+        EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess)
+            << status.error;
+        EXPECT_EQ(query_data.data_ptr, par_data);
+        EXPECT_EQ(query_data.data_dimensions[0], par_length);
+      }
+    }
+    status = ds_amr.GetPythonBoundLocalFieldDataByIndex(gid, num_fields, &query_data);
+    EXPECT_EQ(status.status, DataStructureStatus::kDataStructureFailed);
+    status = ds_amr.GetPythonBoundLocalParticleDataByIndex(gid, 0, 3, &query_data);
+    EXPECT_EQ(status.status, DataStructureStatus::kDataStructureFailed);
+  }
+
+  // Clean up
+  ds_amr.CleanUp();
+  delete[] field_data;
+  delete[] par_data;
+}
+
+TEST_P(TestDataStructureAmrBindLocalData, Can_look_up_local_data_without_Python) {
+  // Arrange
+  DataStructureAmr ds_amr;
+
+  int index_offset = GetParam();
+  bool check_data = false;
+  int num_grids_local = 2;
+  long num_grids = num_grids_local * GetMpiSize();
+  int num_fields = 1;
+  int num_par_types = 1;
+  yt_par_type par_type_list[1];
+  par_type_list[0].par_type = "Par1";
+  par_type_list[0].num_attr = 1;
+  ds_amr.AllocateStorage(num_grids,
+                         num_grids_local,
+                         num_fields,
+                         num_par_types,
+                         par_type_list,
+                         index_offset,
+                         3,
+                         check_data);
+  GenerateLocalHierarchy(
+      num_grids, index_offset, ds_amr.GetGridsLocal(), num_grids_local, num_par_types);
+
+  yt_field* field_list = ds_amr.GetFieldList();
+  field_list[0].field_name = "Field1";
+  field_list[0].field_dtype = YT_DOUBLE;
+  yt_particle* particle_list = ds_amr.GetParticleList();
+  particle_list[0].attr_list[0].attr_name = "PosX";
+  particle_list[0].attr_list[0].attr_dtype = YT_DOUBLE;
+
+  yt_grid* grids_local = ds_amr.GetGridsLocal();
+  long par_length = grids_local[0].par_count_list[0];
+  double* field_data = new double[1];
+  double* par_data = new double[par_length];
+  for (int lid = 0; lid < num_grids_local; lid++) {
+    grids_local[lid].field_data[0].data_ptr = field_data;
+    grids_local[lid].particle_data[0][0].data_ptr = par_data;
+  }
+
+  // Act
+  DataStructureOutput status = ds_amr.BindLocalHierarchy();
+  EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess) << status.error;
+
+  // Assert
+  yt_data query_data;
+  int dimensions[3];
+  for (int i = 0; i < num_grids_local; i++) {
+    long gid = num_grids_local * GetMpiRank() + i + index_offset;
+    status = ds_amr.GetPythonBoundFullHierarchyGridDimensions(gid, dimensions);
+    EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess)
+        << status.error;
+    for (int d = 0; d < 3; d++) {
+      EXPECT_EQ(dimensions[d], grids_local[i].grid_dimensions[d]);
+    }
+    status = ds_amr.GetPythonBoundLocalFieldDataByIndex(gid, 0, &query_data);
+    EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess)
+        << status.error;
+    EXPECT_EQ(query_data.data_ptr, field_data);
+    status = ds_amr.GetPythonBoundLocalParticleDataByIndex(gid, 0, 0, &query_data);
+    EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess)
+        << status.error;
+    EXPECT_EQ(query_data.data_ptr, par_data);
+    EXPECT_EQ(query_data.data_dimensions[0], par_length);
+  }
+  long gid_not_local = (GetMpiRank() == 0) ? num_grids + index_offset : index_offset;
+  status = ds_amr.GetPythonBoundLocalFieldDataByIndex(gid_not_local, 0, &query_data);
+  EXPECT_EQ(status.status, DataStructureStatus::kDataStructureFailed);
+
+  // Clean up
+  ds_amr.CleanUp();
+  delete[] field_data;
+  delete[] par_data;
+}
+
+TEST_P(TestDataStructureAmrBindLocalData, Can_check_local_data_without_Python) {
+  // Arrange
+  DataStructureAmr ds_amr;
+
+  int index_offset = GetParam();
+  bool check_data = true;
+  int num_grids_local = 2;
+  long num_grids = num_grids_local * GetMpiSize();
+  int num_fields = 1;
+  int num_par_types = 1;
+  yt_par_type par_type_list[1];
+  par_type_list[0].par_type = "Par1";
+  par_type_list[0].num_attr = 1;
+  ds_amr.AllocateStorage(num_grids,
+                         num_grids_local,
+                         num_fields,
+                         num_par_types,
+                         par_type_list,
+                         index_offset,
+                         3,
+                         check_data);
+  GenerateLocalHierarchy(
+      num_grids, index_offset, ds_amr.GetGridsLocal(), num_grids_local, num_par_types);
+
+  yt_field* field_list = ds_amr.GetFieldList();
+  field_list[0].field_name = "Field1";
+  field_list[0].field_dtype = YT_DOUBLE;
+  yt_particle* particle_list = ds_amr.GetParticleList();
+  particle_list[0].attr_list[0].attr_name = "PosX";
+  particle_list[0].attr_list[0].attr_dtype = YT_DOUBLE;
+  particle_list[0].coor_x = "PosX";
+  particle_list[0].coor_y = "PosX";
+  particle_list[0].coor_z = "PosX";
+
+  yt_grid* grids_local = ds_amr.GetGridsLocal();
+  std::vector<double> field_data(grids_local[0].grid_dimensions[0] *
+                                 grids_local[0].grid_dimensions[1] *
+                                 grids_local[0].grid_dimensions[2]);
+  for (int lid = 0; lid < num_grids_local; lid++) {
+    grids_local[lid].field_data[0].data_ptr = field_data.data();
+  }
+
+  // Act
+  DataStructureOutput status_without_get_par_attr = ds_amr.CheckLocalData();
+  particle_list[0].get_par_attr = [](const int, const long*, const char*, const char*,
+                                     yt_array*) {};
+  DataStructureOutput status = ds_amr.CheckLocalData();
+
+  // Assert
+  EXPECT_EQ(status_without_get_par_attr.status,
+            DataStructureStatus::kDataStructureFailed);
+  EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess) << status.error;
+
+  // Clean up
+  ds_amr.CleanUp();
+}
+
 TEST_P(TestDataStructureAmrGenerateLocalData, Can_generate_derived_field_data_3d) {
   // Arrange
   DataStructureAmr ds_amr;
@@ -783,6 +1045,92 @@ TEST_P(TestDataStructureAmrGenerateLocalData, Can_generate_particle_data) {
   }
 }
 
+TEST_F(TestDeferredBinding, Can_defer_binding_until_a_function_runs) {
+  // Arrange
+  LibytProcessControl& control = LibytProcessControl::Get();
+  DataStructureAmr& ds_amr = control.data_structure_amr_;
+  ds_amr.SetPythonBindings(GetPyHierarchy(), GetPyGridData(), GetPyParticleData());
+  long counter = control.param_libyt_.counter;
+
+  int num_grids_local = 2;
+  long num_grids = num_grids_local * GetMpiSize();
+  ds_amr.AllocateStorage(num_grids, num_grids_local, 1, 0, nullptr, 0, 3, false);
+  GenerateLocalHierarchy(num_grids, 0, ds_amr.GetGridsLocal(), num_grids_local, 0);
+  yt_field* field_list = ds_amr.GetFieldList();
+  field_list[0].field_name = "Field1";
+  field_list[0].field_dtype = YT_DOUBLE;
+  field_list[0].contiguous_in_x = false;
+  yt_grid* grids_local = ds_amr.GetGridsLocal();
+  long length = grids_local[0].grid_dimensions[0] * grids_local[0].grid_dimensions[1] *
+                grids_local[0].grid_dimensions[2];
+  std::vector<double> field1_data(length, 1.0);
+  for (int lid = 0; lid < num_grids_local; lid++) {
+    grids_local[lid].field_data[0].data_ptr = field1_data.data();
+  }
+
+  yt_trigger every_two_steps;
+  every_two_steps.trigger_type = YT_TRIGGER_EVERY_STEPS;
+  every_two_steps.every_steps = 2;
+  trigger::Set("func", &every_two_steps);
+
+  // Act
+  // Step 1 always binds, since there is no previous step to predict from
+  control.param_libyt_.counter = 1;
+  trigger::Evaluate();
+  bool will_run_in_first_step = deferred_binding::WillAnyFunctionRun();
+  deferred_binding::RecordCall("func");
+  deferred_binding::EndStep();
+
+  // Step 3: func is called in the previous step, but its trigger does not fire
+  control.param_libyt_.counter = 3;
+  trigger::Evaluate();
+  bool will_run_in_second_step = deferred_binding::WillAnyFunctionRun();
+  deferred_binding::Defer();
+  bool is_deferred = deferred_binding::IsDeferred();
+  bool has_grids_local_when_deferred = ds_amr.GetGridsLocal() != nullptr;
+
+  // A new function runs in the same step, and binds the deferred data
+  deferred_binding::RecordCall("new_func");
+  int ensure_bound_result = deferred_binding::EnsureBound();
+  bool is_deferred_after_bound = deferred_binding::IsDeferred();
+  bool has_grids_local_after_bound = ds_amr.GetGridsLocal() != nullptr;
+  deferred_binding::RecordCall("func");
+  deferred_binding::EndStep();
+
+  // Step 5: func still does not fire, but new_func has no trigger
+  control.param_libyt_.counter = 5;
+  trigger::Evaluate();
+  bool will_run_in_third_step = deferred_binding::WillAnyFunctionRun();
+
+  // Assert
+  EXPECT_TRUE(will_run_in_first_step);
+  EXPECT_FALSE(will_run_in_second_step);
+  EXPECT_TRUE(is_deferred);
+  EXPECT_TRUE(has_grids_local_when_deferred);
+  EXPECT_EQ(ensure_bound_result, YT_SUCCESS);
+  EXPECT_FALSE(is_deferred_after_bound);
+  EXPECT_FALSE(has_grids_local_after_bound);
+  EXPECT_TRUE(will_run_in_third_step);
+  for (int i = 0; i < num_grids_local; i++) {
+    long gid = num_grids_local * GetMpiRank() + i;
+    int dimensions[3];
+    DataStructureOutput status =
+        ds_amr.GetPythonBoundFullHierarchyGridDimensions(gid, dimensions);
+    EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess) << status.error;
+    EXPECT_EQ(dimensions[0], 10);
+    yt_data query_data;
+    status = ds_amr.GetPythonBoundLocalFieldData(gid, "Field1", &query_data);
+    EXPECT_EQ(status.status, DataStructureStatus::kDataStructureSuccess) << status.error;
+    EXPECT_EQ(query_data.data_ptr, field1_data.data());
+  }
+
+  // Clean up
+  deferred_binding::Finalize();
+  trigger::Finalize();
+  ds_amr.CleanUp();
+  control.param_libyt_.counter = counter;
+}
+
 INSTANTIATE_TEST_SUITE_P(DifferentIndexOffset, TestDataStructureAmrBindHierarchy,
                          testing::Values(0, 1));
 INSTANTIATE_TEST_SUITE_P(DifferentIndexOffset, TestDataStructureAmrBindLocalData,
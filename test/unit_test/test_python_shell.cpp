@@ -4,7 +4,13 @@
 #endif
 #include <fstream>
 
+#include "async_analysis.h"
+#include "inline_function.h"
+#include "libyt.h"
+#include "libyt_process_control.h"
 #include "libyt_python_shell.h"
+#include "numpy_controller.h"
+#include "python_profiler.h"
 
 class PythonFixture : public testing::Test {
  private:
@@ -32,6 +38,7 @@ class PythonFixture : public testing::Test {
               << std::endl;
     LibytPythonShell::SetExecutionNamespace(GetScriptPyNamespace(script_));
     LibytPythonShell::SetFunctionBodyDict(CreateTemplateDictStorage());
+    LibytProcessControl::Get().param_libyt_.script = script_.c_str();
   }
 
   void TearDown() override { PyRun_SimpleString("del sys"); }
@@ -498,6 +505,268 @@ TEST_F(TestPythonExecution, AllExecuteCell_can_execute_a_valid_arbitrary_code) {
   }
 }
 
+TEST_F(TestPythonExecution, PythonProfiler_can_sample_stacks_of_executed_cell) {
+  // Arrange
+  const char* filename = "TestPythonProfiler.folded";
+  int src_mpi_rank = 0;
+  int output_mpi_rank = 0;
+  std::string src_code = "import time\n"
+                         "def busy_loop():\n"
+                         "    end = time.perf_counter() + 0.2\n"
+                         "    while time.perf_counter() < end:\n"
+                         "        pass\n"
+                         "busy_loop()\n";
+  ASSERT_TRUE(python_profiler::Enable(filename));
+
+  // Act
+  std::vector<PythonOutput> output;
+  if (GetMpiRank() == src_mpi_rank) {
+    python_shell_.AllExecuteCell(
+        src_code, "<test-profile>", src_mpi_rank, output, output_mpi_rank);
+  } else {
+    python_shell_.AllExecuteCell("", "", src_mpi_rank, output, output_mpi_rank);
+  }
+  int result = python_profiler::Flush();
+
+  // Assert
+  EXPECT_EQ(result, 0);
+  if (GetMpiRank() == 0) {
+    std::ifstream file(filename);
+    std::string line;
+    long num_samples = 0;
+    while (std::getline(file, line)) {
+      if (line.compare(0, 15, "<test-profile>;") == 0 &&
+          line.find(";busy_loop (") != std::string::npos) {
+        num_samples += std::stol(line.substr(line.rfind(' ') + 1));
+      }
+    }
+    EXPECT_GT(num_samples, 0);
+    std::remove(filename);
+  }
+}
+
+TEST_F(TestPythonExecution, AsyncAnalysis_can_run_jobs_in_order_on_analysis_thread) {
+  // Arrange
+  PyRun_SimpleString("import threading, inline_script\n"
+                     "async_test_idents = []\n"
+                     "main_ident = threading.get_ident()\n"
+                     "def job0():\n"
+                     "    async_test_idents.append((0, threading.get_ident()))\n"
+                     "def job1():\n"
+                     "    raise ValueError('job1 failed on purpose')\n"
+                     "def job2():\n"
+                     "    async_test_idents.append((2, threading.get_ident()))\n"
+                     "inline_script.job0 = job0\n"
+                     "inline_script.job1 = job1\n"
+                     "inline_script.job2 = job2\n");
+  std::vector<AsyncAnalysisJob> job_list(3);
+  job_list[0].function_name = "job0";
+  job_list[1].function_name = "job1";
+  job_list[2].function_name = "job2";
+
+  // Act
+  for (const AsyncAnalysisJob& job : job_list) {
+    async_analysis::Submit(job);
+  }
+  bool has_pending_jobs = async_analysis::HasPendingJobs();
+  std::vector<AsyncAnalysisJob> finished_jobs = async_analysis::Wait();
+  int check_result = PyRun_SimpleString(
+      "assert [i for i, _ in async_test_idents] == [0, 2]\n"
+      "assert all(ident != main_ident for _, ident in async_test_idents)\n");
+  async_analysis::Finalize();
+
+  // Assert
+  EXPECT_TRUE(has_pending_jobs);
+  EXPECT_FALSE(async_analysis::HasPendingJobs());
+  EXPECT_TRUE(async_analysis::IsDone());
+  ASSERT_EQ(finished_jobs.size(), 3);
+  EXPECT_EQ(finished_jobs[0].function_name, "job0");
+  EXPECT_EQ(finished_jobs[0].exec_result, 0);
+  EXPECT_NE(finished_jobs[1].exec_result, 0);
+  EXPECT_EQ(finished_jobs[2].exec_result, 0);
+  EXPECT_EQ(check_result, 0);
+}
+
+TEST_F(TestPythonExecution, AsyncAnalysis_retired_step_runs_on_its_own_snapshot) {
+  // Arrange
+  PyRun_SimpleString("import sys, threading, types\n"
+                     "saved_libyt = sys.modules.get('libyt')\n"
+                     "libyt_mock = types.ModuleType('libyt')\n"
+                     "sys.modules['libyt'] = libyt_mock\n"
+                     "for key in ['param_yt', 'param_user', 'hierarchy', 'grid_data',\n"
+                     "            'particle_data']:\n"
+                     "    setattr(libyt_mock, key, {})\n"
+                     "libyt_mock.param_yt['step'] = 0\n"
+                     "release_event = threading.Event()\n"
+                     "record_event = threading.Event()\n"
+                     "seen_steps = []\n"
+                     "def block():\n"
+                     "    release_event.wait()\n"
+                     "def record():\n"
+                     "    import libyt\n"
+                     "    seen_steps.append(libyt.param_yt['step'])\n"
+                     "    record_event.wait()\n"
+                     "import inline_script\n"
+                     "inline_script.block = block\n"
+                     "inline_script.record = record\n");
+  PyObject* py_main = PyModule_GetDict(PyImport_AddModule("__main__"));
+  PyObject* py_libyt = PyDict_GetItemString(py_main, "libyt_mock");
+  PyObject* py_param_yt = PyObject_GetAttrString(py_libyt, "param_yt");
+  PyObject* py_param_user = PyObject_GetAttrString(py_libyt, "param_user");
+  PyObject* py_hierarchy = PyObject_GetAttrString(py_libyt, "hierarchy");
+  PyObject* py_grid_data = PyObject_GetAttrString(py_libyt, "grid_data");
+  PyObject* py_particle_data = PyObject_GetAttrString(py_libyt, "particle_data");
+  DataStructureAmr ds_amr;
+  ds_amr.SetPythonBindings(py_hierarchy, py_grid_data, py_particle_data);
+  async_analysis::Enable(true, 1, YT_ASYNC_SKIP_STEP);
+  std::vector<AsyncAnalysisJob> job_list(2);
+  job_list[0].function_name = "block";
+  job_list[1].function_name = "record";
+
+  // Act
+  std::vector<AsyncAnalysisJob> finished_jobs_step0;
+  async_analysis::BeginStep(finished_jobs_step0);
+  bool is_step0_skipped = async_analysis::IsStepSkipped();
+  PyRun_SimpleString("threading.Timer(0.5, release_event.set).start()\n");
+  for (const AsyncAnalysisJob& job : job_list) {
+    async_analysis::Submit(job);
+  }
+  async_analysis::RetireStep(0, ds_amr, py_param_yt, py_param_user);
+  PyRun_SimpleString("libyt_mock.param_yt.clear()\n"
+                     "libyt_mock.param_yt['step'] = 1\n");
+  std::vector<AsyncAnalysisJob> finished_jobs_step1;
+  async_analysis::BeginStep(finished_jobs_step1);
+  bool is_step1_skipped = async_analysis::IsStepSkipped();
+  PyRun_SimpleString("record_event.set()\n");
+  std::vector<AsyncAnalysisJob> finished_jobs = async_analysis::Wait();
+  int check_result = PyRun_SimpleString("assert seen_steps == [0]\n"
+                                        "assert libyt_mock.param_yt['step'] == 1\n");
+  async_analysis::Enable(false, 1, YT_ASYNC_BLOCK);
+  async_analysis::Finalize();
+  PyRun_SimpleString("if saved_libyt is not None:\n"
+                     "    sys.modules['libyt'] = saved_libyt\n"
+                     "else:\n"
+                     "    del sys.modules['libyt']\n");
+  Py_DECREF(py_param_yt);
+  Py_DECREF(py_param_user);
+  Py_DECREF(py_hierarchy);
+  Py_DECREF(py_grid_data);
+  Py_DECREF(py_particle_data);
+
+  // Assert
+  EXPECT_FALSE(is_step0_skipped);
+  EXPECT_TRUE(is_step1_skipped);
+  EXPECT_TRUE(finished_jobs_step0.empty());
+  EXPECT_TRUE(finished_jobs_step1.empty());
+  EXPECT_FALSE(async_analysis::HasPendingJobs());
+  ASSERT_EQ(finished_jobs.size(), 2);
+  EXPECT_EQ(finished_jobs[0].function_name, "block");
+  EXPECT_EQ(finished_jobs[1].function_name, "record");
+  EXPECT_EQ(finished_jobs[1].exec_result, 0);
+  EXPECT_EQ(check_result, 0);
+}
+
+TEST_F(TestPythonExecution, InlineFunction_can_call_cached_function_with_arguments) {
+  // Arrange
+  PyObject* py_namespace = GetScriptPyNamespace("inline_script");
+  PyObject* py_result = PyRun_String("calls = []\n"
+                                     "def record(*args, **kwargs):\n"
+                                     "    calls.append((args, kwargs))\n",
+                                     Py_file_input,
+                                     py_namespace,
+                                     py_namespace);
+  Py_XDECREF(py_result);
+
+  // Act
+  int result_first = inline_function::Call("record", "1, 'a', key=len(calls)");
+  int result_second = inline_function::Call("record", "1, 'a', key=len(calls)");
+  int result_no_args = inline_function::Call("record", "");
+  py_result = PyRun_String("def record(*args, **kwargs):\n"
+                           "    calls.append('redefined')\n",
+                           Py_file_input,
+                           py_namespace,
+                           py_namespace);
+  Py_XDECREF(py_result);
+  int result_redefined = inline_function::Call("record", "");
+  int result_not_defined = inline_function::Call("not_defined", "");
+  int check_result =
+      PyRun_SimpleString("import inline_script\n"
+                         "assert inline_script.calls == [((1, 'a'), {'key': 0}),\n"
+                         "                               ((1, 'a'), {'key': 1}),\n"
+                         "                               ((), {}), 'redefined']\n");
+  inline_function::InvalidateCache();
+
+  // Assert
+  EXPECT_EQ(result_first, 0);
+  EXPECT_EQ(result_second, 0);
+  EXPECT_EQ(result_no_args, 0);
+  EXPECT_EQ(result_redefined, 0);
+  EXPECT_NE(result_not_defined, 0);
+  EXPECT_EQ(check_result, 0);
+}
+
+TEST_F(TestPythonExecution, RunFunctionWithArgs_can_pass_scalars_strings_and_arrays) {
+  // Arrange
+  PyObject* py_namespace = GetScriptPyNamespace("inline_script");
+  PyObject* py_result = PyRun_String("typed_calls = []\n"
+                                     "def record_typed(*args, **kwargs):\n"
+                                     "    typed_calls.append((args, kwargs))\n",
+                                     Py_file_input,
+                                     py_namespace,
+                                     py_namespace);
+  Py_XDECREF(py_result);
+  numpy_controller::InitializeNumPy();
+  PyObject* py_interactive_mode = Py_BuildValue("{s{}}", "func_err_msg");
+  LibytProcessControl::Get().py_interactive_mode_ = py_interactive_mode;
+  LibytProcessControl::Get().libyt_initialized_ = true;
+
+  int step = 10;
+  double time = 0.5;
+  double array[2][3] = {{0.0, 1.0, 2.0}, {3.0, 4.0, 5.0}};
+  yt_arg args[4];
+  args[0].arg_type = YT_ARG_SCALAR;
+  args[0].data_dtype = YT_INT;
+  args[0].data_ptr = &step;
+  args[1].arg_type = YT_ARG_ARRAY;
+  args[1].data_dtype = YT_DOUBLE;
+  args[1].data_ptr = array;
+  args[1].num_dims = 2;
+  args[1].data_dimensions[0] = 2;
+  args[1].data_dimensions[1] = 3;
+  args[2].arg_type = YT_ARG_STRING;
+  args[2].data_ptr = "density";
+  args[2].keyword = "field";
+  args[3].arg_type = YT_ARG_SCALAR;
+  args[3].data_dtype = YT_DOUBLE;
+  args[3].data_ptr = &time;
+  args[3].keyword = "time";
+
+  // Act
+  int result = yt_run_FunctionWithArgs("record_typed", args, 4);
+  int result_no_args = yt_run_FunctionWithArgs("record_typed", nullptr, 0);
+  args[1].num_dims = 0;
+  int result_invalid = yt_run_FunctionWithArgs("record_typed", args, 4);
+  LibytProcessControl::Get().libyt_initialized_ = false;
+  LibytProcessControl::Get().py_interactive_mode_ = nullptr;
+  Py_DECREF(py_interactive_mode);
+  int check_result = PyRun_SimpleString(
+      "import inline_script\n"
+      "calls = inline_script.typed_calls\n"
+      "assert len(calls) == 2\n"
+      "(step, array), kwargs = calls[0]\n"
+      "assert step == 10 and kwargs == {'field': 'density', 'time': 0.5}\n"
+      "assert array.shape == (2, 3) and array[1, 2] == 5.0\n"
+      "assert not array.flags.writeable and not array.flags.owndata\n"
+      "assert calls[1] == ((), {})\n");
+  inline_function::InvalidateCache();
+
+  // Assert
+  EXPECT_EQ(result, YT_SUCCESS);
+  EXPECT_EQ(result_no_args, YT_SUCCESS);
+  EXPECT_EQ(result_invalid, YT_FAIL);
+  EXPECT_EQ(check_result, 0);
+}
+
 TEST_F(TestPythonExecution, AllExecuteCell_can_resolve_an_invalid_arbitrary_code) {
   // Arrange
   int src_mpi_rank = 0;
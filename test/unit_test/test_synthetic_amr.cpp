@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "synthetic_amr.h"
+
+class TestSyntheticAmr : public testing::Test {
+ protected:
+  SyntheticAmrConfig config_;
+
+  void SetUp() override {
+    config_.num_root_grids[0] = 4;
+    config_.num_root_grids[1] = 2;
+    config_.num_root_grids[2] = 2;
+    config_.num_levels = 3;
+    config_.refine_fraction = 0.25;
+  }
+};
+
+TEST_F(TestSyntheticAmr, Can_generate_nested_hierarchy) {
+  // Arrange
+  const long kNumRoot = 4 * 2 * 2;
+  const long kNumLevel1 = 4 * 8;  // 4 of 16 root grids refined, each has 2^3 children
+  const long kNumLevel2 = 8 * 8;  // 8 of 32 level-1 grids refined
+
+  // Act
+  SyntheticAmr amr(config_, 1, 0);
+
+  // Assert
+  ASSERT_EQ(amr.GetNumGrids(), kNumRoot + kNumLevel1 + kNumLevel2);
+  for (const SyntheticGrid& grid : amr.GetGridList()) {
+    if (grid.level == 0) {
+      EXPECT_EQ(grid.parent_id, -1);
+      continue;
+    }
+    const SyntheticGrid& parent = amr.GetGridList()[grid.parent_id];
+    EXPECT_EQ(parent.level, grid.level - 1);
+    for (int d = 0; d < 3; d++) {
+      EXPECT_GE(grid.left_edge[d], parent.left_edge[d]);
+      EXPECT_LE(grid.right_edge[d], parent.right_edge[d]);
+      EXPECT_DOUBLE_EQ(grid.right_edge[d] - grid.left_edge[d],
+                       (parent.right_edge[d] - parent.left_edge[d]) / 2);
+    }
+  }
+}
+
+TEST_F(TestSyntheticAmr, Can_distribute_every_grid_to_exactly_one_rank_evenly) {
+  for (SyntheticAmrDistribution distribution :
+       {SyntheticAmrDistribution::kDistributionBlock,
+        SyntheticAmrDistribution::kDistributionMorton,
+        SyntheticAmrDistribution::kDistributionRandom}) {
+    // Arrange
+    const int kMpiSize = 3;
+    config_.distribution = distribution;
+    std::set<long> id_set;
+    long min_count = -1, max_count = -1, num_grids = 0;
+
+    // Act
+    for (int rank = 0; rank < kMpiSize; rank++) {
+      SyntheticAmr amr(config_, kMpiSize, rank);
+      num_grids = amr.GetNumGrids();
+      for (long gid : amr.GetLocalIdList()) {
+        EXPECT_EQ(amr.GetGridList()[gid].mpi_rank, rank);
+        id_set.insert(gid);
+      }
+      long count = amr.GetNumGridsLocal();
+      min_count = (min_count < 0) ? count : std::min(min_count, count);
+      max_count = std::max(max_count, count);
+    }
+
+    // Assert
+    EXPECT_EQ(static_cast<long>(id_set.size()), num_grids);
+    EXPECT_LE(max_count - min_count, 1);
+  }
+}
+
+TEST_F(TestSyntheticAmr, Can_generate_same_data_set_from_same_seed) {
+  // Arrange
+  config_.distribution = SyntheticAmrDistribution::kDistributionRandom;
+  config_.num_fields = 2;
+  config_.num_ghost_cells = 1;
+
+  // Act
+  SyntheticAmr amr1(config_, 2, 1);
+  SyntheticAmr amr2(config_, 2, 1);
+
+  // Assert
+  ASSERT_EQ(amr1.GetLocalIdList(), amr2.GetLocalIdList());
+  EXPECT_EQ(amr1.GetNumCellsPerGrid(), 10 * 10 * 10);
+  for (long lid = 0; lid < amr1.GetNumGridsLocal(); lid++) {
+    for (int v = 0; v < 2; v++) {
+      const double* data1 = amr1.GetFieldData(lid, v);
+      const double* data2 = amr2.GetFieldData(lid, v);
+      ASSERT_NE(data1, nullptr);
+      for (long idx = 0; idx < amr1.GetNumCellsPerGrid(); idx++) {
+        EXPECT_DOUBLE_EQ(data1[idx], data2[idx]);
+      }
+    }
+  }
+  EXPECT_EQ(amr1.GetFieldData(0, 2), nullptr);
+}